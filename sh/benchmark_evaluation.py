@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+"""
+Time the programs of tests/evaluation interpreted and compiled, to compare
+the interpreter with the synthesiser, and optionally with a baseline build of
+souffle.
+
+Each program is run interpreted, and compiled to a binary once with -o, after
+which only the runs of the binary are timed. The median of the repeated runs
+is reported, along with the ratio of interpreted to compiled time.
+
+Example, comparing a build with a baseline build:
+
+    sh/benchmark_evaluation.py --souffle build/src/souffle \\
+        --baseline baseline-build/src/souffle --repeat 5 -j 1
+"""
+
+import argparse
+import pathlib
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# Programs of tests/evaluation spending most of their time in evaluation rather than I/O
+DEFAULT_TESTS = [
+    "aggregates",
+    "inline_nqueens",
+    "magic_dfa",
+    "magic_nqueens",
+    "magic_perfect_numbers",
+    "magic_turing1",
+    "mrtc",
+    "sum-aggregate",
+]
+
+root = pathlib.Path(__file__).absolute().parent.parent
+
+
+def fact_dir(test_dir):
+    facts = test_dir / "facts"
+    return facts if facts.is_dir() else test_dir
+
+
+def timed_run(cmd, cwd):
+    start = time.perf_counter()
+    status = subprocess.run(cmd, cwd=cwd, capture_output=True, text=True)
+    elapsed = time.perf_counter() - start
+    if status.returncode != 0:
+        sys.stderr.write(status.stderr)
+        raise RuntimeError("Error: command failed: {}".format(" ".join(map(str, cmd))))
+    return elapsed
+
+
+def benchmark(souffle, test, args, workdir):
+    test_dir = root / "tests" / "evaluation" / test
+    program = test_dir / "{}.dl".format(test)
+    if not program.exists():
+        raise RuntimeError("Cannot find program: '{}'".format(program))
+    common = ["-F", str(fact_dir(test_dir)), "-D", str(workdir), "-j", str(args.jobs)]
+
+    interpreted = [timed_run([souffle] + common + [str(program)], workdir) for _ in range(args.repeat)]
+
+    binary = workdir / test
+    timed_run([souffle] + common + ["-o", str(binary), str(program)], workdir)
+    compiled = [timed_run([str(binary)] + common, workdir) for _ in range(args.repeat)]
+
+    return statistics.median(interpreted), statistics.median(compiled)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Time the interpreter and the synthesiser on evaluation tests")
+    parser.add_argument('--souffle', required=True, type=lambda p: pathlib.Path(p).absolute(), help="souffle binary")
+    parser.add_argument('--baseline', type=lambda p: pathlib.Path(p).absolute(), help="souffle binary to compare with")
+    parser.add_argument('--repeat', type=int, default=3, help="Number of timed runs of each program")
+    parser.add_argument('-j', dest='jobs', default="1", help="Number of threads of the programs")
+    parser.add_argument('tests', nargs='*', default=DEFAULT_TESTS, help="Names of the evaluation tests")
+    args = parser.parse_args()
+
+    builds = [("", args.souffle)]
+    if args.baseline:
+        builds = [("baseline ", args.baseline), ("", args.souffle)]
+
+    columns = []
+    for label, _ in builds:
+        columns += ["{}interpreted".format(label), "{}compiled".format(label), "{}ratio".format(label)]
+    sys.stdout.write("{:<24}".format("test") + "".join("{:>22}".format(c) for c in columns) + "\n")
+
+    for test in args.tests:
+        row = []
+        for _, souffle in builds:
+            workdir = pathlib.Path(tempfile.mkdtemp(prefix="souffle-benchmark-"))
+            try:
+                interpreted, compiled = benchmark(str(souffle), test, args, workdir)
+            finally:
+                shutil.rmtree(workdir, ignore_errors=True)
+            row += ["{:.3f}s".format(interpreted), "{:.3f}s".format(compiled),
+                    "{:.2f}x".format(interpreted / compiled if compiled > 0 else float('inf'))]
+        sys.stdout.write("{:<24}".format(test) + "".join("{:>22}".format(c) for c in row) + "\n")
+        sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
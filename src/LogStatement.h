@@ -118,6 +118,14 @@ public:
         return line.str();
     }
 
+    static const std::string mRecursiveRelation(
+            const std::string& relationName, const SrcLocation& srcLocation) {
+        const char* messageType = "@m-recursive-relation";
+        std::stringstream line;
+        line << messageType << ";" << relationName << ";" << str(srcLocation) << ";";
+        return line.str();
+    }
+
     static const std::string pProofCounter(
             const std::string& relationName, const SrcLocation& srcLocation, const std::string& datalogText) {
         // TODO (#590): the profiler should be modified to use this type of log message, as currently these
@@ -69,6 +69,7 @@
 #include "ast2ram/seminaive/UnitTranslator.h"
 #include "ast2ram/utility/TranslatorContext.h"
 #include "config.h"
+#include "interpreter/CompiledStrata.h"
 #include "interpreter/Engine.h"
 #include "interpreter/ProgInterface.h"
 #include "parser/ParserDriver.h"
@@ -79,6 +80,7 @@
 #include "ram/transform/Conditional.h"
 #include "ram/transform/EliminateDuplicates.h"
 #include "ram/transform/ExpandFilter.h"
+#include "ram/transform/HashSetSelection.h"
 #include "ram/transform/HoistAggregate.h"
 #include "ram/transform/HoistConditions.h"
 #include "ram/transform/IfConversion.h"
@@ -175,14 +177,19 @@ namespace souffle {
 }
 
 /**
- * Compiles the given source file to a binary file.
+ * Returns the arguments of the command compiling the given source files to a binary file, or to a
+ * shared library.
  */
-void compileToBinary(
-        Global& glb, const std::string& command, std::vector<fs::path>& sourceFilenames, fs::path binary) {
+std::vector<std::string> compileArguments(Global& glb, const std::string& command,
+        const std::vector<fs::path>& sourceFilenames, const fs::path& binary, bool sharedLibrary) {
     std::vector<std::string> argv;
 
     argv.push_back(command);
 
+    if (sharedLibrary) {
+        argv.push_back("--shared");
+    }
+
     if (glb.config().has("swig")) {
         argv.push_back("-s");
         argv.push_back(glb.config().get("swig"));
@@ -192,6 +199,11 @@ void compileToBinary(
         argv.push_back("-v");
     }
 
+    if (glb.config().has("object-cache")) {
+        argv.push_back("--object-cache");
+        argv.push_back(glb.config().get("object-cache"));
+    }
+
     for (auto&& path : glb.config().getMany("library-dir")) {
         // The first entry may be blank
         if (path.empty()) {
@@ -213,17 +225,106 @@ void compileToBinary(
 
     argv.push_back("-o");
     argv.push_back(binary.string());
+    return argv;
+}
 
+/**
+ * Returns the interpreter of the command compiling C++ sources.
+ */
+const char* compilerInterpreter() {
 #if defined(_MSC_VER)
-    const char* interpreter = "python";
+    return "python";
 #else
-    const char* interpreter = "python3";
+    return "python3";
 #endif
-    auto exit = execute(interpreter, argv);
-    if (!exit) throw std::invalid_argument(tfm::format("unable to execute tool <python3 %s>", command));
+}
+
+/**
+ * Runs the command compiling C++ sources with the given arguments.
+ */
+void runCompiler(const std::vector<std::string>& argv) {
+    auto exit = execute(compilerInterpreter(), argv);
+    if (!exit) throw std::invalid_argument(tfm::format("unable to execute tool <python3 %s>", argv.front()));
     if (*exit != 0) throw std::invalid_argument("failed to compile C++ sources");
 }
 
+/**
+ * Compiles the given source file to a binary file.
+ */
+void compileToBinary(
+        Global& glb, const std::string& command, std::vector<fs::path>& sourceFilenames, fs::path binary) {
+    runCompiler(compileArguments(glb, command, sourceFilenames, binary, false));
+}
+
+/**
+ * Synthesises the heaviest strata of the program, and compiles them into a shared library in the
+ * background for the interpreter to run them once built.
+ */
+Own<interpreter::CompiledStrata> compileStrataInBackground(
+        Global& glb, ram::TranslationUnit& ramTranslationUnit, const std::string& souffleExecutable) {
+    const ram::Program& program = ramTranslationUnit.getProgram();
+    const std::string profile = glb.config().has("hybrid-profile") ? glb.config().get("hybrid-profile") : "";
+    const auto strata = interpreter::CompiledStrata::selectStrata(
+            program, std::stoul(glb.config().get("hybrid")), profile);
+    if (strata.empty()) {
+        return nullptr;
+    }
+
+    const auto souffle_compile = findTool("souffle-compile.py", souffleExecutable, ".");
+    if (!souffle_compile) {
+        std::cerr << "Warning: failed to locate souffle-compile.py, strata are interpreted" << std::endl;
+        return nullptr;
+    }
+
+    // The strata are synthesised as the subroutines of a program of their own, before the
+    // interpreter starts using the translation unit
+    ram::TranslationUnit strataUnit(glb, interpreter::CompiledStrata::extractStrata(program, strata),
+            ramTranslationUnit.getErrorReport(), ramTranslationUnit.getDebugReport());
+
+    // The build takes place in the temporary directory, and its files are removed along with the
+    // compiled strata
+    const std::string placeholder = tempFile();
+    remove(placeholder.c_str());
+    const std::string baseFilename =
+            (fs::temp_directory_path() / fs::path(placeholder).filename()).string();
+    const std::string baseIdentifier = identifier(simpleName(baseFilename));
+    bool withSharedLibrary;
+    synthesiser::GenDb db;
+    synthesiser::Synthesiser(strataUnit).generateCode(db, baseIdentifier, withSharedLibrary);
+
+    std::vector<fs::path> srcFiles{fs::path(baseFilename + ".cpp")};
+    std::ofstream os{srcFiles.front()};
+    db.emitSingleFile(os);
+    os.close();
+
+    if (withSharedLibrary) {
+        if (!glb.config().has("libraries")) {
+            glb.config().set("libraries", "functors");
+        }
+        if (!glb.config().has("library-dir")) {
+            glb.config().set("library-dir", ".");
+        }
+    }
+
+    if (glb.config().has("verbose")) {
+        std::cout << "Compiling strata in the background: " << join(strata, ", ") << "\n";
+    }
+
+    // The build runs in a process of its own, stopped if the interpreter completes first
+    const fs::path library(baseFilename + ".so");
+    std::vector<std::string> command{compilerInterpreter()};
+    for (auto&& arg : compileArguments(glb, *souffle_compile, srcFiles, library, true)) {
+        command.push_back(arg);
+    }
+    auto compiledStrata = mk<interpreter::CompiledStrata>(program, strata,
+            "__factory_Sf_" + baseIdentifier + "_newInstance", std::move(command), library.string(),
+            std::vector<std::string>{srcFiles.front().string()});
+    if (glb.config().has("hybrid-sync")) {
+        compiledStrata->wait();
+    }
+    return compiledStrata;
+}
+
 class InputProvider {
 public:
     virtual ~InputProvider() {}
@@ -549,13 +650,14 @@ Own<ram::transform::Transformer> ramTransformerSequence(Global& glb) {
                     // job count of 0 means all cores are used.
                     [&]() -> bool { return std::stoi(glb.config().get("jobs")) != 1; },
                     mk<ParallelTransformer>()),
-            mk<ReportIndexTransformer>());
+            mk<HashSetSelectionTransformer>(), mk<ReportIndexTransformer>());
     // clang-format on
 
     return ramTransform;
 }
 
-bool interpretTranslationUnit(Global& glb, ram::TranslationUnit& ramTranslationUnit) {
+bool interpretTranslationUnit(Global& glb, ram::TranslationUnit& ramTranslationUnit,
+        Own<interpreter::CompiledStrata> compiledStrata) {
     try {
         std::thread profiler;
         // Start up profiler if needed
@@ -570,6 +672,9 @@ bool interpretTranslationUnit(Global& glb, ram::TranslationUnit& ramTranslationU
         // configure and execute interpreter
         const std::size_t numThreadsOrZero = std::stoi(glb.config().get("jobs"));
         Own<interpreter::Engine> interpreter(mk<interpreter::Engine>(ramTranslationUnit, numThreadsOrZero));
+        if (compiledStrata != nullptr) {
+            interpreter->setCompiledStrata(std::move(compiledStrata));
+        }
         interpreter->executeMain();
         // If the profiler was started, join back here once it exits.
         if (profiler.joinable()) {
@@ -595,6 +700,10 @@ bool interpretTranslationUnit(Global& glb, ram::TranslationUnit& ramTranslationU
     }
 }
 
+bool interpretTranslationUnit(Global& glb, ram::TranslationUnit& ramTranslationUnit) {
+    return interpretTranslationUnit(glb, ramTranslationUnit, nullptr);
+}
+
 const char* packageVersion() {
     return PACKAGE_VERSION;
 }
@@ -639,8 +748,20 @@ std::vector<MainOption> getMainOptions() {
     // clang-format off
   std::vector<MainOption> options{
       {"", 0, "", "", false, ""},
+      {"adaptive-joins", nextOptChar++, "", "", false,
+          "Let the interpreter reorder the joins of recursive rules between iterations, given the "
+          "sizes of their relations."},
+      {"arena-symbols", nextOptChar++, "", "", false,
+          "Store the characters of symbols in contiguous, append-only arenas rather than in "
+          "individual strings; takes precedence over --sharded-symbols."},
       {"auto-schedule", 'a', "FILE", "", false,
           "Use profile auto-schedule <FILE> for auto-scheduling."},
+      {"batch-execution", nextOptChar++, "", "", false,
+          "Evaluate the scans, filters and insertions of the interpreter on blocks of tuples "
+          "rather than tuple by tuple."},
+      {"checkpoint", nextOptChar++, "DIR", "", false,
+          "Save the live relations and the symbol and record tables to <DIR> after each "
+          "stratum, and resume from the last saved stratum. Auto-increment functors are rejected."},
       {"compile", 'c', "", "", false,
           "Generate C++ source code, compile to a binary executable, then run this "
           "executable."},
@@ -648,6 +769,9 @@ std::vector<MainOption> getMainOptions() {
           "Generate C++ source code in multiple files, compile to a binary executable, then "
           "run this "
           "executable."},
+      {"compact-records", nextOptChar++, "", "", false,
+          "Release the records no longer referenced by live relations after each stratum. "
+          "Type casts from or to record types are rejected."},
       {"debug-report", 'r', "FILE", "", false,
           "Write HTML debug report to <FILE>."},
       {"disable-transformers", 'z', "TRANSFORMERS", "", false,
@@ -670,10 +794,21 @@ std::vector<MainOption> getMainOptions() {
        "namespace."},
       {"help", 'h', "", "", false,
           "Display this help message."},
+      {"hybrid", nextOptChar++, "N", "", false,
+          "Compile the <N> heaviest strata in the background while interpreting, and run them "
+          "compiled once built."},
+      {"hybrid-profile", nextOptChar++, "FILE", "", false,
+          "Weigh the strata compiled with --hybrid by the profile <FILE> of a previous run."},
+      {"hybrid-sync", nextOptChar++, "", "", false,
+          "Wait for the strata of --hybrid to be compiled before interpreting, such that they always "
+          "run compiled."},
       {"include-dir", 'I', "DIR", ".", true,
           "Specify directory for include files."},
       {"inline-exclude", nextOptChar++, "RELATIONS", "", false,
           "Prevent the given relations from being inlined. Overrides any `inline` qualifiers."},
+      {"insert-buffers", nextOptChar++, "RELATIONS", "", false,
+          "Collect the tuples inserted into the given relations by parallel loops in "
+          "thread-local buffers, use '*' for all."},
       {"jobs", 'j', "N", "1", false,
           "Run interpreter/compiler in parallel using N threads, N=auto for system "
           "default."},
@@ -693,10 +828,16 @@ std::vector<MainOption> getMainOptions() {
       {"magic-transform-exclude", nextOptChar++, "RELATIONS", "", false,
           "Disable magic set transformation changes on the given relations. Overrides "
           "`magic-transform`. Implies `inline-exclude` for the given relations."},
+      {"memory-budget", nextOptChar++, "MB", "", false,
+          "Move the relations not needed by the next stratum to disk between strata while the "
+          "relations in memory exceed <MB> megabytes, and load them back once needed."},
       {"no-preprocessor", nextOptChar++, "", "", false,
           "Do not use a C preprocessor."},
       {"no-warn", 'w', "", "", false,
           "Disable warnings."},
+      {"object-cache", nextOptChar++, "DIR", "", false,
+          "Compile the generated C++ source files one by one, and reuse the object files of those "
+          "unchanged since a previous compilation from <DIR>."},
       {"output-dir", 'D', "DIR", ".", false,
           "Specify directory for output files. If <DIR> is `-` then stdout is used."},
       {"parse-errors", nextOptChar++, "", "", false,
@@ -711,6 +852,9 @@ std::vector<MainOption> getMainOptions() {
           "Enable the frequency counter in the profiler."},
       {"provenance", 't', "[ none | explain | explore ]", "", false,
           "Enable provenance instrumentation and interaction."},
+      {"sharded-symbols", nextOptChar++, "", "", false,
+          "Use a sharded, lock-free symbol table with per-thread lookup caches, for "
+          "programs encoding symbols from many threads."},
       {"show", nextOptChar++, "[ <see-list> ]", "", true,
           "Print selected program information.\n"
           "Modes:\n"
@@ -724,9 +868,18 @@ std::vector<MainOption> getMainOptions() {
               "\ttransformed-ast\n"
               "\ttransformed-ram\n"
               "\ttype-analysis"},
+      {"spill-dir", nextOptChar++, "DIR", "", false,
+          "Specify directory for the relations moved to disk by --memory-budget; defaults to the "
+          "directory of temporary files."},
       {"swig", 's', "LANG", "", false,
           "Generate SWIG interface for given language. The values <LANG> accepts is java and "
           "python. "},
+      {"table-snapshot", nextOptChar++, "FILE", "", false,
+          "Start from the symbol and record tables saved in <FILE>, if it exists, and save "
+          "them to <FILE> at the end of the run."},
+      {"unboxed-records", nextOptChar++, "", "", false,
+          "Encode records and ADTs of small fields in the values referring to them rather than "
+          "in the record table."},
       {"verbose", 'v', "", "", false,
           "Verbose output."},
       {"version", nextOptChar++, "", "", false,
@@ -735,6 +888,9 @@ std::vector<MainOption> getMainOptions() {
           "Enable a warning."},
       {"wno", nextOptChar++, "WARN", "none", true,
           "Disable a specific warning."},
+      {"work-stealing", nextOptChar++, "", "", false,
+          "Let the threads of parallel loops steal iterations from each other rather than share "
+          "them through OpenMP, for relations of skewed tuples."},
       // TODO(lb):
       // {"Werror", '\xc', "WARN", "none", false, "Turn a warning into an error."},
   };
@@ -848,6 +1004,37 @@ int main(Global& glb, const char* souffle_executable) {
                 throw std::runtime_error("must be profiling to use emit-statistics");
         }
 
+        /* strata compiled in the background run outside of the profiler and of provenance */
+        if (glb.config().has("hybrid")) {
+            if (!isNumber(glb.config().get("hybrid").c_str()) || std::stoi(glb.config().get("hybrid")) < 1) {
+                throw std::runtime_error("--hybrid may only be set to an integer greater than 0.");
+            }
+            if (glb.config().has("profile") || glb.config().has("provenance")) {
+                throw std::runtime_error("--hybrid cannot be used with profiling or provenance.");
+            }
+        }
+
+        /* relations are spilled between consecutive strata, whereas checkpoints save them */
+        if (glb.config().has("memory-budget")) {
+            const std::string& budget = glb.config().get("memory-budget");
+            if (budget.empty() || !isNumber(budget.c_str()) || std::stoll(budget) < 1) {
+                throw std::runtime_error("--memory-budget may only be set to an integer greater than 0.");
+            }
+            if (glb.config().has("checkpoint")) {
+                throw std::runtime_error("--memory-budget cannot be used with --checkpoint.");
+            }
+        }
+
+        /* the bindings of SWIG are compiled along with the program in a single step */
+        if (glb.config().has("object-cache")) {
+            if (glb.config().get("object-cache").empty()) {
+                throw std::runtime_error("--object-cache requires a directory.");
+            }
+            if (glb.config().has("swig")) {
+                throw std::runtime_error("--object-cache cannot be used with --swig.");
+            }
+        }
+
     } catch (std::exception& e) {
         std::cerr << e.what() << std::endl;
         exit(EXIT_FAILURE);
@@ -1067,7 +1254,12 @@ int main(Global& glb, const char* souffle_executable) {
     try {
         if (must_interpret) {
             // ------- interpreter -------------
-            const bool success = interpretTranslationUnit(glb, *ramTranslationUnit);
+            Own<interpreter::CompiledStrata> compiledStrata;
+            if (glb.config().has("hybrid")) {
+                compiledStrata = compileStrataInBackground(glb, *ramTranslationUnit, souffleExecutable);
+            }
+            const bool success =
+                    interpretTranslationUnit(glb, *ramTranslationUnit, std::move(compiledStrata));
             if (!success) {
                 std::exit(EXIT_FAILURE);
             }
@@ -1098,6 +1290,13 @@ int main(Global& glb, const char* souffle_executable) {
 
             std::string baseIdentifier = identifier(simpleName(baseFilename));
 
+            // The code generated for a temporary file is named after the program instead, such that
+            // it is the same from one run to the next and its objects can be reused from the cache
+            std::string programIdentifier = baseIdentifier;
+            if (!compile_mode && !generate_mode && !generate_many_mode) {
+                programIdentifier = identifier(simpleName(glb.config().get("")));
+            }
+
             std::string binaryFilename = baseFilename;
 
             bool withSharedLibrary;
@@ -1107,7 +1306,7 @@ int main(Global& glb, const char* souffle_executable) {
                     glb.config().has("generate-many") || glb.config().has("compile-many");
 
             synthesiser::GenDb db;
-            synthesiser->generateCode(db, baseIdentifier, withSharedLibrary);
+            synthesiser->generateCode(db, programIdentifier, withSharedLibrary);
             std::vector<fs::path> srcFiles;
 
             if (emitToStdOut) {
@@ -36,6 +36,7 @@ enum class RelationTag {
     BTREE,         // use btree data-structure
     BTREE_DELETE,  // use btree_delete data-structure
     EQREL,         // use union data-structure
+    HASHSET,       // use hash set data-structure
 };
 
 /** Space of qualifiers that a relation can have */
@@ -59,6 +60,7 @@ enum class RelationRepresentation {
     BTREE_DELETE,  // use btree_delete data-structure
     EQREL,         // use union data-structure
     INFO,          // info relation for provenance
+    HASHSET,       // use hash set data-structure
 };
 
 /**
@@ -69,7 +71,8 @@ inline bool isRelationRepresentationTag(const RelationTag& tag) {
         case RelationTag::BRIE:
         case RelationTag::BTREE:
         case RelationTag::BTREE_DELETE:
-        case RelationTag::EQREL: return true;
+        case RelationTag::EQREL:
+        case RelationTag::HASHSET: return true;
         default: return false;
     }
 }
@@ -119,6 +122,7 @@ inline RelationRepresentation getRelationRepresentationFromTag(const RelationTag
         case RelationTag::BTREE: return RelationRepresentation::BTREE;
         case RelationTag::BTREE_DELETE: return RelationRepresentation::BTREE_DELETE;
         case RelationTag::EQREL: return RelationRepresentation::EQREL;
+        case RelationTag::HASHSET: return RelationRepresentation::HASHSET;
         default: fatal("invalid relation tag");
     }
 
@@ -140,6 +144,7 @@ inline std::ostream& operator<<(std::ostream& os, RelationTag qualifier) {
         case RelationTag::BTREE: return os << "btree";
         case RelationTag::BTREE_DELETE: return os << "btree_delete";
         case RelationTag::EQREL: return os << "eqrel";
+        case RelationTag::HASHSET: return os << "hashset";
     }
 
     UNREACHABLE_BAD_CASE_ANALYSIS
@@ -168,6 +173,7 @@ inline std::ostream& operator<<(std::ostream& os, RelationRepresentation represe
         case RelationRepresentation::BRIE: return os << "brie";
         case RelationRepresentation::EQREL: return os << "eqrel";
         case RelationRepresentation::INFO: return os << "info";
+        case RelationRepresentation::HASHSET: return os << "hashset";
         case RelationRepresentation::DEFAULT: return os;
     }
 
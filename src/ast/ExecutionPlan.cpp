@@ -45,7 +45,9 @@ Node::NodeVec ExecutionPlan::getChildren() const {
 }
 
 void ExecutionPlan::print(std::ostream& out) const {
-    if (!plans.empty()) {
+    if (leapfrog) {
+        out << " .plan leapfrog";
+    } else if (!plans.empty()) {
         out << " .plan ";
         out << join(plans, ", ",
                 [](std::ostream& os, const auto& arg) { os << arg.first << ":" << *arg.second; });
@@ -54,7 +56,7 @@ void ExecutionPlan::print(std::ostream& out) const {
 
 bool ExecutionPlan::equal(const Node& node) const {
     const auto& other = asAssert<ExecutionPlan>(node);
-    return equal_targets(plans, other.plans);
+    return leapfrog == other.leapfrog && equal_targets(plans, other.plans);
 }
 
 ExecutionPlan* ExecutionPlan::cloning() const {
@@ -62,6 +64,7 @@ ExecutionPlan* ExecutionPlan::cloning() const {
     for (auto& plan : plans) {
         res->setOrderFor(plan.first, clone(plan.second));
     }
+    res->setLeapfrog(leapfrog);
     return res.release();
 }
 
@@ -29,10 +29,12 @@ namespace souffle::ast {
  *
  * An user-defined execution plan consists of one or more
  * execution orders. An execution order is a permutation
- * of atoms in a clause.
+ * of atoms in a clause. Alternatively, a plan may request
+ * a worst-case optimal join (leapfrog triejoin) of the atoms.
  *
  * Example:
  *   .plan 0:(1,2,3), 2:(3,2,1)
+ *   .plan leapfrog
  *
  */
 class ExecutionPlan : public Node {
@@ -47,6 +49,16 @@ public:
     /** Get orders */
     std::map<std::size_t, const ExecutionOrder*> getOrders() const;
 
+    /** Request a leapfrog join for all versions of the clause */
+    void setLeapfrog(bool value) {
+        leapfrog = value;
+    }
+
+    /** Whether a leapfrog join is requested */
+    bool isLeapfrog() const {
+        return leapfrog;
+    }
+
     void apply(const NodeMapper& map) override;
 
     NodeVec getChildren() const override;
@@ -64,6 +76,9 @@ private:
 private:
     /** Mapping versions of clauses to execution orders */
     std::map<std::size_t, Own<ExecutionOrder>> plans;
+
+    /** Leapfrog join requested */
+    bool leapfrog = false;
 };
 
 }  // namespace souffle::ast
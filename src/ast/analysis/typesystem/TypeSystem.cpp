@@ -16,6 +16,8 @@
 
 #include "ast/analysis/typesystem/TypeSystem.h"
 #include "ast/Type.h"
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
 #include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include "souffle/utility/StringUtil.h"
@@ -420,6 +422,71 @@ bool isADTEnum(const AlgebraicDataType& type) {
     return all_of(type.getBranches(), [](auto& branch) { return branch.types.empty(); });
 }
 
+namespace {
+
+/** The least width of fields sharing the bits of unboxed records */
+constexpr unsigned MIN_SHARED_WIDTH = 8;
+
+/** Return the number of bits of the two's complement of the indices of the given number of branches */
+unsigned getBranchIndexWidth(std::size_t branches) {
+    unsigned width = 1;
+    while ((std::size_t(1) << (width - 1)) < branches) {
+        ++width;
+    }
+    return width;
+}
+
+/** Distribute the bits of unboxed records among the fields of unknown width, marked by 0 */
+std::vector<unsigned> distributeWidths(std::vector<unsigned> widths) {
+    const unsigned available = RAM_DOMAIN_SIZE - 1;
+    if (widths.empty() || widths.size() > MAX_UNBOXED_ARITY) {
+        return {};
+    }
+
+    unsigned fixed = 0;
+    unsigned shared = 0;
+    for (unsigned width : widths) {
+        fixed += width;
+        shared += width == 0 ? 1 : 0;
+    }
+    if (fixed > available) {
+        return {};
+    }
+    if (shared == 0) {
+        return widths;
+    }
+
+    const unsigned remaining = available - fixed;
+    if (remaining / shared < MIN_SHARED_WIDTH) {
+        return {};
+    }
+    unsigned extra = remaining % shared;
+    for (auto& width : widths) {
+        if (width == 0) {
+            width = remaining / shared + (extra > 0 ? 1 : 0);
+            extra -= extra > 0 ? 1 : 0;
+        }
+    }
+    return widths;
+}
+
+}  // namespace
+
+std::vector<unsigned> getUnboxedWidths(const std::vector<const Type*>& fieldTypes) {
+    std::vector<unsigned> widths;
+    for (const auto* field : fieldTypes) {
+        const auto* adt = as<AlgebraicDataType>(skipAliasesType(*field));
+        const bool isEnum = adt != nullptr && isADTEnum(*adt);
+        widths.push_back(isEnum ? getBranchIndexWidth(adt->getBranches().size()) : 0);
+    }
+    return distributeWidths(std::move(widths));
+}
+
+std::vector<unsigned> getUnboxedBranchWidths(const AlgebraicDataType& type) {
+    assert(!isADTEnum(type) && "enumerations are no records");
+    return distributeWidths({getBranchIndexWidth(type.getBranches().size()), 0});
+}
+
 const Type& getBaseType(const Type* type) {
     if (auto subset = as<SubsetType>(type)) {
         return getBaseType(&subset->getBaseType());
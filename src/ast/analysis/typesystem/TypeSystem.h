@@ -672,6 +672,17 @@ inline bool isNumericType(const TypeSet& type) {
  */
 bool isADTEnum(const AlgebraicDataType& type);
 
+/**
+ * Return the bit widths of the fields of unboxed records whose fields have the
+ * given types (see souffle/RecordTable.h), or no widths if such records are
+ * always stored in the record table. Fields of enumerations take the bits of
+ * their branch indices; the other fields share the remaining bits.
+ */
+std::vector<unsigned> getUnboxedWidths(const std::vector<const Type*>& fieldTypes);
+
+/** Return the bit widths of the unboxed [branch, argument] pairs of an ADT, which is no enumeration */
+std::vector<unsigned> getUnboxedBranchWidths(const AlgebraicDataType& type);
+
 /** Check whether it is a oderable type */
 inline bool isOrderableType(const TypeSet& type) {
     return isNumericType(type) || isOfKind(type, TypeAttribute::Symbol);
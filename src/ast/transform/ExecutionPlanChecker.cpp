@@ -47,7 +47,9 @@ bool ExecutionPlanChecker::transform(TranslationUnit& translationUnit) {
         for (const Relation* rel : scc) {
             for (auto&& clause : program.getClauses(*rel)) {
                 if (!recursiveClauses.recursive(clause)) {
-                    if (clause->getExecutionPlan() != nullptr) {
+                    // leapfrog joins apply to non-recursive clauses as well
+                    if (clause->getExecutionPlan() != nullptr &&
+                            !clause->getExecutionPlan()->getOrders().empty()) {
                         auto order = clause->getExecutionPlan()->getOrders().begin()->second;
                         report.addError(
                                 "Ignored execution plan for non-recursive clause", order->getSrcLoc());
@@ -88,7 +90,7 @@ bool ExecutionPlanChecker::transform(TranslationUnit& translationUnit) {
                     }
                 }
 
-                if (version <= *maxVersion) {
+                if (maxVersion.has_value() && version <= *maxVersion) {
                     for (const auto& cur : clause->getExecutionPlan()->getOrders()) {
                         if (cur.first >= version) {
                             report.addDiagnostic(Diagnostic(Diagnostic::Type::ERROR,
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "Global.h"
 #include "ast/AlgebraicDataType.h"
 #include "ast/Attribute.h"
 #include "ast/Directive.h"
@@ -162,6 +163,7 @@ private:
         return node->getQualifiedName().toString();
     }
 
+public:
     /**
      * Get sum types info for IO.
      * If they don't exists - create them.
@@ -169,8 +171,11 @@ private:
      * The structure of JSON is approximately:
      * {"ADTs" : {ADT_NAME : {"branches" : [branch..]}, {"arity": ...}}}
      * branch = {{"types": [types ...]}, ["name": ...]}
+     *
+     * If records are unboxed, ADTs and branches with other than one argument
+     * have the "widths" of their unboxed records.
      */
-    json11::Json getAlgebraicDataTypes(TranslationUnit& translationUnit) const {
+    static json11::Json getAlgebraicDataTypes(const TranslationUnit& translationUnit) {
         static json11::Json sumTypesInfo;
 
         // Check if the types were already constructed
@@ -182,6 +187,7 @@ private:
         auto& typeEnv = translationUnit.getAnalysis<analysis::TypeEnvironmentAnalysis>().getTypeEnvironment();
 
         std::map<std::string, json11::Json> sumTypes;
+        const bool unboxed = translationUnit.global().config().has("unboxed-records");
 
         for (auto* astType : program.getTypes()) {
             const auto& type = typeEnv.getType(*astType);
@@ -201,12 +207,18 @@ private:
 
                     auto branchInfo = json11::Json::object{
                             {{"types", std::move(branchTypes)}, {"name", branch.name.toString()}}};
+                    if (unboxed && !isADTEnum(sumType) && branch.types.size() != 1) {
+                        addUnboxedWidths(branchInfo, analysis::getUnboxedWidths(branch.types));
+                    }
                     branchesInfo.push_back(std::move(branchInfo));
                 }
 
                 auto typeQualifier = analysis::getTypeQualifier(type);
                 auto&& sumInfo = json11::Json::object{{{"branches", std::move(branchesInfo)},
                         {"arity", static_cast<long long>(branches.size())}, {"enum", isADTEnum(sumType)}}};
+                if (unboxed && !isADTEnum(sumType)) {
+                    addUnboxedWidths(sumInfo, analysis::getUnboxedBranchWidths(sumType));
+                }
                 sumTypes.emplace(std::move(typeQualifier), std::move(sumInfo));
             }
         }
@@ -215,7 +227,7 @@ private:
         return sumTypesInfo;
     }
 
-    json11::Json getRecordsTypes(TranslationUnit& translationUnit) const {
+    static json11::Json getRecordsTypes(const TranslationUnit& translationUnit) {
         static json11::Json ramRecordTypes;
         // Check if the types where already constructed
         if (!ramRecordTypes.is_null()) {
@@ -226,20 +238,24 @@ private:
         auto& typeEnv = translationUnit.getAnalysis<analysis::TypeEnvironmentAnalysis>().getTypeEnvironment();
         std::vector<std::string> elementTypes;
         std::map<std::string, json11::Json> records;
+        const bool unboxed = translationUnit.global().config().has("unboxed-records");
 
         // Iterate over all record types in the program populating the records map.
         for (auto* astType : program.getTypes()) {
             const auto& type = typeEnv.getType(*astType);
             if (isA<analysis::RecordType>(skipAliasesType(type))) {
+                const auto& fields = as<analysis::RecordType>(skipAliasesType(type))->getFields();
                 elementTypes.clear();
 
-                for (const analysis::Type* field :
-                        as<analysis::RecordType>(skipAliasesType(type))->getFields()) {
+                for (const analysis::Type* field : fields) {
                     elementTypes.push_back(getTypeQualifier(*field));
                 }
                 const std::size_t recordArity = elementTypes.size();
-                json11::Json recordInfo = json11::Json::object{
+                auto recordInfo = json11::Json::object{
                         {"types", std::move(elementTypes)}, {"arity", static_cast<long long>(recordArity)}};
+                if (unboxed) {
+                    addUnboxedWidths(recordInfo, analysis::getUnboxedWidths(fields));
+                }
                 records.emplace(getTypeQualifier(type), std::move(recordInfo));
             }
         }
@@ -248,6 +264,19 @@ private:
         return ramRecordTypes;
     }
 
+private:
+    /** Add the widths of unboxed records to the type information, unless they are always boxed */
+    static void addUnboxedWidths(json11::Json::object& info, const std::vector<unsigned>& widths) {
+        if (widths.empty()) {
+            return;
+        }
+        json11::Json::array widthsInfo;
+        for (unsigned width : widths) {
+            widthsInfo.push_back(static_cast<long long>(width));
+        }
+        info.emplace("widths", std::move(widthsInfo));
+    }
+
     json11::Json getRecordsParams(TranslationUnit& translationUnit) const {
         static json11::Json ramRecordParams;
         // Check if the types where already constructed
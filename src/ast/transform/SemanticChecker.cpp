@@ -516,6 +516,13 @@ void SemanticCheckerImpl::checkClause(const Clause& clause) {
             report.addError("Auto-increment functor in a recursive rule", ctr.getSrcLoc());
         });
     }
+
+    // the counter is not saved with checkpoints, hence a resumed run would number tuples differently
+    if (tu.global().config().has("checkpoint")) {
+        visit(clause, [&](const Counter& ctr) {
+            report.addError("Auto-increment functor is not supported with checkpoint", ctr.getSrcLoc());
+        });
+    }
 }
 
 void SemanticCheckerImpl::checkComplexRule(const std::set<const Clause*>& multiRule) {
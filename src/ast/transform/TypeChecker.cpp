@@ -536,6 +536,21 @@ void TypeCheckerImpl::visit_(type_identity<TypeCast>, const ast::TypeCast& cast)
     if (argTypes.isAll() || castTypes.size() != 1 || argTypes.isAll() || argTypes.size() != 1) {
         return;
     }
+
+    // records are relocated according to the declared types of attributes, which casts would bypass
+    auto refersToRecords = [](const analysis::Type& type) {
+        if (isBaseOfKind(type, TypeAttribute::ADT)) {
+            return !isADTEnum(*as<analysis::AlgebraicDataType>(skipAliasesType(type)));
+        }
+        return isBaseOfKind(type, TypeAttribute::Record);
+    };
+    const analysis::Type& castType = *castTypes.begin();
+    const analysis::Type& argType = *argTypes.begin();
+    if (tu.global().config().has("compact-records") && castType != argType &&
+            (refersToRecords(castType) || refersToRecords(argType))) {
+        report.addError("Type cast from or to a record type is not supported with compact-records",
+                cast.getSrcLoc());
+    }
 }
 
 void TypeCheckerImpl::visit_(type_identity<IntrinsicFunctor>, const IntrinsicFunctor& fun) {
@@ -30,6 +30,7 @@
 #include "ast/StringConstant.h"
 #include "ast/SubsumptiveClause.h"
 #include "ast/UnnamedVariable.h"
+#include "ast/Variable.h"
 #include "ast/analysis/Functor.h"
 #include "ast/utility/Utils.h"
 #include "ast/utility/Visitor.h"
@@ -49,6 +50,8 @@
 #include "ram/FloatConstant.h"
 #include "ram/GuardedInsert.h"
 #include "ram/Insert.h"
+#include "ram/Intersection.h"
+#include "ram/IntersectionSource.h"
 #include "ram/IntrinsicAggregator.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/Negation.h"
@@ -59,18 +62,80 @@
 #include "ram/SignedConstant.h"
 #include "ram/StringConstant.h"
 #include "ram/TupleElement.h"
+#include "ram/UndefValue.h"
 #include "ram/UnpackRecord.h"
 #include "ram/UnsignedConstant.h"
 #include "ram/UserDefinedAggregator.h"
 #include "ram/utility/Utils.h"
 #include "souffle/TypeAttribute.h"
 #include "souffle/utility/StringUtil.h"
+#include <algorithm>
 #include <map>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
 namespace souffle::ast2ram::seminaive {
 
+namespace {
+
+/**
+ * Checks whether the hypergraph formed by the variables of the given atoms
+ * is cyclic, using the GYO reduction: variables occurring in a single atom
+ * and atoms subsumed by other atoms are removed until a fixpoint is
+ * reached. The hypergraph is acyclic iff at most one atom remains.
+ */
+bool isCyclic(const std::vector<ast::Atom*>& atoms) {
+    std::vector<std::set<std::string>> edges;
+    for (const auto* atom : atoms) {
+        std::set<std::string> edge;
+        for (const auto* arg : atom->getArguments()) {
+            if (const auto* var = as<ast::Variable>(arg)) {
+                edge.insert(var->getName());
+            }
+        }
+        edges.push_back(std::move(edge));
+    }
+
+    bool changed = true;
+    while (changed && edges.size() > 1) {
+        changed = false;
+
+        // remove variables occurring in a single atom
+        std::map<std::string, std::size_t> occurrences;
+        for (const auto& edge : edges) {
+            for (const auto& var : edge) {
+                occurrences[var]++;
+            }
+        }
+        for (auto& edge : edges) {
+            for (auto it = edge.begin(); it != edge.end();) {
+                if (occurrences[*it] == 1) {
+                    it = edge.erase(it);
+                    changed = true;
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // remove atoms subsumed by other atoms
+        for (std::size_t i = 0; i < edges.size(); i++) {
+            for (std::size_t j = 0; j < edges.size(); j++) {
+                if (i != j && std::includes(edges[j].begin(), edges[j].end(), edges[i].begin(),
+                                      edges[i].end())) {
+                    edges.erase(edges.begin() + i);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+    return edges.size() > 1;
+}
+
+}  // namespace
+
 ClauseTranslator::ClauseTranslator(const TranslatorContext& context, TranslationMode mode)
         : ast2ram::ClauseTranslator(context, mode), valueIndex(mk<ValueIndex>()) {}
 
@@ -158,6 +223,11 @@ Own<ram::Statement> ClauseTranslator::createRamFactQuery(const ast::Clause& clau
 Own<ram::Statement> ClauseTranslator::createRamRuleQuery(const ast::Clause& clause) {
     assert(isRule(clause) && "clause should be rule");
 
+    // Cyclic bodies and bodies requesting it are joined by intersecting atoms
+    if (isIntersectionJoinApplicable(clause)) {
+        return createRamIntersectionQuery(clause);
+    }
+
     // Index all variables and generators in the clause
     indexClause(clause);
 
@@ -171,6 +241,142 @@ Own<ram::Statement> ClauseTranslator::createRamRuleQuery(const ast::Clause& clau
     return mk<ram::Query>(std::move(op));
 }
 
+bool ClauseTranslator::isIntersectionJoinApplicable(const ast::Clause& clause) const {
+    const auto* plan = clause.getExecutionPlan();
+    const bool requested = plan != nullptr && plan->isLeapfrog();
+
+    // explicit orders take precedence
+    if (plan != nullptr && contains(plan->getOrders(), version)) {
+        return false;
+    }
+
+    // the join computes plain insertions only
+    if (mode != DEFAULT || isA<ast::SubsumptiveClause>(clause) ||
+            context.getGlobal()->config().has("provenance") ||
+            !context.getProgram()->getRelation(clause)->getFunctionalDependencies().empty()) {
+        return false;
+    }
+
+    // generators introduce levels of their own
+    if (visitExists(clause, [](const ast::Aggregator&) { return true; }) ||
+            visitExists(clause, [](const ast::IntrinsicFunctor& functor) {
+                return ast::analysis::FunctorAnalysis::isMultiResult(functor);
+            })) {
+        return false;
+    }
+
+    // atoms must consist of distinct variables and non-float constants over
+    // ordered relations; variables are joined on integral values
+    auto atoms = ast::getBodyLiterals<ast::Atom>(clause);
+    std::set<std::string> atomVariables;
+    for (const auto* atom : atoms) {
+        const auto* relation = context.getProgram()->getRelation(*atom);
+        const auto rep = relation->getRepresentation();
+        if (rep != RelationRepresentation::DEFAULT && rep != RelationRepresentation::BTREE) {
+            return false;
+        }
+        const auto& attributes = relation->getAttributes();
+        std::set<std::string> variables;
+        for (std::size_t i = 0; i < atom->getArity(); i++) {
+            const auto* arg = atom->getArguments()[i];
+            if (attributes[i]->getIsLattice()) {
+                return false;
+            }
+            if (const auto* var = as<ast::Variable>(arg)) {
+                if (!variables.insert(var->getName()).second ||
+                        context.getAttributeTypeQualifier(attributes[i]->getTypeName())[0] == 'f') {
+                    return false;
+                }
+            } else if (const auto* numConstant = as<ast::NumericConstant>(arg)) {
+                if (context.getInferredNumericConstantType(*numConstant) ==
+                        ast::NumericConstant::Type::Float) {
+                    return false;
+                }
+            } else if (!isA<ast::Constant>(arg) && !isA<ast::UnnamedVariable>(arg)) {
+                return false;
+            }
+        }
+        if (variables.empty()) {
+            return false;
+        }
+        atomVariables.insert(variables.begin(), variables.end());
+    }
+
+    // all variables must be bound by atoms
+    if (visitExists(clause,
+                [&](const ast::Variable& var) { return !contains(atomVariables, var.getName()); })) {
+        return false;
+    }
+
+    return requested || isCyclic(atoms);
+}
+
+Own<ram::Statement> ClauseTranslator::createRamIntersectionQuery(const ast::Clause& clause) {
+    auto atoms = getAtomOrdering(clause);
+
+    // variables are bound in the order of their first appearance, one level each
+    std::vector<std::string> variables;
+    for (const auto* atom : atoms) {
+        for (const auto* arg : atom->getArguments()) {
+            const auto* var = as<ast::Variable>(arg);
+            if (var != nullptr && !contains(variables, var->getName())) {
+                variables.push_back(var->getName());
+            }
+        }
+    }
+    for (std::size_t level = 0; level < variables.size(); level++) {
+        valueIndex->addVarReference(variables[level], level, 0);
+    }
+
+    // Set up the RAM statement bottom-up
+    auto op = createInsertion(clause);
+    op = addBodyLiteralConstraints(clause, std::move(op));
+
+    // each level intersects the atoms containing its variable, restricted
+    // by the constants and the variables bound on outer levels
+    for (std::size_t level = variables.size(); level-- > 0;) {
+        VecOwn<ram::IntersectionSource> sources;
+        for (const auto* atom : atoms) {
+            const auto& args = atom->getArguments();
+            auto pos = std::find_if(args.begin(), args.end(), [&](const ast::Argument* arg) {
+                const auto* var = as<ast::Variable>(arg);
+                return var != nullptr && var->getName() == variables[level];
+            });
+            if (pos == args.end()) {
+                continue;
+            }
+
+            VecOwn<ram::Expression> values;
+            for (const auto* arg : args) {
+                if (const auto* constant = as<ast::Constant>(arg)) {
+                    values.push_back(translateConstant(*constant));
+                } else if (const auto* var = as<ast::Variable>(arg)) {
+                    auto bound = std::find(variables.begin(), variables.end(), var->getName());
+                    if (bound < variables.begin() + level) {
+                        values.push_back(mk<ram::TupleElement>(bound - variables.begin(), 0));
+                    } else {
+                        values.push_back(mk<ram::UndefValue>());
+                    }
+                } else {
+                    values.push_back(mk<ram::UndefValue>());
+                }
+            }
+            sources.push_back(mk<ram::IntersectionSource>(
+                    getClauseAtomName(clause, atom), pos - args.begin(), std::move(values)));
+        }
+        op = mk<ram::Intersection>(std::move(sources), std::move(op), level);
+    }
+
+    // add checks for emptiness of the atoms
+    for (auto it = atoms.rbegin(); it != atoms.rend(); ++it) {
+        op = mk<ram::Filter>(
+                mk<ram::Negation>(mk<ram::EmptinessCheck>(getClauseAtomName(clause, *it))), std::move(op));
+    }
+
+    op = addEntryPoint(clause, std::move(op));
+    return mk<ram::Query>(std::move(op));
+}
+
 Own<ram::Operation> ClauseTranslator::addEntryPoint(const ast::Clause& clause, Own<ram::Operation> op) const {
     auto cond = createCondition(clause);
     return cond != nullptr ? mk<ram::Filter>(std::move(cond), std::move(op)) : std::move(op);
@@ -261,7 +467,8 @@ Own<ram::Operation> ClauseTranslator::addRecordUnpack(
 
     // add an unpack level
     const Location& loc = valueIndex->getDefinitionPoint(*rec);
-    op = mk<ram::UnpackRecord>(std::move(op), curLevel, makeRamTupleElement(loc), rec->getArguments().size());
+    op = mk<ram::UnpackRecord>(std::move(op), curLevel, makeRamTupleElement(loc), rec->getArguments().size(),
+            context.getUnboxedWidths(rec));
     return op;
 }
 
@@ -298,13 +505,14 @@ Own<ram::Operation> ClauseTranslator::addAdtUnpack(
         op = addConstantConstraints(branchLevel, branchArguments, std::move(op));
     } else {
         op = addConstantConstraints(curLevel, branchArguments, std::move(op));
-        op = mk<ram::UnpackRecord>(
-                std::move(op), curLevel, mk<ram::TupleElement>(branchLevel, 1), branchArguments.size());
+        op = mk<ram::UnpackRecord>(std::move(op), curLevel, mk<ram::TupleElement>(branchLevel, 1),
+                branchArguments.size(), context.getUnboxedArgumentWidths(adt));
     }
 
     const Location& loc = valueIndex->getDefinitionPoint(*adt);
     // add an unpack level for main record
-    op = mk<ram::UnpackRecord>(std::move(op), branchLevel, makeRamTupleElement(loc), 2);
+    op = mk<ram::UnpackRecord>(
+            std::move(op), branchLevel, makeRamTupleElement(loc), 2, context.getUnboxedBranchWidths(adt));
 
     return op;
 }
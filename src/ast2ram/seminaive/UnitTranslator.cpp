@@ -21,7 +21,9 @@
 #include "ast/SubsumptiveClause.h"
 #include "ast/TranslationUnit.h"
 #include "ast/UserDefinedFunctor.h"
+#include "ast/analysis/SCCGraph.h"
 #include "ast/analysis/TopologicallySortedSCCGraph.h"
+#include "ast/transform/IOAttributes.h"
 #include "ast/utility/Utils.h"
 #include "ast/utility/Visitor.h"
 #include "ast2ram/ClauseTranslator.h"
@@ -31,6 +33,7 @@
 #include "ram/Assign.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/CompactRecords.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -43,23 +46,30 @@
 #include "ram/Filter.h"
 #include "ram/IO.h"
 #include "ram/Insert.h"
+#include "ram/Intersection.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/Parallel.h"
 #include "ram/Program.h"
 #include "ram/Query.h"
 #include "ram/Relation.h"
+#include "ram/RelationOperation.h"
 #include "ram/RelationSize.h"
+#include "ram/Restore.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
 #include "ram/SignedConstant.h"
+#include "ram/Spill.h"
 #include "ram/Statement.h"
 #include "ram/Swap.h"
+#include "ram/TaskGraph.h"
+#include "ram/True.h"
 #include "ram/TranslationUnit.h"
 #include "ram/TupleElement.h"
 #include "ram/UndefValue.h"
@@ -68,14 +78,19 @@
 #include "ram/UserDefinedOperator.h"
 #include "ram/Variable.h"
 #include "ram/utility/Utils.h"
+#include "ram/utility/Visitor.h"
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
 #include "souffle/BinaryConstraintOps.h"
 #include "souffle/TypeAttribute.h"
+#include "souffle/datastructure/TableSnapshot.h"
+#include "souffle/io/BinaryFormat.h"
 #include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/FileUtil.h"
 #include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/StringUtil.h"
+#include "souffle/utility/json11.h"
 #include <algorithm>
 #include <cassert>
 #include <chrono>
@@ -83,6 +98,7 @@
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
@@ -141,6 +157,13 @@ Own<ram::Statement> UnitTranslator::generateNonRecursiveRelation(const ast::Rela
         appendStmt(result, std::move(rule));
     }
 
+    // The rules of a relation are independent of each other
+    if (!result.empty()) {
+        auto rules = generateParallelRules(std::move(result));
+        result.clear();
+        appendStmt(result, std::move(rules));
+    }
+
     // Add logging for entire relation
     if (glb->config().has("profile")) {
         const std::string& relationName = toString(rel.getQualifiedName());
@@ -164,6 +187,52 @@ Own<ram::Statement> UnitTranslator::generateNonRecursiveRelation(const ast::Rela
     return mk<ram::Sequence>(std::move(result));
 }
 
+Own<ram::Statement> UnitTranslator::generateParallelRules(VecOwn<ram::Statement> rules) const {
+    // Rules are only evaluated concurrently if several threads are available
+    if (glb->config().get("jobs") == "1" || glb->config().has("profile")) {
+        return mk<ram::Sequence>(std::move(rules));
+    }
+
+    // Estimate the cost of a rule by the number of relations it iterates over.
+    // Rules iterating over a single relation are spread evenly over the threads
+    // by their parallel scan, whereas the work of the outer loop of a join may be
+    // skewed. Hence, only joins are worth evaluating side by side.
+    auto getCost = [](const ram::Statement& rule) {
+        std::size_t cost = 0;
+        visit(rule, [&](const ram::RelationOperation&) { cost++; });
+        visit(rule, [&](const ram::Intersection&) { cost++; });
+        return cost;
+    };
+    const std::size_t minJoinCost = 2;
+
+    VecOwn<ram::Statement> cheapRules;
+    std::vector<std::pair<std::size_t, Own<ram::Statement>>> joins;
+    for (auto& rule : rules) {
+        const std::size_t cost = getCost(*rule);
+        if (cost < minJoinCost) {
+            cheapRules.push_back(std::move(rule));
+        } else {
+            joins.emplace_back(cost, std::move(rule));
+        }
+    }
+    if (joins.size() < 2) {
+        for (auto& [cost, rule] : joins) {
+            cheapRules.push_back(std::move(rule));
+        }
+        return mk<ram::Sequence>(std::move(cheapRules));
+    }
+
+    // Start the most expensive joins first, such that they obtain a fair share of the threads
+    std::stable_sort(joins.begin(), joins.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+    VecOwn<ram::Statement> parallelRules;
+    for (auto& [cost, rule] : joins) {
+        parallelRules.push_back(std::move(rule));
+    }
+    cheapRules.push_back(mk<ram::Parallel>(std::move(parallelRules)));
+    return mk<ram::Sequence>(std::move(cheapRules));
+}
+
 Own<ram::Statement> UnitTranslator::generateStratum(std::size_t scc) const {
     // Make a new ram statement for the current SCC
     VecOwn<ram::Statement> current;
@@ -273,6 +342,11 @@ Own<ram::Statement> UnitTranslator::generateMergeRelations(
     if (rel->getRepresentation() == RelationRepresentation::EQREL) {
         return mk<ram::MergeExtend>(destRelation, srcRelation);
     }
+
+    // Relations without auxiliary attributes or deletions - insert in bulk
+    if (rel->getAuxiliaryArity() == 0 && rel->getRepresentation() != RelationRepresentation::BTREE_DELETE) {
+        return mk<ram::Merge>(destRelation, srcRelation);
+    }
     for (std::size_t i = 0; i < rel->getArity(); i++) {
         values.push_back(mk<ram::TupleElement>(0, i));
     }
@@ -304,7 +378,7 @@ Own<ram::Statement> UnitTranslator::generateDebugRelation(const ast::Relation* r
     return stmt;
 }
 
-Own<ram::Statement> UnitTranslator::translateRecursiveClauses(
+VecOwn<ram::Statement> UnitTranslator::translateRecursiveClauses(
         const ast::RelationSet& scc, const ast::Relation* rel) const {
     assert(contains(scc, rel) && "relation should belong to scc");
     VecOwn<ram::Statement> code;
@@ -323,7 +397,7 @@ Own<ram::Statement> UnitTranslator::translateRecursiveClauses(
         }
     }
 
-    return mk<ram::Sequence>(std::move(code));
+    return code;
 }
 
 Own<ram::Statement> UnitTranslator::translateSubsumptiveRecursiveClauses(
@@ -414,7 +488,7 @@ VecOwn<ram::Statement> UnitTranslator::generateClauseVersions(
         for (const auto& cur : clause->getExecutionPlan()->getOrders()) {
             maxVersion = std::max(cur.first, maxVersion.value_or(cur.first));
         }
-        assert(sccAtoms.size() > *maxVersion && "missing clause versions");
+        assert((!maxVersion.has_value() || sccAtoms.size() > *maxVersion) && "missing clause versions");
     }
 
     return clauseVersions;
@@ -518,17 +592,27 @@ Own<ram::Statement> UnitTranslator::generateStratumTableUpdates(const ast::Relat
         std::string newRelation = getNewRelationName(rel->getQualifiedName());
         std::string deltaRelation = getDeltaRelationName(rel->getQualifiedName());
 
+        // merge the source relation into the main relation, measuring the merge time separately
+        auto mergeRelations = [&](const std::string& srcRelation) -> Own<ram::Statement> {
+            auto merge = generateMergeRelations(rel, mainRelation, srcRelation);
+            if (glb->config().has("profile")) {
+                merge = mk<ram::LogRelationTimer>(std::move(merge),
+                        LogStatement::mRecursiveRelation(toString(rel->getQualifiedName()), rel->getSrcLoc()),
+                        srcRelation);
+            }
+            return merge;
+        };
+
         // swap new and and delta relation and clear new relation afterwards (if not a subsumptive relation)
         Own<ram::Statement> updateRelTable;
         if (rel->getAuxiliaryArity() > 0) {
-            updateRelTable =
-                    mk<ram::Sequence>(mk<ram::Clear>(deltaRelation), generateStratumLubSequence(*rel, true),
-                            generateMergeRelations(rel, mainRelation, deltaRelation));
+            updateRelTable = mk<ram::Sequence>(mk<ram::Clear>(deltaRelation),
+                    generateStratumLubSequence(*rel, true), mergeRelations(deltaRelation));
         } else if (!context->hasSubsumptiveClause(rel->getQualifiedName())) {
-            updateRelTable = mk<ram::Sequence>(generateMergeRelations(rel, mainRelation, newRelation),
+            updateRelTable = mk<ram::Sequence>(mergeRelations(newRelation),
                     mk<ram::Swap>(deltaRelation, newRelation), mk<ram::Clear>(newRelation));
         } else {
-            updateRelTable = generateMergeRelations(rel, mainRelation, deltaRelation);
+            updateRelTable = mergeRelations(deltaRelation);
         }
 
         // Measure update time
@@ -565,13 +649,20 @@ Own<ram::Statement> UnitTranslator::generateStratumLoopBody(const ast::RelationS
         return stmt;
     };
 
-    // first translate regular recursive clauses
+    // first translate regular recursive clauses, whose versions are independent of each other
+    VecOwn<ram::Statement> clauseVersions;
     for (const ast::Relation* rel : scc) {
         auto relClauses = translateRecursiveClauses(scc, rel);
-        // add profiling information
-        relClauses = addProfiling(rel, std::move(relClauses));
-        appendStmt(loopBody, mk<ram::Sequence>(std::move(relClauses)));
+        if (hasProfile) {
+            // add profiling information
+            appendStmt(clauseVersions, addProfiling(rel, mk<ram::Sequence>(std::move(relClauses))));
+        } else {
+            for (auto& clauseVersion : relClauses) {
+                appendStmt(clauseVersions, std::move(clauseVersion));
+            }
+        }
     }
+    appendStmt(loopBody, generateParallelRules(std::move(clauseVersions)));
 
     // translating subsumptive clauses
     for (const ast::Relation* rel : scc) {
@@ -834,6 +925,239 @@ Own<ram::Statement> UnitTranslator::generateStoreRelation(const ast::Relation* r
     return mk<ram::Sequence>(std::move(storeStmts));
 }
 
+Own<ram::Statement> UnitTranslator::generateCheckpointedStratum(
+        Own<ram::Statement> stratum, std::size_t index, const ast::RelationSet& liveRelations) const {
+    // The strata completed by a previous run are recorded in the @checkpoint relation
+    auto isCompleted = [](std::size_t stratumIndex) {
+        VecOwn<ram::Expression> values;
+        values.push_back(mk<ram::SignedConstant>(static_cast<RamSigned>(stratumIndex)));
+        return mk<ram::ExistenceCheck>("@checkpoint", std::move(values));
+    };
+
+    // The live relations alternate between two slots, such that the slot of the last checkpoint
+    // remains intact while the next one is saved
+    const std::size_t slot = index % 2;
+
+    // Compute the stratum unless it has been completed, and save the live relations afterwards
+    VecOwn<ram::Statement> compute;
+    appendStmt(compute, mk<ram::Exit>(isCompleted(index)));
+    appendStmt(compute, std::move(stratum));
+    for (const auto* relation : liveRelations) {
+        appendStmt(compute, generateCheckpointRelation(relation, "output", slot));
+    }
+    appendStmt(compute, generateCheckpointProgress("output", index));
+    appendStmt(compute, mk<ram::Exit>(mk<ram::True>()));
+
+    // Restore the live relations if this is the last stratum completed by a previous run
+    VecOwn<ram::Statement> restore;
+    appendStmt(restore, mk<ram::Exit>(mk<ram::Negation>(isCompleted(index))));
+    appendStmt(restore, mk<ram::Exit>(isCompleted(index + 1)));
+    for (const auto* relation : liveRelations) {
+        appendStmt(restore, generateCheckpointRelation(relation, "input", slot));
+    }
+    appendStmt(restore, mk<ram::Exit>(mk<ram::True>()));
+
+    return mk<ram::Sequence>(mk<ram::Loop>(mk<ram::Sequence>(std::move(compute))),
+            mk<ram::Loop>(mk<ram::Sequence>(std::move(restore))));
+}
+
+Own<ram::Statement> UnitTranslator::generateCheckpointRelation(
+        const ast::Relation* relation, const std::string& operation, std::size_t slot) const {
+    // Values are saved verbatim, hence symbols and records remain valid along with the snapshot of
+    // the symbol and record tables taken with the checkpoint
+    std::string ramRelationName = getConcreteRelationName(relation->getQualifiedName());
+    const auto arity = createRamRelation(relation, ramRelationName)->getArity();
+    std::vector<std::string> types(arity, "i:number");
+    json11::Json relJson = json11::Json::object{{"arity", static_cast<long long>(arity)},
+            {"types", json11::Json::array(types.begin(), types.end())}};
+
+    const std::string& dir = glb->config().get("checkpoint");
+    std::map<std::string, std::string> directives;
+    directives["IO"] = "binary";
+    directives["operation"] = operation;
+    directives["name"] = ramRelationName;
+    directives["filename"] = ramRelationName + "." + std::to_string(slot) + ".bin";
+    directives["fact-dir"] = dir;
+    directives["output-dir"] = dir;
+    directives["checkpoint-dir"] = dir;
+    directives["types"] = json11::Json(json11::Json::object{{"relation", relJson}}).dump();
+    directives["auxArity"] = "0";
+    return mk<ram::IO>(ramRelationName, directives);
+}
+
+Own<ram::Statement> UnitTranslator::generateCompactRecords(
+        const ast::RelationSet& liveRelations, const std::string& recordTypes) const {
+    // Only the relations with attributes of record types may reference records
+    std::vector<std::string> relations;
+    for (const auto* relation : liveRelations) {
+        std::string ramRelationName = getConcreteRelationName(relation->getQualifiedName());
+        auto ramRelation = createRamRelation(relation, ramRelationName);
+        const auto& types = ramRelation->getAttributeTypes();
+        if (any_of(types, [](const std::string& type) { return type[0] == 'r' || type[0] == '+'; })) {
+            relations.push_back(ramRelationName);
+        }
+    }
+    if (relations.empty()) {
+        return nullptr;
+    }
+    return mk<ram::CompactRecords>(std::move(relations), recordTypes);
+}
+
+bool UnitTranslator::isSpillable(const ast::Relation* relation, bool compactRecords) const {
+    // The tuples of equivalence relations are enumerated as their closure, and the records of
+    // spilled tuples would not be kept by record compaction
+    if (relation->getArity() == 0 || relation->getRepresentation() == RelationRepresentation::EQREL) {
+        return false;
+    }
+    std::string ramRelationName = getConcreteRelationName(relation->getQualifiedName());
+    auto ramRelation = createRamRelation(relation, ramRelationName);
+    const auto& types = ramRelation->getAttributeTypes();
+    return !compactRecords ||
+           none_of(types, [](const std::string& type) { return type[0] == 'r' || type[0] == '+'; });
+}
+
+Own<ram::Statement> UnitTranslator::generateSpill(const ast::TranslationUnit& translationUnit,
+        std::size_t index, const ast::RelationSet& liveRelations, bool compactRecords) const {
+    const auto& sccGraph = translationUnit.getAnalysis<ast::analysis::SCCGraphAnalysis>();
+    const auto& sccOrdering =
+            translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
+    std::map<std::size_t, std::size_t> position;
+    for (std::size_t i = 0; i < sccOrdering.size(); i++) {
+        position[sccOrdering.at(i)] = i;
+    }
+
+    // The live relations not read by the next stratum may be spilled, those read last first;
+    // relations read by no later stratum are kept, since they would never be restored
+    std::vector<std::pair<std::size_t, std::string>> candidates;
+    for (const auto* relation : liveRelations) {
+        if (!isSpillable(relation, compactRecords)) {
+            continue;
+        }
+        std::optional<std::size_t> nextUse;
+        for (std::size_t scc : sccGraph.getSuccessorSCCs(relation)) {
+            const std::size_t use = position.at(scc);
+            if (use > index && (!nextUse.has_value() || use < *nextUse)) {
+                nextUse = use;
+            }
+        }
+        if (nextUse.has_value() && *nextUse > index + 1) {
+            candidates.emplace_back(*nextUse, getConcreteRelationName(relation->getQualifiedName()));
+        }
+    }
+    if (candidates.empty()) {
+        return nullptr;
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    std::vector<std::string> relations;
+    for (const auto& candidate : candidates) {
+        relations.push_back(candidate.second);
+    }
+    const std::size_t budget = std::stoull(glb->config().get("memory-budget")) << 20;
+    return mk<ram::Spill>(std::move(relations), budget);
+}
+
+Own<ram::Statement> UnitTranslator::generateRestore(
+        const ast::TranslationUnit& translationUnit, std::size_t index, bool compactRecords) const {
+    const auto& sccGraph = translationUnit.getAnalysis<ast::analysis::SCCGraphAnalysis>();
+    const auto& sccOrdering =
+            translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
+    std::map<std::size_t, std::size_t> position;
+    for (std::size_t i = 0; i < sccOrdering.size(); i++) {
+        position[sccOrdering.at(i)] = i;
+    }
+
+    // Only the relations computed before the previous stratum may have been spilled
+    std::vector<std::string> relations;
+    for (const auto* relation : sccGraph.getExternalPredecessorRelations(sccOrdering.at(index))) {
+        if (position.at(sccGraph.getSCC(relation)) + 1 < index && isSpillable(relation, compactRecords)) {
+            relations.push_back(getConcreteRelationName(relation->getQualifiedName()));
+        }
+    }
+    if (relations.empty()) {
+        return nullptr;
+    }
+    return mk<ram::Restore>(std::move(relations));
+}
+
+Own<ram::Statement> UnitTranslator::generateCheckpointResume(
+        const ast::TranslationUnit& translationUnit, const VecOwn<ram::Statement>& main) const {
+    const auto& sccOrdering =
+            translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
+
+    // A checkpoint is only resumed by the same program, hence the program is identified by its
+    // relations, subroutines and strata, as translated so far
+    std::stringstream program;
+    for (const auto& relation : createRamRelations(sccOrdering)) {
+        program << *relation << "\n";
+    }
+    for (const auto& [name, subroutine] : ramSubroutines) {
+        program << "SUBROUTINE " << name << "\n" << *subroutine << "\n";
+    }
+    for (const auto& stmt : main) {
+        program << *stmt << "\n";
+    }
+    for (std::size_t scc : sccOrdering) {
+        program << "STRATUM " << join(context->getRelationsInSCC(scc), ",", [](auto& out, const auto* rel) {
+            out << rel->getQualifiedName();
+        }) << "\n";
+    }
+    const std::string text = program.str();
+
+    // The fact files are hashed as well when resuming, such that changed inputs discard the
+    // checkpoint; the files of the default fact directory are resolved against the fact directory
+    // of the run
+    const std::string factDir = glb->config().get("fact-dir");
+    std::vector<std::string> inputs;
+    for (std::size_t scc : sccOrdering) {
+        for (const auto* relation : context->getRelationsInSCC(scc)) {
+            for (const auto* load : context->getLoadDirectives(relation->getQualifiedName())) {
+                std::map<std::string, std::string> params;
+                for (const auto& [key, value] : load->getParameters()) {
+                    params[key] = unescape(value);
+                }
+                const std::string& io = params["IO"];
+                if (io != "file" && io != "binary") {
+                    continue;
+                }
+                std::string name = getOr(params, "filename",
+                        params["name"] + (io == "file" ? std::string(".facts") : std::string(".bin")));
+                const std::string dir = getOr(params, "fact-dir", factDir);
+                if (!isAbsolute(name) && dir != factDir) {
+                    name = dir + pathSeparator + name;
+                }
+                inputs.push_back(name);
+                if (io == "binary") {
+                    inputs.push_back(getBinarySymbolFileName(name));
+                }
+            }
+        }
+    }
+
+    std::map<std::string, std::string> directives;
+    directives["fingerprint"] = std::to_string(details::snapshotHash(text.data(), text.size()));
+    directives["inputs"] = json11::Json(inputs).dump();
+    directives["fact-dir"] = factDir;
+    return generateCheckpointProgress("input", std::nullopt, std::move(directives));
+}
+
+Own<ram::Statement> UnitTranslator::generateCheckpointProgress(const std::string& operation,
+        std::optional<std::size_t> stratum, std::map<std::string, std::string> directives) const {
+    json11::Json relJson = json11::Json::object{
+            {"arity", static_cast<long long>(1)}, {"types", json11::Json::array{"i:number"}}};
+
+    directives["IO"] = "checkpoint";
+    directives["operation"] = operation;
+    directives["name"] = "@checkpoint";
+    directives["checkpoint-dir"] = glb->config().get("checkpoint");
+    directives["types"] = json11::Json(json11::Json::object{{"relation", relJson}}).dump();
+    if (stratum.has_value()) {
+        directives["stratum"] = std::to_string(*stratum);
+    }
+    return mk<ram::IO>("@checkpoint", directives);
+}
+
 Own<ram::Relation> UnitTranslator::createRamRelation(
         const ast::Relation* baseRelation, std::string ramRelationName) const {
     auto arity = baseRelation->getArity();
@@ -901,6 +1225,12 @@ VecOwn<ram::Relation> UnitTranslator::createRamRelations(const std::vector<std::
             }
         }
     }
+
+    // Add the relation of the strata completed by a previous run
+    if (glb->config().has("checkpoint")) {
+        ramRelations.push_back(mk<ram::Relation>("@checkpoint", 1, 0, std::vector<std::string>{"stratum"},
+                std::vector<std::string>{"i:number"}, RelationRepresentation::DEFAULT));
+    }
     return ramRelations;
 }
 
@@ -911,8 +1241,32 @@ Own<ram::Sequence> UnitTranslator::generateProgram(const ast::TranslationUnit& t
     }
     const auto& sccOrdering =
             translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
+
+    // Records are only compacted if the program has record types
+    std::string recordTypes;
+    if (glb->config().has("compact-records")) {
+        auto records = ast::transform::IOAttributesTransformer::getRecordsTypes(translationUnit);
+        auto adts = ast::transform::IOAttributesTransformer::getAlgebraicDataTypes(translationUnit);
+        if (!records.object_items().empty() || !adts.object_items().empty()) {
+            recordTypes = json11::Json(json11::Json::object{{"records", records}, {"ADTs", adts}}).dump();
+        }
+    }
+    const bool compactRecords = !recordTypes.empty();
+
+    // Independent strata may run concurrently if several threads are available; checkpoints are
+    // taken and records are compacted between consecutive strata, hence they require the strata to
+    // run in order
+    const bool checkpoint = glb->config().has("checkpoint");
+    const bool spill = glb->config().has("memory-budget");
+    if (sccOrdering.size() > 1 && glb->config().get("jobs") != "1" && !glb->config().has("profile") &&
+            !checkpoint && !compactRecords && !spill) {
+        return mk<ram::Sequence>(generateStrataTaskGraph(translationUnit));
+    }
+
     VecOwn<ram::Statement> res;
 
+    ast::RelationSet liveRelations;
+
     // Create subroutines for each SCC according to topological order
     for (std::size_t i = 0; i < sccOrdering.size(); i++) {
         // Generate the main stratum code
@@ -929,7 +1283,38 @@ Own<ram::Sequence> UnitTranslator::generateProgram(const ast::TranslationUnit& t
         addRamSubroutine(stratumID, std::move(stratum));
 
         // invoke the strata
-        appendStmt(res, mk<ram::Call>("stratum_" + stratumID));
+        Own<ram::Statement> call = mk<ram::Call>("stratum_" + stratumID);
+
+        // Save the relations live after each stratum but the last one, release the records they
+        // no longer reference, and spill those not needed by the next stratum
+        const bool lastStratum = i + 1 == sccOrdering.size();
+        if ((checkpoint || compactRecords || spill) && !lastStratum) {
+            const auto& sccRelations = context->getRelationsInSCC(sccOrdering.at(i));
+            liveRelations.insert(sccRelations.begin(), sccRelations.end());
+            for (const auto* expired : expiredRelations) {
+                liveRelations.erase(expired);
+            }
+        }
+        if (checkpoint && !lastStratum) {
+            call = generateCheckpointedStratum(std::move(call), i, liveRelations);
+        }
+        if (spill) {
+            appendStmt(res, generateRestore(translationUnit, i, compactRecords));
+        }
+        appendStmt(res, std::move(call));
+        if (compactRecords && !lastStratum) {
+            appendStmt(res, generateCompactRecords(liveRelations, recordTypes));
+        }
+        if (spill && !lastStratum) {
+            appendStmt(res, generateSpill(translationUnit, i, liveRelations, compactRecords));
+        }
+    }
+
+    // Load the strata completed by a previous run of the same program, along with its symbol and
+    // record tables, and discard the checkpoint once the run has completed
+    if (checkpoint) {
+        res.insert(res.begin(), generateCheckpointResume(translationUnit, res));
+        appendStmt(res, generateCheckpointProgress("output", std::nullopt));
     }
 
     // Add main timer if profiling
@@ -943,6 +1328,67 @@ Own<ram::Sequence> UnitTranslator::generateProgram(const ast::TranslationUnit& t
     return mk<ram::Sequence>(std::move(res));
 }
 
+Own<ram::Statement> UnitTranslator::generateStrataTaskGraph(const ast::TranslationUnit& translationUnit) {
+    const auto& sccGraph = translationUnit.getAnalysis<ast::analysis::SCCGraphAnalysis>();
+    const auto& sccOrdering =
+            translationUnit.getAnalysis<ast::analysis::TopologicallySortedSCCGraphAnalysis>().order();
+
+    VecOwn<ram::Statement> tasks;
+    std::vector<std::vector<std::size_t>> predecessors;
+
+    // task of the stratum computing each SCC
+    std::map<std::size_t, std::size_t> sccTask;
+
+    // the last task writing to the console or to a database; such tasks are kept in order
+    std::optional<std::size_t> lastSharedIOTask;
+
+    for (std::size_t i = 0; i < sccOrdering.size(); i++) {
+        const std::size_t scc = sccOrdering.at(i);
+        auto stratum = generateStratum(scc);
+
+        // A stratum depends on the strata computing its input relations
+        std::set<std::size_t> preds;
+        for (std::size_t pred : sccGraph.getPredecessorSCCs(scc)) {
+            preds.insert(sccTask.at(pred));
+        }
+        bool sharedIO = visitExists(*stratum, [](const ram::IO& io) {
+            const std::string kind = io.get("IO");
+            return kind == "stdin" || kind == "stdout" || kind == "stdoutprintsize" || kind == "sqlite";
+        });
+        if (sharedIO) {
+            if (lastSharedIOTask.has_value()) {
+                preds.insert(*lastSharedIOTask);
+            }
+            lastSharedIOTask = tasks.size();
+        }
+
+        // Add the subroutine
+        const ast::Relation* rel = *context->getRelationsInSCC(scc).begin();
+        std::string stratumID = rel->getQualifiedName().toString();
+        addRamSubroutine(stratumID, std::move(stratum));
+
+        sccTask[scc] = tasks.size();
+        tasks.push_back(mk<ram::Call>("stratum_" + stratumID));
+        predecessors.emplace_back(preds.begin(), preds.end());
+
+        // Clear expired relations once all strata using them have completed
+        const auto& expiredRelations = context->getExpiredRelations(i);
+        if (!expiredRelations.empty()) {
+            std::set<std::size_t> users;
+            for (const auto* expired : expiredRelations) {
+                users.insert(sccTask.at(sccGraph.getSCC(expired)));
+                for (std::size_t user : sccGraph.getSuccessorSCCs(expired)) {
+                    users.insert(sccTask.at(user));
+                }
+            }
+            tasks.push_back(generateClearExpiredRelations(expiredRelations));
+            predecessors.emplace_back(users.begin(), users.end());
+        }
+    }
+
+    return mk<ram::TaskGraph>(std::move(tasks), std::move(predecessors));
+}
+
 Own<ram::TranslationUnit> UnitTranslator::translateUnit(ast::TranslationUnit& tu) {
     glb = &tu.global();
 
@@ -19,6 +19,7 @@
 #include "ram/Expression.h"
 #include "souffle/utility/ContainerUtil.h"
 #include <map>
+#include <optional>
 #include <set>
 #include <string>
 #include <vector>
@@ -55,7 +56,7 @@ protected:
     virtual Own<ram::Relation> createRamRelation(
             const ast::Relation* baseRelation, std::string ramRelationName) const;
     virtual VecOwn<ram::Relation> createRamRelations(const std::vector<std::size_t>& sccOrdering) const;
-    Own<ram::Statement> translateRecursiveClauses(
+    VecOwn<ram::Statement> translateRecursiveClauses(
             const ast::RelationSet& scc, const ast::Relation* rel) const;
     Own<ram::Statement> translateSubsumptiveRecursiveClauses(
             const ast::RelationSet& scc, const ast::Relation* rel) const;
@@ -70,13 +71,36 @@ protected:
 
     /** High-level relation translation */
     virtual Own<ram::Sequence> generateProgram(const ast::TranslationUnit& translationUnit);
+    Own<ram::Statement> generateStrataTaskGraph(const ast::TranslationUnit& translationUnit);
     Own<ram::Statement> generateNonRecursiveRelation(const ast::Relation& rel) const;
+    Own<ram::Statement> generateParallelRules(VecOwn<ram::Statement> rules) const;
     Own<ram::Statement> generateRecursiveStratum(const ast::RelationSet& scc, std::size_t sccNum) const;
 
     /** IO translation */
     Own<ram::Statement> generateStoreRelation(const ast::Relation* relation) const;
     Own<ram::Statement> generateLoadRelation(const ast::Relation* relation) const;
 
+    /** Checkpoint translation */
+    Own<ram::Statement> generateCheckpointedStratum(
+            Own<ram::Statement> stratum, std::size_t index, const ast::RelationSet& liveRelations) const;
+    Own<ram::Statement> generateCheckpointRelation(
+            const ast::Relation* relation, const std::string& operation, std::size_t slot) const;
+    Own<ram::Statement> generateCheckpointProgress(const std::string& operation,
+            std::optional<std::size_t> stratum, std::map<std::string, std::string> directives = {}) const;
+    Own<ram::Statement> generateCheckpointResume(
+            const ast::TranslationUnit& translationUnit, const VecOwn<ram::Statement>& main) const;
+
+    /** Record compaction between strata */
+    Own<ram::Statement> generateCompactRecords(
+            const ast::RelationSet& liveRelations, const std::string& recordTypes) const;
+
+    /** Spilling of relations between strata */
+    Own<ram::Statement> generateSpill(const ast::TranslationUnit& translationUnit, std::size_t index,
+            const ast::RelationSet& liveRelations, bool compactRecords) const;
+    Own<ram::Statement> generateRestore(
+            const ast::TranslationUnit& translationUnit, std::size_t index, bool compactRecords) const;
+    bool isSpillable(const ast::Relation* relation, bool compactRecords) const;
+
     /** Low-level stratum translation */
     Own<ram::Statement> generateStratum(std::size_t scc) const;
     Own<ram::Statement> generateStratumPreamble(const ast::RelationSet& scc) const;
@@ -121,7 +121,7 @@ Own<ram::Expression> ValueTranslator::visit_(type_identity<ast::RecordInit>, con
     for (const auto& cur : init.getArguments()) {
         values.push_back(translateValue(cur));
     }
-    return mk<ram::PackRecord>(std::move(values));
+    return mk<ram::PackRecord>(std::move(values), context.getUnboxedWidths(&init));
 }
 
 Own<ram::Expression> ValueTranslator::visit_(type_identity<ast::BranchInit>, const ast::BranchInit& adt) {
@@ -147,13 +147,14 @@ Own<ram::Expression> ValueTranslator::visit_(type_identity<ast::BranchInit>, con
     // Branch is stored either as [branch_id, [arguments]],
     // or [branch_id, argument] in case of a single argument.
     if (branchValues.size() != 1) {
-        finalRecordValues.push_back(mk<ram::PackRecord>(std::move(branchValues)));
+        finalRecordValues.push_back(
+                mk<ram::PackRecord>(std::move(branchValues), context.getUnboxedArgumentWidths(&adt)));
     } else {
         finalRecordValues.push_back(std::move(branchValues.at(0)));
     }
 
     // Final result is a pack operation
-    return mk<ram::PackRecord>(std::move(finalRecordValues));
+    return mk<ram::PackRecord>(std::move(finalRecordValues), context.getUnboxedBranchWidths(&adt));
 }
 
 Own<ram::Expression> ValueTranslator::visit_(type_identity<ast::Aggregator>, const ast::Aggregator& agg) {
@@ -21,6 +21,7 @@
 #include "ast/Functor.h"
 #include "ast/IntrinsicFunctor.h"
 #include "ast/QualifiedName.h"
+#include "ast/RecordInit.h"
 #include "ast/SubsumptiveClause.h"
 #include "ast/TranslationUnit.h"
 #include "ast/UserDefinedAggregator.h"
@@ -319,6 +320,29 @@ bool TranslatorContext::isADTBranchSimple(const ast::BranchInit* adt) const {
     return arity <= 1;
 }
 
+std::vector<unsigned> TranslatorContext::getUnboxedWidths(const ast::RecordInit* record) const {
+    if (!global->config().has("unboxed-records")) {
+        return {};
+    }
+    const auto& type = ast::analysis::getBaseType(&*typeAnalysis->getTypes(record).begin());
+    return ast::analysis::getUnboxedWidths(asAssert<ast::analysis::RecordType>(type).getFields());
+}
+
+std::vector<unsigned> TranslatorContext::getUnboxedBranchWidths(const ast::BranchInit* adt) const {
+    if (!global->config().has("unboxed-records")) {
+        return {};
+    }
+    return ast::analysis::getUnboxedBranchWidths(sumTypeBranches->unsafeGetType(adt->getBranchName()));
+}
+
+std::vector<unsigned> TranslatorContext::getUnboxedArgumentWidths(const ast::BranchInit* adt) const {
+    if (!global->config().has("unboxed-records")) {
+        return {};
+    }
+    const auto& type = sumTypeBranches->unsafeGetType(adt->getBranchName());
+    return ast::analysis::getUnboxedWidths(type.getBranchTypes(adt->getBranchName()));
+}
+
 Own<ram::Statement> TranslatorContext::translateNonRecursiveClause(
         const ast::Clause& clause, TranslationMode mode) const {
     auto clauseTranslator = Own<ClauseTranslator>(translationStrategy->createClauseTranslator(*this, mode));
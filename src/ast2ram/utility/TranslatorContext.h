@@ -47,6 +47,7 @@ class IntrinsicFunctor;
 class Literal;
 class Program;
 class QualifiedName;
+class RecordInit;
 class Relation;
 class SipsMetric;
 class TranslationUnit;
@@ -140,6 +141,11 @@ public:
     int getADTBranchId(const ast::BranchInit* adt) const;
     bool isADTBranchSimple(const ast::BranchInit* adt) const;
 
+    /** Unboxed record methods; no widths unless records are unboxed */
+    std::vector<unsigned> getUnboxedWidths(const ast::RecordInit* record) const;
+    std::vector<unsigned> getUnboxedBranchWidths(const ast::BranchInit* adt) const;
+    std::vector<unsigned> getUnboxedArgumentWidths(const ast::BranchInit* adt) const;
+
     /** Polymorphic objects methods */
     ast::NumericConstant::Type getInferredNumericConstantType(const ast::NumericConstant& nc) const;
     AggregateOp getOverloadedAggregatorOperator(const ast::IntrinsicAggregator& aggr) const;
@@ -67,10 +67,17 @@ protected:
      */
     std::size_t num_jobs;
 
+    /**
+     * table snapshot filename
+     */
+    std::string table_snapshot;
+
 public:
     // all argument constructor
-    CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, std::size_t nj)
-            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj) {}
+    CmdOptions(const char* s, const char* id, const char* od, bool pe, const char* pfn, std::size_t nj,
+            const char* ts = "")
+            : src(s), input_dir(id), output_dir(od), profiling(pe), profile_name(pfn), num_jobs(nj),
+              table_snapshot(ts) {}
 
     /**
      * get source code name
@@ -114,6 +121,13 @@ public:
         return num_jobs;
     }
 
+    /**
+     * get filename of the table snapshot, empty if none
+     */
+    const std::string& getTableSnapshot() const {
+        return table_snapshot;
+    }
+
     /**
      * Parses the given command line parameters, handles -h help requests or errors
      * and returns whether the parsing was successful or not.
@@ -132,6 +146,7 @@ public:
         // long options
         option longOptions[] = {{"facts", true, nullptr, 'F'}, {"output", true, nullptr, 'D'},
                 {"profile", true, nullptr, 'p'}, {"jobs", true, nullptr, 'j'}, {"index", true, nullptr, 'i'},
+                {"table-snapshot", true, nullptr, 'T'},
                 // the terminal option -- needs to be null
                 {nullptr, false, nullptr, 0}};
 
@@ -139,7 +154,7 @@ public:
         bool ok = true;
 
         int c; /* command-line arguments processing */
-        while ((c = getopt_long(argc, argv, "D:F:hp:j:i:", longOptions, nullptr)) != EOF) {
+        while ((c = getopt_long(argc, argv, "D:F:hp:j:i:T:", longOptions, nullptr)) != EOF) {
             switch (c) {
                 /* Fact directories */
                 case 'F':
@@ -182,6 +197,10 @@ public:
                     std::cerr << "\nWarning: OpenMP was not enabled in compilation\n\n";
 #endif
                     break;
+                /* Table snapshot of a previous run */
+                case 'T':
+                    table_snapshot = optarg;
+                    break;
                 default: printHelpPage(exec_name); return false;
             }
         }
@@ -220,6 +239,11 @@ private:
             std::cerr << "                                    (default: auto)\n";
         }
 #endif
+        std::cerr << "    --table-snapshot=<FILE>      -- Start from the symbol and record tables\n";
+        std::cerr << "                                    saved in <FILE>, and save them at the end\n";
+        if (!table_snapshot.empty()) {
+            std::cerr << "                                    (default: " << table_snapshot << ")\n";
+        }
         std::cerr << "    -h                           -- prints this help page.\n";
         std::cerr << "--------------------------------------------------------------------\n";
 #ifdef SOUFFLE_GENERATOR_VERSION
@@ -19,10 +19,18 @@
 
 #include "souffle/RamTypes.h"
 #include "souffle/utility/span.h"
+#include <array>
+#include <cassert>
+#include <cstddef>
 #include <initializer_list>
+#include <memory>
+#include <stdexcept>
 
 namespace souffle {
 
+class TableSnapshot;
+class TableSnapshotWriter;
+
 /** The interface of any Record Table. */
 class RecordTable {
 public:
@@ -35,6 +43,27 @@ public:
     virtual RamDomain pack(const std::initializer_list<RamDomain>& List) = 0;
 
     virtual const RamDomain* unpack(const RamDomain Ref, const std::size_t Arity) const = 0;
+
+    /**
+     * Check that the record table can be based on the given snapshot,
+     * otherwise throw a std::runtime_error.
+     */
+    virtual void checkSnapshot(const TableSnapshot&) const {
+        throw std::runtime_error("Record table does not support snapshots");
+    }
+
+    /**
+     * Base the record table on the given snapshot, keeping the references of
+     * its records. Not thread-safe.
+     */
+    virtual void importSnapshot(std::shared_ptr<const TableSnapshot>) {
+        throw std::runtime_error("Record table does not support snapshots");
+    }
+
+    /** Add all records to the given snapshot. */
+    virtual void exportSnapshot(TableSnapshotWriter&) const {
+        throw std::runtime_error("Record table does not support snapshots");
+    }
 };
 
 /** @brief helper to convert tuple to record reference for the synthesiser */
@@ -55,4 +84,90 @@ RamDomain pack(RecordTableT&& recordTab, const std::initializer_list<RamDomain>&
     return recordTab.pack(std::data(initlist), initlist.size());
 }
 
+/**
+ * Unboxed records
+ *
+ * Records of small fields may be encoded in the value referring to them
+ * rather than being stored in a record table. The fields of an unboxed record
+ * are two's complement bit fields of the widths determined by the type of the
+ * record (see ast::analysis::getUnboxedWidths), starting at the least
+ * significant bit. The sign bit is set, hence unboxed records are negative,
+ * whereas references into record tables and nil are not.
+ *
+ * A record is unboxed if and only if each field fits into its width, hence
+ * equal records have equal values. Records without widths are always boxed.
+ */
+
+/** @brief the maximal arity of unboxed records */
+constexpr std::size_t MAX_UNBOXED_ARITY = 4;
+
+/** @brief return true if the value is an unboxed record */
+inline bool isUnboxedRecord(RamDomain value) {
+    return value < 0;
+}
+
+/** @brief encode a record as an unboxed record, unless a field does not fit into its width */
+inline bool packUnboxed(const RamDomain* tuple, span<const unsigned> widths, RamDomain& value) {
+    RamUnsigned bits = RamUnsigned(1) << (RAM_DOMAIN_SIZE - 1);
+    unsigned shift = 0;
+    for (std::size_t i = 0; i < widths.size(); ++i) {
+        const unsigned width = widths[i];
+        const RamDomain bound = RamDomain(1) << (width - 1);
+        if (tuple[i] < -bound || tuple[i] >= bound) {
+            return false;
+        }
+        const RamUnsigned mask = (RamUnsigned(1) << width) - 1;
+        bits |= (ramBitCast<RamUnsigned>(tuple[i]) & mask) << shift;
+        shift += width;
+    }
+    assert(shift < RAM_DOMAIN_SIZE && "the widths of unboxed records exceed the domain");
+    value = ramBitCast<RamDomain>(bits);
+    return true;
+}
+
+/** @brief decode the fields of an unboxed record */
+inline void unpackUnboxed(RamDomain value, span<const unsigned> widths, RamDomain* tuple) {
+    RamUnsigned bits = ramBitCast<RamUnsigned>(value);
+    for (std::size_t i = 0; i < widths.size(); ++i) {
+        const unsigned width = widths[i];
+        const RamUnsigned mask = (RamUnsigned(1) << width) - 1;
+        const RamUnsigned sign = RamUnsigned(1) << (width - 1);
+        tuple[i] = ramBitCast<RamDomain>(((bits & mask) ^ sign) - sign);
+        bits >>= width;
+    }
+}
+
+/** @brief convert a record to a value, unboxed if its fields fit into the given widths */
+template <class RecordTableT>
+RamDomain packRecord(RecordTableT&& recordTab, const RamDomain* tuple, std::size_t arity,
+        span<const unsigned> widths) {
+    RamDomain value;
+    if (!widths.empty() && packUnboxed(tuple, widths, value)) {
+        return value;
+    }
+    return recordTab.pack(tuple, arity);
+}
+
+/**
+ * @brief convert a value of a record with the given widths to the record.
+ * Unboxed records are decoded into the given buffer of the arity of the record.
+ */
+template <class RecordTableT>
+const RamDomain* unpackRecord(RecordTableT&& recordTab, RamDomain value, std::size_t arity,
+        span<const unsigned> widths, RamDomain* buffer) {
+    if (isUnboxedRecord(value)) {
+        assert(widths.size() == arity && "unboxed record of a type without widths");
+        unpackUnboxed(value, widths, buffer);
+        return buffer;
+    }
+    return recordTab.unpack(value, arity);
+}
+
+/** @brief helper to convert tuple to record value for the synthesiser */
+template <class RecordTableT, std::size_t Arity>
+RamDomain pack(RecordTableT&& recordTab, Tuple<RamDomain, Arity> const& tuple,
+        const std::array<unsigned, Arity>& widths) {
+    return packRecord(recordTab, tuple.data(), Arity, widths);
+}
+
 }  // namespace souffle
@@ -20,11 +20,13 @@
 #include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/datastructure/ConcurrentCache.h"
+#include "souffle/datastructure/TableSnapshot.h"
 #include "souffle/utility/MiscUtil.h"
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
 #include <initializer_list>
 #include <iostream>
 #include <map>
@@ -940,6 +942,35 @@ public:
      */
     virtual RecordTable& getRecordTable() = 0;
 
+    /**
+     * Base the symbol and record tables on the snapshot saved by a previous run,
+     * such that symbols and records keep the indices they had in that run.
+     * Must be called before the program is run.
+     *
+     * @return false if the snapshot file does not exist
+     * @throws std::runtime_error if the snapshot is invalid or inconsistent with the program
+     */
+    bool loadTableSnapshot(const std::string& fileName) {
+        if (!std::filesystem::exists(fileName)) {
+            return false;
+        }
+        importTableSnapshot(getSymbolTable(), getRecordTable(), TableSnapshot::open(fileName));
+        return true;
+    }
+
+    /**
+     * Save a snapshot of the symbol and record tables, to be loaded by
+     * loadTableSnapshot() in a later run.
+     *
+     * @throws std::runtime_error if the snapshot cannot be written
+     */
+    void saveTableSnapshot(const std::string& fileName) {
+        TableSnapshotWriter writer;
+        getSymbolTable().exportSnapshot(writer);
+        getRecordTable().exportSnapshot(writer);
+        writer.write(fileName);
+    }
+
     /**
      * Remove all the tuples from the outputRelations, calling the purge method of each.
      *
@@ -19,10 +19,15 @@
 #include "souffle/RamTypes.h"
 
 #include <memory>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace souffle {
 
+class TableSnapshot;
+class TableSnapshotWriter;
+
 /** Interface of a generic SymbolTable iterator. */
 class SymbolTableIteratorInterface {
 public:
@@ -117,6 +122,16 @@ public:
     /** @brief Decode a symbol index to a symbol; aliases decode. */
     virtual const std::string& unsafeDecode(const RamDomain index) const = 0;
 
+    /**
+     * @brief Decode a symbol index to the characters of a symbol.
+     *
+     * The view remains valid as long as the symbol table. Unlike decode, it
+     * does not require the symbol to be stored as a std::string.
+     */
+    virtual std::string_view decodeView(const RamDomain index) const {
+        return decode(index);
+    }
+
     /**
      * @brief Encode the symbol, it is inserted if it does not exist.
      *
@@ -124,6 +139,27 @@ public:
      * happened.
      */
     virtual std::pair<RamDomain, bool> findOrInsert(const std::string& symbol) = 0;
+
+    /**
+     * @brief Check that the symbol table can be based on the given snapshot,
+     * otherwise throw a std::runtime_error.
+     */
+    virtual void checkSnapshot(const TableSnapshot&) const {
+        throw std::runtime_error("Symbol table does not support snapshots");
+    }
+
+    /**
+     * @brief Base the symbol table on the given snapshot, keeping the indices
+     * of its symbols. Not thread-safe.
+     */
+    virtual void importSnapshot(std::shared_ptr<const TableSnapshot>) {
+        throw std::runtime_error("Symbol table does not support snapshots");
+    }
+
+    /** @brief Add all symbols to the given snapshot. */
+    virtual void exportSnapshot(TableSnapshotWriter&) const {
+        throw std::runtime_error("Symbol table does not support snapshots");
+    }
 };
 
 }  // namespace souffle
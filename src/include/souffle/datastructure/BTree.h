@@ -18,6 +18,7 @@
 #pragma once
 
 #include "souffle/datastructure/BTreeUtil.h"
+#include "souffle/datastructure/NodeArena.h"
 #include "souffle/utility/CacheUtil.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
@@ -43,13 +44,13 @@ namespace detail {
  *
  * @tparam Key             .. the element type to be stored in this tree
  * @tparam Comparator     .. a class defining an order on the stored elements
- * @tparam Allocator     .. utilized for allocating memory for required nodes
+ * @tparam Allocator     .. determines the allocation of nodes; an arena_allocator places them in a
+ *                          NodeArena owned by the tree, otherwise they are allocated on the heap
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
  * @tparam isSet        .. true = set, false = multiset
  */
-template <typename Key, typename Comparator,
-        typename Allocator,  // is ignored so far - TODO: add support
+template <typename Key, typename Comparator, typename Allocator,
         unsigned blockSize, typename SearchStrategy, bool isSet, typename WeakComparator = Comparator,
         typename Updater = detail::updater<Key>>
 class btree {
@@ -103,6 +104,8 @@ protected:
 
     struct node;
 
+    class node_factory;
+
     /**
      * The base type of all node types containing essential
      * book-keeping information.
@@ -188,10 +191,9 @@ protected:
         /**
          * A deep-copy operation creating a clone of this node.
          */
-        node* clone() const {
+        node* clone(node_factory& factory) const {
             // create a clone of this node
-            node* res = (this->isInner()) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* res = factory.create(this->isInner());
 
             // copy basic fields
             res->position = this->position;
@@ -209,7 +211,7 @@ protected:
             // copy child nodes recursively
             auto* ires = (inner_node*)res;
             for (size_type i = 0; i <= this->numElements; ++i) {
-                ires->children[i] = this->getChild(i)->clone();
+                ires->children[i] = this->getChild(i)->clone(factory);
                 ires->children[i]->parent = res;
             }
 
@@ -342,19 +344,21 @@ protected:
         /**
          * Splits this node.
          *
+         * @param factory .. the factory creating the nodes of the enclosing b-tree
          * @param root .. a pointer to the root-pointer of the enclosing b-tree
          *                 (might have to be updated if the root-node needs to be split)
          * @param idx  .. the position of the insert causing the split
          */
 #ifdef IS_PARALLEL
-        void split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        void split(node_factory& factory, node** root, lock_type& root_lock, int idx,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void split(node** root, lock_type& root_lock, int idx) {
+        void split(node_factory& factory, node** root, lock_type& root_lock, int idx) {
 #endif
             assert(this->numElements == maxKeys);
 
@@ -362,8 +366,7 @@ protected:
             int split_point = getSplitPoint(idx);
 
             // create a new sibling node
-            node* sibling = (this->inner) ? static_cast<node*>(new inner_node())
-                                          : static_cast<node*>(new leaf_node());
+            node* sibling = factory.create(this->inner);
 
 #ifdef IS_PARALLEL
             // lock sibling
@@ -393,9 +396,9 @@ protected:
 
             // update parent
 #ifdef IS_PARALLEL
-            grow_parent(root, root_lock, sibling, locked_nodes);
+            grow_parent(factory, root, root_lock, sibling, locked_nodes);
 #else
-            grow_parent(root, root_lock, sibling);
+            grow_parent(factory, root, root_lock, sibling);
 #endif
         }
 
@@ -412,14 +415,15 @@ protected:
          */
         // TODO: remove root_lock ... no longer needed
 #ifdef IS_PARALLEL
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx, std::vector<node*>& locked_nodes) {
+        int rebalance_or_split(node_factory& factory, node** root, lock_type& root_lock, int idx,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        int rebalance_or_split(node** root, lock_type& root_lock, int idx) {
+        int rebalance_or_split(node_factory& factory, node** root, lock_type& root_lock, int idx) {
 #endif
 
             // this node is full ... and needs some space
@@ -437,7 +441,7 @@ protected:
                 // lock access to left sibling
                 if (!left->lock.try_start_write()) {
                     // left node is currently updated => skip balancing and split
-                    split(root, root_lock, idx, locked_nodes);
+                    split(factory, root, root_lock, idx, locked_nodes);
                     return 0;
                 }
 #endif
@@ -510,9 +514,9 @@ protected:
 
             // Option B) split node
 #ifdef IS_PARALLEL
-            split(root, root_lock, idx, locked_nodes);
+            split(factory, root, root_lock, idx, locked_nodes);
 #else
-            split(root, root_lock, idx);
+            split(factory, root, root_lock, idx);
 #endif
             return 0;  // = no re-balancing
         }
@@ -527,21 +531,22 @@ protected:
          * @param sibling .. the new right-sibling to be add to the parent node
          */
 #ifdef IS_PARALLEL
-        void grow_parent(node** root, lock_type& root_lock, node* sibling, std::vector<node*>& locked_nodes) {
+        void grow_parent(node_factory& factory, node** root, lock_type& root_lock, node* sibling,
+                std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(!this->parent || this->parent->lock.is_write_locked());
             assert((this->parent != nullptr) || root_lock.is_write_locked());
             assert(this->isLeaf() || souffle::contains(locked_nodes, this));
             assert(!this->parent || souffle::contains(locked_nodes, const_cast<node*>(this->parent)));
 #else
-        void grow_parent(node** root, lock_type& root_lock, node* sibling) {
+        void grow_parent(node_factory& factory, node** root, lock_type& root_lock, node* sibling) {
 #endif
 
             if (this->parent == nullptr) {
                 assert(*root == this);
 
                 // create a new root node
-                auto* new_root = new inner_node();
+                auto* new_root = factory.template create<inner_node>();
                 new_root->numElements = 1;
                 new_root->keys[0] = keys[this->numElements];
 
@@ -563,9 +568,9 @@ protected:
 
 #ifdef IS_PARALLEL
                 parent->insert_inner(
-                        root, root_lock, pos, this, keys[this->numElements], sibling, locked_nodes);
+                        factory, root, root_lock, pos, this, keys[this->numElements], sibling, locked_nodes);
 #else
-                parent->insert_inner(root, root_lock, pos, this, keys[this->numElements], sibling);
+                parent->insert_inner(factory, root, root_lock, pos, this, keys[this->numElements], sibling);
 #endif
             }
         }
@@ -579,13 +584,13 @@ protected:
          * @param newNode .. the new right-child of the inserted key
          */
 #ifdef IS_PARALLEL
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode, std::vector<node*>& locked_nodes) {
+        void insert_inner(node_factory& factory, node** root, lock_type& root_lock, unsigned pos,
+                node* predecessor, const Key& key, node* newNode, std::vector<node*>& locked_nodes) {
             assert(this->lock.is_write_locked());
             assert(souffle::contains(locked_nodes, this));
 #else
-        void insert_inner(node** root, lock_type& root_lock, unsigned pos, node* predecessor, const Key& key,
-                node* newNode) {
+        void insert_inner(node_factory& factory, node** root, lock_type& root_lock, unsigned pos,
+                node* predecessor, const Key& key, node* newNode) {
 #endif
 
             // check capacity
@@ -598,9 +603,9 @@ protected:
 
                 // split this node
 #ifdef IS_PARALLEL
-                pos -= rebalance_or_split(root, root_lock, pos, locked_nodes);
+                pos -= rebalance_or_split(factory, root, root_lock, pos, locked_nodes);
 #else
-                pos -= rebalance_or_split(root, root_lock, pos);
+                pos -= rebalance_or_split(factory, root, root_lock, pos);
 #endif
 
                 // complete insertion within new sibling if necessary
@@ -625,9 +630,10 @@ protected:
                     }
 
                     pos = (i > static_cast<unsigned>(other->numElements)) ? 0 : static_cast<unsigned>(i);
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode, locked_nodes);
+                    other->insert_inner(
+                            factory, root, root_lock, pos, predecessor, key, newNode, locked_nodes);
 #else
-                    other->insert_inner(root, root_lock, pos, predecessor, key, newNode);
+                    other->insert_inner(factory, root, root_lock, pos, predecessor, key, newNode);
 #endif
                     return;
                 }
@@ -871,19 +877,6 @@ protected:
 
         // a simple default constructor initializing member fields
         inner_node() : node(true) {}
-
-        // clear up child nodes recursively
-        ~inner_node() {
-            for (unsigned i = 0; i <= this->numElements; ++i) {
-                if (children[i] != nullptr) {
-                    if (children[i]->isLeaf()) {
-                        delete static_cast<leaf_node*>(children[i]);
-                    } else {
-                        delete static_cast<inner_node*>(children[i]);
-                    }
-                }
-            }
-        }
     };
 
     /**
@@ -895,6 +888,91 @@ protected:
         leaf_node() : node(false) {}
     };
 
+    /**
+     * Creates and releases the nodes of a tree. Depending on the allocator of
+     * the tree, nodes are allocated individually on the heap or within a
+     * NodeArena owned by the tree. Releasing the nodes of an arena does not
+     * require traversing them unless they have to be destructed.
+     */
+    class node_factory {
+    public:
+        static constexpr bool uses_arena = is_arena_allocator<Allocator>::value;
+
+        node_factory() : arena(uses_arena ? std::make_unique<NodeArena>() : nullptr) {}
+
+        // the arena is handed over, the moved-from factory obtains a fresh one
+        node_factory(node_factory&& other) : node_factory() {
+            std::swap(arena, other.arena);
+        }
+
+        node_factory(const node_factory&) = delete;
+        node_factory& operator=(const node_factory&) = delete;
+
+        template <typename N>
+        N* create() {
+            if constexpr (uses_arena) {
+                return new (arena->allocate(sizeof(N), alignof(N))) N();
+            } else {
+                return new N();
+            }
+        }
+
+        node* create(bool inner) {
+            return inner ? static_cast<node*>(create<inner_node>()) : static_cast<node*>(create<leaf_node>());
+        }
+
+        /**
+         * Releases the given tree, which has been created by this factory.
+         */
+        void release(node* root) {
+            if (root != nullptr && !(uses_arena && trivial_nodes)) {
+                destroy(root);
+            }
+            if constexpr (uses_arena) {
+                arena->reset();
+            }
+        }
+
+        void swap(node_factory& other) {
+            std::swap(arena, other.arena);
+        }
+
+        // determines the number of bytes reserved by the arena of this factory
+        size_type getReservedBytes() const {
+            return arena ? arena->getReservedBytes() : 0;
+        }
+
+    private:
+        static constexpr bool trivial_nodes = std::is_trivially_destructible<leaf_node>::value &&
+                                              std::is_trivially_destructible<inner_node>::value;
+
+        // the arena holding the nodes, if requested by the allocator
+        std::unique_ptr<NodeArena> arena;
+
+        void destroy(node* cur) {
+            if (cur->isLeaf()) {
+                dispose(static_cast<leaf_node*>(cur));
+                return;
+            }
+            auto* inner = static_cast<inner_node*>(cur);
+            for (unsigned i = 0; i <= inner->numElements; ++i) {
+                if (inner->children[i] != nullptr) {
+                    destroy(inner->children[i]);
+                }
+            }
+            dispose(inner);
+        }
+
+        template <typename N>
+        void dispose(N* cur) {
+            if constexpr (uses_arena) {
+                cur->~N();
+            } else {
+                delete cur;
+            }
+        }
+    };
+
     // ------------------- iterators ------------------------
 
 public:
@@ -1038,6 +1116,9 @@ protected:
     // a pointer to the left-most node of this tree (initial note for iteration)
     leaf_node* leftmost;
 
+    // the factory creating the nodes of this tree
+    node_factory factory;
+
     /* -------------- operator hint statistics ----------------- */
 
     // an aggregation of statistical values of the hint utilization
@@ -1076,7 +1157,8 @@ public:
 
     // a move constructor
     btree(btree&& other)
-            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost) {
+            : comp(other.comp), weak_comp(other.weak_comp), root(other.root), leftmost(other.leftmost),
+              factory(std::move(other.factory)) {
         other.root = nullptr;
         other.leftmost = nullptr;
     }
@@ -1087,14 +1169,6 @@ public:
         *this = set;
     }
 
-protected:
-    /**
-     * An internal constructor enabling the specific creation of a tree
-     * based on internal parameters.
-     */
-    btree(size_type /* size */, node* root, leaf_node* leftmost) : root(root), leftmost(leftmost) {}
-
-public:
     // the destructor freeing all contained nodes
     ~btree() {
         clear();
@@ -1142,7 +1216,7 @@ public:
             }
 
             // create new node
-            leftmost = new leaf_node();
+            leftmost = factory.template create<leaf_node>();
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1341,7 +1415,7 @@ public:
                 // split this node
                 auto old_root = root;
                 idx -= cur->rebalance_or_split(
-                        const_cast<node**>(&root), root_lock, static_cast<int>(idx), parents);
+                        factory, const_cast<node**>(&root), root_lock, static_cast<int>(idx), parents);
 
                 // release parent lock
                 for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
@@ -1393,7 +1467,7 @@ public:
         // special handling for inserting first element
         if (empty()) {
             // create new node
-            leftmost = new leaf_node();
+            leftmost = factory.template create<leaf_node>();
             leftmost->numElements = 1;
             leftmost->keys[0] = k;
             root = leftmost;
@@ -1466,7 +1540,7 @@ public:
 
             if (cur->numElements >= node::maxKeys) {
                 // split this node
-                idx -= cur->rebalance_or_split(&root, root_lock, static_cast<int>(idx));
+                idx -= cur->rebalance_or_split(factory, &root, root_lock, static_cast<int>(idx));
 
                 // insert element in right fragment
                 if (((size_type)idx) > cur->numElements) {
@@ -1509,6 +1583,80 @@ public:
         }
     }
 
+    /**
+     * Inserts the given range of elements, which has to be sorted according to
+     * the order of this tree. Elements succeeding the current maximum of the tree
+     * are appended bottom-up by filling the right-most nodes of each level, such
+     * that an empty tree is built from completely filled nodes. Any other element
+     * is inserted utilizing insertion hints.
+     *
+     * This operation must not be executed concurrently to other modifications.
+     */
+    template <typename Iter>
+    void insertSorted(const Iter& a, const Iter& b) {
+        // elements merged by an updater are inserted one by one
+        if (!std::is_same<Comparator, WeakComparator>::value) {
+            insert(a, b);
+            return;
+        }
+
+        // insert the prefix of elements not succeeding the maximum
+        auto it = a;
+        if (!empty()) {
+            operation_hints hints;
+            const Key max = *findMax();
+            for (; it != b && (isSet ? !less(max, *it) : less(*it, max)); ++it) {
+                insert(*it, hints);
+            }
+        }
+
+        // quick exit - nothing left to append
+        if (it == b) {
+            return;
+        }
+
+        // start an empty tree with a single leaf
+        if (empty()) {
+            leftmost = factory.template create<leaf_node>();
+            leftmost->numElements = 1;
+            leftmost->keys[0] = *it;
+            root = leftmost;
+            ++it;
+        }
+
+        append(it, b);
+    }
+
+    /**
+     * Inserts the given batch of elements in any order. The batch is sorted
+     * in place before being inserted through insertSorted().
+     */
+    void insertBatch(std::vector<Key>& batch) {
+        std::sort(batch.begin(), batch.end(), [&](const Key& x, const Key& y) { return less(x, y); });
+        insertSorted(batch.begin(), batch.end());
+    }
+
+    /**
+     * Inserts the given buffer of elements in any order, e.g. the tuples a
+     * thread derived in a parallel loop. The buffer is sorted (and, for sets,
+     * de-duplicated) in place, such that consecutive elements are inserted
+     * into the same leaves utilizing the given hints.
+     *
+     * Unlike insertBatch(), this operation may be executed concurrently to
+     * other insertions.
+     */
+    void insertBuffer(std::vector<Key>& buffer, operation_hints& hints) {
+        std::sort(buffer.begin(), buffer.end(), [&](const Key& x, const Key& y) { return less(x, y); });
+        if (isSet) {
+            buffer.erase(std::unique(buffer.begin(), buffer.end(),
+                                 [&](const Key& x, const Key& y) { return equal(x, y); }),
+                    buffer.end());
+        }
+        for (const auto& key : buffer) {
+            insert(key, hints);
+        }
+    }
+
     // Obtains an iterator referencing the first element of the tree.
     iterator begin() const {
         return iterator(leftmost, 0);
@@ -1735,13 +1883,7 @@ public:
      * Clears this tree.
      */
     void clear() {
-        if (root != nullptr) {
-            if (root->isLeaf()) {
-                delete static_cast<leaf_node*>(root);
-            } else {
-                delete static_cast<inner_node*>(root);
-            }
-        }
+        factory.release(root);
         root = nullptr;
         leftmost = nullptr;
     }
@@ -1755,6 +1897,7 @@ public:
         // swap the content
         std::swap(root, other.root);
         std::swap(leftmost, other.leftmost);
+        factory.swap(other.factory);
     }
 
     // Implementation of the assignment operation for trees.
@@ -1771,7 +1914,7 @@ public:
         }
 
         // clone content (deep copy)
-        root = other.root->clone();
+        root = other.root->clone(factory);
 
         // update leftmost reference
         auto tmp = root;
@@ -1857,6 +2000,9 @@ public:
         out << "  Size of inner node: " << sizeof(inner_node) << "\n";
         out << "  Size of leaf node:  " << sizeof(leaf_node) << "\n";
         out << "  Size of Key:        " << sizeof(Key) << "\n";
+        if (node_factory::uses_arena) {
+            out << "  Arena reserved:     " << factory.getReservedBytes() << " bytes\n";
+        }
         out << "  max keys / node:  " << node::maxKeys << "\n";
         out << "  avg keys / node:  " << (size() / (double)nodes) << "\n";
         out << "  avg filling rate: " << ((size() / (double)nodes) / node::maxKeys) << "\n";
@@ -1901,17 +2047,19 @@ public:
             return R();
         }
 
-        // resolve tree recursively
-        auto root = buildSubTree(a, b - 1);
+        // resolve tree recursively, creating the nodes by the factory of the result
+        R res;
+        res.root = res.buildSubTree(a, b - 1);
 
         // find leftmost node
-        node* leftmost = root;
+        node* leftmost = res.root;
         while (!leftmost->isLeaf()) {
             leftmost = leftmost->getChild(0);
         }
+        res.leftmost = static_cast<leaf_node*>(leftmost);
 
         // build result
-        return R(b - a, root, static_cast<leaf_node*>(leftmost));
+        return res;
     }
 
 protected:
@@ -1953,9 +2101,138 @@ private:
         return !node->isEmpty() && !less(k, node->keys[0]) && less(k, node->keys[node->numElements - 1]);
     }
 
+    /**
+     * Obtains a pointer to the largest element of this tree, or null if empty.
+     */
+    const Key* findMax() const {
+        const Key* res = nullptr;
+        node* cur = root;
+        while (cur != nullptr) {
+            // nodes may be empty due to biased insertion
+            if (!cur->isEmpty()) {
+                res = &cur->keys[cur->numElements - 1];
+            }
+            cur = (cur->isLeaf()) ? nullptr : cur->getChild(cur->numElements);
+        }
+        return res;
+    }
+
+    /**
+     * Appends the given sorted range of elements succeeding the maximum of this
+     * non-empty tree. Full nodes are left behind at the right border of each
+     * level, and a new root is added whenever the old one runs full.
+     */
+    template <typename Iter>
+    void append(Iter a, const Iter& b) {
+        // collect the right-most node of each level, starting with the leaf level
+        std::vector<node*> border;
+        for (node* cur = root;; cur = cur->getChild(cur->numElements)) {
+            border.push_back(cur);
+            if (cur->isLeaf()) {
+                break;
+            }
+        }
+        std::reverse(border.begin(), border.end());
+
+        // the most recently appended element
+        const Key* last = findMax();
+
+        for (; a != b; ++a) {
+            const Key& k = *a;
+            assert(!less(k, *last) && "Range not sorted!");
+
+            // skip duplicates in sets
+            if (isSet && !less(*last, k)) {
+                continue;
+            }
+
+            // append to the right-most leaf if there is space left
+            node* leaf = border[0];
+            if (!leaf->isFull()) {
+                last = &leaf->keys[leaf->numElements];
+                leaf->keys[leaf->numElements] = k;
+                leaf->numElements++;
+                continue;
+            }
+
+            // otherwise the key separates the full leaf from a new right-most leaf
+            node* cur = factory.template create<leaf_node>();
+            border[0] = cur;
+            for (size_type level = 1;; ++level) {
+                // the root is full => grow the tree by one level
+                if (level == border.size()) {
+                    auto* newRoot = factory.template create<inner_node>();
+                    newRoot->numElements = 1;
+                    newRoot->keys[0] = k;
+                    newRoot->children[0] = root;
+                    newRoot->children[1] = cur;
+                    root->parent = newRoot;
+                    root->position = 0;
+                    cur->parent = newRoot;
+                    cur->position = 1;
+                    root = newRoot;
+                    border.push_back(newRoot);
+                    last = &newRoot->keys[0];
+                    break;
+                }
+
+                // there is space in the parent => add key and child
+                node* parent = border[level];
+                if (!parent->isFull()) {
+                    auto n = parent->numElements;
+                    parent->keys[n] = k;
+                    parent->getChildren()[n + 1] = cur;
+                    cur->parent = parent;
+                    cur->position = static_cast<field_index_type>(n + 1);
+                    parent->numElements++;
+                    last = &parent->keys[n];
+                    break;
+                }
+
+                // the parent is full as well => continue with a new right-most inner node
+                auto* sibling = factory.template create<inner_node>();
+                sibling->children[0] = cur;
+                cur->parent = sibling;
+                cur->position = 0;
+                border[level] = sibling;
+                cur = sibling;
+            }
+        }
+
+        // nodes left empty at the border borrow an element from their left sibling (top-down,
+        // such that every node has a non-empty parent when being fixed)
+        for (auto it = border.rbegin(); it != border.rend(); ++it) {
+            node* cur = *it;
+            if (!cur->isEmpty() || cur == root) {
+                continue;
+            }
+            node* parent = cur->parent;
+            auto pos = cur->position;
+            assert(pos > 0 && "Empty node without left sibling!");
+            node* sibling = parent->getChild(pos - 1);
+            if (sibling->numElements < 2) {
+                continue;
+            }
+
+            // rotate the last element of the sibling through the parent
+            cur->keys[0] = parent->keys[pos - 1];
+            parent->keys[pos - 1] = sibling->keys[sibling->numElements - 1];
+            if (cur->isInner()) {
+                node* moved = sibling->getChild(sibling->numElements);
+                cur->getChildren()[1] = cur->getChild(0);
+                cur->getChild(1)->position = 1;
+                cur->getChildren()[0] = moved;
+                moved->parent = cur;
+                moved->position = 0;
+            }
+            cur->numElements = 1;
+            sibling->numElements--;
+        }
+    }
+
     // Utility function for the load operation above.
     template <typename Iter>
-    static node* buildSubTree(const Iter& a, const Iter& b) {
+    node* buildSubTree(const Iter& a, const Iter& b) {
         const int N = node::maxKeys;
 
         // divide range in N+1 sub-ranges
@@ -1964,7 +2241,7 @@ private:
         // terminal case: length is less then maxKeys
         if (length <= N) {
             // create a leaf node
-            node* res = new leaf_node();
+            node* res = factory.template create<leaf_node>();
             res->numElements = length;
 
             for (int i = 0; i < length; ++i) {
@@ -1984,7 +2261,7 @@ private:
         }
 
         // create inner node
-        node* res = new inner_node();
+        node* res = factory.template create<inner_node>();
         res->numElements = numKeys;
 
         Iter c = a;
@@ -2025,12 +2302,12 @@ const SearchStrategy
  *
  * @tparam Key             .. the element type to be stored in this set
  * @tparam Comparator     .. a class defining an order on the stored elements
- * @tparam Allocator     .. utilized for allocating memory for required nodes
+ * @tparam Allocator     .. utilized for allocating memory for required nodes, see arena_allocator
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
  */
 template <typename Key, typename Comparator = detail::comparator<Key>,
-        typename Allocator = std::allocator<Key>,  // is ignored so far
+        typename Allocator = std::allocator<Key>,
         unsigned blockSize = 256,
         typename SearchStrategy = typename souffle::detail::default_strategy<Key>::type,
         typename WeakComparator = Comparator, typename Updater = souffle::detail::updater<Key>>
@@ -2063,12 +2340,6 @@ public:
     // A move constructor.
     btree_set(btree_set&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    btree_set(s size, n* root, l* leftmost) : super(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     btree_set& operator=(const btree_set& other) {
         super::operator=(other);
@@ -2087,12 +2358,12 @@ public:
  *
  * @tparam Key             .. the element type to be stored in this set
  * @tparam Comparator     .. a class defining an order on the stored elements
- * @tparam Allocator     .. utilized for allocating memory for required nodes
+ * @tparam Allocator     .. utilized for allocating memory for required nodes, see arena_allocator
  * @tparam blockSize    .. determines the number of bytes/block utilized by leaf nodes
  * @tparam SearchStrategy .. enables switching between linear, binary or any other search strategy
  */
 template <typename Key, typename Comparator = detail::comparator<Key>,
-        typename Allocator = std::allocator<Key>,  // is ignored so far
+        typename Allocator = std::allocator<Key>,
         unsigned blockSize = 256,
         typename SearchStrategy = typename souffle::detail::default_strategy<Key>::type,
         typename WeakComparator = Comparator, typename Updater = souffle::detail::updater<Key>>
@@ -2125,12 +2396,6 @@ public:
     // A move constructor.
     btree_multiset(btree_multiset&& other) : super(std::move(other)) {}
 
-private:
-    // A constructor required by the bulk-load facility.
-    template <typename s, typename n, typename l>
-    btree_multiset(s size, n* root, l* leftmost) : super(size, root, leftmost) {}
-
-public:
     // Support for the assignment operator.
     btree_multiset& operator=(const btree_multiset& other) {
         super::operator=(other);
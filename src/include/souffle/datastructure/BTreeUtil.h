@@ -16,7 +16,15 @@
 
 #pragma once
 
+#include <array>
+#include <bitset>
+#include <cstddef>
 #include <tuple>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+#include <immintrin.h>
+#endif
 
 namespace souffle {
 
@@ -188,6 +196,194 @@ struct binary_search : public search_strategy {
     }
 };
 
+/**
+ * A trait determining whether a comparator exposes the attribute it compares
+ * first. Comparators opt in to accelerated node searches by declaring
+ *
+ *      static constexpr std::size_t leading_column = <attribute>;
+ *      using leading_type = <integral type the attribute is compared as>;
+ */
+template <typename Comp, typename = void>
+struct has_leading_column : public std::false_type {};
+
+template <typename Comp>
+struct has_leading_column<Comp, std::void_t<decltype(Comp::leading_column), typename Comp::leading_type>>
+        : public std::true_type {};
+
+/**
+ * A search strategy for b-tree nodes storing tuples of integers. Instead of
+ * comparing full tuples, it counts the keys whose leading attribute is less
+ * than the one of the searched key -- several keys at once using AVX2 or
+ * SSE4.2 instructions if enabled at compile time, a scalar loop otherwise --
+ * and only binary searches the remaining keys with full tuple comparisons,
+ * such that long runs of keys sharing the leading attribute remain cheap.
+ *
+ * If the comparator does not expose its leading attribute (see
+ * has_leading_column) this strategy falls back to a binary search.
+ */
+struct simd_search : public search_strategy {
+    /**
+     * Required user-defined default constructor.
+     */
+    simd_search() = default;
+
+    /**
+     * Obtains an iterator referencing an element equivalent to the
+     * given key in the given range. If no such element is present,
+     * a reference to the first element not less than the given key
+     * is returned.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter operator()(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (applicable<Key, Iter, Comp>()) {
+            return lower_bound(k, a, b, comp);
+        } else {
+            return binary_search()(k, a, b, comp);
+        }
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * is not less than the given key.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter lower_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (applicable<Key, Iter, Comp>()) {
+            return binary_search().lower_bound(k, a + countLess<std::remove_cv_t<Comp>>(k, a, b), b, comp);
+        } else {
+            return binary_search().lower_bound(k, a, b, comp);
+        }
+    }
+
+    /**
+     * Obtains a reference to the first element in the given range that
+     * such that the given key is less than the referenced element.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    inline Iter upper_bound(const Key& k, Iter a, Iter b, Comp& comp) const {
+        if constexpr (applicable<Key, Iter, Comp>()) {
+            return binary_search().upper_bound(k, a + countLess<std::remove_cv_t<Comp>>(k, a, b), b, comp);
+        } else {
+            return binary_search().upper_bound(k, a, b, comp);
+        }
+    }
+
+private:
+    template <typename Key>
+    struct is_integer_array : public std::false_type {};
+
+    template <typename T, std::size_t N>
+    struct is_integer_array<std::array<T, N>>
+            : public std::bool_constant<std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8)> {};
+
+    /**
+     * Determines whether the counting of leading attributes can be applied
+     * for the given key, iterator and comparator types.
+     */
+    template <typename Key, typename Iter, typename Comp>
+    static constexpr bool applicable() {
+        using C = std::remove_cv_t<Comp>;
+        if constexpr (is_integer_array<Key>::value && std::is_pointer_v<Iter> &&
+                      has_leading_column<C>::value) {
+            using T = typename C::leading_type;
+            return std::is_integral_v<T> && sizeof(T) == sizeof(typename Key::value_type) &&
+                   C::leading_column < std::tuple_size<Key>::value;
+        } else {
+            return false;
+        }
+    }
+
+    /**
+     * Counts the elements in the range [a,b) whose leading attribute is less than
+     * the leading attribute of the given key. Since the range is ordered, this is
+     * the position of the first candidate for a full comparison.
+     */
+    template <typename Comp, typename Key>
+    static std::size_t countLess(const Key& k, const Key* a, const Key* b) {
+        using T = typename Comp::leading_type;
+        using E = typename Key::value_type;
+        constexpr std::size_t col = Comp::leading_column;
+        constexpr std::size_t stride = sizeof(Key) / sizeof(E);
+
+        const E* base = &((*a)[col]);
+        const std::size_t n = b - a;
+        const T needle = static_cast<T>(k[col]);
+        std::size_t i = 0;
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+        // integer vector comparisons are signed; unsigned values are biased into the signed range
+        if constexpr (sizeof(T) == 4) {
+            const int bias = std::is_signed_v<T> ? 0 : static_cast<int>(0x80000000u);
+            const int key = static_cast<int>(needle) ^ bias;
+#if defined(__AVX2__)
+            const __m256i offsets = _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride,
+                    5 * stride, 6 * stride, 7 * stride);
+            const __m256i vbias = _mm256_set1_epi32(bias);
+            const __m256i vkey = _mm256_set1_epi32(key);
+            for (; i + 8 <= n; i += 8) {
+                __m256i vals = _mm256_i32gather_epi32(
+                        reinterpret_cast<const int*>(base + i * stride), offsets, sizeof(E));
+                __m256i lt = _mm256_cmpgt_epi32(vkey, _mm256_xor_si256(vals, vbias));
+                int mask = _mm256_movemask_ps(_mm256_castsi256_ps(lt));
+                if (mask != 0xFF) {
+                    return i + std::bitset<8>(mask).count();
+                }
+            }
+#else
+            const __m128i vbias = _mm_set1_epi32(bias);
+            const __m128i vkey = _mm_set1_epi32(key);
+            for (; i + 4 <= n; i += 4) {
+                const E* cur = base + i * stride;
+                __m128i vals = _mm_setr_epi32(static_cast<int>(cur[0]), static_cast<int>(cur[stride]),
+                        static_cast<int>(cur[2 * stride]), static_cast<int>(cur[3 * stride]));
+                __m128i lt = _mm_cmpgt_epi32(vkey, _mm_xor_si128(vals, vbias));
+                int mask = _mm_movemask_ps(_mm_castsi128_ps(lt));
+                if (mask != 0xF) {
+                    return i + std::bitset<4>(mask).count();
+                }
+            }
+#endif
+        } else {
+            const long long bias = std::is_signed_v<T> ? 0 : static_cast<long long>(0x8000000000000000ull);
+            const long long key = static_cast<long long>(needle) ^ bias;
+#if defined(__AVX2__)
+            const __m256i offsets = _mm256_setr_epi64x(0, stride, 2 * stride, 3 * stride);
+            const __m256i vbias = _mm256_set1_epi64x(bias);
+            const __m256i vkey = _mm256_set1_epi64x(key);
+            for (; i + 4 <= n; i += 4) {
+                __m256i vals = _mm256_i64gather_epi64(
+                        reinterpret_cast<const long long*>(base + i * stride), offsets, sizeof(E));
+                __m256i lt = _mm256_cmpgt_epi64(vkey, _mm256_xor_si256(vals, vbias));
+                int mask = _mm256_movemask_pd(_mm256_castsi256_pd(lt));
+                if (mask != 0xF) {
+                    return i + std::bitset<4>(mask).count();
+                }
+            }
+#else
+            const __m128i vbias = _mm_set1_epi64x(bias);
+            const __m128i vkey = _mm_set1_epi64x(key);
+            for (; i + 2 <= n; i += 2) {
+                const E* cur = base + i * stride;
+                __m128i vals = _mm_set_epi64x(
+                        static_cast<long long>(cur[stride]), static_cast<long long>(cur[0]));
+                __m128i lt = _mm_cmpgt_epi64(vkey, _mm_xor_si128(vals, vbias));
+                int mask = _mm_movemask_pd(_mm_castsi128_pd(lt));
+                if (mask != 0x3) {
+                    return i + std::bitset<2>(mask).count();
+                }
+            }
+#endif
+        }
+#endif
+
+        // scalar fallback and remainder
+        while (i < n && static_cast<T>(base[i * stride]) < needle) {
+            ++i;
+        }
+        return i;
+    }
+};
+
 // ---------- search strategies selection --------------
 
 /**
@@ -201,6 +397,7 @@ struct strategy_selection {
 
 struct linear : public strategy_selection<linear_search> {};
 struct binary : public strategy_selection<binary_search> {};
+struct simd : public strategy_selection<simd_search> {};
 
 // by default every key utilizes binary search
 template <typename Key>
@@ -212,6 +409,12 @@ struct default_strategy<int> : public linear {};
 template <typename... Ts>
 struct default_strategy<std::tuple<Ts...>> : public linear {};
 
+// tuples of integers compare their leading attribute with simd_search
+template <typename T, std::size_t N>
+struct default_strategy<std::array<T, N>>
+        : public std::conditional_t<std::is_integral_v<T> && (sizeof(T) == 4 || sizeof(T) == 8), simd,
+                  binary> {};
+
 /**
  * The default non-updater
  */
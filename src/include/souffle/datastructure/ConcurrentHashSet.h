@@ -0,0 +1,431 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ConcurrentHashSet.h
+ *
+ * A concurrent, insert-only hash set of fixed-size tuples based on open
+ * addressing with linear probing. It supports only point lookups and is
+ * used for relations which are exclusively probed with fully bound keys.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace souffle {
+
+namespace detail {
+
+/**
+ * A hash function for tuples of integral values mixing all elements of
+ * the tuple with the 64-bit finalizer of MurmurHash3.
+ */
+template <typename Key>
+struct tuple_hash {
+    std::size_t operator()(const Key& key) const {
+        uint64_t h = 0x9e3779b97f4a7c15ULL;
+        for (const auto& cur : key) {
+            h = (h ^ static_cast<uint64_t>(cur)) * 0xff51afd7ed558ccdULL;
+            h ^= h >> 32;
+        }
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<std::size_t>(h);
+    }
+};
+
+}  // namespace detail
+
+/**
+ * A concurrent hash set for insertions and membership tests.
+ *
+ * Elements are stored in a power-of-two sized table of slots which is
+ * probed linearly. Each slot is claimed by an atomic state transition
+ * (empty -> busy -> full), hence concurrent insertions do not require
+ * locks. Growing the table requires exclusive access, which is obtained
+ * through a read/write lock that insertions acquire in shared mode.
+ * Replaced tables are retained until the set is cleared, such that
+ * concurrent membership tests never access released memory.
+ *
+ * Iterators and partitions are not stable under concurrent insertions.
+ *
+ * @tparam Key the type of the stored elements
+ * @tparam Hash the hash function for elements
+ * @tparam KeyEqual the equality predicate for elements
+ */
+template <typename Key, typename Hash = detail::tuple_hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class ConcurrentHashSet {
+public:
+    using element_type = Key;
+    using key_type = Key;
+    using size_type = std::size_t;
+
+    /**
+     * Hash sets do not exploit access patterns, hence hints are empty.
+     * They are provided for interface compatibility with b-trees.
+     */
+    struct operation_hints {
+        void clear() {}
+    };
+
+private:
+    // the states of a slot
+    enum : uint8_t { EMPTY = 0, BUSY = 1, FULL = 2 };
+
+    struct Slot {
+        std::atomic<uint8_t> state{EMPTY};
+        Key key;
+    };
+
+    struct Table {
+        explicit Table(size_type capacity) : capacity(capacity), slots(std::make_unique<Slot[]>(capacity)) {}
+
+        // the number of slots, a power of two
+        const size_type capacity;
+
+        // the slots of this table
+        std::unique_ptr<Slot[]> slots;
+
+        // the maximum number of elements before the table is grown (load factor 1/2)
+        size_type limit() const {
+            return capacity / 2;
+        }
+    };
+
+    static constexpr size_type initialCapacity = 16;
+
+    // the current table
+    std::atomic<Table*> table;
+
+    // the current and all replaced tables
+    std::vector<std::unique_ptr<Table>> tables;
+
+    // the number of elements, including those being inserted
+    std::atomic<size_type> numElements{0};
+
+    // a lock synchronising insertions (shared) with the growth of the table (exclusive)
+    ReadWriteLock growLock;
+
+    Hash hasher;
+    KeyEqual equal;
+
+public:
+    /**
+     * An iterator over the elements of a table, skipping empty slots.
+     */
+    class iterator {
+        const Table* table = nullptr;
+        size_type pos = 0;
+
+        void skip() {
+            while (pos < table->capacity && table->slots[pos].state.load(std::memory_order_acquire) != FULL) {
+                ++pos;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Key;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Key*;
+        using reference = const Key&;
+
+        iterator() = default;
+
+        iterator(const Table* table, size_type pos) : table(table), pos(pos) {
+            skip();
+        }
+
+        bool operator==(const iterator& other) const {
+            return pos == other.pos;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return pos != other.pos;
+        }
+
+        const Key& operator*() const {
+            return table->slots[pos].key;
+        }
+
+        const Key* operator->() const {
+            return &table->slots[pos].key;
+        }
+
+        iterator& operator++() {
+            ++pos;
+            skip();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+    };
+
+    using const_iterator = iterator;
+    using chunk = range<iterator>;
+
+    ConcurrentHashSet(const Hash& hash = Hash(), const KeyEqual& keyEqual = KeyEqual())
+            : hasher(hash), equal(keyEqual) {
+        tables.push_back(std::make_unique<Table>(initialCapacity));
+        table.store(tables.back().get());
+    }
+
+    ConcurrentHashSet(const ConcurrentHashSet&) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet&) = delete;
+
+    /**
+     * Inserts the given element; returns true if it was not present before.
+     * This operation may be invoked concurrently.
+     */
+    bool insert(const Key& key) {
+        const size_type hash = hasher(key);
+        while (true) {
+            growLock.start_read();
+            Table* cur = table.load(std::memory_order_acquire);
+
+            // reserve room for the element, grow the table if it is too full
+            if (numElements.fetch_add(1, std::memory_order_relaxed) >= cur->limit()) {
+                numElements.fetch_sub(1, std::memory_order_relaxed);
+                growLock.end_read();
+                grow(cur);
+                continue;
+            }
+
+            const bool inserted = insert(*cur, key, hash);
+            if (!inserted) {
+                numElements.fetch_sub(1, std::memory_order_relaxed);
+            }
+            growLock.end_read();
+            return inserted;
+        }
+    }
+
+    bool insert(const Key& key, operation_hints&) {
+        return insert(key);
+    }
+
+    /**
+     * Inserts all elements of the given range.
+     */
+    template <typename Iter>
+    void insert(const Iter& a, const Iter& b) {
+        for (auto it = a; it != b; ++it) {
+            insert(*it);
+        }
+    }
+
+    /**
+     * Tests whether the given element is present. This operation may be
+     * invoked concurrently to insertions.
+     */
+    bool contains(const Key& key) const {
+        const Table* cur = table.load(std::memory_order_acquire);
+        return locate(*cur, key) < cur->capacity;
+    }
+
+    bool contains(const Key& key, operation_hints&) const {
+        return contains(key);
+    }
+
+    /**
+     * Obtains an iterator referencing the given element or end() if it is not present.
+     */
+    iterator find(const Key& key) const {
+        const Table* cur = table.load(std::memory_order_acquire);
+        return iterator(cur, locate(*cur, key));
+    }
+
+    iterator find(const Key& key, operation_hints&) const {
+        return find(key);
+    }
+
+    /**
+     * Point lookups in the style of an ordered set; the range
+     * [lower_bound(k), upper_bound(k)) contains k if present and is empty
+     * otherwise. Ranges between distinct bounds are not supported.
+     */
+    iterator lower_bound(const Key& key) const {
+        return find(key);
+    }
+
+    iterator lower_bound(const Key& key, operation_hints&) const {
+        return lower_bound(key);
+    }
+
+    iterator upper_bound(const Key& key) const {
+        auto res = find(key);
+        if (res != end()) {
+            ++res;
+        }
+        return res;
+    }
+
+    iterator upper_bound(const Key& key, operation_hints&) const {
+        return upper_bound(key);
+    }
+
+    iterator begin() const {
+        return iterator(table.load(std::memory_order_acquire), 0);
+    }
+
+    iterator end() const {
+        const Table* cur = table.load(std::memory_order_acquire);
+        return iterator(cur, cur->capacity);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_type size() const {
+        return numElements.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Partitions the set into at most the given number of disjoint chunks,
+     * e.g. to be processed in parallel.
+     */
+    std::vector<chunk> getChunks(size_type num) const {
+        std::vector<chunk> res;
+        const Table* cur = table.load(std::memory_order_acquire);
+        const size_type parts = std::max<size_type>(1, num);
+        const size_type step = std::max<size_type>(1, (cur->capacity + parts - 1) / parts);
+        for (size_type i = 0; i < cur->capacity; i += step) {
+            chunk part(iterator(cur, i), iterator(cur, std::min(i + step, cur->capacity)));
+            if (!part.empty()) {
+                res.push_back(part);
+            }
+        }
+        return res;
+    }
+
+    std::vector<chunk> partition(size_type num) const {
+        return getChunks(num);
+    }
+
+    /**
+     * Removes all elements; must not be invoked concurrently to any other operation.
+     */
+    void clear() {
+        tables.clear();
+        tables.push_back(std::make_unique<Table>(initialCapacity));
+        table.store(tables.back().get());
+        numElements = 0;
+    }
+
+    /**
+     * Prints a summary of the occupation of this hash set.
+     */
+    void printStats(std::ostream& out = std::cout) const {
+        const Table* cur = table.load(std::memory_order_acquire);
+        out << "---------------------------------\n";
+        out << "  Hash Set Statistics:\n";
+        out << "    Size:            " << size() << "\n";
+        out << "    Capacity:        " << cur->capacity << "\n";
+        out << "    Load Factor:     " << (double)size() / (double)cur->capacity << "\n";
+        out << "    Retired Tables:  " << tables.size() - 1 << "\n";
+        out << "---------------------------------\n";
+    }
+
+private:
+    /**
+     * Claims a slot for the given element in the given table unless an
+     * equal element is present. The table must have a free slot.
+     */
+    bool insert(Table& t, const Key& key, size_type hash) {
+        const size_type mask = t.capacity - 1;
+        for (size_type i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = t.slots[i];
+            uint8_t state = slot.state.load(std::memory_order_acquire);
+            if (state == EMPTY) {
+                if (slot.state.compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+                    slot.key = key;
+                    slot.state.store(FULL, std::memory_order_release);
+                    return true;
+                }
+            }
+            // wait for a concurrent insertion into this slot to complete
+            while (state == BUSY) {
+                state = slot.state.load(std::memory_order_acquire);
+            }
+            if (equal(slot.key, key)) {
+                return false;
+            }
+        }
+    }
+
+    /**
+     * Obtains the position of the given element in the given table, or its
+     * capacity if the element is not present.
+     */
+    size_type locate(const Table& t, const Key& key) const {
+        const size_type mask = t.capacity - 1;
+        for (size_type i = hasher(key) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = t.slots[i];
+            uint8_t state = slot.state.load(std::memory_order_acquire);
+            if (state == EMPTY) {
+                return t.capacity;
+            }
+            while (state == BUSY) {
+                state = slot.state.load(std::memory_order_acquire);
+            }
+            if (equal(slot.key, key)) {
+                return i;
+            }
+        }
+    }
+
+    /**
+     * Replaces the given table by a table of twice the capacity unless
+     * another thread has done so already.
+     */
+    void grow(Table* cur) {
+        growLock.start_write();
+        if (table.load(std::memory_order_relaxed) == cur) {
+            auto next = std::make_unique<Table>(cur->capacity * 2);
+            const size_type mask = next->capacity - 1;
+            for (size_type i = 0; i < cur->capacity; ++i) {
+                const Slot& slot = cur->slots[i];
+                if (slot.state.load(std::memory_order_relaxed) != FULL) {
+                    continue;
+                }
+                // elements are unique, hence the first free slot is taken
+                size_type pos = hasher(slot.key) & mask;
+                while (next->slots[pos].state.load(std::memory_order_relaxed) != EMPTY) {
+                    pos = (pos + 1) & mask;
+                }
+                next->slots[pos].key = slot.key;
+                next->slots[pos].state.store(FULL, std::memory_order_relaxed);
+            }
+            table.store(next.get(), std::memory_order_release);
+            tables.push_back(std::move(next));
+        }
+        growLock.end_write();
+    }
+};
+
+}  // namespace souffle
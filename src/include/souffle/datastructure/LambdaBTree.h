@@ -83,7 +83,7 @@ public:
             }
 
             // create new node
-            this->leftmost = new typename parenttype::leaf_node();
+            this->leftmost = this->factory.template create<typename parenttype::leaf_node>();
             this->leftmost->numElements = 1;
             // call the functor as we've successfully inserted
             typename Functor::result_type res = f(k);
@@ -313,8 +313,9 @@ public:
 
                 // split this node
                 auto old_root = this->root;
-                idx -= cur->rebalance_or_split(const_cast<typename parenttype::node**>(&this->root),
-                        this->root_lock, static_cast<int>(idx), parents);
+                idx -= cur->rebalance_or_split(this->factory,
+                        const_cast<typename parenttype::node**>(&this->root), this->root_lock,
+                        static_cast<int>(idx), parents);
 
                 // release parent lock
                 for (auto it = parents.rbegin(); it != parents.rend(); ++it) {
@@ -367,7 +368,7 @@ public:
         // special handling for inserting first element
         if (this->empty()) {
             // create new node
-            this->leftmost = new typename parenttype::leaf_node();
+            this->leftmost = this->factory.template create<typename parenttype::leaf_node>();
             this->leftmost->numElements = 1;
             // call the functor as we've successfully inserted
             typename Functor::result_type res = f(k);
@@ -444,8 +445,9 @@ public:
 
             if (cur->numElements >= parenttype::node::maxKeys) {
                 // split this node
-                idx -= cur->rebalance_or_split(const_cast<typename parenttype::node**>(&this->root),
-                        this->root_lock, static_cast<int>(idx));
+                idx -= cur->rebalance_or_split(this->factory,
+                        const_cast<typename parenttype::node**>(&this->root), this->root_lock,
+                        static_cast<int>(idx));
 
                 // insert element in right fragment
                 if (((typename parenttype::size_type)idx) > cur->numElements) {
@@ -514,7 +516,7 @@ public:
         }
 
         // clone content (deep copy)
-        this->root = other.root->clone();
+        this->root = other.root->clone(this->factory);
 
         // update leftmost reference
         auto tmp = this->root;
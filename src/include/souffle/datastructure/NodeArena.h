@@ -0,0 +1,197 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file NodeArena.h
+ *
+ * A memory arena for the nodes of tree-shaped data structures, supporting
+ * the release of all nodes at once.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * A memory arena serving the node allocations of a single data structure.
+ *
+ * Each thread allocates from its own pool of memory blocks by bumping a
+ * pointer. Nodes are never freed individually. Instead, reset() releases
+ * all nodes at once in time proportional to the number of blocks. Pools
+ * retain their first blocks for reuse, hence small data structures which are
+ * cleared and refilled repeatedly (e.g. the delta relations of a fixpoint
+ * computation) stop allocating memory, while the memory of large ones is
+ * returned to the system.
+ *
+ * Blocks grow geometrically per pool, such that arenas of small data
+ * structures remain small.
+ */
+class NodeArena {
+public:
+    /** The size of the first block of each pool */
+    static constexpr std::size_t initialBlockSize = std::size_t(1) << 12;
+
+    /** The maximum size of regular blocks */
+    static constexpr std::size_t maxBlockSize = std::size_t(1) << 20;
+
+    /** The number of bytes each pool retains on a reset */
+    static constexpr std::size_t retainedBytes = std::size_t(1) << 20;
+
+    NodeArena() : lanes(MAX_THREADS), pools(std::make_unique<Pool[]>(lanes.lanes())) {}
+
+    NodeArena(const NodeArena&) = delete;
+    NodeArena& operator=(const NodeArena&) = delete;
+
+    /**
+     * Allocates the given number of bytes with the given alignment. This
+     * operation may be invoked concurrently.
+     */
+    void* allocate(std::size_t size, std::size_t alignment) {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "alignment must be a power of two");
+        const auto lane = lanes.threadLane();
+        auto guard = lanes.guard();
+        return pools[lane].allocate(size, alignment);
+    }
+
+    /**
+     * Releases all allocated memory for reuse. Must not be invoked
+     * concurrently to any other operation.
+     */
+    void reset() {
+        for (std::size_t i = 0; i < lanes.lanes(); ++i) {
+            pools[i].reset();
+        }
+    }
+
+    /**
+     * Obtains the number of bytes reserved by this arena.
+     */
+    std::size_t getReservedBytes() const {
+        std::size_t res = 0;
+        for (std::size_t i = 0; i < lanes.lanes(); ++i) {
+            for (const auto& block : pools[i].blocks) {
+                res += block.size;
+            }
+        }
+        return res;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        std::size_t size;
+    };
+
+    /**
+     * The blocks of a single thread; blocks [0, next) are in use, the
+     * remaining ones are retained for reuse.
+     */
+    struct Pool {
+        std::vector<Block> blocks;
+        std::size_t next = 0;
+        char* cursor = nullptr;
+        char* limit = nullptr;
+
+        void reset() {
+            // keep the leading blocks up to the retained size, release the others
+            std::size_t kept = 0;
+            std::size_t total = 0;
+            while (kept < blocks.size() && total + blocks[kept].size <= retainedBytes) {
+                total += blocks[kept++].size;
+            }
+            blocks.resize(kept);
+            next = 0;
+            cursor = limit = nullptr;
+        }
+
+        void* allocate(std::size_t size, std::size_t alignment) {
+            if (void* res = bump(size, alignment)) {
+                return res;
+            }
+
+            // move on to the next retained block that is large enough
+            const std::size_t required = size + alignment;
+            while (next < blocks.size()) {
+                Block& block = blocks[next++];
+                if (block.size >= required) {
+                    cursor = block.data.get();
+                    limit = cursor + block.size;
+                    return bump(size, alignment);
+                }
+            }
+
+            // otherwise allocate a new block, twice as large as the last one
+            std::size_t blockSize = blocks.empty() ? initialBlockSize : blocks.back().size * 2;
+            blockSize = std::max(std::min(blockSize, maxBlockSize), required);
+            blocks.push_back({std::make_unique<char[]>(blockSize), blockSize});
+            next = blocks.size();
+            cursor = blocks.back().data.get();
+            limit = cursor + blockSize;
+            return bump(size, alignment);
+        }
+
+        void* bump(std::size_t size, std::size_t alignment) {
+            if (cursor == nullptr) {
+                return nullptr;
+            }
+            const auto addr = reinterpret_cast<std::uintptr_t>(cursor);
+            char* res = cursor + ((alignment - addr % alignment) % alignment);
+            if (res + size > limit) {
+                return nullptr;
+            }
+            cursor = res + size;
+            return res;
+        }
+    };
+
+    // maps threads to pools
+    ConcurrentLanes lanes;
+
+    // the pools, one per lane
+    std::unique_ptr<Pool[]> pools;
+};
+
+/**
+ * An allocator requesting the nodes of a data structure to be allocated
+ * from a NodeArena owned by the data structure. Data structures which do
+ * not support arenas treat it like std::allocator.
+ */
+template <typename T>
+struct arena_allocator : public std::allocator<T> {
+    template <typename U>
+    struct rebind {
+        using other = arena_allocator<U>;
+    };
+
+    arena_allocator() = default;
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>&) {}
+};
+
+/**
+ * A trait determining whether the given allocator requests the use of a NodeArena.
+ */
+template <typename Allocator>
+struct is_arena_allocator : std::false_type {};
+
+template <typename T>
+struct is_arena_allocator<arena_allocator<T>> : std::true_type {};
+
+}  // namespace souffle
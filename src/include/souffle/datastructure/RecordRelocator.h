@@ -0,0 +1,293 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file RecordRelocator.h
+ *
+ * Copies the records referenced by live values into another record table,
+ * such that records no longer referenced can be released (see
+ * SpecializedRecordTable::compact).
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/utility/json11.h"
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Copies records from a source to a target record table, following the
+ * attribute types of the values referring to them.
+ *
+ * The layout of records and algebraic data types is described by a JSON
+ * object with the "records" and "ADTs" entries of the type information of
+ * IO directives. A value of a record type refers to a record of its fields,
+ * unless it is nil. A value of a non-enumeration ADT refers to a pair of the
+ * branch and its argument, where branches with other than one argument refer
+ * to a record of their arguments. Records of types with "widths" may be
+ * unboxed; they are decoded and encoded again, as their fields may refer to
+ * records.
+ *
+ * Nested records are copied before the records containing them, such that
+ * the copies refer to the copies of the nested records. Records already
+ * copied under the same type are reused, hence shared records remain shared.
+ * The traversal uses an explicit stack, as lists built from records may be
+ * nested arbitrarily deep.
+ *
+ * References held in attributes of other types are not followed; the type
+ * checker hence rejects casts from or to record types when records are
+ * compacted.
+ */
+class RecordRelocator {
+public:
+    /** The identifier of an attribute type */
+    using TypeId = std::size_t;
+
+    RecordRelocator(const RecordTable& source, RecordTable& target, const std::string& types)
+            : source(source), target(target) {
+        std::string parseErrors;
+        typeInfo = json11::Json::parse(types, parseErrors);
+        assert(parseErrors.empty() && "Internal JSON parsing failed.");
+        // values of primitive types are never relocated
+        layouts.push_back(Layout{Kind::Value, {}, {}, {}, {}});
+    }
+
+    /** Return the identifier of the attribute type with the given qualifier, e.g. "r:Pair" */
+    TypeId getType(const std::string& qualifier) {
+        auto pos = typeIds.find(qualifier);
+        if (pos != typeIds.end()) {
+            return pos->second;
+        }
+        if (qualifier.size() < 2 || (qualifier[0] != 'r' && qualifier[0] != '+')) {
+            return typeIds.emplace(qualifier, valueType).first->second;
+        }
+
+        // the type is registered before its fields, which may refer to it
+        const TypeId id = layouts.size();
+        typeIds.emplace(qualifier, id);
+        layouts.emplace_back();
+
+        if (qualifier[0] == 'r') {
+            const auto& recordInfo = typeInfo["records"][qualifier];
+            assert(!recordInfo.is_null() && "Missing record type information");
+            std::vector<TypeId> fields;
+            for (const auto& field : recordInfo["types"].array_items()) {
+                fields.push_back(getType(field.string_value()));
+            }
+            layouts[id] = Layout{Kind::Record, std::move(fields), {}, getWidths(recordInfo), {}};
+            return id;
+        }
+
+        const auto& adtInfo = typeInfo["ADTs"][qualifier];
+        assert(!adtInfo.is_null() && "Missing adt type information");
+        if (adtInfo["enum"].bool_value()) {
+            layouts[id] = Layout{Kind::Value, {}, {}, {}, {}};
+            return id;
+        }
+        std::vector<TypeId> branches;
+        for (const auto& branch : adtInfo["branches"].array_items()) {
+            const auto& branchTypes = branch["types"].array_items();
+            if (branchTypes.size() == 1) {
+                branches.push_back(getType(branchTypes[0].string_value()));
+                continue;
+            }
+            // the arguments of the branch form an anonymous record
+            std::vector<TypeId> fields;
+            for (const auto& field : branchTypes) {
+                fields.push_back(getType(field.string_value()));
+            }
+            branches.push_back(layouts.size());
+            layouts.push_back(Layout{Kind::Record, std::move(fields), {}, getWidths(branch), {}});
+        }
+        layouts[id] = Layout{Kind::Branch, {}, std::move(branches), getWidths(adtInfo), {}};
+        return id;
+    }
+
+    /** Return true if values of the given type refer to records */
+    bool isReference(TypeId type) const {
+        return layouts[type].kind != Kind::Value;
+    }
+
+    /**
+     * Copy the records reachable from the given value of the given type into
+     * the target table, and return the value referring to the copies.
+     */
+    RamDomain relocate(RamDomain value, TypeId type) {
+        if (!isReference(type) || value == 0) {
+            return value;
+        }
+        if (const RamDomain* copy = findCopy(type, value)) {
+            return *copy;
+        }
+
+        RamDomain result = 0;
+        push(type, value);
+        while (!stack.empty()) {
+            Frame& frame = stack.back();
+
+            // copy the nested records first
+            bool nested = false;
+            for (; frame.field < frame.data.size(); ++frame.field) {
+                const TypeId fieldType = getFieldType(frame, frame.field);
+                const RamDomain fieldValue = frame.data[frame.field];
+                if (!isReference(fieldType) || fieldValue == 0) {
+                    continue;
+                }
+                if (const RamDomain* copy = findCopy(fieldType, fieldValue)) {
+                    frame.data[frame.field] = *copy;
+                    continue;
+                }
+                push(fieldType, fieldValue);
+                nested = true;
+                break;
+            }
+            if (nested) {
+                continue;
+            }
+
+            const auto& widths = layouts[frame.type].widths;
+            result = packRecord(target, frame.data.data(), frame.data.size(), widths);
+            layouts[frame.type].copies.emplace(frame.ref, result);
+            ++copied;
+            stack.pop_back();
+            if (!stack.empty()) {
+                Frame& parent = stack.back();
+                parent.data[parent.field++] = result;
+            }
+        }
+        return result;
+    }
+
+    /** Return the number of records copied so far */
+    std::size_t getCopied() const {
+        return copied;
+    }
+
+private:
+    enum class Kind { Value, Record, Branch };
+
+    /** How the values of a type refer to records */
+    struct Layout {
+        Kind kind;
+
+        /** The types of the fields of records */
+        std::vector<TypeId> fields;
+
+        /** The types of the arguments of branches, by branch index */
+        std::vector<TypeId> branches;
+
+        /** The widths of unboxed records */
+        std::vector<unsigned> widths;
+
+        /** The copies of the records referenced by values of this type */
+        std::unordered_map<RamDomain, RamDomain> copies;
+    };
+
+    /** A record being copied, whose fields are relocated in order */
+    struct Frame {
+        TypeId type;
+        RamDomain ref;
+        std::vector<RamDomain> data;
+        std::size_t field;
+    };
+
+    static constexpr TypeId valueType = 0;
+
+    static std::vector<unsigned> getWidths(const json11::Json& info) {
+        std::vector<unsigned> widths;
+        for (const auto& width : info["widths"].array_items()) {
+            widths.push_back(static_cast<unsigned>(width.int_value()));
+        }
+        return widths;
+    }
+
+    void push(TypeId type, RamDomain ref) {
+        const std::size_t arity = getArity(type);
+        RamDomain unboxed[MAX_UNBOXED_ARITY];
+        const RamDomain* data = unpackRecord(source, ref, arity, layouts[type].widths, unboxed);
+        stack.push_back(Frame{type, ref, std::vector<RamDomain>(data, data + arity), 0});
+    }
+
+    std::size_t getArity(TypeId type) const {
+        const Layout& layout = layouts[type];
+        return layout.kind == Kind::Branch ? 2 : layout.fields.size();
+    }
+
+    TypeId getFieldType(const Frame& frame, std::size_t field) const {
+        const Layout& layout = layouts[frame.type];
+        if (layout.kind == Kind::Record) {
+            return layout.fields[field];
+        }
+        if (field == 0) {
+            return valueType;
+        }
+        const auto branch = static_cast<std::size_t>(frame.data[0]);
+        assert(branch < layout.branches.size() && "invalid branch of an algebraic data type");
+        return layout.branches[branch];
+    }
+
+    const RamDomain* findCopy(TypeId type, RamDomain ref) const {
+        const auto& copies = layouts[type].copies;
+        auto pos = copies.find(ref);
+        return pos != copies.end() ? &pos->second : nullptr;
+    }
+
+    const RecordTable& source;
+    RecordTable& target;
+
+    /** The "records" and "ADTs" type information */
+    json11::Json typeInfo;
+
+    std::map<std::string, TypeId> typeIds;
+    std::vector<Layout> layouts;
+
+    std::vector<Frame> stack;
+    std::size_t copied = 0;
+};
+
+/**
+ * Relocate the records referenced by the tuples of a relation of a
+ * synthesised program, whose attributes have the given types. The tuples are
+ * reinserted, as their order may change.
+ */
+template <class Relation>
+void relocateRecords(
+        RecordRelocator& relocator, Relation& relation, const std::vector<std::string>& attributeTypes) {
+    std::vector<std::pair<std::size_t, RecordRelocator::TypeId>> columns;
+    for (std::size_t i = 0; i < attributeTypes.size(); ++i) {
+        const auto type = relocator.getType(attributeTypes[i]);
+        if (relocator.isReference(type)) {
+            columns.emplace_back(i, type);
+        }
+    }
+    if (columns.empty() || relation.size() == 0) {
+        return;
+    }
+
+    std::vector<typename Relation::t_tuple> tuples(relation.begin(), relation.end());
+    relation.purge();
+    for (auto& tuple : tuples) {
+        for (const auto& [column, type] : columns) {
+            tuple[column] = relocator.relocate(tuple[column], type);
+        }
+        relation.insert(tuple);
+    }
+}
+
+}  // namespace souffle
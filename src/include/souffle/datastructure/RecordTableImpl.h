@@ -17,12 +17,15 @@
 #include "souffle/RamTypes.h"
 #include "souffle/RecordTable.h"
 #include "souffle/datastructure/ConcurrentFlyweight.h"
+#include "souffle/datastructure/TableSnapshot.h"
 #include "souffle/utility/span.h"
 
 #include <cassert>
 #include <cstddef>
+#include <functional>
 #include <limits>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -344,6 +347,9 @@ public:
     virtual RamDomain pack(const RamDomain* Tuple) = 0;
     virtual RamDomain pack(const std::initializer_list<RamDomain>& List) = 0;
     virtual const RamDomain* unpack(RamDomain index) const = 0;
+
+    /** @brief call the given function on the reference and the data of each record */
+    virtual void forEach(const std::function<void(RamDomain, const RamDomain*)>& F) const = 0;
 };
 
 /** @brief Bidirectional mappping between records and record references, for any record arity. */
@@ -388,6 +394,15 @@ public:
     const RamDomain* unpack(RamDomain Index) const override {
         return fetch(Index).data();
     }
+
+    void forEach(const std::function<void(RamDomain, const RamDomain*)>& F) const override {
+        for (auto It = Base::begin(); It != Base::end(); ++It) {
+            // the reserved first slot is unassigned
+            if (const auto* Entry = It.operator->()) {
+                F(static_cast<RamDomain>(Entry->second), Entry->first.data());
+            }
+        }
+    }
 };
 
 /** @brief Bidirectional mappping between records and record references, specialized for a record arity. */
@@ -437,6 +452,15 @@ public:
     const RamDomain* unpack(RamDomain Index) const override {
         return Base::fetch(Index).data();
     }
+
+    void forEach(const std::function<void(RamDomain, const RamDomain*)>& F) const override {
+        for (auto It = Base::begin(); It != Base::end(); ++It) {
+            // the reserved first slot is unassigned
+            if (const auto* Entry = It.operator->()) {
+                F(static_cast<RamDomain>(Entry->second), Entry->first.data());
+            }
+        }
+    }
 };
 
 /** Record map specialized for arity 0 */
@@ -479,9 +503,19 @@ public:
         assert(Index == EmptyRecordIndex);
         return EmptyRecordData;
     }
+
+    /** The empty record is not part of snapshots, as its reference is fixed */
+    void forEach(const std::function<void(RamDomain, const RamDomain*)>&) const override {}
 };
 
-/** A concurrent Record Table with some specialized record maps. */
+/**
+ * A concurrent Record Table with some specialized record maps.
+ *
+ * The record table may be based on a snapshot of a previous record table (see
+ * TableSnapshot), whose records keep their references. Records of an arity
+ * that are not part of the snapshot are stored in the record map of that
+ * arity and referenced past the snapshot records of that arity.
+ */
 template <std::size_t... SpecializedArities>
 class SpecializedRecordTable : public RecordTable {
 private:
@@ -494,6 +528,12 @@ private:
     // The concurrency manager.
     mutable ConcurrentLanes Lanes;
 
+    // The snapshot this record table is based on, if any.
+    std::shared_ptr<const TableSnapshot> Snapshot;
+
+    // The records of the snapshot, indexed by arity.
+    std::vector<const TableSnapshot::Records*> SnapshotRecords;
+
     template <std::size_t Arity, std::size_t... Arities>
     void CreateSpecializedMaps() {
         if (Arity >= Size) {
@@ -537,22 +577,131 @@ public:
     /** @brief convert tuple to record reference */
     virtual RamDomain pack(const RamDomain* Tuple, const std::size_t Arity) override {
         auto Guard = Lanes.guard();
+        if (const auto* Records = snapshotRecords(Arity)) {
+            if (const auto Ref = Records->find(Tuple)) {
+                return *Ref;
+            }
+            return lookupMap(Arity).pack(Tuple) + static_cast<RamDomain>(Records->getSlots());
+        }
         return lookupMap(Arity).pack(Tuple);
     }
 
     /** @brief convert tuple to record reference */
     virtual RamDomain pack(const std::initializer_list<RamDomain>& List) override {
-        auto Guard = Lanes.guard();
-        return lookupMap(List.size()).pack(std::data(List));
+        return pack(std::data(List), List.size());
     }
 
     /** @brief convert record reference to a record */
     virtual const RamDomain* unpack(const RamDomain Ref, const std::size_t Arity) const override {
         auto Guard = Lanes.guard();
+        if (const auto* Records = snapshotRecords(Arity)) {
+            const auto Slots = static_cast<RamDomain>(Records->getSlots());
+            if (Ref < Slots) {
+                return Records->unpack(Ref);
+            }
+            return lookupMap(Arity).unpack(Ref - Slots);
+        }
         return lookupMap(Arity).unpack(Ref);
     }
 
+    /**
+     * @brief check that records already present have the reference they have
+     * in the snapshot; otherwise a std::runtime_error is thrown.
+     */
+    void checkSnapshot(const TableSnapshot& NewSnapshot) const override {
+        forEachRecord([&](std::size_t Arity, RamDomain Ref, const RamDomain* Data) {
+            const auto* Records = NewSnapshot.getRecords(Arity);
+            const auto NewRef = Records ? Records->find(Data) : std::nullopt;
+            if (!NewRef || *NewRef != Ref) {
+                throw std::runtime_error("Record table is inconsistent with the snapshot");
+            }
+        });
+    }
+
+    /**
+     * @brief base the record table on the given snapshot.
+     *
+     * @throws std::runtime_error if the snapshot fails checkSnapshot()
+     */
+    void importSnapshot(std::shared_ptr<const TableSnapshot> NewSnapshot) override {
+        checkSnapshot(*NewSnapshot);
+
+        for (auto Map : Maps) {
+            delete Map;
+        }
+        Maps.clear();
+        Size = 0;
+        CreateSpecializedMaps<SpecializedArities...>();
+
+        SnapshotRecords.clear();
+        for (const auto& Records : NewSnapshot->getAllRecords()) {
+            if (Records.getArity() >= SnapshotRecords.size()) {
+                SnapshotRecords.resize(Records.getArity() + 1, nullptr);
+            }
+            SnapshotRecords[Records.getArity()] = &Records;
+        }
+        Snapshot = std::move(NewSnapshot);
+    }
+
+    void exportSnapshot(TableSnapshotWriter& Writer) const override {
+        forEachRecord([&](std::size_t Arity, RamDomain Ref, const RamDomain* Data) {
+            Writer.addRecord(Arity, Ref, Data);
+        });
+    }
+
+    /**
+     * @brief replace the records by the ones the given function packs into an empty table.
+     *
+     * The function is called with this table and the empty table, which is
+     * based on the same snapshot as this one; e.g. it copies the records still
+     * referenced (see RecordRelocator). Afterwards, this table holds the
+     * copied records only. Not thread-safe.
+     */
+    template <typename F>
+    void compact(F&& Copy) {
+        SpecializedRecordTable Target(Lanes.lanes());
+        if (Snapshot) {
+            Target.importSnapshot(Snapshot);
+        }
+        Copy(static_cast<const RecordTable&>(*this), static_cast<RecordTable&>(Target));
+
+        // the target releases the records of this table
+        std::swap(Size, Target.Size);
+        std::swap(Maps, Target.Maps);
+        std::swap(Snapshot, Target.Snapshot);
+        std::swap(SnapshotRecords, Target.SnapshotRecords);
+    }
+
 private:
+    /** @brief lookup the snapshot records of a given arity, or nullptr if there are none. */
+    const TableSnapshot::Records* snapshotRecords(const std::size_t Arity) const {
+        return Arity < SnapshotRecords.size() ? SnapshotRecords[Arity] : nullptr;
+    }
+
+    /** @brief call the given function on the arity, reference and data of each record. */
+    template <typename F>
+    void forEachRecord(F&& Fn) const {
+        for (const auto* Records : SnapshotRecords) {
+            if (Records == nullptr) {
+                continue;
+            }
+            for (RamDomain Ref = 0; static_cast<std::size_t>(Ref) < Records->getSlots(); ++Ref) {
+                if (Records->contains(Ref)) {
+                    Fn(Records->getArity(), Ref, Records->unpack(Ref));
+                }
+            }
+        }
+        for (std::size_t Arity = 0; Arity < Size; ++Arity) {
+            if (Maps[Arity] == nullptr) {
+                continue;
+            }
+            const auto* Records = snapshotRecords(Arity);
+            const auto Offset = static_cast<RamDomain>(Records ? Records->getSlots() : 0);
+            Maps[Arity]->forEach(
+                    [&](RamDomain Ref, const RamDomain* Data) { Fn(Arity, Ref + Offset, Data); });
+        }
+    }
+
     /** @brief lookup RecordMap for a given arity; the map for that arity must exist. */
     RecordMap& lookupMap(const std::size_t Arity) const {
         assert(Arity < Size && "Lookup for an arity while there is no record for that arity.");
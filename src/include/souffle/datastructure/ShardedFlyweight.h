@@ -0,0 +1,518 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ShardedFlyweight.h
+ *
+ * A flyweight whose keys are spread over independent shards, each being a
+ * lock-free, insert-only hash table. Lookups never block, not even while a
+ * shard grows, and are served by a per-thread cache of recent results.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/datastructure/ConcurrentInsertOnlyHashMap.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+
+namespace souffle {
+
+namespace details {
+
+/** Returns the index of the most significant bit set in the given non-zero value. */
+inline std::size_t highestBit(std::uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - static_cast<std::size_t>(__builtin_clzll(value));
+#endif
+}
+
+/**
+ * Returns an identifier distinguishing flyweights in per-thread caches.
+ * Identifiers are never reused, hence entries of destroyed flyweights
+ * cannot be mistaken for entries of new ones.
+ */
+inline std::size_t nextFlyweightId() {
+    static std::atomic<std::size_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace details
+
+/**
+ * A concurrent flyweight assigning a unique index to each inserted key, with
+ * the same interface as FlyweightImpl.
+ *
+ * Keys are distributed over a fixed number of shards by their hash value.
+ * Each shard is an open-addressing table of pointers to immutable entries,
+ * claimed by compare-and-swap. A full table is replaced by a table of twice
+ * the size; the thread growing a shard marks the empty slots of the old table
+ * as moved while copying, such that concurrent operations reaching a moved
+ * slot continue in the new table. Lookups thus never wait, while insertions
+ * into a growing shard only wait if the new table becomes full as well.
+ * Replaced tables are retained until the flyweight is destroyed.
+ *
+ * The index of a key encodes its shard, such that indices are assigned
+ * without a shared counter. Indices are not consecutive: an index reserved by
+ * an insertion that lost a race for the same key remains unused.
+ *
+ * The stored keys are created by the KeyFactory from the inserted ones (see
+ * details::Factory); the factory must support concurrent calls.
+ *
+ * Iterators are not stable under concurrent insertions.
+ */
+template <class Key, class Hash = std::hash<Key>, class KeyEqual = std::equal_to<Key>,
+        class KeyFactory = details::Factory<Key>>
+class ShardedFlyweight {
+public:
+    using index_type = std::size_t;
+    using key_type = Key;
+    using value_type = std::pair<const Key, const index_type>;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+private:
+    static constexpr std::size_t shardBits = 6;
+    static constexpr std::size_t numShards = std::size_t(1) << shardBits;
+
+    // the entries of a shard are indexed by segments of doubling sizes
+    static constexpr std::size_t firstSegmentBits = 6;
+    static constexpr std::size_t numSegments = 64 - firstSegmentBits;
+
+    static constexpr std::size_t initialCapacity = 64;
+
+    // the number of cached lookups per thread
+    static constexpr std::size_t cacheSize = 1024;
+
+    struct Entry {
+        value_type value;
+        std::size_t hash;
+    };
+
+    struct Table {
+        explicit Table(std::size_t capacity)
+                : capacity(capacity), slots(std::make_unique<std::atomic<const Entry*>[]>(capacity)) {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        // the number of slots, a power of two
+        const std::size_t capacity;
+
+        // the slots, each being empty, moved, or pointing to an entry
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+        // the table replacing this one, once this one grows
+        std::atomic<Table*> next{nullptr};
+
+        // the number of occupied slots, and of places held for entries being added
+        std::atomic<std::size_t> size{0};
+
+        // the maximum number of entries before the table is grown (load factor 1/2)
+        std::size_t limit() const {
+            return capacity / 2;
+        }
+    };
+
+    struct alignas(hardware_destructive_interference_size) Shard {
+        // the table receiving new entries
+        std::atomic<Table*> table{nullptr};
+
+        // the number of indices reserved in this shard
+        std::atomic<std::size_t> reserved{0};
+
+        // the entries by their index within the shard
+        std::array<std::atomic<std::atomic<const Entry*>*>, numSegments> segments{};
+
+        // serialises the growth of the table and the allocation of segments
+        std::mutex growLock;
+
+        // the current and all replaced tables
+        std::vector<std::unique_ptr<Table>> tables;
+
+        // entries of insertions that lost a race for their key
+        std::vector<std::unique_ptr<const Entry>> discarded;
+    };
+
+    struct CacheLine {
+        std::size_t owner = 0;
+        const Entry* entry = nullptr;
+    };
+
+public:
+    /**
+     * An iterator over the entries in order of their shard and index,
+     * skipping unused indices.
+     */
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = ShardedFlyweight::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ShardedFlyweight::pointer;
+        using reference = ShardedFlyweight::reference;
+
+        iterator() = default;
+
+        iterator(const ShardedFlyweight* flyweight, std::size_t shard)
+                : flyweight(flyweight), shard(shard) {
+            skip();
+        }
+
+        bool operator==(const iterator& other) const {
+            return shard == other.shard && local == other.local;
+        }
+
+        bool operator!=(const iterator& other) const {
+            return !(*this == other);
+        }
+
+        reference operator*() const {
+            return current->value;
+        }
+
+        pointer operator->() const {
+            return &current->value;
+        }
+
+        iterator& operator++() {
+            ++local;
+            skip();
+            return *this;
+        }
+
+        iterator operator++(int) {
+            auto res = *this;
+            ++(*this);
+            return res;
+        }
+
+    private:
+        /** Move to the next used index, or past the last shard */
+        void skip() {
+            for (; shard < numShards; ++shard, local = 0) {
+                const Shard& cur = flyweight->shards[shard];
+                const std::size_t reserved = cur.reserved.load(std::memory_order_acquire);
+                for (; local < reserved; ++local) {
+                    current = flyweight->lookupIndex(cur, local);
+                    if (current != nullptr) {
+                        return;
+                    }
+                }
+            }
+            local = 0;
+            current = nullptr;
+        }
+
+        const ShardedFlyweight* flyweight = nullptr;
+        std::size_t shard = numShards;
+        std::size_t local = 0;
+        const Entry* current = nullptr;
+    };
+
+    /** Construct a flyweight; the number of lanes is accepted for compatibility with FlyweightImpl. */
+    explicit ShardedFlyweight(std::size_t /* laneCount */ = 1, std::size_t /* initialCapacity */ = 8,
+            const Hash& hash = Hash(), const KeyEqual& keyEqual = KeyEqual())
+            : id(details::nextFlyweightId()), shards(std::make_unique<Shard[]>(numShards)), hasher(hash),
+              equal(keyEqual) {
+        for (std::size_t i = 0; i < numShards; ++i) {
+            shards[i].tables.push_back(std::make_unique<Table>(initialCapacity));
+            shards[i].table.store(shards[i].tables.back().get(), std::memory_order_relaxed);
+        }
+    }
+
+    ShardedFlyweight(const ShardedFlyweight&) = delete;
+    ShardedFlyweight& operator=(const ShardedFlyweight&) = delete;
+
+    ~ShardedFlyweight() {
+        for (std::size_t i = 0; i < numShards; ++i) {
+            Shard& shard = shards[i];
+            const std::size_t reserved = shard.reserved.load(std::memory_order_relaxed);
+            for (std::size_t local = 0; local < reserved; ++local) {
+                delete lookupIndex(shard, local);
+            }
+            for (auto& segment : shard.segments) {
+                delete[] segment.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Shards are independent of the number of threads, hence this is a no-op. */
+    void setNumLanes(std::size_t) {}
+
+    iterator begin() const {
+        return iterator(this, 0);
+    }
+
+    iterator end() const {
+        return iterator(this, numShards);
+    }
+
+    /** Return true if the key is in the flyweight. */
+    bool weakContains(const Key& key) const {
+        return find(key, hasher(key)) != nullptr;
+    }
+
+    /**
+     * Return the key associated with the given index.
+     * Assumption: the index is mapped in the flyweight.
+     */
+    const Key& fetch(const index_type index) const {
+        const Entry* entry = lookupIndex(shards[index & (numShards - 1)], index >> shardBits);
+        assert(entry != nullptr && "index is not mapped");
+        return entry->value.first;
+    }
+
+    /**
+     * Return the pair of the index of the given key and a boolean indicating
+     * whether the key was inserted by this call (true) or already present
+     * (false).
+     */
+    std::pair<index_type, bool> findOrInsert(const Key& key) {
+        const std::size_t hash = hasher(key);
+        if (const Entry* entry = find(key, hash)) {
+            return std::make_pair(entry->value.second, false);
+        }
+
+        const std::size_t shardIndex = hash & (numShards - 1);
+        Shard& shard = shards[shardIndex];
+        const Entry* created = nullptr;
+        Table* table = shard.table.load(std::memory_order_acquire);
+        while (true) {
+            Table* next = nullptr;
+            // whether this insertion holds one of the limit() places of the table
+            bool holdsPlace = false;
+            const std::size_t mask = table->capacity - 1;
+            std::size_t pos = (hash >> shardBits) & mask;
+            for (std::size_t probes = 0; probes < table->capacity; ++probes, pos = (pos + 1) & mask) {
+                const Entry* cur = table->slots[pos].load(std::memory_order_acquire);
+                if (cur == nullptr) {
+                    if (!holdsPlace) {
+                        if (table->size.fetch_add(1, std::memory_order_relaxed) >= table->limit()) {
+                            table->size.fetch_sub(1, std::memory_order_relaxed);
+                            break;
+                        }
+                        holdsPlace = true;
+                    }
+                    if (created == nullptr) {
+                        created = createEntry(shard, shardIndex, key, hash);
+                    }
+                    if (table->slots[pos].compare_exchange_strong(
+                                cur, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        remember(created);
+                        return std::make_pair(created->value.second, true);
+                    }
+                }
+                if (cur == moved()) {
+                    next = table->next.load(std::memory_order_acquire);
+                    break;
+                }
+                if (cur->hash == hash && equal(cur->value.first, key)) {
+                    if (holdsPlace) {
+                        table->size.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    discard(shard, created);
+                    remember(cur);
+                    return std::make_pair(cur->value.second, false);
+                }
+            }
+            if (holdsPlace) {
+                table->size.fetch_sub(1, std::memory_order_relaxed);
+            }
+            table = (next != nullptr) ? next : grow(shard, table);
+        }
+    }
+
+private:
+    /** The marker of slots whose entries are found in the next table. */
+    static const Entry* moved() {
+        static const char marker = 0;
+        return reinterpret_cast<const Entry*>(&marker);
+    }
+
+    /** The cache of recent lookups of the calling thread, shared by all flyweights. */
+    static CacheLine* cache() {
+        static thread_local std::array<CacheLine, cacheSize> lines{};
+        return lines.data();
+    }
+
+    CacheLine& cacheLine(std::size_t hash) const {
+        return cache()[(hash >> shardBits) & (cacheSize - 1)];
+    }
+
+    void remember(const Entry* entry) const {
+        CacheLine& line = cacheLine(entry->hash);
+        line.owner = id;
+        line.entry = entry;
+    }
+
+    /** Locate the entry of the given key, or return nullptr. */
+    const Entry* find(const Key& key, std::size_t hash) const {
+        const CacheLine& line = cacheLine(hash);
+        if (line.owner == id && line.entry->hash == hash && equal(line.entry->value.first, key)) {
+            return line.entry;
+        }
+
+        const Table* table = shards[hash & (numShards - 1)].table.load(std::memory_order_acquire);
+        while (table != nullptr) {
+            const std::size_t mask = table->capacity - 1;
+            std::size_t pos = (hash >> shardBits) & mask;
+            const Table* next = nullptr;
+            for (std::size_t probes = 0; probes < table->capacity; ++probes, pos = (pos + 1) & mask) {
+                const Entry* cur = table->slots[pos].load(std::memory_order_acquire);
+                if (cur == nullptr) {
+                    return nullptr;
+                }
+                if (cur == moved()) {
+                    next = table->next.load(std::memory_order_acquire);
+                    break;
+                }
+                if (cur->hash == hash && equal(cur->value.first, key)) {
+                    remember(cur);
+                    return cur;
+                }
+            }
+            table = next;
+        }
+        return nullptr;
+    }
+
+    /** Reserve an index in the given shard and create the entry of the key under that index. */
+    const Entry* createEntry(Shard& shard, std::size_t shardIndex, const Key& key, std::size_t hash) {
+        const std::size_t local = shard.reserved.fetch_add(1, std::memory_order_acq_rel);
+        Key stored{};
+        factory.replace(stored, key);
+        const auto* entry = new Entry{value_type(std::move(stored), (local << shardBits) | shardIndex), hash};
+        allocateSlot(shard, local).store(entry, std::memory_order_release);
+        return entry;
+    }
+
+    /** Retire the entry of an insertion that found its key inserted concurrently. */
+    void discard(Shard& shard, const Entry* entry) {
+        if (entry == nullptr) {
+            return;
+        }
+        allocateSlot(shard, entry->value.second >> shardBits).store(nullptr, std::memory_order_release);
+        std::lock_guard<std::mutex> guard(shard.growLock);
+        shard.discarded.emplace_back(entry);
+    }
+
+    /** Return the entry of the given index within the shard, or nullptr if it is unused. */
+    static const Entry* lookupIndex(const Shard& shard, std::size_t local) {
+        const std::size_t biased = local + (std::size_t(1) << firstSegmentBits);
+        const std::size_t bit = details::highestBit(biased);
+        const auto* segment = shard.segments[bit - firstSegmentBits].load(std::memory_order_acquire);
+        if (segment == nullptr) {
+            return nullptr;
+        }
+        return segment[biased - (std::size_t(1) << bit)].load(std::memory_order_acquire);
+    }
+
+    /** Return the slot of the given index within the shard, allocating its segment if needed. */
+    static std::atomic<const Entry*>& allocateSlot(Shard& shard, std::size_t local) {
+        const std::size_t biased = local + (std::size_t(1) << firstSegmentBits);
+        const std::size_t bit = details::highestBit(biased);
+        auto& segment = shard.segments[bit - firstSegmentBits];
+        auto* cur = segment.load(std::memory_order_acquire);
+        if (cur == nullptr) {
+            std::lock_guard<std::mutex> guard(shard.growLock);
+            cur = segment.load(std::memory_order_relaxed);
+            if (cur == nullptr) {
+                const std::size_t size = std::size_t(1) << bit;
+                cur = new std::atomic<const Entry*>[size];
+                for (std::size_t i = 0; i < size; ++i) {
+                    cur[i].store(nullptr, std::memory_order_relaxed);
+                }
+                segment.store(cur, std::memory_order_release);
+            }
+        }
+        return cur[biased - (std::size_t(1) << bit)];
+    }
+
+    /**
+     * Replace the given table of the shard by a table of twice the size,
+     * unless it has been replaced already, and return the replacement.
+     */
+    Table* grow(Shard& shard, Table* table) {
+        std::lock_guard<std::mutex> guard(shard.growLock);
+        if (Table* next = table->next.load(std::memory_order_acquire)) {
+            return next;
+        }
+
+        shard.tables.push_back(std::make_unique<Table>(table->capacity * 2));
+        Table* next = shard.tables.back().get();
+        // Insertions hold a place before claiming a slot, hence the old table has at most limit()
+        // entries; their places are taken up front, such that concurrent insertions into the new
+        // table leave room for all of them.
+        const std::size_t pending = table->limit();
+        next->size.store(pending, std::memory_order_relaxed);
+        table->next.store(next, std::memory_order_release);
+
+        // move the entries, marking empty slots such that no entry is added behind the copy
+        std::size_t copied = 0;
+        for (std::size_t i = 0; i < table->capacity; ++i) {
+            const Entry* cur = nullptr;
+            if (!table->slots[i].compare_exchange_strong(
+                        cur, moved(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+                copy(*next, cur);
+                ++copied;
+            }
+        }
+        assert(copied <= pending && "more entries than places in the table");
+        next->size.fetch_sub(pending - copied, std::memory_order_relaxed);
+
+        shard.table.store(next, std::memory_order_release);
+        return next;
+    }
+
+    /** Add an entry, known to be absent, to the given table, in a place held for it. */
+    void copy(Table& table, const Entry* entry) {
+        const std::size_t mask = table.capacity - 1;
+        std::size_t pos = (entry->hash >> shardBits) & mask;
+        for (std::size_t probes = 0; probes < table.capacity; ++probes, pos = (pos + 1) & mask) {
+            const Entry* cur = nullptr;
+            if (table.slots[pos].compare_exchange_strong(
+                        cur, entry, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return;
+            }
+        }
+        fatal("no free slot for a moved entry of a flyweight");
+    }
+
+    // the identifier of this flyweight in per-thread caches
+    const std::size_t id;
+
+    std::unique_ptr<Shard[]> shards;
+
+    Hash hasher;
+    KeyEqual equal;
+    KeyFactory factory;
+};
+
+}  // namespace souffle
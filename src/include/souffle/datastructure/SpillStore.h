@@ -0,0 +1,245 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file SpillStore.h
+ *
+ * Moves relations that are not needed by the next strata out of memory into
+ * files on local disk, and back once they are needed again.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/utility/FileUtil.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#endif
+
+namespace souffle {
+
+/**
+ * The header of a spill file.
+ *
+ * The header is followed by the tuples of the relation, stored row by row in
+ * the order the relation enumerates them, i.e. sorted by its main index. The
+ * tuples are grouped into pages of `pageSize` tuples, the last page holding
+ * the remaining ones, such that a page is written and read at once.
+ */
+struct SpillFileHeader {
+    static constexpr char expectedMagic[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'S'};
+
+    char magic[8];
+    std::uint32_t domainSize;
+    std::uint32_t pageSize;
+    std::uint64_t arity;
+    std::uint64_t size;
+
+    /** Checks whether this header was written by this program for a relation of the given arity */
+    bool isValid(std::size_t expectedArity) const {
+        return std::memcmp(magic, expectedMagic, sizeof(expectedMagic)) == 0 &&
+               domainSize == sizeof(RamDomain) && arity == expectedArity && pageSize > 0;
+    }
+};
+
+/**
+ * A store of spilled relations in a directory on local disk.
+ *
+ * A relation is spilled by writing its tuples to a spill file one page at a
+ * time, and purging it. It is restored by mapping the file into memory and
+ * inserting its pages in order; the tuples are sorted, such that b-tree
+ * relations are rebuilt bottom-up. The store keeps track of the spilled
+ * relations, hence restoring a relation that is held in memory has no effect.
+ *
+ * The relations are either the relations of the interpreter, enumerating
+ * pointers to their tuples, or those of synthesised programs, enumerating
+ * their tuples.
+ */
+class SpillStore {
+public:
+    /** The number of bytes of the tuples of a page */
+    static constexpr std::size_t pageBytes = 1 << 16;
+
+    /** Creates a store in the given directory, or in the directory of temporary files if empty */
+    explicit SpillStore(const std::string& directory)
+            : directory(directory.empty() ? std::filesystem::temp_directory_path().string() : directory) {}
+
+    SpillStore(const SpillStore&) = delete;
+    SpillStore& operator=(const SpillStore&) = delete;
+
+    ~SpillStore() {
+        for (const auto& entry : spilled) {
+            std::remove(entry.second.c_str());
+        }
+    }
+
+    /** Whether the relation of the given name is spilled */
+    bool isSpilled(const std::string& name) const {
+        return spilled.count(name) > 0;
+    }
+
+    /**
+     * Writes the tuples of the relation to its spill file and purges the
+     * relation. Empty relations are not spilled.
+     */
+    template <class Relation>
+    void spill(const std::string& name, Relation& relation, std::size_t arity) {
+        if (relation.size() == 0 || arity == 0 || isSpilled(name)) {
+            return;
+        }
+        const std::string fileName = getFileName(name);
+        std::ofstream file(fileName, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open spill file " + fileName);
+        }
+
+        SpillFileHeader header;
+        std::memcpy(header.magic, SpillFileHeader::expectedMagic, sizeof(header.magic));
+        header.domainSize = sizeof(RamDomain);
+        header.pageSize = static_cast<std::uint32_t>(getPageSize(arity));
+        header.arity = arity;
+        header.size = relation.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+        std::vector<RamDomain> page;
+        page.reserve(header.pageSize * arity);
+        auto flush = [&]() {
+            file.write(reinterpret_cast<const char*>(page.data()),
+                    static_cast<std::streamsize>(page.size() * sizeof(RamDomain)));
+            page.clear();
+        };
+        for (const auto& tuple : relation) {
+            const RamDomain* data = getData(tuple);
+            page.insert(page.end(), data, data + arity);
+            if (page.size() == header.pageSize * arity) {
+                flush();
+            }
+        }
+        flush();
+        file.close();
+        if (!file) {
+            std::remove(fileName.c_str());
+            throw std::runtime_error("Cannot write spill file " + fileName);
+        }
+
+        relation.purge();
+        spilled[name] = fileName;
+    }
+
+    /**
+     * Inserts the tuples of the spill file of the relation back into it, if
+     * the relation is spilled, and removes the spill file.
+     */
+    template <class Relation>
+    void restore(const std::string& name, Relation& relation, std::size_t arity) {
+        auto it = spilled.find(name);
+        if (it == spilled.end()) {
+            return;
+        }
+        const std::string fileName = it->second;
+        spilled.erase(it);
+        {
+            const MappedFile file(fileName);
+            SpillFileHeader header;
+            if (!file.is_open() || file.size() < sizeof(header)) {
+                throw std::runtime_error("Cannot read spill file " + fileName);
+            }
+            std::memcpy(&header, file.data(), sizeof(header));
+            const std::size_t size = static_cast<std::size_t>(header.size);
+            if (!header.isValid(arity) ||
+                    (file.size() - sizeof(header)) / sizeof(RamDomain) < size * arity) {
+                throw std::runtime_error("Invalid spill file " + fileName);
+            }
+
+            // the file is mapped with the alignment of pages, hence the tuples following the
+            // header are aligned as well
+            const auto* tuples = reinterpret_cast<const RamDomain*>(file.data() + sizeof(header));
+            for (std::size_t first = 0; first < size; first += header.pageSize) {
+                const std::size_t count = std::min<std::size_t>(header.pageSize, size - first);
+                insertPage(relation, tuples + first * arity, count, arity);
+            }
+        }
+        std::remove(fileName.c_str());
+    }
+
+private:
+    /**
+     * Determines whether a relation accepts batches of tuples through
+     * insertBatch(const RamDomain* data, std::size_t count).
+     */
+    template <typename T, typename = void>
+    struct supports_batch_insert : std::false_type {};
+
+    template <typename T>
+    struct supports_batch_insert<T, std::void_t<decltype(std::declval<T&>().insertBatch(
+                                            std::declval<const RamDomain*>(), std::size_t()))>>
+            : std::true_type {};
+
+    template <class Relation>
+    static void insertPage(Relation& relation, const RamDomain* data, std::size_t count, std::size_t arity) {
+        if constexpr (supports_batch_insert<Relation>::value) {
+            relation.insertBatch(data, count);
+        } else {
+            for (std::size_t i = 0; i < count; ++i) {
+                relation.insert(data + i * arity);
+            }
+        }
+    }
+
+    static const RamDomain* getData(const RamDomain* tuple) {
+        return tuple;
+    }
+
+    template <class Tuple>
+    static const RamDomain* getData(const Tuple& tuple) {
+        return tuple.data();
+    }
+
+    static std::size_t getPageSize(std::size_t arity) {
+        return std::max<std::size_t>(1, pageBytes / (arity * sizeof(RamDomain)));
+    }
+
+    /** Returns the name of the spill file of a relation, unique to this process */
+    std::string getFileName(const std::string& name) {
+        auto res = fileIds.emplace(name, fileIds.size());
+#ifdef _WIN32
+        const auto pid = _getpid();
+#else
+        const auto pid = ::getpid();
+#endif
+        return directory + pathSeparator + "souffle-" + std::to_string(pid) + "-" +
+               std::to_string(res.first->second) + ".spill";
+    }
+
+    /** The directory of the spill files */
+    const std::string directory;
+
+    /** The spill files of the spilled relations */
+    std::map<std::string, std::string> spilled;
+
+    /** The number of the spill file of each relation spilled so far */
+    std::map<std::string, std::size_t> fileIds;
+};
+
+}  // namespace souffle
@@ -0,0 +1,256 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file StringArena.h
+ *
+ * Append-only storage of strings in large contiguous chunks, and a
+ * flyweight of strings kept in such storage.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/datastructure/ShardedFlyweight.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Append-only storage of strings.
+ *
+ * The characters of appended strings are placed back to back in chunks of
+ * chunkSize bytes, which are claimed by an atomic bump pointer; strings
+ * larger than a quarter of a chunk obtain a chunk of their own. Appended
+ * strings remain valid until the arena is destroyed.
+ */
+class StringArena {
+public:
+    static constexpr std::size_t chunkSize = std::size_t(1) << 20;
+
+    StringArena() {
+        addChunk(chunkSize);
+    }
+
+    StringArena(const StringArena&) = delete;
+    StringArena& operator=(const StringArena&) = delete;
+
+    /** Copy the given string into the arena; may be invoked concurrently. */
+    std::string_view append(std::string_view value) {
+        const std::size_t length = value.size();
+        if (length > chunkSize / 4) {
+            std::lock_guard<std::mutex> guard(chunkLock);
+            chunks.push_back(std::make_unique<Chunk>(length));
+            return copy(*chunks.back(), 0, value);
+        }
+        while (true) {
+            Chunk* chunk = current.load(std::memory_order_acquire);
+            const std::size_t offset = chunk->used.fetch_add(length, std::memory_order_relaxed);
+            if (offset + length <= chunk->capacity) {
+                return copy(*chunk, offset, value);
+            }
+            std::lock_guard<std::mutex> guard(chunkLock);
+            if (current.load(std::memory_order_relaxed) == chunk) {
+                addChunk(chunkSize);
+            }
+        }
+    }
+
+    /** Store the given string in the arena and refer to it; the factory interface of flyweights. */
+    std::string_view& replace(std::string_view& place, std::string_view value) {
+        place = append(value);
+        return place;
+    }
+
+    /** Return the number of bytes reserved by the arena. */
+    std::size_t getReservedBytes() const {
+        std::lock_guard<std::mutex> guard(chunkLock);
+        std::size_t bytes = 0;
+        for (const auto& chunk : chunks) {
+            bytes += chunk->capacity;
+        }
+        return bytes;
+    }
+
+private:
+    struct Chunk {
+        explicit Chunk(std::size_t capacity)
+                : capacity(capacity), data(std::make_unique<char[]>(capacity)), used(0) {}
+
+        const std::size_t capacity;
+        std::unique_ptr<char[]> data;
+        std::atomic<std::size_t> used;
+    };
+
+    static std::string_view copy(Chunk& chunk, std::size_t offset, std::string_view value) {
+        char* target = chunk.data.get() + offset;
+        if (!value.empty()) {
+            std::memcpy(target, value.data(), value.size());
+        }
+        return std::string_view(target, value.size());
+    }
+
+    void addChunk(std::size_t capacity) {
+        chunks.push_back(std::make_unique<Chunk>(capacity));
+        current.store(chunks.back().get(), std::memory_order_release);
+    }
+
+    // the chunk receiving small strings
+    std::atomic<Chunk*> current{nullptr};
+
+    // serialises the allocation of chunks
+    mutable std::mutex chunkLock;
+
+    std::vector<std::unique_ptr<Chunk>> chunks;
+};
+
+/**
+ * A concurrent flyweight of strings whose characters are kept in a
+ * StringArena, rather than in separately allocated std::string objects.
+ *
+ * Strings are looked up through a ShardedFlyweight of views into the arena
+ * and are best accessed through view(). For the sake of interfaces returning
+ * references to std::string, fetch() materializes the requested strings on
+ * demand; materialized strings are retained until the flyweight is destroyed.
+ */
+class ArenaFlyweight {
+    using Base = ShardedFlyweight<std::string_view, std::hash<std::string_view>,
+            std::equal_to<std::string_view>, StringArena>;
+
+public:
+    using index_type = Base::index_type;
+    using key_type = Base::key_type;
+    using value_type = Base::value_type;
+    using iterator = Base::iterator;
+
+    explicit ArenaFlyweight(std::size_t laneCount = 1, std::size_t initialCapacity = 8)
+            : symbols(laneCount, initialCapacity) {}
+
+    ArenaFlyweight(const ArenaFlyweight&) = delete;
+    ArenaFlyweight& operator=(const ArenaFlyweight&) = delete;
+
+    ~ArenaFlyweight() {
+        for (std::size_t i = 0; i < numSegments; ++i) {
+            auto* segment = materialized[i].load(std::memory_order_relaxed);
+            if (segment == nullptr) {
+                continue;
+            }
+            for (std::size_t j = 0, size = segmentSize(i); j < size; ++j) {
+                auto* chunk = segment[j].load(std::memory_order_relaxed);
+                if (chunk == nullptr) {
+                    continue;
+                }
+                for (std::size_t k = 0; k < chunkSize; ++k) {
+                    delete chunk[k].load(std::memory_order_relaxed);
+                }
+                delete[] chunk;
+            }
+            delete[] segment;
+        }
+    }
+
+    /** Arenas are independent of the number of threads, hence this is a no-op. */
+    void setNumLanes(std::size_t) {}
+
+    iterator begin() const {
+        return symbols.begin();
+    }
+
+    iterator end() const {
+        return symbols.end();
+    }
+
+    bool weakContains(std::string_view symbol) const {
+        return symbols.weakContains(symbol);
+    }
+
+    std::pair<index_type, bool> findOrInsert(std::string_view symbol) {
+        return symbols.findOrInsert(symbol);
+    }
+
+    /** Return the characters of the string with the given index. */
+    std::string_view view(const index_type index) const {
+        return symbols.fetch(index);
+    }
+
+    /** Return the string with the given index, materializing it if necessary. */
+    const std::string& fetch(const index_type index) const {
+        const std::size_t position = static_cast<std::size_t>(index);
+        auto* chunk = getChunk(position / chunkSize);
+        auto& slot = chunk[position % chunkSize];
+        const std::string* string = slot.load(std::memory_order_acquire);
+        if (string == nullptr) {
+            const auto* fresh = new std::string(view(index));
+            if (slot.compare_exchange_strong(
+                        string, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                string = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return *string;
+    }
+
+private:
+    using Slot = std::atomic<const std::string*>;
+
+    // materialized strings are kept in chunks of a fixed number of slots, allocated once a string
+    // of the chunk is fetched; the chunks are indexed by segments of doubling sizes
+    static constexpr std::size_t chunkSize = 1024;
+    static constexpr std::size_t firstSegmentBits = 4;
+    static constexpr std::size_t numSegments = 64 - firstSegmentBits;
+
+    static std::size_t segmentSize(std::size_t segment) {
+        return std::size_t(1) << (segment + firstSegmentBits);
+    }
+
+    /** Return the chunk of slots with the given index, allocating it if necessary. */
+    Slot* getChunk(std::size_t chunkIndex) const {
+        const std::size_t biased = chunkIndex + (std::size_t(1) << firstSegmentBits);
+        const std::size_t bit = details::highestBit(biased);
+        const std::size_t segmentIndex = bit - firstSegmentBits;
+        auto* segment = getOrAllocate(materialized[segmentIndex], segmentSize(segmentIndex));
+        return getOrAllocate(segment[biased - (std::size_t(1) << bit)], chunkSize);
+    }
+
+    /** Return the array of null pointers at the given place, allocating it if necessary. */
+    template <typename T>
+    static std::atomic<T*>* getOrAllocate(std::atomic<std::atomic<T*>*>& place, std::size_t size) {
+        auto* array = place.load(std::memory_order_acquire);
+        if (array == nullptr) {
+            auto* fresh = new std::atomic<T*>[size];
+            for (std::size_t i = 0; i < size; ++i) {
+                fresh[i].store(nullptr, std::memory_order_relaxed);
+            }
+            if (place.compare_exchange_strong(
+                        array, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                array = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        return array;
+    }
+
+    Base symbols;
+
+    mutable std::array<std::atomic<std::atomic<Slot*>*>, numSegments> materialized{};
+};
+
+}  // namespace souffle
@@ -9,13 +9,16 @@
 /**
  * @file SymbolTableImpl.h
  *
- * SymbolTable definition
+ * SymbolTable definitions
  */
 
 #pragma once
 
 #include "souffle/SymbolTable.h"
 #include "souffle/datastructure/ConcurrentFlyweight.h"
+#include "souffle/datastructure/ShardedFlyweight.h"
+#include "souffle/datastructure/StringArena.h"
+#include "souffle/datastructure/TableSnapshot.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StreamUtil.h"
@@ -26,54 +29,125 @@
 #include <initializer_list>
 #include <iostream>
 #include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace souffle {
 
+namespace details {
+
+/** The flyweight of symbol tables with concurrent access lanes */
+class LaneSymbolFlyweight : public FlyweightImpl<std::string> {
+public:
+    using key_type = std::string;
+    using FlyweightImpl<std::string>::FlyweightImpl;
+    using FlyweightImpl<std::string>::Base::setNumLanes;
+};
+
+}  // namespace details
+
 /**
- * @class SymbolTableImpl
+ * @class BasicSymbolTable
+ *
+ * Implementation of the symbol table on top of a flyweight.
  *
- * Implementation of the symbol table.
+ * The symbol table may be based on a snapshot of a previous symbol table (see
+ * TableSnapshot), whose symbols keep their indices. Symbols that are not part
+ * of the snapshot are stored in an overlay and indexed past the snapshot.
  */
-class SymbolTableImpl : public SymbolTable, protected FlyweightImpl<std::string> {
+template <class Flyweight>
+class BasicSymbolTable : public SymbolTable {
 private:
-    using Base = FlyweightImpl<std::string>;
+    /** The flyweight holding the symbols that are not part of the snapshot */
+    using Overlay = Flyweight;
+
+    /** Whether the overlay stores its symbols as std::string, which can then be referenced directly */
+    static constexpr bool StoresStrings = std::is_same_v<typename Overlay::key_type, std::string>;
 
 public:
-    class IteratorImpl : public SymbolTableIteratorInterface, private Base::iterator {
+    class IteratorImpl : public SymbolTableIteratorInterface {
     public:
-        IteratorImpl(Base::iterator&& it) : Base::iterator(it) {}
+        /** Iterator on the first symbol */
+        IteratorImpl(const BasicSymbolTable& Table) : Table(Table), Snapshot(0), It(Table.Symbols->begin()) {
+            while (Snapshot < snapshotSlots() && !Table.Snapshot->containsSymbol(Snapshot)) {
+                ++Snapshot;
+            }
+            update();
+        }
+
+        /** Iterator past the last symbol */
+        IteratorImpl(const BasicSymbolTable& Table, const typename Overlay::iterator& It)
+                : Table(Table), Snapshot(snapshotSlots()), It(It) {}
 
-        IteratorImpl(const Base::iterator& it) : Base::iterator(it) {}
+        IteratorImpl(const IteratorImpl& Other)
+                : Table(Other.Table), Snapshot(Other.Snapshot), It(Other.It), Current(Other.Current) {}
 
         const std::pair<const std::string, const std::size_t>& get() const {
-            return **this;
+            if constexpr (StoresStrings) {
+                if (!Current) {
+                    return *It;
+                }
+            }
+            return *Current;
         }
 
         bool equals(const SymbolTableIteratorInterface& other) {
-            return (*this) == static_cast<const IteratorImpl&>(other);
+            const auto& That = static_cast<const IteratorImpl&>(other);
+            return Snapshot == That.Snapshot && It == That.It;
         }
 
         SymbolTableIteratorInterface& incr() {
-            ++(*this);
+            if (Snapshot < snapshotSlots()) {
+                do {
+                    ++Snapshot;
+                } while (Snapshot < snapshotSlots() && !Table.Snapshot->containsSymbol(Snapshot));
+            } else {
+                ++It;
+            }
+            update();
             return *this;
         }
 
         std::unique_ptr<SymbolTableIteratorInterface> copy() const {
             return std::make_unique<IteratorImpl>(*this);
         }
+
+    private:
+        RamDomain snapshotSlots() const {
+            return static_cast<RamDomain>(Table.Offset);
+        }
+
+        /** Materialize the current entry unless it can be referenced directly */
+        void update() {
+            Current.reset();
+            if (Snapshot < snapshotSlots()) {
+                Current.emplace(Table.Snapshot->decodeSymbol(Snapshot), Snapshot);
+            } else if ((Table.Offset != 0 || !StoresStrings) && It != Table.Symbols->end()) {
+                Current.emplace(std::string(It->first), It->second + Table.Offset);
+            }
+        }
+
+        const BasicSymbolTable& Table;
+        RamDomain Snapshot;
+        typename Overlay::iterator It;
+        std::optional<std::pair<const std::string, const std::size_t>> Current;
     };
 
     using iterator = SymbolTable::Iterator;
 
     /** @brief Construct a symbol table with the given number of concurrent access lanes. */
-    SymbolTableImpl(const std::size_t LaneCount = 1) : Base(LaneCount) {}
+    BasicSymbolTable(const std::size_t LaneCount = 1)
+            : Lanes(LaneCount), Symbols(std::make_unique<Overlay>(LaneCount)) {}
 
     /** @brief Construct a symbol table with the given initial symbols. */
-    SymbolTableImpl(std::initializer_list<std::string> symbols) : Base(1, symbols.size()) {
+    BasicSymbolTable(std::initializer_list<std::string> symbols)
+            : Lanes(1), Symbols(std::make_unique<Overlay>(1, symbols.size())) {
         for (const auto& symbol : symbols) {
             findOrInsert(symbol);
         }
@@ -81,8 +155,8 @@ public:
 
     /** @brief Construct a symbol table with the given number of concurrent access lanes and initial symbols.
      */
-    SymbolTableImpl(const std::size_t LaneCount, std::initializer_list<std::string> symbols)
-            : Base(LaneCount, symbols.size()) {
+    BasicSymbolTable(const std::size_t LaneCount, std::initializer_list<std::string> symbols)
+            : Lanes(LaneCount), Symbols(std::make_unique<Overlay>(LaneCount, symbols.size())) {
         for (const auto& symbol : symbols) {
             findOrInsert(symbol);
         }
@@ -93,27 +167,42 @@ public:
      * This function is not thread-safe, do not call when other threads are using the datastructure.
      */
     void setNumLanes(const std::size_t NumLanes) {
-        Base::setNumLanes(NumLanes);
+        Lanes = NumLanes;
+        Symbols->setNumLanes(NumLanes);
     }
 
     iterator begin() const override {
-        return SymbolTable::Iterator(std::make_unique<IteratorImpl>(Base::begin()));
+        return SymbolTable::Iterator(std::make_unique<IteratorImpl>(*this));
     }
 
     iterator end() const override {
-        return SymbolTable::Iterator(std::make_unique<IteratorImpl>(Base::end()));
+        return SymbolTable::Iterator(std::make_unique<IteratorImpl>(*this, Symbols->end()));
     }
 
     bool weakContains(const std::string& symbol) const override {
-        return Base::weakContains(symbol);
+        return (Snapshot && Snapshot->findSymbol(symbol)) || Symbols->weakContains(symbol);
     }
 
     RamDomain encode(const std::string& symbol) override {
-        return Base::findOrInsert(symbol).first;
+        return findOrInsert(symbol).first;
     }
 
     const std::string& decode(const RamDomain index) const override {
-        return Base::fetch(index);
+        if (static_cast<std::size_t>(index) < Offset) {
+            return Snapshot->decodeSymbol(index);
+        }
+        return Symbols->fetch(index - static_cast<RamDomain>(Offset));
+    }
+
+    std::string_view decodeView(const RamDomain index) const override {
+        if (static_cast<std::size_t>(index) < Offset) {
+            return Snapshot->getSymbol(index);
+        }
+        if constexpr (StoresStrings) {
+            return Symbols->fetch(index - static_cast<RamDomain>(Offset));
+        } else {
+            return Symbols->view(index - static_cast<RamDomain>(Offset));
+        }
     }
 
     RamDomain unsafeEncode(const std::string& symbol) override {
@@ -125,9 +214,80 @@ public:
     }
 
     std::pair<RamDomain, bool> findOrInsert(const std::string& symbol) override {
-        auto Res = Base::findOrInsert(symbol);
-        return std::make_pair(static_cast<RamDomain>(Res.first), Res.second);
+        if (Snapshot) {
+            if (const auto Index = Snapshot->findSymbol(symbol)) {
+                return std::make_pair(*Index, false);
+            }
+        }
+        auto Res = Symbols->findOrInsert(symbol);
+        return std::make_pair(static_cast<RamDomain>(Res.first + Offset), Res.second);
     }
+
+    /**
+     * @brief Check that symbols already present have the index they have in
+     * the snapshot, e.g. because they were encoded in the same order in both
+     * runs; otherwise a std::runtime_error is thrown.
+     */
+    void checkSnapshot(const TableSnapshot& NewSnapshot) const override {
+        for (auto It = begin(); It != end(); ++It) {
+            const auto Index = NewSnapshot.findSymbol(It->first);
+            if (!Index || static_cast<std::size_t>(*Index) != It->second) {
+                throw std::runtime_error("Symbol table is inconsistent with the snapshot: " + It->first);
+            }
+        }
+    }
+
+    /**
+     * @brief Base the symbol table on the given snapshot.
+     *
+     * @throws std::runtime_error if the snapshot fails checkSnapshot()
+     */
+    void importSnapshot(std::shared_ptr<const TableSnapshot> NewSnapshot) override {
+        checkSnapshot(*NewSnapshot);
+        Symbols = std::make_unique<Overlay>(Lanes);
+        Offset = NewSnapshot->getSymbolSlots();
+        Snapshot = std::move(NewSnapshot);
+    }
+
+    void exportSnapshot(TableSnapshotWriter& Writer) const override {
+        for (RamDomain Index = 0; static_cast<std::size_t>(Index) < Offset; ++Index) {
+            if (Snapshot->containsSymbol(Index)) {
+                Writer.addSymbol(Index, Snapshot->getSymbol(Index));
+            }
+        }
+        for (auto It = Symbols->begin(); It != Symbols->end(); ++It) {
+            Writer.addSymbol(static_cast<RamDomain>(It->second + Offset), It->first);
+        }
+    }
+
+private:
+    /** The number of concurrent access lanes */
+    std::size_t Lanes;
+
+    /** The snapshot this symbol table is based on, if any */
+    std::shared_ptr<const TableSnapshot> Snapshot;
+
+    /** The number of indices covered by the snapshot */
+    std::size_t Offset = 0;
+
+    /** The symbols that are not part of the snapshot */
+    std::unique_ptr<Overlay> Symbols;
 };
 
+/** The symbol table, whose concurrent accesses are organised in lanes. */
+using SymbolTableImpl = BasicSymbolTable<details::LaneSymbolFlyweight>;
+
+/**
+ * A symbol table for programs encoding symbols from many threads at once,
+ * based on a sharded, lock-free flyweight (see ShardedFlyweight).
+ */
+using ShardedSymbolTable = BasicSymbolTable<ShardedFlyweight<std::string>>;
+
+/**
+ * A symbol table keeping the characters of its symbols back to back in
+ * append-only arenas (see ArenaFlyweight), which saves the allocation of a
+ * std::string per symbol. Symbols are best accessed through decodeView.
+ */
+using ArenaSymbolTable = BasicSymbolTable<ArenaFlyweight>;
+
 }  // namespace souffle
@@ -0,0 +1,510 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file TableSnapshot.h
+ *
+ * Persistent snapshots of the symbol and record tables, allowing a program
+ * to start from the tables of a previous run.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/utility/FileUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace souffle {
+
+namespace details {
+
+/**
+ * FNV-1a hash of the given bytes; unlike std::hash, it is stable across programs. Bytes are hashed
+ * in several parts by passing the hash of the previous parts.
+ */
+inline std::uint64_t snapshotHash(
+        const void* data, std::size_t size, std::uint64_t hash = 0xcbf29ce484222325ULL) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/** The number of buckets of a hash index for the given number of entries, a power of two */
+inline std::size_t snapshotBuckets(std::size_t entries) {
+    std::size_t buckets = 1;
+    while (buckets < 2 * entries) {
+        buckets <<= 1;
+    }
+    return buckets;
+}
+
+inline bool isPowerOfTwo(std::size_t value) {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+inline std::size_t snapshotAlign(std::size_t size) {
+    return (size + 7) & ~std::size_t(7);
+}
+
+}  // namespace details
+
+/**
+ * A snapshot of a symbol table and a record table, stored in a file which is
+ * mapped into memory read-only.
+ *
+ * Symbols and records keep the indices they had when the snapshot was taken,
+ * hence data persisted along with the snapshot remains valid. Lookups probe
+ * the hash indexes stored in the file and compare against the mapped data in
+ * place, and records are unpacked straight from the mapping. Only decoding a
+ * symbol requires a std::string, which is created on first use and cached.
+ *
+ * The file holds, in host byte order and aligned to 8 bytes:
+ *  - the header,
+ *  - the symbols: offsets[slots + 1], buckets[symbolBuckets], present[slots],
+ *    and the characters of all symbols,
+ *  - for each record arity: a section header, records[slots * arity],
+ *    buckets[buckets] and present[slots].
+ * Buckets hold the index of an entry plus one, or zero if they are unused.
+ */
+class TableSnapshot {
+public:
+    struct Header {
+        static constexpr char expectedMagic[8] = {'S', 'O', 'U', 'F', 'S', 'N', 'A', 'P'};
+        static constexpr std::uint32_t expectedByteOrder = 0x01020304;
+
+        char magic[8];
+        std::uint32_t byteOrder;
+        std::uint32_t domainSize;
+        std::uint64_t symbolSlots;
+        std::uint64_t symbolBytes;
+        std::uint64_t symbolBuckets;
+        std::uint64_t recordSections;
+    };
+
+    struct SectionHeader {
+        std::uint64_t arity;
+        std::uint64_t slots;
+        std::uint64_t buckets;
+    };
+
+    /** The records of a single arity */
+    class Records {
+    public:
+        std::size_t getArity() const {
+            return arity;
+        }
+
+        /** Obtains the number of indices covered by this snapshot */
+        std::size_t getSlots() const {
+            return slots;
+        }
+
+        bool contains(RamDomain index) const {
+            const auto i = static_cast<std::size_t>(index);
+            return i < slots && present[i] != 0;
+        }
+
+        const RamDomain* unpack(RamDomain index) const {
+            return records + static_cast<std::size_t>(index) * arity;
+        }
+
+        std::optional<RamDomain> find(const RamDomain* record) const {
+            const std::size_t length = arity * sizeof(RamDomain);
+            const std::size_t mask = buckets - 1;
+            for (std::size_t b = details::snapshotHash(record, length) & mask;; b = (b + 1) & mask) {
+                if (index[b] == 0) {
+                    return std::nullopt;
+                }
+                const auto candidate = static_cast<RamDomain>(index[b] - 1);
+                if (std::memcmp(unpack(candidate), record, length) == 0) {
+                    return candidate;
+                }
+            }
+        }
+
+    private:
+        friend class TableSnapshot;
+
+        std::size_t arity = 0;
+        std::size_t slots = 0;
+        std::size_t buckets = 0;
+        const RamDomain* records = nullptr;
+        const std::uint64_t* index = nullptr;
+        const std::uint8_t* present = nullptr;
+    };
+
+    /**
+     * Opens the snapshot stored in the given file.
+     *
+     * @throws std::runtime_error if the file cannot be read or was written
+     * by an incompatible program
+     */
+    static std::shared_ptr<const TableSnapshot> open(const std::string& fileName) {
+        return std::shared_ptr<const TableSnapshot>(new TableSnapshot(fileName));
+    }
+
+    TableSnapshot(const TableSnapshot&) = delete;
+    TableSnapshot& operator=(const TableSnapshot&) = delete;
+
+    ~TableSnapshot() {
+        for (std::size_t i = 0; i < decodeBlocks; ++i) {
+            if (auto* block = decoded[i].load(std::memory_order_relaxed)) {
+                for (std::size_t j = 0; j < decodeBlockSize; ++j) {
+                    delete block[j].load(std::memory_order_relaxed);
+                }
+                delete[] block;
+            }
+        }
+    }
+
+    /** Obtains the number of symbol indices covered by this snapshot */
+    std::size_t getSymbolSlots() const {
+        return symbolSlots;
+    }
+
+    bool containsSymbol(RamDomain index) const {
+        const auto i = static_cast<std::size_t>(index);
+        return i < symbolSlots && symbolPresent[i] != 0;
+    }
+
+    /** Obtains a view of the given symbol within the mapped file */
+    std::string_view getSymbol(RamDomain index) const {
+        const auto i = static_cast<std::size_t>(index);
+        const auto length = static_cast<std::size_t>(symbolOffsets[i + 1] - symbolOffsets[i]);
+        return std::string_view(symbolChars + symbolOffsets[i], length);
+    }
+
+    std::optional<RamDomain> findSymbol(std::string_view symbol) const {
+        const std::size_t mask = symbolBuckets - 1;
+        for (std::size_t b = details::snapshotHash(symbol.data(), symbol.size()) & mask;;
+                b = (b + 1) & mask) {
+            if (symbolIndex[b] == 0) {
+                return std::nullopt;
+            }
+            const auto candidate = static_cast<RamDomain>(symbolIndex[b] - 1);
+            if (getSymbol(candidate) == symbol) {
+                return candidate;
+            }
+        }
+    }
+
+    /**
+     * Decodes the given symbol into a string, which is created on first use.
+     * This operation may be invoked concurrently.
+     */
+    const std::string& decodeSymbol(RamDomain index) const {
+        const auto i = static_cast<std::size_t>(index);
+        auto& blockRef = decoded[i / decodeBlockSize];
+        auto* block = blockRef.load(std::memory_order_acquire);
+        if (block == nullptr) {
+            auto* fresh = new std::atomic<const std::string*>[decodeBlockSize]();
+            if (blockRef.compare_exchange_strong(block, fresh, std::memory_order_acq_rel)) {
+                block = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        auto& slot = block[i % decodeBlockSize];
+        const std::string* str = slot.load(std::memory_order_acquire);
+        if (str == nullptr) {
+            const auto* fresh = new std::string(getSymbol(index));
+            if (slot.compare_exchange_strong(str, fresh, std::memory_order_acq_rel)) {
+                str = fresh;
+            } else {
+                delete fresh;
+            }
+        }
+        return *str;
+    }
+
+    /** Obtains the records of the given arity, or nullptr if there are none */
+    const Records* getRecords(std::size_t arity) const {
+        for (const auto& section : recordSections) {
+            if (section.arity == arity) {
+                return &section;
+            }
+        }
+        return nullptr;
+    }
+
+    const std::vector<Records>& getAllRecords() const {
+        return recordSections;
+    }
+
+private:
+    static constexpr std::size_t decodeBlockSize = std::size_t(1) << 12;
+
+    template <typename T>
+    static const T* as(const char* data) {
+        return reinterpret_cast<const T*>(data);
+    }
+
+    explicit TableSnapshot(const std::string& fileName) : file(fileName) {
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open table snapshot " + fileName);
+        }
+        const char* pos = file.data();
+        const char* end = pos + file.size();
+        auto invalid = [&]() { return std::runtime_error("Invalid table snapshot " + fileName); };
+        auto take = [&](std::uint64_t count, std::size_t elementSize) {
+            const auto available = static_cast<std::size_t>(end - pos);
+            if (count > available / elementSize) {
+                throw invalid();
+            }
+            const auto size = static_cast<std::size_t>(count) * elementSize;
+            const char* res = pos;
+            // sections are padded to 8 bytes, except for the last one
+            pos += std::min(details::snapshotAlign(size), available);
+            return res;
+        };
+        // each bucket refers to an entry or is unused, and at least one is unused to end probing
+        auto checkBuckets = [&](const std::uint64_t* buckets, std::size_t count, std::size_t entries) {
+            if (!details::isPowerOfTwo(count)) {
+                throw invalid();
+            }
+            std::size_t used = 0;
+            for (std::size_t b = 0; b < count; ++b) {
+                if (buckets[b] > entries) {
+                    throw invalid();
+                }
+                used += (buckets[b] != 0);
+            }
+            if (used == count) {
+                throw invalid();
+            }
+        };
+
+        Header header;
+        std::memcpy(&header, take(1, sizeof(header)), sizeof(header));
+        if (std::memcmp(header.magic, Header::expectedMagic, sizeof(header.magic)) != 0 ||
+                header.byteOrder != Header::expectedByteOrder || header.domainSize != sizeof(RamDomain)) {
+            throw std::runtime_error("Incompatible table snapshot " + fileName);
+        }
+
+        symbolOffsets = as<std::uint64_t>(take(header.symbolSlots + 1, sizeof(std::uint64_t)));
+        symbolSlots = static_cast<std::size_t>(header.symbolSlots);
+        symbolIndex = as<std::uint64_t>(take(header.symbolBuckets, sizeof(std::uint64_t)));
+        symbolBuckets = static_cast<std::size_t>(header.symbolBuckets);
+        symbolPresent = as<std::uint8_t>(take(symbolSlots, 1));
+        symbolChars = take(header.symbolBytes, 1);
+        if (symbolOffsets[0] != 0 || symbolOffsets[symbolSlots] != header.symbolBytes) {
+            throw invalid();
+        }
+        for (std::size_t i = 0; i < symbolSlots; ++i) {
+            if (symbolOffsets[i] > symbolOffsets[i + 1]) {
+                throw invalid();
+            }
+        }
+        checkBuckets(symbolIndex, symbolBuckets, symbolSlots);
+
+        for (std::uint64_t s = 0; s < header.recordSections; ++s) {
+            SectionHeader section;
+            std::memcpy(&section, take(1, sizeof(section)), sizeof(section));
+            if (section.arity == 0 || section.arity > file.size()) {
+                throw invalid();
+            }
+            Records records;
+            records.arity = static_cast<std::size_t>(section.arity);
+            records.records = as<RamDomain>(take(section.slots, records.arity * sizeof(RamDomain)));
+            records.slots = static_cast<std::size_t>(section.slots);
+            records.index = as<std::uint64_t>(take(section.buckets, sizeof(std::uint64_t)));
+            records.buckets = static_cast<std::size_t>(section.buckets);
+            records.present = as<std::uint8_t>(take(records.slots, 1));
+            checkBuckets(records.index, records.buckets, records.slots);
+            recordSections.push_back(records);
+        }
+
+        decodeBlocks = (symbolSlots + decodeBlockSize - 1) / decodeBlockSize;
+        decoded = std::make_unique<std::atomic<std::atomic<const std::string*>*>[]>(decodeBlocks);
+    }
+
+    const MappedFile file;
+
+    std::size_t symbolSlots = 0;
+    std::size_t symbolBuckets = 0;
+    const std::uint64_t* symbolOffsets = nullptr;
+    const std::uint64_t* symbolIndex = nullptr;
+    const std::uint8_t* symbolPresent = nullptr;
+    const char* symbolChars = nullptr;
+
+    std::vector<Records> recordSections;
+
+    /** The decoded symbols, allocated in blocks on demand */
+    std::size_t decodeBlocks = 0;
+    std::unique_ptr<std::atomic<std::atomic<const std::string*>*>[]> decoded;
+};
+
+/**
+ * Base the given symbol and record tables on the snapshot. Both tables are
+ * checked before either of them is changed, hence they are left unchanged
+ * if the snapshot is rejected.
+ *
+ * @throws std::runtime_error if the snapshot is inconsistent with one of the tables
+ */
+template <class SymbolTableT, class RecordTableT>
+void importTableSnapshot(SymbolTableT& symbolTable, RecordTableT& recordTable,
+        const std::shared_ptr<const TableSnapshot>& snapshot) {
+    symbolTable.checkSnapshot(*snapshot);
+    recordTable.checkSnapshot(*snapshot);
+    symbolTable.importSnapshot(snapshot);
+    recordTable.importSnapshot(snapshot);
+}
+
+/**
+ * Collects the content of a symbol table and a record table and writes it as
+ * a TableSnapshot.
+ */
+class TableSnapshotWriter {
+public:
+    /** Adds a symbol; the string must remain valid until the snapshot is written. */
+    void addSymbol(RamDomain index, std::string_view symbol) {
+        symbols.emplace_back(index, symbol);
+    }
+
+    void addRecord(std::size_t arity, RamDomain index, const RamDomain* record) {
+        auto& entries = records[arity];
+        entries.push_back(index);
+        entries.insert(entries.end(), record, record + arity);
+    }
+
+    /**
+     * Writes the snapshot to the given file. The file is replaced atomically,
+     * hence it may be the file of a snapshot that is still in use.
+     *
+     * @throws std::runtime_error if the file cannot be written
+     */
+    void write(const std::string& fileName) {
+        const std::string tempName = fileName + ".tmp";
+        std::ofstream out(tempName, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Cannot write table snapshot " + fileName);
+        }
+        writeTo(out);
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Cannot write table snapshot " + fileName);
+        }
+        std::error_code error;
+        std::filesystem::rename(tempName, fileName, error);
+        if (error) {
+            throw std::runtime_error("Cannot write table snapshot " + fileName + ": " + error.message());
+        }
+    }
+
+private:
+    template <typename T>
+    static void put(std::ostream& out, const T* data, std::size_t count) {
+        const std::size_t size = count * sizeof(T);
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+        static const char padding[8] = {};
+        out.write(padding, static_cast<std::streamsize>(details::snapshotAlign(size) - size));
+    }
+
+    template <typename T>
+    static void put(std::ostream& out, const T& value) {
+        put(out, &value, 1);
+    }
+
+    void writeTo(std::ostream& out) {
+        std::sort(symbols.begin(), symbols.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+        const std::size_t symbolSlots =
+                symbols.empty() ? 0 : static_cast<std::size_t>(symbols.back().first) + 1;
+
+        std::vector<std::uint64_t> offsets(symbolSlots + 1, 0);
+        std::vector<std::uint8_t> present(symbolSlots, 0);
+        std::string chars;
+        std::size_t next = 0;
+        for (const auto& [index, symbol] : symbols) {
+            const auto i = static_cast<std::size_t>(index);
+            for (; next <= i; ++next) {
+                offsets[next] = chars.size();
+            }
+            chars.append(symbol);
+            present[i] = 1;
+        }
+        for (; next <= symbolSlots; ++next) {
+            offsets[next] = chars.size();
+        }
+        std::vector<std::uint64_t> buckets(details::snapshotBuckets(symbols.size()), 0);
+        for (const auto& [index, symbol] : symbols) {
+            insert(buckets, details::snapshotHash(symbol.data(), symbol.size()), index);
+        }
+
+        TableSnapshot::Header header;
+        std::memcpy(header.magic, TableSnapshot::Header::expectedMagic, sizeof(header.magic));
+        header.byteOrder = TableSnapshot::Header::expectedByteOrder;
+        header.domainSize = sizeof(RamDomain);
+        header.symbolSlots = symbolSlots;
+        header.symbolBytes = chars.size();
+        header.symbolBuckets = buckets.size();
+        header.recordSections = records.size();
+        put(out, header);
+        put(out, offsets.data(), offsets.size());
+        put(out, buckets.data(), buckets.size());
+        put(out, present.data(), present.size());
+        put(out, chars.data(), chars.size());
+
+        for (const auto& [arity, entries] : records) {
+            const std::size_t stride = arity + 1;
+            const std::size_t count = entries.size() / stride;
+            std::size_t slots = 0;
+            for (std::size_t e = 0; e < count; ++e) {
+                slots = std::max(slots, static_cast<std::size_t>(entries[e * stride]) + 1);
+            }
+            std::vector<RamDomain> data(slots * arity, 0);
+            std::vector<std::uint8_t> recordPresent(slots, 0);
+            std::vector<std::uint64_t> recordBuckets(details::snapshotBuckets(count), 0);
+            for (std::size_t e = 0; e < count; ++e) {
+                const RamDomain index = entries[e * stride];
+                const RamDomain* record = &entries[e * stride + 1];
+                std::copy(record, record + arity, &data[static_cast<std::size_t>(index) * arity]);
+                recordPresent[static_cast<std::size_t>(index)] = 1;
+                insert(recordBuckets, details::snapshotHash(record, arity * sizeof(RamDomain)), index);
+            }
+            put(out, TableSnapshot::SectionHeader{arity, slots, recordBuckets.size()});
+            put(out, data.data(), data.size());
+            put(out, recordBuckets.data(), recordBuckets.size());
+            put(out, recordPresent.data(), recordPresent.size());
+        }
+    }
+
+    static void insert(std::vector<std::uint64_t>& buckets, std::uint64_t hash, RamDomain index) {
+        const std::size_t mask = buckets.size() - 1;
+        std::size_t b = hash & mask;
+        while (buckets[b] != 0) {
+            b = (b + 1) & mask;
+        }
+        buckets[b] = static_cast<std::uint64_t>(index) + 1;
+    }
+
+    std::vector<std::pair<RamDomain, std::string_view>> symbols;
+
+    /** The records of each arity, stored as the index followed by the values */
+    std::map<std::size_t, std::vector<RamDomain>> records;
+};
+
+}  // namespace souffle
@@ -0,0 +1,110 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file BinaryFormat.h
+ *
+ * Defines the layout of the binary fact format shared by ReadStreamBinary
+ * and WriteStreamBinary, and of the checkpoints built on it.
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/utility/FileUtil.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace souffle {
+
+/**
+ * The header of a binary fact file.
+ *
+ * The header is followed by one array of `size` values per column, i.e. the
+ * relation is stored column by column. Numbers are stored as they are
+ * represented in RAM. Symbols are stored as indices into a symbol dictionary
+ * kept in a sidecar file (see getBinarySymbolFileName()), which holds the
+ * number of symbols followed by the length and characters of each symbol.
+ * All values are stored in host byte order; the header records the byte
+ * order and domain size such that incompatible files are rejected.
+ */
+struct BinaryFormatHeader {
+    static constexpr char expectedMagic[8] = {'S', 'O', 'U', 'F', 'F', 'L', 'E', 'B'};
+    static constexpr std::uint32_t expectedByteOrder = 0x01020304;
+
+    char magic[8];
+    std::uint32_t byteOrder;
+    std::uint32_t domainSize;
+    std::uint64_t width;
+    std::uint64_t size;
+
+    /** Creates the header of a relation of the given width and size */
+    static BinaryFormatHeader create(std::size_t width, std::size_t size) {
+        BinaryFormatHeader header;
+        std::memcpy(header.magic, expectedMagic, sizeof(expectedMagic));
+        header.byteOrder = expectedByteOrder;
+        header.domainSize = sizeof(RamDomain);
+        header.width = width;
+        header.size = size;
+        return header;
+    }
+
+    /** Checks whether this header was written by a compatible program */
+    bool isValid() const {
+        return std::memcmp(magic, expectedMagic, sizeof(expectedMagic)) == 0 &&
+               byteOrder == expectedByteOrder && domainSize == sizeof(RamDomain);
+    }
+};
+
+/**
+ * Returns the name of the symbol dictionary accompanying the given binary
+ * fact file.
+ */
+inline std::string getBinarySymbolFileName(const std::string& fileName) {
+    return fileName + ".symbols";
+}
+
+/**
+ * Returns the name of the file recording the last stratum completed by a
+ * checkpointed run (see ReadCheckpoint). The live relations are stored in the
+ * same directory as binary fact files.
+ */
+inline std::string getCheckpointProgressFileName(const std::string& dir) {
+    return dir + pathSeparator + "progress";
+}
+
+/**
+ * Returns the name of the file identifying the program and the inputs of the
+ * run that the progress of a checkpoint belongs to.
+ */
+inline std::string getCheckpointFingerprintFileName(const std::string& dir) {
+    return dir + pathSeparator + "fingerprint";
+}
+
+/**
+ * Returns the name of the snapshot of the symbol and record tables that the
+ * relations of a checkpoint refer to.
+ */
+inline std::string getCheckpointSnapshotFileName(const std::string& dir) {
+    return dir + pathSeparator + "tables.snapshot";
+}
+
+/**
+ * Determines whether attributes of the given type can be stored in the
+ * binary fact format. Records and ADTs refer to the record table, hence
+ * their values are meaningless outside of the program writing them.
+ */
+inline bool isBinaryFormatType(const std::string& type) {
+    return !type.empty() && (type[0] == 'i' || type[0] == 'u' || type[0] == 'f' || type[0] == 's');
+}
+
+}  // namespace souffle
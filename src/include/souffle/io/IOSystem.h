@@ -18,10 +18,14 @@
 #include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/io/ReadStream.h"
+#include "souffle/io/ReadStreamBinary.h"
 #include "souffle/io/ReadStreamCSV.h"
+#include "souffle/io/ReadStreamCheckpoint.h"
 #include "souffle/io/ReadStreamJSON.h"
 #include "souffle/io/WriteStream.h"
+#include "souffle/io/WriteStreamBinary.h"
 #include "souffle/io/WriteStreamCSV.h"
+#include "souffle/io/WriteStreamCheckpoint.h"
 #include "souffle/io/WriteStreamJSON.h"
 
 #ifdef USE_SQLITE
@@ -81,11 +85,15 @@ private:
         registerReadStreamFactory(std::make_shared<ReadCinCSVFactory>());
         registerReadStreamFactory(std::make_shared<ReadFileJSONFactory>());
         registerReadStreamFactory(std::make_shared<ReadCinJSONFactory>());
+        registerReadStreamFactory(std::make_shared<ReadFileBinaryFactory>());
+        registerReadStreamFactory(std::make_shared<ReadCheckpointFactory>());
         registerWriteStreamFactory(std::make_shared<WriteFileCSVFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutCSVFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutPrintSizeFactory>());
         registerWriteStreamFactory(std::make_shared<WriteFileJSONFactory>());
         registerWriteStreamFactory(std::make_shared<WriteCoutJSONFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteFileBinaryFactory>());
+        registerWriteStreamFactory(std::make_shared<WriteCheckpointFactory>());
 #ifdef USE_SQLITE
         registerReadStreamFactory(std::make_shared<ReadSQLiteFactory>());
         registerWriteStreamFactory(std::make_shared<WriteSQLiteFactory>());
@@ -24,11 +24,14 @@
 #include "souffle/utility/json11.h"
 #include <cctype>
 #include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace souffle {
@@ -39,9 +42,44 @@ protected:
             const std::map<std::string, std::string>& rwOperation, SymbolTable& symTab, RecordTable& recTab)
             : SerialisationStream(symTab, recTab, rwOperation) {}
 
+    /**
+     * Determines whether a relation accepts batches of tuples through
+     * insertBatch(const RamDomain* data, std::size_t count).
+     */
+    template <typename T, typename = void>
+    struct supports_batch_insert : std::false_type {};
+
+    template <typename T>
+    struct supports_batch_insert<T, std::void_t<decltype(std::declval<T&>().insertBatch(
+                                            std::declval<const RamDomain*>(), std::size_t()))>>
+            : std::true_type {};
+
+    // the number of tuples handed to a relation at once
+    static constexpr std::size_t batchSize = 1 << 16;
+
 public:
     template <typename T>
     void readAll(T& relation) {
+        const std::size_t width = typeAttributes.size();
+        if constexpr (supports_batch_insert<T>::value) {
+            if (width > 0) {
+                if (readBlocks([&](const RamDomain* data, std::size_t count) {
+                        relation.insertBatch(data, count);
+                    })) {
+                    return;
+                }
+                readBatches(relation, width);
+                return;
+            }
+        } else {
+            if (width > 0 && readBlocks([&](const RamDomain* data, std::size_t count) {
+                    for (std::size_t i = 0; i < count; ++i) {
+                        relation.insert(data + i * width);
+                    }
+                })) {
+                return;
+            }
+        }
         while (const auto next = readNextTuple()) {
             const RamDomain* ramDomain = next.get();
             relation.insert(ramDomain);
@@ -49,6 +87,36 @@ public:
     }
 
 protected:
+    /**
+     * Reads all tuples and hands them to the relation in batches, enabling
+     * the bulk-insertion of sorted input.
+     */
+    template <typename T>
+    void readBatches(T& relation, std::size_t width) {
+        std::vector<RamDomain> batch;
+        batch.reserve(batchSize * width);
+        while (const auto next = readNextTuple()) {
+            batch.insert(batch.end(), next.get(), next.get() + width);
+            if (batch.size() == batchSize * width) {
+                relation.insertBatch(batch.data(), batchSize);
+                batch.clear();
+            }
+        }
+        if (!batch.empty()) {
+            relation.insertBatch(batch.data(), batch.size() / width);
+        }
+    }
+
+    /**
+     * Reads all tuples at once, handing them to the given consumer in blocks
+     * of consecutively stored tuples. Streams capable of parsing their input
+     * concurrently override this operation; the default returns false to
+     * indicate that tuples are to be read one at a time via readNextTuple().
+     */
+    virtual bool readBlocks(const std::function<void(const RamDomain*, std::size_t)>& /* consumer */) {
+        return false;
+    }
+
     /**
      * Read a record from a string.
      *
@@ -127,7 +195,8 @@ protected:
             *charactersRead = pos - initial_position;
         }
 
-        return recordTable.pack(recordValues.data(), recordValues.size());
+        return packRecord(
+                recordTable, recordValues.data(), recordValues.size(), getUnboxedWidths(recordInfo));
     }
 
     RamDomain readADT(const std::string& source, const std::string& adtName, std::size_t pos = 0,
@@ -178,7 +247,7 @@ protected:
 
             RamDomain emptyArgs = recordTable.pack(toVector<RamDomain>().data(), 0);
             const RamDomain record[] = {branchIdx, emptyArgs};
-            return recordTable.pack(record, 2);
+            return packRecord(recordTable, record, 2, getUnboxedWidths(adtInfo));
         }
 
         consumeChar(source, '(', pos);
@@ -235,14 +304,15 @@ protected:
         // Store branch either as [branch_id, [arguments]] or [branch_id, argument].
         RamDomain branchValue = [&]() -> RamDomain {
             if (branchArgs.size() != 1) {
-                return recordTable.pack(branchArgs.data(), branchArgs.size());
+                return packRecord(
+                        recordTable, branchArgs.data(), branchArgs.size(), getUnboxedWidths(branchInfo));
             } else {
                 return branchArgs[0];
             }
         }();
 
         RamDomain rec[2] = {branchIdx, branchValue};
-        return recordTable.pack(rec, 2);
+        return packRecord(recordTable, rec, 2, getUnboxedWidths(adtInfo));
     }
 
     /**
@@ -0,0 +1,220 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/io/BinaryFormat.h"
+#include "souffle/io/ReadStream.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/FileUtil.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Reads relations stored in the binary fact format (see BinaryFormatHeader).
+ *
+ * The fact file is mapped into memory and its columns are copied into the
+ * relation in batches, without any parsing. Only symbols require a
+ * translation, which is computed once per entry of the symbol dictionary.
+ */
+class ReadFileBinary : public ReadStream {
+public:
+    ReadFileBinary(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable)
+            : ReadStream(rwOperation, symbolTable, recordTable),
+              baseName(souffle::baseName(getFileName(rwOperation))), file(getFileName(rwOperation)) {
+        for (std::size_t col = 0; col < arity; ++col) {
+            if (!isBinaryFormatType(typeAttributes[col])) {
+                throw std::invalid_argument("Binary fact files do not support attributes of type <" +
+                                            typeAttributes[col] + ">\n");
+            }
+        }
+        if (!file.is_open()) {
+            // suppress error message in case file cannot be open when flag -w is set
+            if (getOr(rwOperation, "no-warn", "false") != "true") {
+                throw std::invalid_argument("Cannot open fact file " + baseName + "\n");
+            }
+            return;
+        }
+
+        BinaryFormatHeader header;
+        if (file.size() < sizeof(header)) {
+            throw std::invalid_argument("Invalid binary fact file " + baseName + "\n");
+        }
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (!header.isValid()) {
+            throw std::invalid_argument("Incompatible binary fact file " + baseName + "\n");
+        }
+        if (header.width != arity) {
+            throw std::invalid_argument("Binary fact file " + baseName + " has " +
+                                        std::to_string(header.width) + " columns, expected " +
+                                        std::to_string(arity) + "\n");
+        }
+        // the values are counted by division, as their number may overflow in a corrupt header
+        const std::size_t available = (file.size() - sizeof(header)) / sizeof(RamDomain);
+        if (header.width > 0 && header.size > available / header.width) {
+            throw std::invalid_argument("Truncated binary fact file " + baseName + "\n");
+        }
+        size = static_cast<std::size_t>(header.size);
+        columns = reinterpret_cast<const RamDomain*>(file.data() + sizeof(header));
+
+        if (std::any_of(typeAttributes.begin(), typeAttributes.begin() + arity,
+                    [](const std::string& type) { return type[0] == 's'; })) {
+            readSymbols(getBinarySymbolFileName(getFileName(rwOperation)));
+        }
+    }
+
+    ~ReadFileBinary() override = default;
+
+protected:
+    Own<RamDomain[]> readNextTuple() override {
+        if (next >= size) {
+            return nullptr;
+        }
+        Own<RamDomain[]> tuple = mk<RamDomain[]>(typeAttributes.size());
+        copyTuples(next, 1, tuple.get());
+        ++next;
+        return tuple;
+    }
+
+    bool readBlocks(const std::function<void(const RamDomain*, std::size_t)>& consumer) override {
+        const std::size_t width = typeAttributes.size();
+        std::vector<RamDomain> block;
+        while (next < size) {
+            const std::size_t count = std::min(batchSize, size - next);
+            block.assign(count * width, 0);
+            copyTuples(next, count, block.data());
+            consumer(block.data(), count);
+            next += count;
+        }
+        return true;
+    }
+
+    /**
+     * Copies the given range of tuples from the columns of the file into
+     * consecutive tuples of the given buffer; auxiliary attributes are left
+     * untouched.
+     */
+    void copyTuples(std::size_t first, std::size_t count, RamDomain* out) const {
+        const std::size_t width = typeAttributes.size();
+        for (std::size_t col = 0; col < arity; ++col) {
+            const RamDomain* column = columns + col * size + first;
+            if (typeAttributes[col][0] == 's') {
+                for (std::size_t i = 0; i < count; ++i) {
+                    const auto index = static_cast<std::size_t>(column[i]);
+                    if (index >= symbols.size()) {
+                        throw std::invalid_argument("Invalid symbol in column " + std::to_string(col + 1) +
+                                                    " of binary fact file " + baseName + "\n");
+                    }
+                    out[i * width + col] = symbols[index];
+                }
+            } else {
+                for (std::size_t i = 0; i < count; ++i) {
+                    out[i * width + col] = column[i];
+                }
+            }
+        }
+    }
+
+    /**
+     * Reads the symbol dictionary, encoding its symbols in the symbol table.
+     */
+    void readSymbols(const std::string& fileName) {
+        const MappedFile dictionary(fileName);
+        if (!dictionary.is_open()) {
+            throw std::invalid_argument("Cannot open symbol file " + souffle::baseName(fileName) + "\n");
+        }
+        const char* pos = dictionary.data();
+        const char* end = pos + dictionary.size();
+        auto readLength = [&]() {
+            std::uint64_t value;
+            if (static_cast<std::size_t>(end - pos) < sizeof(value)) {
+                throw std::invalid_argument("Truncated symbol file " + souffle::baseName(fileName) + "\n");
+            }
+            std::memcpy(&value, pos, sizeof(value));
+            pos += sizeof(value);
+            return value;
+        };
+        const std::uint64_t numSymbols = readLength();
+        symbols.reserve(static_cast<std::size_t>(numSymbols));
+        for (std::uint64_t i = 0; i < numSymbols; ++i) {
+            const std::uint64_t length = readLength();
+            if (static_cast<std::uint64_t>(end - pos) < length) {
+                throw std::invalid_argument("Truncated symbol file " + souffle::baseName(fileName) + "\n");
+            }
+            symbols.push_back(symbolTable.encode(std::string(pos, static_cast<std::size_t>(length))));
+            pos += length;
+        }
+    }
+
+    /**
+     * Return given filename or construct from relation name.
+     * Default name is [configured path]/[relation name].bin
+     *
+     * @param rwOperation map of IO configuration options
+     * @return input filename
+     */
+    static std::string getFileName(const std::map<std::string, std::string>& rwOperation) {
+        auto name = getOr(rwOperation, "filename", rwOperation.at("name") + ".bin");
+        if (!isAbsolute(name)) {
+            name = getOr(rwOperation, "fact-dir", ".") + pathSeparator + name;
+        }
+        return name;
+    }
+
+    std::string baseName;
+    const MappedFile file;
+
+    /** The columns of the relation, stored consecutively */
+    const RamDomain* columns = nullptr;
+
+    /** The number of tuples of the relation */
+    std::size_t size = 0;
+
+    /** The index of the next tuple read by readNextTuple() */
+    std::size_t next = 0;
+
+    /** Maps the indices of the symbol dictionary to symbol table entries */
+    std::vector<RamDomain> symbols;
+};
+
+class ReadFileBinaryFactory : public ReadStreamFactory {
+public:
+    Own<ReadStream> getReader(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable) override {
+        return mk<ReadFileBinary>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~ReadFileBinaryFactory() override = default;
+};
+
+}  // namespace souffle
@@ -20,6 +20,7 @@
 #include "souffle/io/ReadStream.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/FileUtil.h"
+#include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StringUtil.h"
 
 #ifdef USE_LIBZ
@@ -37,6 +38,7 @@
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <streambuf>
 #include <string>
 #include <vector>
 
@@ -63,6 +65,170 @@ public:
     }
 
 protected:
+    /**
+     * A worker parsing chunks of the input of the given stream.
+     */
+    ReadStreamCSV(std::istream& file, const ReadStreamCSV& other)
+            : ReadStream(other), rfc4180(other.rfc4180), delimiter(other.delimiter), file(file),
+              lineNumber(0), inputMap(other.inputMap) {}
+
+    /** The number of bytes read from the input at once */
+    static constexpr std::size_t blockSize = std::size_t(1) << 26;
+
+    /** The minimal number of bytes of a chunk parsed by a single thread */
+    static constexpr std::size_t minChunkSize = std::size_t(1) << 16;
+
+    /**
+     * Reads the input in large blocks, which are split into chunks of whole
+     * lines that are parsed concurrently. The tuples of each block are handed
+     * to the consumer in the order of the input.
+     */
+    bool readBlocks(const std::function<void(const RamDomain*, std::size_t)>& consumer) override {
+        const std::size_t numThreads = MAX_THREADS;
+        if (numThreads <= 1) {
+            return false;
+        }
+        const std::size_t width = typeAttributes.size();
+
+        std::string buffer;
+        bool atEnd = false;
+        while (!atEnd) {
+            // append the next block to the incomplete lines of the previous one
+            const std::size_t carry = buffer.size();
+            buffer.resize(carry + blockSize);
+            file.read(&buffer[carry], static_cast<std::streamsize>(blockSize));
+            buffer.resize(carry + static_cast<std::size_t>(file.gcount()));
+            atEnd = !file;
+
+            const std::size_t chunkSize = std::max(minChunkSize, buffer.size() / (4 * numThreads));
+            const std::vector<std::size_t> bounds = getChunkBounds(buffer, atEnd, chunkSize);
+            const std::size_t numChunks = bounds.size() - 1;
+
+            // determine the number of the line preceding each chunk
+            std::vector<std::size_t> lines(numChunks + 1, 0);
+            PARALLEL_START
+                pfor(std::size_t i = 0; i < numChunks; ++i) {
+                    lines[i + 1] = static_cast<std::size_t>(
+                            std::count(buffer.begin() + bounds[i], buffer.begin() + bounds[i + 1], '\n'));
+                }
+            PARALLEL_END
+            lines[0] = lineNumber;
+            for (std::size_t i = 0; i < numChunks; ++i) {
+                lines[i + 1] += lines[i];
+            }
+
+            // parse the chunks
+            std::vector<std::vector<RamDomain>> tuples(numChunks);
+            std::vector<std::string> errors(numChunks);
+            PARALLEL_START
+                ChunkBuffer chunk;
+                std::istream in(&chunk);
+                ReadStreamCSV worker(in, *this);
+                pfor(std::size_t i = 0; i < numChunks; ++i) {
+                    chunk.assign(&buffer[bounds[i]], &buffer[0] + bounds[i + 1]);
+                    in.clear();
+                    worker.lineNumber = lines[i];
+                    try {
+                        while (const auto next = worker.readNextTuple()) {
+                            tuples[i].insert(tuples[i].end(), next.get(), next.get() + width);
+                        }
+                    } catch (std::exception& e) {
+                        errors[i] = e.what();
+                    }
+                }
+            PARALLEL_END
+
+            for (std::size_t i = 0; i < numChunks; ++i) {
+                if (!errors[i].empty()) {
+                    throw std::invalid_argument(errors[i]);
+                }
+                consumer(tuples[i].data(), tuples[i].size() / width);
+            }
+
+            lineNumber = lines[numChunks];
+            buffer.erase(0, bounds.back());
+        }
+        return true;
+    }
+
+    /**
+     * Splits the given block of input into chunks of whole lines of roughly
+     * the given size. Returns the offsets delimiting the chunks; the input
+     * following the last offset is an incomplete line, unless the end of the
+     * input has been reached.
+     */
+    std::vector<std::size_t> getChunkBounds(
+            const std::string& buffer, bool atEnd, std::size_t chunkSize) const {
+        std::vector<std::size_t> bounds{0};
+        std::size_t end = 0;
+        if (!rfc4180) {
+            end = atEnd ? buffer.size() : buffer.rfind('\n') + 1;
+            for (std::size_t next = chunkSize; next < end;) {
+                const std::size_t pos = buffer.find('\n', next - 1);
+                if (pos == std::string::npos || pos + 1 >= end) {
+                    break;
+                }
+                bounds.push_back(pos + 1);
+                next = pos + 1 + chunkSize;
+            }
+        } else {
+            // quoted fields may span several lines, hence follow the fields of
+            // each record as readNextTuple() does; columns not read by it are
+            // never treated as quoted
+            const int lastColumn = inputMap.empty() ? -1 : inputMap.rbegin()->first;
+            int column = 0;
+            bool fieldStart = true;
+            bool quoted = false;
+            for (std::size_t pos = 0; pos < buffer.size(); ++pos) {
+                const char c = buffer[pos];
+                if (quoted) {
+                    if (c == '"') {
+                        if (pos + 1 < buffer.size() && buffer[pos + 1] == '"') {
+                            ++pos;
+                        } else {
+                            quoted = false;
+                        }
+                    }
+                } else if (c == '\n') {
+                    end = pos + 1;
+                    if (end >= bounds.back() + chunkSize) {
+                        bounds.push_back(end);
+                    }
+                    column = 0;
+                    fieldStart = true;
+                } else if (fieldStart && c == '"' && column <= lastColumn) {
+                    quoted = true;
+                    fieldStart = false;
+                } else if (buffer.compare(pos, delimiter.size(), delimiter) == 0) {
+                    pos += delimiter.size() - 1;
+                    ++column;
+                    fieldStart = true;
+                } else {
+                    fieldStart = false;
+                }
+            }
+            if (atEnd) {
+                end = buffer.size();
+            }
+            while (bounds.back() >= end && bounds.size() > 1) {
+                bounds.pop_back();
+            }
+        }
+        if (end > 0) {
+            bounds.push_back(end);
+        }
+        return bounds;
+    }
+
+    /**
+     * A stream buffer presenting a chunk of the input without copying it.
+     */
+    struct ChunkBuffer : public std::streambuf {
+        void assign(char* begin, char* end) {
+            setg(begin, begin, end);
+        }
+    };
+
     bool readNextLine(std::string& line, bool& isCRLF) {
         if (!getline(file, line)) {
             return false;
@@ -372,6 +538,17 @@ public:
     ~ReadFileCSV() override = default;
 
 protected:
+    bool readBlocks(const std::function<void(const RamDomain*, std::size_t)>& consumer) override {
+        try {
+            return ReadStreamCSV::readBlocks(consumer);
+        } catch (std::exception& e) {
+            std::stringstream errorMessage;
+            errorMessage << e.what();
+            errorMessage << "cannot parse fact file " << baseName << "!\n";
+            throw std::invalid_argument(errorMessage.str());
+        }
+    }
+
     /**
      * Return given filename or construct from relation name.
      * Default name is [configured path]/[relation name].facts
@@ -0,0 +1,161 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file ReadStreamCheckpoint.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/datastructure/TableSnapshot.h"
+#include "souffle/io/BinaryFormat.h"
+#include "souffle/io/ReadStream.h"
+#include "souffle/utility/FileUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/json11.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Reads the progress of a checkpointed run.
+ *
+ * A checkpoint directory holds the relations that are live after the last
+ * completed stratum as binary fact files, a snapshot of the symbol and record
+ * tables their values refer to, and the index of that stratum. Reading the
+ * checkpoint bases the tables on the snapshot and yields the indices of all
+ * completed strata, such that the program can skip them and restore the
+ * live relations instead.
+ *
+ * The checkpoint is only resumed by a run with the same fingerprint, which
+ * covers the program and the contents of its input fact files.
+ */
+class ReadCheckpoint : public ReadStream {
+public:
+    ReadCheckpoint(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable)
+            : ReadStream(rwOperation, symbolTable, recordTable) {
+        const std::string& dir = rwOperation.at("checkpoint-dir");
+        std::filesystem::create_directories(dir);
+
+        // The progress of a run of another program, or of the same program on other inputs, is
+        // discarded, and the checkpoints of this run are identified by its own fingerprint
+        const std::string fingerprint = getFingerprint(rwOperation);
+        std::string previous;
+        std::ifstream(getCheckpointFingerprintFileName(dir)) >> previous;
+        if (previous != fingerprint) {
+            std::error_code error;
+            if (std::filesystem::remove(getCheckpointProgressFileName(dir), error)) {
+                std::cerr << "Warning: discarding checkpoint " << dir
+                          << " of another program or of other inputs\n";
+            }
+            const std::string fingerprintName = getCheckpointFingerprintFileName(dir);
+            {
+                std::ofstream file(fingerprintName + ".tmp");
+                file << fingerprint << "\n";
+            }
+            std::filesystem::rename(fingerprintName + ".tmp", fingerprintName, error);
+            if (error) {
+                throw std::runtime_error("Cannot write checkpoint " + dir + ": " + error.message());
+            }
+            return;
+        }
+
+        std::ifstream progress(getCheckpointProgressFileName(dir));
+        RamSigned lastStratum;
+        if (!(progress >> lastStratum)) {
+            return;
+        }
+        try {
+            importTableSnapshot(
+                    symbolTable, recordTable, TableSnapshot::open(getCheckpointSnapshotFileName(dir)));
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Warning: cannot resume from checkpoint " << dir << ": " << e.what() << "\n";
+            return;
+        }
+        completed = lastStratum + 1;
+    }
+
+    ~ReadCheckpoint() override = default;
+
+protected:
+    /**
+     * Returns the fingerprint of the program, given by the compiler, combined with the contents of
+     * its input files, resolved against the fact directory.
+     */
+    static std::string getFingerprint(const std::map<std::string, std::string>& rwOperation) {
+        const std::string program = getOr(rwOperation, "fingerprint", "");
+        std::uint64_t hash = details::snapshotHash(program.data(), program.size());
+
+        std::string error;
+        const auto inputs = json11::Json::parse(getOr(rwOperation, "inputs", "[]"), error);
+        std::vector<char> buffer(1 << 16);
+        for (const auto& input : inputs.array_items()) {
+            std::string name = input.string_value();
+            if (!isAbsolute(name)) {
+                name = getOr(rwOperation, "fact-dir", ".") + pathSeparator + name;
+            }
+            hash = details::snapshotHash(name.c_str(), name.size() + 1, hash);
+            std::ifstream file(name, std::ios::in | std::ios::binary);
+            while (file) {
+                file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                hash = details::snapshotHash(buffer.data(), static_cast<std::size_t>(file.gcount()), hash);
+            }
+            // a missing file differs from an empty one
+            const char present = file.eof() ? 1 : 0;
+            hash = details::snapshotHash(&present, 1, hash);
+        }
+        return std::to_string(hash);
+    }
+
+    Own<RamDomain[]> readNextTuple() override {
+        if (next >= completed) {
+            return nullptr;
+        }
+        Own<RamDomain[]> tuple = mk<RamDomain[]>(1);
+        tuple[0] = next++;
+        return tuple;
+    }
+
+    /** The number of strata completed by the previous run */
+    RamSigned completed = 0;
+
+    /** The stratum returned by the next call of readNextTuple() */
+    RamSigned next = 0;
+};
+
+class ReadCheckpointFactory : public ReadStreamFactory {
+public:
+    Own<ReadStream> getReader(const std::map<std::string, std::string>& rwOperation, SymbolTable& symbolTable,
+            RecordTable& recordTable) override {
+        return mk<ReadCheckpoint>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "checkpoint";
+        return name;
+    }
+
+    ~ReadCheckpointFactory() override = default;
+};
+
+}  // namespace souffle
@@ -201,7 +201,8 @@ protected:
             }
         }
 
-        return recordTable.pack(recordValues.data(), recordValues.size());
+        return packRecord(
+                recordTable, recordValues.data(), recordValues.size(), getUnboxedWidths(recordInfo));
     }
 
     Own<RamDomain[]> readNextTupleObject() {
@@ -311,7 +312,8 @@ protected:
             }
         }
 
-        return recordTable.pack(recordValues.data(), recordValues.size());
+        return packRecord(
+                recordTable, recordValues.data(), recordValues.size(), getUnboxedWidths(recordInfo));
     }
 };
 
@@ -81,6 +81,15 @@ protected:
     std::size_t arity = 0;
     std::size_t auxiliaryArity = 0;
 
+    /** Return the widths of unboxed records of a record or ADT type, or none if they are always boxed */
+    static std::vector<unsigned> getUnboxedWidths(const Json& typeInfo) {
+        std::vector<unsigned> widths;
+        for (const auto& width : typeInfo["widths"].array_items()) {
+            widths.push_back(static_cast<unsigned>(width.int_value()));
+        }
+        return widths;
+    }
+
 private:
     void setupFromJson() {
         auto&& relInfo = types["relation"];
@@ -27,6 +27,7 @@
 #include <memory>
 #include <ostream>
 #include <string>
+#include <string_view>
 
 namespace souffle {
 
@@ -48,11 +49,12 @@ public:
             if (relation.begin() != relation.end()) {
                 writeNullary();
             }
-            return;
-        }
-        for (const auto& current : relation) {
-            writeNext(current);
+        } else {
+            for (const auto& current : relation) {
+                writeNext(current);
+            }
         }
+        writeEnd();
     }
 
     template <typename T>
@@ -69,13 +71,16 @@ protected:
         fatal("attempting to print size of a write operation");
     }
 
+    /** Complete the output once all tuples are written; failures are thrown */
+    virtual void writeEnd() {}
+
     template <typename Tuple>
     void writeNext(const Tuple tuple) {
         using tcb::make_span;
         writeNextTuple(make_span(tuple).data());
     }
 
-    virtual void outputSymbol(std::ostream& destination, const std::string& value) {
+    virtual void outputSymbol(std::ostream& destination, std::string_view value) {
         destination << value;
     }
 
@@ -94,7 +99,9 @@ protected:
         auto&& recordTypes = recordInfo["types"];
         const std::size_t recordArity = recordInfo["arity"].long_value();
 
-        const RamDomain* tuplePtr = recordTable.unpack(value, recordArity);
+        RamDomain unboxed[MAX_UNBOXED_ARITY];
+        const RamDomain* tuplePtr =
+                unpackRecord(recordTable, value, recordArity, getUnboxedWidths(recordInfo), unboxed);
 
         destination << "[";
 
@@ -111,7 +118,7 @@ protected:
                 case 'i': destination << recordValue; break;
                 case 'f': destination << ramBitCast<RamFloat>(recordValue); break;
                 case 'u': destination << ramBitCast<RamUnsigned>(recordValue); break;
-                case 's': outputSymbol(destination, symbolTable.decode(recordValue)); break;
+                case 's': outputSymbol(destination, symbolTable.decodeView(recordValue)); break;
                 case 'r': outputRecord(destination, recordValue, recordType); break;
                 case '+': outputADT(destination, recordValue, recordType); break;
                 default: fatal("Unsupported type attribute: `%c`", recordType[0]);
@@ -137,8 +144,11 @@ protected:
         json11::Json branchInfo;
         json11::Json::array branchTypes;
 
+        RamDomain unboxed[2];
+        RamDomain unboxedArgs[MAX_UNBOXED_ARITY];
         if (!isEnum) {
-            const RamDomain* tuplePtr = recordTable.unpack(value, 2);
+            const RamDomain* tuplePtr =
+                    unpackRecord(recordTable, value, 2, getUnboxedWidths(adtInfo), unboxed);
 
             branchId = tuplePtr[0];
             branchInfo = adtInfo["branches"][branchId];
@@ -147,7 +157,8 @@ protected:
             // Prepare branch's arguments for output.
             branchArgs = [&]() -> const RamDomain* {
                 if (branchTypes.size() > 1) {
-                    return recordTable.unpack(tuplePtr[1], branchTypes.size());
+                    return unpackRecord(recordTable, tuplePtr[1], branchTypes.size(),
+                            getUnboxedWidths(branchInfo), unboxedArgs);
                 } else {
                     return &tuplePtr[1];
                 }
@@ -174,7 +185,7 @@ protected:
                 case 'i': destination << branchArgs[i]; break;
                 case 'f': destination << ramBitCast<RamFloat>(branchArgs[i]); break;
                 case 'u': destination << ramBitCast<RamUnsigned>(branchArgs[i]); break;
-                case 's': outputSymbol(destination, symbolTable.decode(branchArgs[i])); break;
+                case 's': outputSymbol(destination, symbolTable.decodeView(branchArgs[i])); break;
                 case 'r': outputRecord(destination, branchArgs[i], argType); break;
                 case '+': outputADT(destination, branchArgs[i], argType); break;
                 default: fatal("Unsupported type attribute: `%c`", argType[0]);
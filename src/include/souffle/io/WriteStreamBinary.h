@@ -0,0 +1,171 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamBinary.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/io/BinaryFormat.h"
+#include "souffle/io/WriteStream.h"
+#include "souffle/utility/ContainerUtil.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace souffle {
+
+/**
+ * Writes relations in the binary fact format (see BinaryFormatHeader).
+ *
+ * The tuples are collected column by column and written once all of them
+ * have been passed to the stream. Symbols are numbered in order of their
+ * first occurrence and written to the symbol dictionary of the fact file.
+ */
+class WriteFileBinary : public WriteStream {
+public:
+    WriteFileBinary(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
+            const RecordTable& recordTable)
+            : WriteStream(rwOperation, symbolTable, recordTable), fileName(getFileName(rwOperation)),
+              columns(arity), file(fileName, std::ios::out | std::ios::binary) {
+        for (std::size_t col = 0; col < arity; ++col) {
+            if (!isBinaryFormatType(typeAttributes[col])) {
+                throw std::invalid_argument("Binary fact files do not support attributes of type <" +
+                                            typeAttributes[col] + ">\n");
+            }
+        }
+        if (!file.is_open()) {
+            throw std::invalid_argument("Cannot open binary fact file " + fileName + "\n");
+        }
+        if (std::any_of(typeAttributes.begin(), typeAttributes.begin() + arity,
+                    [](const std::string& type) { return type[0] == 's'; })) {
+            symbolFile.open(getBinarySymbolFileName(fileName), std::ios::out | std::ios::binary);
+            if (!symbolFile.is_open()) {
+                throw std::invalid_argument(
+                        "Cannot open binary symbol file " + getBinarySymbolFileName(fileName) + "\n");
+            }
+        }
+    }
+
+    ~WriteFileBinary() override = default;
+
+protected:
+    void writeEnd() override {
+        const auto header = BinaryFormatHeader::create(arity, size);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto& column : columns) {
+            file.write(reinterpret_cast<const char*>(column.data()),
+                    static_cast<std::streamsize>(column.size() * sizeof(RamDomain)));
+        }
+        file.close();
+        if (file.fail()) {
+            throw std::runtime_error("Cannot write binary fact file " + fileName + "\n");
+        }
+
+        if (symbolFile.is_open()) {
+            writeLength(symbols.size());
+            for (RamDomain symbol : symbols) {
+                const std::string_view value = symbolTable.decodeView(symbol);
+                writeLength(value.size());
+                symbolFile.write(value.data(), static_cast<std::streamsize>(value.size()));
+            }
+            symbolFile.close();
+            if (symbolFile.fail()) {
+                throw std::runtime_error(
+                        "Cannot write binary symbol file " + getBinarySymbolFileName(fileName) + "\n");
+            }
+        }
+    }
+
+    void writeNullary() override {
+        ++size;
+    }
+
+    void writeNextTuple(const RamDomain* tuple) override {
+        for (std::size_t col = 0; col < arity; ++col) {
+            RamDomain value = tuple[col];
+            if (typeAttributes[col][0] == 's') {
+                const auto res = symbolIndex.emplace(value, static_cast<RamDomain>(symbols.size()));
+                if (res.second) {
+                    symbols.push_back(value);
+                }
+                value = res.first->second;
+            }
+            columns[col].push_back(value);
+        }
+        ++size;
+    }
+
+    void writeLength(std::uint64_t length) {
+        symbolFile.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    }
+
+    /**
+     * Return given filename or construct from relation name.
+     * Default name is [configured path]/[relation name].bin
+     *
+     * @param rwOperation map of IO configuration options
+     * @return output filename
+     */
+    static std::string getFileName(const std::map<std::string, std::string>& rwOperation) {
+        auto name = getOr(rwOperation, "filename", rwOperation.at("name") + ".bin");
+        if (name.front() != '/') {
+            name = getOr(rwOperation, "output-dir", ".") + "/" + name;
+        }
+        return name;
+    }
+
+    /** The name of the fact file */
+    const std::string fileName;
+
+    /** The columns of the written tuples */
+    std::vector<std::vector<RamDomain>> columns;
+
+    /** The number of written tuples */
+    std::size_t size = 0;
+
+    /** The symbols in order of their first occurrence */
+    std::vector<RamDomain> symbols;
+
+    /** Maps symbols to their index in the symbol dictionary */
+    std::unordered_map<RamDomain, RamDomain> symbolIndex;
+
+    std::ofstream file;
+    std::ofstream symbolFile;
+};
+
+class WriteFileBinaryFactory : public WriteStreamFactory {
+public:
+    Own<WriteStream> getWriter(const std::map<std::string, std::string>& rwOperation,
+            const SymbolTable& symbolTable, const RecordTable& recordTable) override {
+        return mk<WriteFileBinary>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "binary";
+        return name;
+    }
+
+    ~WriteFileBinaryFactory() override = default;
+};
+
+}  // namespace souffle
@@ -32,6 +32,7 @@
 #include <map>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace souffle {
@@ -65,11 +66,11 @@ protected:
         destination << "\n";
     }
 
-    virtual void outputSymbol(std::ostream& destination, const std::string& value) {
+    void outputSymbol(std::ostream& destination, std::string_view value) override {
         outputSymbol(destination, value, false);
     }
 
-    void outputSymbol(std::ostream& destination, const std::string& value, bool fieldValue) {
+    void outputSymbol(std::ostream& destination, std::string_view value, bool fieldValue) {
         if (rfc4180) {
             if (!fieldValue) {
                 destination << '"';
@@ -97,7 +98,7 @@ protected:
 
     void writeNextTupleElement(std::ostream& destination, const std::string& type, RamDomain value) {
         switch (type[0]) {
-            case 's': outputSymbol(destination, symbolTable.decode(value), true); break;
+            case 's': outputSymbol(destination, symbolTable.decodeView(value), true); break;
             case 'i': destination << value; break;
             case 'u': destination << ramBitCast<RamUnsigned>(value); break;
             case 'f': destination << ramBitCast<RamFloat>(value); break;
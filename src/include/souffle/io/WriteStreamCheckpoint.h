@@ -0,0 +1,96 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file WriteStreamCheckpoint.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
+#include "souffle/SymbolTable.h"
+#include "souffle/datastructure/TableSnapshot.h"
+#include "souffle/io/BinaryFormat.h"
+#include "souffle/io/WriteStream.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace souffle {
+
+/**
+ * Completes a checkpoint once the live relations have been written (see
+ * ReadCheckpoint), or discards the checkpoint once the run has completed.
+ *
+ * The snapshot of the tables is written before the progress, and both are
+ * replaced atomically, such that the progress always refers to a complete
+ * checkpoint. The content of the relation is ignored.
+ */
+class WriteCheckpoint : public WriteStream {
+public:
+    WriteCheckpoint(const std::map<std::string, std::string>& rwOperation, const SymbolTable& symbolTable,
+            const RecordTable& recordTable)
+            : WriteStream(rwOperation, symbolTable, recordTable) {
+        const std::string& dir = rwOperation.at("checkpoint-dir");
+        const std::string progressName = getCheckpointProgressFileName(dir);
+        std::error_code error;
+        if (!contains(rwOperation, "stratum")) {
+            std::filesystem::remove(progressName, error);
+            return;
+        }
+
+        std::filesystem::create_directories(dir);
+        TableSnapshotWriter snapshot;
+        symbolTable.exportSnapshot(snapshot);
+        recordTable.exportSnapshot(snapshot);
+        snapshot.write(getCheckpointSnapshotFileName(dir));
+
+        const std::string tempName = progressName + ".tmp";
+        {
+            std::ofstream progress(tempName);
+            progress << rwOperation.at("stratum") << "\n";
+        }
+        std::filesystem::rename(tempName, progressName, error);
+        if (error) {
+            throw std::runtime_error("Cannot write checkpoint " + dir + ": " + error.message());
+        }
+    }
+
+    ~WriteCheckpoint() override = default;
+
+protected:
+    void writeNullary() override {}
+
+    void writeNextTuple(const RamDomain*) override {}
+};
+
+class WriteCheckpointFactory : public WriteStreamFactory {
+public:
+    Own<WriteStream> getWriter(const std::map<std::string, std::string>& rwOperation,
+            const SymbolTable& symbolTable, const RecordTable& recordTable) override {
+        return mk<WriteCheckpoint>(rwOperation, symbolTable, recordTable);
+    }
+
+    const std::string& getName() const override {
+        static const std::string name = "checkpoint";
+        return name;
+    }
+
+    ~WriteCheckpointFactory() override = default;
+};
+
+}  // namespace souffle
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "souffle/RamTypes.h"
+#include "souffle/RecordTable.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/io/WriteStream.h"
 #include "souffle/utility/ContainerUtil.h"
@@ -25,6 +26,7 @@
 #include <queue>
 #include <stack>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -96,7 +98,7 @@ protected:
             assert(currType.length() > 2 && "Invalid type length");
             switch (currType[0]) {
                 // since some strings may need to be escaped, we use dump here
-                case 's': destination << Json(symbolTable.decode(currValue)).dump(); break;
+                case 's': destination << Json(std::string(symbolTable.decodeView(currValue))).dump(); break;
                 case 'i': destination << currValue; break;
                 case 'u': destination << (int)ramBitCast<RamUnsigned>(currValue); break;
                 case 'f': destination << ramBitCast<RamFloat>(currValue); break;
@@ -110,7 +112,9 @@ protected:
 
                     auto&& recordTypes = recordInfo["types"];
                     const std::size_t recordArity = recordInfo["arity"].long_value();
-                    const RamDomain* tuplePtr = recordTable.unpack(currValue, recordArity);
+                    RamDomain unboxed[MAX_UNBOXED_ARITY];
+                    const RamDomain* tuplePtr = unpackRecord(
+                            recordTable, currValue, recordArity, getUnboxedWidths(recordInfo), unboxed);
                     worklist.push("]");
                     for (auto i = (long long)(recordArity - 1); i >= 0; --i) {
                         if (i != (long long)(recordArity - 1)) {
@@ -151,7 +155,7 @@ protected:
             assert(currType.length() > 2 && "Invalid type length");
             switch (currType[0]) {
                 // since some strings may need to be escaped, we use dump here
-                case 's': destination << Json(symbolTable.decode(currValue)).dump(); break;
+                case 's': destination << Json(std::string(symbolTable.decodeView(currValue))).dump(); break;
                 case 'i': destination << currValue; break;
                 case 'u': destination << (int)ramBitCast<RamUnsigned>(currValue); break;
                 case 'f': destination << ramBitCast<RamFloat>(currValue); break;
@@ -165,7 +169,9 @@ protected:
 
                     auto&& recordTypes = recordInfo["types"];
                     const std::size_t recordArity = recordInfo["arity"].long_value();
-                    const RamDomain* tuplePtr = recordTable.unpack(currValue, recordArity);
+                    RamDomain unboxed[MAX_UNBOXED_ARITY];
+                    const RamDomain* tuplePtr = unpackRecord(
+                            recordTable, currValue, recordArity, getUnboxedWidths(recordInfo), unboxed);
                     worklist.push("}");
                     for (auto i = (long long)(recordArity - 1); i >= 0; --i) {
                         if (i != (long long)(recordArity - 1)) {
@@ -26,6 +26,7 @@
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <sqlite3.h>
@@ -105,7 +106,8 @@ private:
     }
 
     uint64_t getSymbolTableIDFromDB(std::size_t index) {
-        if (sqlite3_bind_text(symbolSelectStatement, 1, symbolTable.decode(index).c_str(), -1,
+        const std::string_view symbol = symbolTable.decodeView(index);
+        if (sqlite3_bind_text(symbolSelectStatement, 1, symbol.data(), static_cast<int>(symbol.size()),
                     SQLITE_TRANSIENT) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
@@ -122,7 +124,8 @@ private:
             return dbSymbolTable[index];
         }
 
-        if (sqlite3_bind_text(symbolInsertStatement, 1, symbolTable.decode(index).c_str(), -1,
+        const std::string_view symbol = symbolTable.decodeView(index);
+        if (sqlite3_bind_text(symbolInsertStatement, 1, symbol.data(), static_cast<int>(symbol.size()),
                     SQLITE_TRANSIENT) != SQLITE_OK) {
             throwError("SQLite error in sqlite3_bind_text: ");
         }
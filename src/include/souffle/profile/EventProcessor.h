@@ -443,6 +443,30 @@ public:
     }
 } recursiveRelationCopyTimingProcessor;
 
+/**
+ * Recursive Relation Merge Timing Profile Event Processor
+ */
+const class RecursiveRelationMergeTimingProcessor : public EventProcessor {
+public:
+    RecursiveRelationMergeTimingProcessor() {
+        EventProcessorSingleton::instance().registerEventProcessor("@m-recursive-relation", this);
+    }
+    /** process event input */
+    void process(ProfileDatabase& db, const std::vector<std::string>& signature, va_list& args) override {
+        const std::string& relation = signature[1];
+        const std::string& srcLocator = signature[2];
+        microseconds start = va_arg(args, microseconds);
+        microseconds end = va_arg(args, microseconds);
+        va_arg(args, std::size_t);
+        va_arg(args, std::size_t);
+        va_arg(args, std::size_t);
+        std::string iteration = std::to_string(va_arg(args, std::size_t));
+        db.addTextEntry({"program", "relation", relation, "source-locator"}, srcLocator);
+        db.addDurationEntry(
+                {"program", "relation", relation, "iteration", iteration, "mergetime"}, start, end);
+    }
+} recursiveRelationMergeTimingProcessor;
+
 /**
  * Recursive Relation Copy Timing Profile Event Processor
  */
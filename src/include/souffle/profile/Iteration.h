@@ -29,6 +29,7 @@ private:
     std::chrono::microseconds endtime{};
     std::size_t numTuples = 0;
     std::chrono::microseconds copytime{};
+    std::chrono::microseconds mergetime{};
     std::string locator = "";
 
     std::unordered_map<std::string, std::shared_ptr<Rule>> rules;
@@ -84,6 +85,14 @@ public:
         this->copytime = copy_time;
     }
 
+    std::chrono::microseconds getMergetime() const {
+        return mergetime;
+    }
+
+    void setMergetime(std::chrono::microseconds merge_time) {
+        this->mergetime = merge_time;
+    }
+
     void setStarttime(std::chrono::microseconds time) {
         starttime = time;
     }
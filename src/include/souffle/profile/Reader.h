@@ -180,6 +180,10 @@ public:
             auto copytime = (duration.getEnd() - duration.getStart());
             base.setCopytime(copytime);
         }
+        if (duration.getKey() == "mergetime") {
+            auto mergetime = (duration.getEnd() - duration.getStart());
+            base.setMergetime(mergetime);
+        }
         DSNVisitor::visit(duration);
     }
     void visit(DirectoryEntry& directory) override {
@@ -114,6 +114,14 @@ public:
         return result;
     }
 
+    std::chrono::microseconds getMergeTime() const {
+        std::chrono::microseconds result{};
+        for (auto& iter : iterations) {
+            result += iter->getMergetime();
+        }
+        return result;
+    }
+
     std::size_t size() const {
         std::size_t result = 0;
         for (auto& iter : iterations) {
@@ -329,6 +329,12 @@ public:
                 comma(firstCol);
                 ss << i->getCopytime().count();
             }
+            ss << R"_(], "merge_t": [)_";
+            firstCol = true;
+            for (auto& i : iter) {
+                comma(firstCol);
+                ss << i->getMergetime().count();
+            }
             ss << R"_(], "tuples": [)_";
             firstCol = true;
             for (auto& i : iter) {
@@ -701,7 +707,7 @@ public:
         std::printf(
                 "  %-30s%-5s %s\n", "rul id <rule id>", "-", "display the rule name for the given rule id.");
         std::printf("  %-30s%-5s %s\n", "graph <relation id> <type>", "-",
-                "graph a relation by type: (tot_t/copy_t/tuples).");
+                "graph a relation by type: (tot_t/copy_t/merge_t/tuples).");
         std::printf("  %-30s%-5s %s\n", "graph <rule id> <type>", "-",
                 "graph recursive(C) rule by type(tot_t/tuples).");
         std::printf("  %-30s%-5s %s\n", "graph ver <rule id> <type>", "-",
@@ -1011,6 +1017,7 @@ public:
             linereader.appendTabCompletion("rel " + row[5]);
             linereader.appendTabCompletion("graph " + row[5] + " tot_t");
             linereader.appendTabCompletion("graph " + row[5] + " copy_t");
+            linereader.appendTabCompletion("graph " + row[5] + " merge_t");
             linereader.appendTabCompletion("graph " + row[5] + " tuples");
             linereader.appendTabCompletion("usage " + row[5]);
         }
@@ -1277,6 +1284,13 @@ public:
                     }
                     std::printf("%4s   %s\n\n", "NO", "COPYTIME");
                     graphByTime(list);
+                } else if (col == "merge_t") {
+                    std::vector<std::chrono::microseconds> list;
+                    for (auto& i : iter) {
+                        list.emplace_back(i->getMergetime());
+                    }
+                    std::printf("%4s   %s\n\n", "NO", "MERGETIME");
+                    graphByTime(list);
                 } else if (col == "tuples") {
                     std::vector<std::size_t> list;
                     for (auto& i : iter) {
@@ -1307,6 +1321,13 @@ public:
                     }
                     std::printf("%4s   %s\n\n", "NO", "COPYTIME");
                     graphByTime(list);
+                } else if (col == "merge_t") {
+                    std::vector<std::chrono::microseconds> list;
+                    for (auto& i : iter) {
+                        list.emplace_back(i->getMergetime());
+                    }
+                    std::printf("%4s   %s\n\n", "NO", "MERGETIME");
+                    graphByTime(list);
                 } else if (col == "tuples") {
                     std::vector<std::size_t> list;
                     for (auto& i : iter) {
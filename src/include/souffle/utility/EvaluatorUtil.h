@@ -17,9 +17,18 @@
 #pragma once
 
 #include "souffle/RamTypes.h"
+#include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StringUtil.h"
 #include "souffle/utility/tinyformat.h"
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
 #include <csignal>
+#include <cstddef>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
 
 namespace souffle::evaluator {
 
@@ -64,6 +73,122 @@ void runRange(const A from, const A to, F&& go) {
     }
 }
 
+/**
+ * Enumerates the values common to a number of sorted sets in ascending order
+ * (leapfrog intersection). Sets are accessed through `seek(i, key, value)`,
+ * which obtains the least value of set i not less than key, and returns false
+ * if there is no such value. Enumeration stops early if `go` returns false.
+ */
+template <typename A, typename S /* (std::size_t, RamDomain, RamDomain&) -> bool */,
+        typename F /* Tuple<RamDomain,1> -> bool */>
+void runIntersection(const std::size_t numSets, S&& seek, F&& go) {
+    assert(numSets > 0);
+    A key = std::numeric_limits<A>::lowest();
+    // number of consecutive sets containing the key
+    std::size_t agreed = 0;
+    for (std::size_t i = 0;; i = (i + 1) % numSets) {
+        RamDomain value;
+        if (!seek(i, ramBitCast(key), value)) {
+            return;
+        }
+        if (ramBitCast<A>(value) != key) {
+            key = ramBitCast<A>(value);
+            agreed = 0;
+        }
+        if (++agreed == numSets) {
+            if (!go(Tuple<RamDomain, 1>{ramBitCast(key)}) || key == std::numeric_limits<A>::max()) {
+                return;
+            }
+            ++key;
+            agreed = 0;
+        }
+    }
+}
+
+/**
+ * Executes a graph of tasks, where `predecessors[i]` lists the tasks which
+ * must complete before task i is started. Tasks may only depend on tasks with
+ * a lower index. Independent tasks are executed concurrently by up to
+ * `numThreads` threads (0 selects the OpenMP default); the threads are shared
+ * among the parallel regions nested in the running tasks, such that the total
+ * number of busy threads stays within the budget.
+ *
+ * A task takes its share of the threads left free by the running tasks when it
+ * starts, split evenly among the ready tasks, and returns it once completed; a
+ * ready task waits while no thread is free.
+ */
+template <typename F /* std::size_t -> void */>
+void runTaskGraph(const std::vector<std::vector<std::size_t>>& predecessors,
+        [[maybe_unused]] std::size_t numThreads, F&& go) {
+    const std::size_t numTasks = predecessors.size();
+#ifdef _OPENMP
+    if (numThreads == 0) {
+        numThreads = static_cast<std::size_t>(omp_get_max_threads());
+    }
+    if (numThreads > 1 && numTasks > 1) {
+        std::vector<std::size_t> pending(numTasks);
+        std::vector<std::vector<std::size_t>> successors(numTasks);
+        std::deque<std::size_t> ready;
+        for (std::size_t i = 0; i < numTasks; i++) {
+            pending[i] = predecessors[i].size();
+            for (std::size_t pred : predecessors[i]) {
+                assert(pred < i && "tasks must only depend on preceding tasks");
+                successors[pred].push_back(i);
+            }
+            if (pending[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+
+        std::mutex lock;
+        std::condition_variable changed;
+        std::size_t freeThreads = numThreads;
+        std::size_t completed = 0;
+
+        // tasks run their own parallel regions, hence nesting must be enabled; it is
+        // not disabled afterwards, as other task graphs may run concurrently
+        const int requiredLevels = omp_get_active_level() + 2;
+        if (omp_get_max_active_levels() < requiredLevels) {
+            omp_set_max_active_levels(requiredLevels);
+        }
+#pragma omp parallel num_threads(static_cast<int>(numThreads))
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            for (;;) {
+                changed.wait(guard,
+                        [&]() { return (!ready.empty() && freeThreads > 0) || completed == numTasks; });
+                if (completed == numTasks) {
+                    break;
+                }
+                // split the free threads evenly among the ready tasks
+                const std::size_t share = std::max<std::size_t>(1, freeThreads / ready.size());
+                const std::size_t task = ready.front();
+                ready.pop_front();
+                freeThreads -= share;
+                guard.unlock();
+
+                omp_set_num_threads(static_cast<int>(share));
+                go(task);
+
+                guard.lock();
+                freeThreads += share;
+                completed++;
+                for (std::size_t succ : successors[task]) {
+                    if (--pending[succ] == 0) {
+                        ready.push_back(succ);
+                    }
+                }
+                changed.notify_all();
+            }
+        }
+        return;
+    }
+#endif
+    for (std::size_t i = 0; i < numTasks; i++) {
+        go(i);
+    }
+}
+
 template <typename A>
 A symbol2numeric(const std::string& src) {
     try {
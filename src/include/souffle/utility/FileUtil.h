@@ -23,11 +23,13 @@
 #include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <map>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 #include <sys/stat.h>
 
 // -------------------------------------------------------------------------------
@@ -35,6 +37,8 @@
 // -------------------------------------------------------------------------------
 
 #ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #else
 #define NOMINMAX
@@ -360,4 +364,73 @@ public:
     }
 };
 
+/**
+ * A read-only view of the content of a file. The file is mapped into memory
+ * where supported, and read otherwise.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fileName) {
+#ifndef _WIN32
+        const int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) == 0) {
+            length = static_cast<std::size_t>(info.st_size);
+            if (length == 0) {
+                isOpen = true;
+            } else {
+                void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (addr != MAP_FAILED) {
+                    mapped = static_cast<const char*>(addr);
+                    isOpen = true;
+                }
+            }
+        }
+        ::close(fd);
+        if (isOpen) {
+            return;
+        }
+#endif
+        std::ifstream file(fileName, std::ios::in | std::ios::binary);
+        if (!file.is_open()) {
+            return;
+        }
+        buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        length = buffer.size();
+        isOpen = true;
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapped != nullptr) {
+            ::munmap(const_cast<char*>(mapped), length);
+        }
+#endif
+    }
+
+    bool is_open() const {
+        return isOpen;
+    }
+
+    const char* data() const {
+        return mapped != nullptr ? mapped : buffer.data();
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+private:
+    bool isOpen = false;
+    const char* mapped = nullptr;
+    std::size_t length = 0;
+    std::vector<char> buffer;
+};
+
 }  // namespace souffle
@@ -17,11 +17,14 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <vector>
 
 // https://bugs.llvm.org/show_bug.cgi?id=41423
 #if defined(__cpp_lib_hardware_interference_size) && (__cpp_lib_hardware_interference_size != 201703L)
@@ -135,6 +138,16 @@ constexpr std::size_t hardware_destructive_interference_size = 2 * sizeof(max_al
 
 namespace souffle {
 
+/** The minimal number of tuples for which a merge of relations is parallelised */
+constexpr std::size_t parallelMergeThreshold = 1 << 14;
+
+/**
+ * The number of tuples at which a thread-local insert buffer is inserted into
+ * its relation before the end of the parallel operation, bounding the memory
+ * held by buffers of threads deriving many (possibly duplicate) tuples.
+ */
+constexpr std::size_t insertBufferLimit = std::size_t(1) << 12;
+
 struct SeqConcurrentLanes {
     struct TrivialLock {
         ~TrivialLock() {}
@@ -873,6 +886,114 @@ struct ConcurrentLanes : protected SeqConcurrentLanes {
 
 #endif
 
+/**
+ * A parallel loop over the indices [0, count) whose threads steal iterations from each other.
+ *
+ * Each thread of the parallel region starts on an even share of the indices, taken from its
+ * front. A thread exhausting its share steals the back half of the share of another thread, and
+ * carries on with it as its own share. The shares of threads stuck on heavy iterations are thus
+ * split recursively among the idle threads, as long as they are not exhausted.
+ *
+ * The loop runs on the threads of the enclosing parallel region, hence on the thread pool the
+ * runtime keeps across regions, and the thread numbers used by concurrent lanes stay valid.
+ */
+class WorkStealingLoop {
+public:
+    explicit WorkStealingLoop(std::size_t count, std::size_t threads = MAX_THREADS)
+            : shares(std::max<std::size_t>(threads, 1)) {
+        const std::size_t size = count / shares.size();
+        const std::size_t remainder = count % shares.size();
+        std::size_t begin = 0;
+        for (std::size_t i = 0; i < shares.size(); ++i) {
+            shares[i].begin = begin;
+            begin += size + (i < remainder ? 1 : 0);
+            shares[i].end = begin;
+        }
+    }
+
+    WorkStealingLoop(const WorkStealingLoop&) = delete;
+    WorkStealingLoop& operator=(const WorkStealingLoop&) = delete;
+
+    /** Obtain the next iteration of the calling thread, returning false once none is left */
+    bool next(std::size_t& index) {
+        const std::size_t self = threadNum();
+        if (self < shares.size() && pop(shares[self], index)) {
+            return true;
+        }
+        for (std::size_t i = 1; i <= shares.size(); ++i) {
+            const std::size_t victim = (self + i) % shares.size();
+            if (victim != self && steal(victim, self, index)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    /** Indices [begin, end) left to a thread */
+    struct alignas(hardware_destructive_interference_size) Share {
+        SpinLock lock;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+
+    static std::size_t threadNum() {
+#ifdef _OPENMP
+        return static_cast<std::size_t>(omp_get_thread_num());
+#else
+        return 0;
+#endif
+    }
+
+    static bool pop(Share& share, std::size_t& index) {
+        std::lock_guard<SpinLock> guard(share.lock);
+        if (share.begin == share.end) {
+            return false;
+        }
+        index = share.begin++;
+        return true;
+    }
+
+    /** Steal the back half of the share of the victim, the first index of which is returned */
+    bool steal(std::size_t victim, std::size_t self, std::size_t& index) {
+        // a thread without share of its own steals a single index at a time
+        const bool owned = self < shares.size();
+        std::size_t begin;
+        std::size_t end;
+        {
+            std::lock_guard<SpinLock> guard(shares[victim].lock);
+            Share& share = shares[victim];
+            if (share.begin == share.end) {
+                return false;
+            }
+            begin = owned ? share.begin + (share.end - share.begin) / 2 : share.end - 1;
+            end = share.end;
+            share.end = begin;
+        }
+        index = begin;
+        if (begin + 1 < end) {
+            std::lock_guard<SpinLock> guard(shares[self].lock);
+            shares[self].begin = begin + 1;
+            shares[self].end = end;
+        }
+        return true;
+    }
+
+    std::vector<Share> shares;
+};
+
+// support for a parallel region whose loop steals iterations, see WorkStealingLoop
+#define PARALLEL_STEAL_START(COUNT)                    \
+    {                                                  \
+        souffle::WorkStealingLoop stealingLoop(COUNT); \
+        PARALLEL_START
+#define PARALLEL_STEAL_END \
+    PARALLEL_END           \
+    }
+
+// support for loops stealing their iterations within such a region
+#define psteal(INDEX) for (std::size_t INDEX = 0; stealingLoop.next(INDEX);)
+
 /**
  * Obtains a reference to the lock synchronizing output operations.
  */
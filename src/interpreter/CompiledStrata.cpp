@@ -0,0 +1,374 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CompiledStrata.cpp
+ *
+ * Define the strata compiled in the background while the interpreter runs.
+ ***********************************************************************/
+
+#include "interpreter/CompiledStrata.h"
+#include "ram/AbstractExistenceCheck.h"
+#include "ram/AutoIncrement.h"
+#include "ram/BinRelationStatement.h"
+#include "ram/Call.h"
+#include "ram/Clear.h"
+#include "ram/CompactRecords.h"
+#include "ram/EmptinessCheck.h"
+#include "ram/Erase.h"
+#include "ram/IO.h"
+#include "ram/Insert.h"
+#include "ram/Loop.h"
+#include "ram/Merge.h"
+#include "ram/MergeExtend.h"
+#include "ram/Query.h"
+#include "ram/Relation.h"
+#include "ram/RelationOperation.h"
+#include "ram/RelationSize.h"
+#include "ram/RelationStatement.h"
+#include "ram/Sequence.h"
+#include "ram/Statement.h"
+#include "ram/SubroutineArgument.h"
+#include "ram/SubroutineReturn.h"
+#include "ram/Swap.h"
+#include "ram/utility/Visitor.h"
+#include "souffle/profile/ProgramRun.h"
+#include "souffle/profile/Reader.h"
+#include "souffle/profile/Relation.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <utility>
+
+#ifdef _MSC_VER
+#include "souffle/utility/SubProcess.h"
+#define dlopen(libname, flags) LoadLibrary((libname))
+#define dlsym(lib, fn) GetProcAddress(static_cast<HMODULE>(lib), (fn))
+#define dlerror() "cannot load library"
+#else
+#include <csignal>
+#include <dlfcn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace souffle::interpreter {
+
+namespace {
+
+/** Relations accessed by a statement */
+std::set<std::string> accessedRelations(const ram::Node& stmt) {
+    std::set<std::string> accessed;
+    visit(stmt, [&](const ram::Insert& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::Erase& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::RelationOperation& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::RelationStatement& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::AbstractExistenceCheck& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::EmptinessCheck& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::RelationSize& node) { accessed.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::BinRelationStatement& node) {
+        accessed.insert(node.getFirstRelation());
+        accessed.insert(node.getSecondRelation());
+    });
+    return accessed;
+}
+
+/** Relations modified by a statement */
+std::set<std::string> modifiedRelations(const ram::Node& stmt) {
+    std::set<std::string> modified;
+    visit(stmt, [&](const ram::Insert& node) { modified.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::Erase& node) { modified.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::Clear& node) { modified.insert(node.getRelation()); });
+    visit(stmt, [&](const ram::IO& node) {
+        if (node.get("operation") == "input") {
+            modified.insert(node.getRelation());
+        }
+    });
+    visit(stmt, [&](const ram::Merge& node) { modified.insert(node.getTargetRelation()); });
+    visit(stmt, [&](const ram::MergeExtend& node) { modified.insert(node.getTargetRelation()); });
+    visit(stmt, [&](const ram::Swap& node) {
+        modified.insert(node.getFirstRelation());
+        modified.insert(node.getSecondRelation());
+    });
+    return modified;
+}
+
+bool isTemporary(const std::string& relation) {
+    return !relation.empty() && relation[0] == '@';
+}
+
+}  // namespace
+
+CompiledStrata::CompiledStrata(const ram::Program& program, const std::vector<std::string>& names,
+        std::string entry, std::vector<std::string> command, std::string library,
+        std::vector<std::string> temporaries)
+        : entry(std::move(entry)), library(std::move(library)), temporaries(std::move(temporaries)) {
+    std::map<std::string, const ram::Relation*> relations;
+    for (const ram::Relation* relation : program.getRelations()) {
+        relations[relation->getName()] = relation;
+    }
+
+    // The temporary relations of a stratum are internal to the compiled program
+    const auto& subroutines = program.getSubroutines();
+    for (const std::string& name : names) {
+        const ram::Statement& stmt = *subroutines.at(name);
+        const auto modified = modifiedRelations(stmt);
+        auto& accessed = strata[name];
+        for (const std::string& relation : accessedRelations(stmt)) {
+            if (isTemporary(relation)) {
+                continue;
+            }
+            std::vector<bool> symbols;
+            for (const std::string& type : relations.at(relation)->getAttributeTypes()) {
+                symbols.push_back(type[0] == 's');
+            }
+            accessed.push_back({relation, std::move(symbols), modified.count(relation) > 0});
+        }
+    }
+
+    builder = std::thread([this, command = std::move(command)]() { runBuild(command); });
+}
+
+CompiledStrata::~CompiledStrata() {
+    program.reset();
+    {
+        std::lock_guard<std::mutex> guard(build.lock);
+        build.abandoned = true;
+#ifndef _MSC_VER
+        // the compiler runs in the process group of the command
+        if (build.pid > 0) {
+            ::kill(-static_cast<pid_t>(build.pid), SIGTERM);
+        }
+#endif
+    }
+    if (builder.joinable()) {
+        builder.join();
+    }
+    std::remove(library.c_str());
+    for (const std::string& file : temporaries) {
+        std::remove(file.c_str());
+    }
+}
+
+void CompiledStrata::wait() {
+    if (builder.joinable()) {
+        builder.join();
+    }
+}
+
+void CompiledStrata::runBuild(const std::vector<std::string>& command) {
+    bool succeeded = false;
+#ifdef _MSC_VER
+    {
+        std::lock_guard<std::mutex> guard(build.lock);
+        if (build.abandoned) {
+            return;
+        }
+    }
+    const auto exit = execute(
+            command.front(), span<std::string const>{command.data() + 1, command.data() + command.size()});
+    succeeded = exit && *exit == 0;
+#else
+    std::vector<char*> argv;
+    for (const std::string& arg : command) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    // The command is started under the lock, such that it is either abandoned before it starts or
+    // stopped by the destructor; it runs in a process group of its own, along with the compiler
+    pid_t pid;
+    {
+        std::lock_guard<std::mutex> guard(build.lock);
+        if (build.abandoned) {
+            return;
+        }
+        pid = ::fork();
+        if (pid == 0) {
+            ::setpgid(0, 0);
+            ::execvp(argv[0], argv.data());
+            ::_exit(127);
+        }
+        if (pid > 0) {
+            ::setpgid(pid, pid);
+            build.pid = pid;
+        }
+    }
+    int status = 0;
+    if (pid > 0 && ::waitpid(pid, &status, 0) == pid) {
+        succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+#endif
+    for (const std::string& file : temporaries) {
+        std::remove(file.c_str());
+    }
+
+    std::lock_guard<std::mutex> guard(build.lock);
+    build.pid = 0;
+    build.done = true;
+    build.succeeded = succeeded;
+    if (!succeeded && !build.abandoned) {
+        std::cerr << "Warning: failed to compile strata" << std::endl;
+    }
+}
+
+std::vector<std::string> CompiledStrata::selectStrata(
+        const ram::Program& program, std::size_t count, const std::string& profile) {
+    // Temporary relations shared with other subroutines or with the main program are left to the
+    // interpreter
+    std::map<std::string, std::size_t> users;
+    for (const auto& relation : accessedRelations(program.getMain())) {
+        ++users[relation];
+    }
+    for (const auto& sub : program.getSubroutines()) {
+        for (const auto& relation : accessedRelations(*sub.second)) {
+            ++users[relation];
+        }
+    }
+
+    std::map<std::string, const ram::Relation*> relations;
+    for (const ram::Relation* relation : program.getRelations()) {
+        relations[relation->getName()] = relation;
+    }
+
+    // A stratum is compiled if it only exchanges numbers and symbols with the interpreter, and
+    // does not depend on the state of the interpreter
+    auto isCompilable = [&](const ram::Statement& stmt) {
+        bool compilable = true;
+        visit(stmt, [&](const ram::SubroutineArgument&) { compilable = false; });
+        visit(stmt, [&](const ram::SubroutineReturn&) { compilable = false; });
+        visit(stmt, [&](const ram::AutoIncrement&) { compilable = false; });
+        visit(stmt, [&](const ram::Call&) { compilable = false; });
+        visit(stmt, [&](const ram::CompactRecords&) { compilable = false; });
+        visit(stmt, [&](const ram::IO& io) { compilable = compilable && !io.isCheckpoint(); });
+        for (const auto& relation : accessedRelations(stmt)) {
+            if (isTemporary(relation)) {
+                compilable = compilable && users[relation] == 1;
+                continue;
+            }
+            for (const std::string& type : relations.at(relation)->getAttributeTypes()) {
+                compilable = compilable && type[0] != 'r' && type[0] != '+';
+            }
+        }
+        return compilable;
+    };
+
+    std::shared_ptr<profile::ProgramRun> run;
+    if (!profile.empty()) {
+        run = std::make_shared<profile::ProgramRun>();
+        profile::Reader reader(profile, run);
+        reader.processFile();
+    }
+
+    std::vector<std::pair<double, std::string>> weighted;
+    for (const auto& [name, stmt] : program.getSubroutines()) {
+        if (!isCompilable(*stmt)) {
+            continue;
+        }
+        double weight = 0;
+        if (run != nullptr) {
+            for (const auto& relation : modifiedRelations(*stmt)) {
+                if (const auto* profiled = run->getRelation(relation)) {
+                    const auto time = profiled->getNonRecTime() + profiled->getRecTime();
+                    weight += static_cast<double>(time.count());
+                }
+            }
+        } else {
+            visit(*stmt, [&](const ram::Query&) { weight += 1; });
+            visit(*stmt, [&](const ram::Loop& loop) {
+                visit(loop, [&](const ram::Query&) { weight += 9; });
+            });
+        }
+        if (weight > 0) {
+            weighted.emplace_back(weight, name);
+        }
+    }
+    std::stable_sort(weighted.begin(), weighted.end(),
+            [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+
+    std::vector<std::string> selected;
+    for (std::size_t i = 0; i < weighted.size() && i < count; ++i) {
+        selected.push_back(weighted[i].second);
+    }
+    return selected;
+}
+
+Own<ram::Program> CompiledStrata::extractStrata(
+        const ram::Program& program, const std::vector<std::string>& strata) {
+    const auto& subroutines = program.getSubroutines();
+    std::set<std::string> accessed;
+    std::map<std::string, Own<ram::Statement>> subs;
+    for (const std::string& name : strata) {
+        const ram::Statement& stmt = *subroutines.at(name);
+        const auto relations = accessedRelations(stmt);
+        accessed.insert(relations.begin(), relations.end());
+        subs[name] = clone(stmt);
+    }
+
+    VecOwn<ram::Relation> rels;
+    for (const ram::Relation* relation : program.getRelations()) {
+        if (accessed.count(relation->getName()) > 0) {
+            rels.push_back(clone(relation));
+        }
+    }
+    return mk<ram::Program>(std::move(rels), mk<ram::Sequence>(), std::move(subs));
+}
+
+void CompiledStrata::setNumThreads(std::size_t numThreadsValue) {
+    numThreads = numThreadsValue;
+}
+
+SouffleProgram* CompiledStrata::getProgram(const std::string& stratum) {
+    if (strata.count(stratum) == 0) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> guard(loading);
+    if (loaded) {
+        return program.get();
+    }
+
+    {
+        std::lock_guard<std::mutex> buildGuard(build.lock);
+        if (!build.done) {
+            return nullptr;
+        }
+        loaded = true;
+        if (!build.succeeded) {
+            return nullptr;
+        }
+    }
+
+    // The library remains mapped once removed
+    void* handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        std::cerr << "Warning: ignoring compiled strata: " << dlerror() << std::endl;
+    }
+    std::remove(library.c_str());
+    if (handle == nullptr) {
+        return nullptr;
+    }
+    auto* create = reinterpret_cast<SouffleProgram* (*)()>(dlsym(handle, entry.c_str()));
+    if (create == nullptr) {
+        std::cerr << "Warning: ignoring compiled strata: missing " << entry << std::endl;
+        return nullptr;
+    }
+    program.reset(create());
+    program->setNumThreads(numThreads);
+    program->setPerformIO(true);
+    return program.get();
+}
+
+const std::vector<CompiledStrata::AccessedRelation>& CompiledStrata::getAccessedRelations(
+        const std::string& stratum) const {
+    return strata.at(stratum);
+}
+
+}  // namespace souffle::interpreter
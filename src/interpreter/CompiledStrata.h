@@ -0,0 +1,154 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CompiledStrata.h
+ *
+ * Declares the strata compiled in the background while the interpreter runs.
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Program.h"
+#include "souffle/SouffleInterface.h"
+#include "souffle/utility/ContainerUtil.h"
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace souffle::interpreter {
+
+/**
+ * @class CompiledStrata
+ * @brief Strata of the program compiled into a shared library while the interpreter runs
+ *
+ * A background process builds the library. Once it is available, the strata called
+ * from then on run through the compiled program rather than the interpreter. The
+ * relations of the interpreter and of the compiled program differ in layout,
+ * hence the relations accessed by a stratum are copied into the compiled
+ * program before it runs, and the relations it modifies are copied back.
+ */
+class CompiledStrata {
+public:
+    /** A relation accessed by a compiled stratum */
+    struct AccessedRelation {
+        /** Name of the relation */
+        std::string name;
+
+        /** Whether each attribute is a symbol, encoded by different symbol tables */
+        std::vector<bool> symbols;
+
+        /** Whether the stratum modifies the relation */
+        bool modified;
+    };
+
+    /**
+     * @param program the RAM program of the interpreter
+     * @param strata the names of the compiled strata
+     * @param entry the name of the function of the library creating the compiled program
+     * @param command the command building the library, the program followed by its arguments
+     * @param library the path of the library built by the command
+     * @param temporaries the files the command builds the library from, removed once it completes
+     */
+    CompiledStrata(const ram::Program& program, const std::vector<std::string>& strata, std::string entry,
+            std::vector<std::string> command, std::string library, std::vector<std::string> temporaries);
+
+    /** Stops the build if it is still running, and removes its files */
+    ~CompiledStrata();
+
+    /** @brief Wait for the build of the library to complete */
+    void wait();
+
+    /**
+     * @brief Select the heaviest strata the compiled program can run, at most `count` of them
+     *
+     * The strata are weighed by the time spent on their relations in the given profile if
+     * any, and by the number of their queries otherwise, recursive queries counting more.
+     */
+    static std::vector<std::string> selectStrata(
+            const ram::Program& program, std::size_t count, const std::string& profile);
+
+    /** @brief Return a program of the given strata as subroutines, to be synthesised */
+    static Own<ram::Program> extractStrata(
+            const ram::Program& program, const std::vector<std::string>& strata);
+
+    /** @brief Set the number of threads of the compiled program */
+    void setNumThreads(std::size_t numThreads);
+
+    /** @brief Return the compiled program if the stratum is compiled and the library is built */
+    SouffleProgram* getProgram(const std::string& stratum);
+
+    /** @brief Return the relations accessed by a compiled stratum */
+    const std::vector<AccessedRelation>& getAccessedRelations(const std::string& stratum) const;
+
+    /** @brief Return the lock serialising the compiled strata, which share the compiled program */
+    std::mutex& getLock() {
+        return lock;
+    }
+
+private:
+    /** Runs the command building the library, in the building thread */
+    void runBuild(const std::vector<std::string>& command);
+
+    /** State of the background build, shared with the building thread */
+    struct Build {
+        std::mutex lock;
+
+        /** Whether the build has completed */
+        bool done = false;
+
+        /** Whether the library is no longer wanted, such that the build is not started */
+        bool abandoned = false;
+
+        /** Process running the command, or 0 if it is not running */
+        long pid = 0;
+
+        /** Whether the library has been built */
+        bool succeeded = false;
+    };
+
+    /** Relations accessed by each compiled stratum */
+    std::map<std::string, std::vector<AccessedRelation>> strata;
+
+    /** Name of the function creating the compiled program */
+    std::string entry;
+
+    /** Path of the library */
+    std::string library;
+
+    /** Files the library is built from */
+    std::vector<std::string> temporaries;
+
+    /** Background build of the library */
+    Build build;
+
+    /** Thread waiting for the build */
+    std::thread builder;
+
+    /** Whether the library has been loaded, or has failed to */
+    bool loaded = false;
+
+    /** Lock of the loading of the library */
+    std::mutex loading;
+
+    /** Compiled program */
+    std::unique_ptr<SouffleProgram> program;
+
+    /** Number of threads of the compiled program */
+    std::size_t numThreads = 1;
+
+    /** Lock serialising the compiled strata */
+    std::mutex lock;
+};
+
+}  // namespace souffle::interpreter
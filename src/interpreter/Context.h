@@ -19,14 +19,118 @@
 #include "interpreter/Index.h"
 #include "interpreter/Relation.h"
 #include "souffle/RamTypes.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
 namespace souffle::interpreter {
 
+/**
+ * The tuples derived by a single thread of a parallel operation for
+ * relations with insert buffers. They are inserted in bulk when the thread
+ * completes its share of the operation, avoiding the contention of
+ * concurrent insertions into the same relation.
+ */
+class InsertBuffers {
+public:
+    /** @brief Append a tuple to the buffer of the given relation, inserting the buffer once it is full */
+    void append(RelationWrapper& rel, const RamDomain* tuple) {
+        auto& buffer = getBuffer(rel);
+        buffer.insert(buffer.end(), tuple, tuple + rel.getArity());
+        if (buffer.size() >= insertBufferLimit * rel.getArity()) {
+            rel.insertBuffer(buffer.data(), buffer.size() / rel.getArity());
+            buffer.clear();
+        }
+    }
+
+    /** @brief Insert all buffered tuples into their relations */
+    void flush() {
+        for (auto& [rel, buffer] : buffers) {
+            rel->insertBuffer(buffer.data(), buffer.size() / rel->getArity());
+            buffer.clear();
+        }
+    }
+
+private:
+    std::vector<RamDomain>& getBuffer(RelationWrapper& rel) {
+        // operations insert into few relations, hence a linear search suffices
+        for (auto& [cur, buffer] : buffers) {
+            if (cur == &rel) {
+                return buffer;
+            }
+        }
+        buffers.emplace_back(&rel, std::vector<RamDomain>());
+        return buffers.back().second;
+    }
+
+    /** @brief The buffers of the relations, storing tuples consecutively */
+    std::vector<std::pair<RelationWrapper*, std::vector<RamDomain>>> buffers;
+};
+
+/**
+ * A block of tuples of a batch scan, with a selection vector of the tuples
+ * satisfying the conditions evaluated so far. Conditions and expressions are
+ * evaluated for all selected tuples at once rather than tuple by tuple.
+ */
+class Batch {
+public:
+    /** @brief The maximal number of tuples of a block */
+    static constexpr std::size_t SIZE = 1024;
+
+    Batch(std::size_t tupleId, std::size_t arity) : tupleId(tupleId), arity(arity) {}
+
+    /** @brief Select all tuples of a block of consecutive tuples */
+    void reset(const RamDomain* block, std::size_t count) {
+        assert(count <= SIZE && "block exceeds the batch size");
+        tuples = block;
+        selected = count;
+        std::iota(selection.begin(), selection.begin() + count, 0);
+    }
+
+    /** @brief Get the identifier of the tuples in the context */
+    std::size_t getTupleId() const {
+        return tupleId;
+    }
+
+    /** @brief Get the number of selected tuples */
+    std::size_t size() const {
+        return selected;
+    }
+
+    bool empty() const {
+        return selected == 0;
+    }
+
+    /** @brief Get the i-th selected tuple */
+    const RamDomain* getTuple(std::size_t i) const {
+        return tuples + selection[i] * arity;
+    }
+
+    /** @brief Keep the i-th selected tuple if and only if keep(i) holds */
+    template <typename Predicate>
+    void retain(Predicate keep) {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < selected; ++i) {
+            selection[count] = selection[i];
+            count += keep(i) ? 1 : 0;
+        }
+        selected = count;
+    }
+
+private:
+    const std::size_t tupleId;
+    const std::size_t arity;
+    const RamDomain* tuples = nullptr;
+    std::size_t selected = 0;
+    std::array<std::uint16_t, SIZE> selection;
+};
+
 /**
  * Evaluation context for Interpreter operations
  */
@@ -37,29 +141,29 @@ public:
     Context(std::size_t size = 0) : data(size) {}
 
     /** This constructor is used when program enter a new scope.
-     * Only Subroutine value needs to be copied */
-    Context(Context& ctxt) : returnValues(ctxt.returnValues), args(ctxt.args) {}
+     * Only Subroutine values and variables need to be copied, and the frame
+     * is allocated at the size of the enclosing one */
+    Context(Context& ctxt)
+            : data(ctxt.data.size()), returnValues(ctxt.returnValues), args(ctxt.args),
+              insertBuffers(ctxt.insertBuffers), variables(ctxt.variables) {}
     virtual ~Context() = default;
 
-    const RamDomain*& operator[](std::size_t index) {
-        if (index >= data.size()) {
-            data.resize((index + 1));
+    /** @brief Allocate the frame of a query, whose tuples are bound to the slots [0, size) */
+    void reserveFrame(std::size_t size) {
+        if (data.size() < size) {
+            data.resize(size);
         }
-        return data[index];
     }
 
-    const RamDomain* const& operator[](std::size_t index) const {
+    /** @brief Get the slot of a tuple, within the frame */
+    const RamDomain*& operator[](std::size_t index) {
+        assert(index < data.size() && "tuple slot outside of the frame");
         return data[index];
     }
 
-    /** @brief Allocate a tuple.
-     *  allocatedDataContainer has the ownership of those tuples. */
-    RamDomain* allocateNewTuple(std::size_t size) {
-        Own<RamDomain[]> newTuple(new RamDomain[size]);
-        allocatedDataContainer.push_back(std::move(newTuple));
-
-        // Return the reference as raw pointer.
-        return allocatedDataContainer.back().get();
+    const RamDomain* const& operator[](std::size_t index) const {
+        assert(index < data.size() && "tuple slot outside of the frame");
+        return data[index];
     }
 
     /** @brief Get subroutine return value */
@@ -109,6 +213,16 @@ public:
         return views[id].get();
     }
 
+    /** @brief Get the insert buffers of the enclosing parallel operation, if any */
+    InsertBuffers* getInsertBuffers() const {
+        return insertBuffers;
+    }
+
+    /** @brief Set the insert buffers of the current thread */
+    void setInsertBuffers(InsertBuffers* buffers) {
+        insertBuffers = buffers;
+    }
+
     RamDomain getVariable(const std::string& name) {
         return variables[name];
     }
@@ -118,16 +232,16 @@ public:
     }
 
 private:
-    /** @brief Run-time value */
+    /** @brief Frame of the tuples bound by the current query, one slot per tuple identifier */
     std::vector<const RamDomain*> data;
     /** @brief Subroutine return value */
     std::vector<RamDomain>* returnValues = nullptr;
     /** @brief Subroutine arguments */
     const std::vector<RamDomain>* args = nullptr;
-    /** @bref Allocated data */
-    VecOwn<RamDomain[]> allocatedDataContainer;
     /** @brief Views */
     VecOwn<ViewWrapper> views;
+    /** @brief Insert buffers of the current thread */
+    InsertBuffers* insertBuffers = nullptr;
     std::map<std::string, RamDomain> variables;
 };
 
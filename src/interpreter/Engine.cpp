@@ -29,6 +29,7 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/CompactRecords.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
 #include "ram/DebugInfo.h"
@@ -46,11 +47,13 @@
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
 #include "ram/IntrinsicAggregator.h"
+#include "ram/Intersection.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -68,13 +71,16 @@
 #include "ram/Query.h"
 #include "ram/Relation.h"
 #include "ram/RelationSize.h"
+#include "ram/Restore.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
+#include "ram/Spill.h"
 #include "ram/Statement.h"
 #include "ram/StringConstant.h"
 #include "ram/SubroutineArgument.h"
 #include "ram/SubroutineReturn.h"
 #include "ram/Swap.h"
+#include "ram/TaskGraph.h"
 #include "ram/TranslationUnit.h"
 #include "ram/True.h"
 #include "ram/TupleElement.h"
@@ -90,14 +96,17 @@
 #include "souffle/SignalHandler.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/TypeAttribute.h"
+#include "souffle/datastructure/RecordRelocator.h"
 #include "souffle/datastructure/RecordTableImpl.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/datastructure/TableSnapshot.h"
 #include "souffle/io/IOSystem.h"
 #include "souffle/io/ReadStream.h"
 #include "souffle/io/WriteStream.h"
 #include "souffle/profile/Logger.h"
 #include "souffle/profile/ProfileEvent.h"
 #include "souffle/utility/EvaluatorUtil.h"
+#include "souffle/utility/FileUtil.h"
 #include "souffle/utility/MiscUtil.h"
 #include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StringUtil.h"
@@ -114,10 +123,13 @@
 #include <iterator>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <regex>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -300,6 +312,17 @@ RamDomain callStateless(ExecuteFn&& execute, Context& ctxt, Shadow& shadow, souf
     }
 }
 
+/** Create the symbol table selected by the configuration */
+Own<SymbolTable> makeSymbolTable(Global& global, const std::size_t numOfThreads) {
+    if (global.config().has("arena-symbols")) {
+        return mk<ArenaSymbolTable>(numOfThreads);
+    }
+    if (global.config().has("sharded-symbols")) {
+        return mk<ShardedSymbolTable>(numOfThreads);
+    }
+    return mk<SymbolTableImpl>(numOfThreads);
+}
+
 }  // namespace
 
 Engine::Engine(ram::TranslationUnit& tUnit, const std::size_t numberOfThreadsOrZero)
@@ -307,7 +330,9 @@ Engine::Engine(ram::TranslationUnit& tUnit, const std::size_t numberOfThreadsOrZ
           frequencyCounterEnabled(global.config().has("profile-frequency")),
           numOfThreads(number_of_threads(numberOfThreadsOrZero)),
           isa(tUnit.getAnalysis<ram::analysis::IndexAnalysis>()), recordTable(numOfThreads),
-          symbolTable(numOfThreads), regexCache(numOfThreads) {}
+          symbolTable(makeSymbolTable(global, numOfThreads)),
+          regexCache(numOfThreads), workStealing(global.config().has("work-stealing")),
+          spillStore(global.config().get("spill-dir")) {}
 
 Engine::RelationHandle& Engine::getRelationHandle(const std::size_t idx) {
     return *relations[idx];
@@ -328,13 +353,72 @@ Global& Engine::getGlobal() {
 }
 
 SymbolTable& Engine::getSymbolTable() {
-    return symbolTable;
+    return *symbolTable;
 }
 
 RecordTable& Engine::getRecordTable() {
     return recordTable;
 }
 
+void Engine::setCompiledStrata(Own<CompiledStrata> strata) {
+    compiledStrata = std::move(strata);
+    compiledStrata->setNumThreads(numOfThreads);
+}
+
+bool Engine::executeCompiledStratum(const std::string& name) {
+    SouffleProgram* program = compiledStrata->getProgram(name);
+    if (program == nullptr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> guard(compiledStrata->getLock());
+
+    std::map<std::string, RelationWrapper*> interpreted;
+    for (auto& handle : relations) {
+        if (handle != nullptr) {
+            interpreted[(*handle)->getName()] = handle->get();
+        }
+    }
+
+    // The relations are copied, translating symbols between the symbol tables
+    SymbolTable& compiledSymbols = program->getSymbolTable();
+    const auto& accessed = compiledStrata->getAccessedRelations(name);
+    for (const auto& relation : accessed) {
+        const RelationWrapper& source = *interpreted.at(relation.name);
+        souffle::Relation& target = *program->getRelation(relation.name);
+        target.purge();
+        tuple values(&target);
+        for (const RamDomain* row : source) {
+            for (std::size_t i = 0; i < relation.symbols.size(); ++i) {
+                values[i] =
+                        relation.symbols[i] ? compiledSymbols.encode(symbolTable->decode(row[i])) : row[i];
+            }
+            target.insert(values);
+        }
+    }
+
+    std::vector<RamDomain> args;
+    std::vector<RamDomain> ret;
+    program->executeSubroutine(name, args, ret);
+
+    for (const auto& relation : accessed) {
+        if (!relation.modified) {
+            continue;
+        }
+        RelationWrapper& target = *interpreted.at(relation.name);
+        const souffle::Relation& source = *program->getRelation(relation.name);
+        target.purge();
+        std::vector<RamDomain> values(relation.symbols.size());
+        for (const tuple& row : source) {
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                values[i] =
+                        relation.symbols[i] ? symbolTable->encode(compiledSymbols.decode(row[i])) : row[i];
+            }
+            target.insert(values.data());
+        }
+    }
+    return true;
+}
+
 ram::TranslationUnit& Engine::getTranslationUnit() {
     return tUnit;
 }
@@ -366,6 +450,8 @@ void Engine::createRelation(const ram::Relation& id, const std::size_t idx) {
         res = createEqrelRelation(id, isa.getIndexSelection(id.getName()));
     } else if (id.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
         res = createBTreeDeleteRelation(id, isa.getIndexSelection(id.getName()));
+    } else if (id.getRepresentation() == RelationRepresentation::HASHSET) {
+        res = createHashsetRelation(id, isa.getIndexSelection(id.getName()));
     } else {
         res = createBTreeRelation(id, isa.getIndexSelection(id.getName()));
     }
@@ -441,6 +527,12 @@ void Engine::executeMain() {
      * must be able to find actual functions for each user-defined functor. */
     loadDLL();
 
+    /* Must load the table snapshot before generating IR, because the generator
+     * encodes the string constants of the program. */
+    if (global.config().has("table-snapshot")) {
+        loadTableSnapshot(global.config().get("table-snapshot"));
+    }
+
     generateIR();
     assert(main != nullptr && "Executing an empty program");
 
@@ -494,22 +586,68 @@ void Engine::executeMain() {
                     "@relation-reads;" + cur.first, cur.second, 0);
         }
     }
+    if (global.config().has("table-snapshot")) {
+        saveTableSnapshot(global.config().get("table-snapshot"));
+    }
     SignalHandler::instance()->reset();
 }
 
+void Engine::loadTableSnapshot(const std::string& fileName) {
+    if (!existFile(fileName)) {
+        return;
+    }
+    try {
+        importTableSnapshot(*symbolTable, recordTable, TableSnapshot::open(fileName));
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Warning: ignoring table snapshot: " << e.what() << std::endl;
+    }
+}
+
+void Engine::saveTableSnapshot(const std::string& fileName) {
+    try {
+        TableSnapshotWriter writer;
+        symbolTable->exportSnapshot(writer);
+        recordTable.exportSnapshot(writer);
+        writer.write(fileName);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Warning: " << e.what() << std::endl;
+    }
+}
+
 void Engine::generateIR() {
     const ram::Program& program = tUnit.getProgram();
-    NodeGenerator generator(*this);
+    if (generator == nullptr) {
+        generator = mk<NodeGenerator>(*this);
+    }
     if (subroutine.empty()) {
         for (const auto& sub : program.getSubroutines()) {
-            subroutine.emplace(std::make_pair("stratum_" + sub.first, generator.generateTree(*sub.second)));
+            subroutine.emplace(std::make_pair("stratum_" + sub.first, generator->generateTree(*sub.second)));
         }
     }
     if (main == nullptr) {
-        main = generator.generateTree(program.getMain());
+        main = generator->generateTree(program.getMain());
     }
 }
 
+const Node* Engine::planJoins(JoinPlanner& planner) {
+    std::vector<std::size_t> sizes;
+    for (std::size_t id : planner.getRelationIds()) {
+        sizes.push_back(getRelationHandle(id)->size());
+    }
+    planner.replan(sizes);
+    if (planner.isOriginalOrder()) {
+        return nullptr;
+    }
+    if (planner.getPlan() == nullptr) {
+        // queries of a stratum may run concurrently
+        std::lock_guard<std::mutex> guard(generatorLock);
+        auto query = planner.reorder();
+        auto node = generator->generateTree(*query);
+        planner.setPlan(std::move(query), std::move(node));
+    }
+    return planner.getPlan();
+}
+
 void Engine::executeSubroutine(
         const std::string& name, const std::vector<RamDomain>& args, std::vector<RamDomain>& ret) {
     Context ctxt;
@@ -519,6 +657,14 @@ void Engine::executeSubroutine(
     execute(subroutine["stratum_" + name].get(), ctxt);
 }
 
+// Threaded dispatch relies on the labels-as-values extension of GCC and Clang
+#if defined(__GNUC__) && !defined(_MSC_VER)
+#define SOUFFLE_THREADED_DISPATCH
+#define DISPATCH_LABEL(tok) L_##tok:
+#else
+#define DISPATCH_LABEL(tok)
+#endif
+
 RamDomain Engine::execute(const Node* node, Context& ctxt) {
 #define DEBUG(Kind) std::cout << "Running Node: " << #Kind << "\n";
 #define EVAL_CHILD(ty, idx) ramBitCast<ty>(execute(shadow.getChild(idx), ctxt))
@@ -532,13 +678,14 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 #define CASE(...) GET_MACRO(__VA_ARGS__, EXTEND_CASE, _Dummy, _Dummy2, BASE_CASE)(__VA_ARGS__)
 
 #define BASE_CASE(Kind) \
-    case (I_##Kind): {  \
+    case (I_##Kind): DISPATCH_LABEL(I_##Kind) {  \
         return [&]() -> RamDomain { \
             [[maybe_unused]] const auto& shadow = *static_cast<const interpreter::Kind*>(node); \
             [[maybe_unused]] const auto& cur = *static_cast<const ram::Kind*>(node->getShadow());
 // EXTEND_CASE also defer the relation type
 #define EXTEND_CASE(Kind, Structure, Arity, AuxiliaryArity)       \
-    case (I_##Kind##_##Structure##_##Arity##_##AuxiliaryArity): { \
+    case (I_##Kind##_##Structure##_##Arity##_##AuxiliaryArity): \
+    DISPATCH_LABEL(I_##Kind##_##Structure##_##Arity##_##AuxiliaryArity) { \
         return [&]() -> RamDomain { \
             [[maybe_unused]] const auto& shadow = *static_cast<const interpreter::Kind*>(node); \
             [[maybe_unused]] const auto& cur = *static_cast<const ram::Kind*>(node->getShadow());\
@@ -571,6 +718,19 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         high[expr.first] = execute(expr.second.get(), ctxt);            \
     }
 
+#ifdef SOUFFLE_THREADED_DISPATCH
+    // Jump to the case of the node through the table of the addresses of the cases, indexed by the node
+    // type resolved when generating the node
+#define LABEL_ADDRESS(tok) &&L_I_##tok,
+#define EXPAND_LABEL_ADDRESS(structure, arity, auxiliaryArity, tok) \
+    &&L_I_##tok##_##structure##_##arity##_##auxiliaryArity,
+    static const void* const dispatchTable[] = {
+            FOR_EACH_INTERPRETER_TOKEN(LABEL_ADDRESS, EXPAND_LABEL_ADDRESS)};
+#undef LABEL_ADDRESS
+#undef EXPAND_LABEL_ADDRESS
+    goto* dispatchTable[node->getType()];
+#endif
+
     switch (node->getType()) {
         CASE(NumericConstant)
             return cur.getConstant();
@@ -656,7 +816,7 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                 /** Unary Functor Operators */
                 case FunctorOp::ORD: return execute(shadow.getChild(0), ctxt);
                 case FunctorOp::STRLEN:
-                    return getSymbolTable().decode(execute(shadow.getChild(0), ctxt)).size();
+                    return getSymbolTable().decodeView(execute(shadow.getChild(0), ctxt)).size();
                 case FunctorOp::NEG: return -execute(shadow.getChild(0), ctxt);
                 case FunctorOp::FNEG: {
                     RamDomain result = execute(shadow.getChild(0), ctxt);
@@ -760,7 +920,7 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                 case FunctorOp::CAT: {
                     std::stringstream ss;
                     for (std::size_t i = 0; i < args.size(); i++) {
-                        ss << getSymbolTable().decode(execute(shadow.getChild(i), ctxt));
+                        ss << getSymbolTable().decodeView(execute(shadow.getChild(i), ctxt));
                     }
                     return getSymbolTable().encode(ss.str());
                 }
@@ -963,7 +1123,7 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
             for (std::size_t i = 0; i < arity; ++i) {
                 data[i] = execute(shadow.getChild(i), ctxt);
             }
-            return getRecordTable().pack(data.get(), arity);
+            return packRecord(getRecordTable(), data.get(), arity, cur.getUnboxedWidths());
         ESAC(PackRecord)
 
         CASE(SubroutineArgument)
@@ -1024,8 +1184,8 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         // clang-format off
 #define COMPARE_NUMERIC(ty, op) return EVAL_LEFT(ty) op EVAL_RIGHT(ty)
 #define COMPARE_STRING(op)                                        \
-    return (getSymbolTable().decode(EVAL_LEFT(RamDomain)) op \
-            getSymbolTable().decode(EVAL_RIGHT(RamDomain)))
+    return (getSymbolTable().decodeView(EVAL_LEFT(RamDomain)) op \
+            getSymbolTable().decodeView(EVAL_RIGHT(RamDomain)))
 #define COMPARE_EQ_NE(opCode, op)                                         \
     case BinaryConstraintOp::   opCode: COMPARE_NUMERIC(RamDomain  , op); \
     case BinaryConstraintOp::F##opCode: COMPARE_NUMERIC(RamFloat   , op);
@@ -1048,21 +1208,21 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                 case BinaryConstraintOp::MATCH: {
                     bool result = false;
                     RamDomain right = execute(shadow.getRhs(), ctxt);
-                    const std::string& text = getSymbolTable().decode(right);
+                    const std::string_view text = getSymbolTable().decodeView(right);
 
                     const Node* patternNode = shadow.getLhs();
                     if (const RegexConstant* regexNode = dynamic_cast<const RegexConstant*>(patternNode);
                             regexNode) {
                         const auto& regex = regexNode->getRegex();
                         if (regex) {
-                            result = std::regex_match(text, *regex);
+                            result = std::regex_match(text.begin(), text.end(), *regex);
                         }
                     } else {
                         RamDomain left = execute(patternNode, ctxt);
                         const std::string& pattern = getSymbolTable().decode(left);
                         try {
                             const std::regex& regex = regexCache.getOrCreate(pattern);
-                            result = std::regex_match(text, regex);
+                            result = std::regex_match(text.begin(), text.end(), regex);
                         } catch (...) {
                             std::cerr << "warning: wrong pattern provided for match(\"" << pattern << "\",\""
                                       << text << "\").\n";
@@ -1074,21 +1234,21 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                 case BinaryConstraintOp::NOT_MATCH: {
                     bool result = false;
                     RamDomain right = execute(shadow.getRhs(), ctxt);
-                    const std::string& text = getSymbolTable().decode(right);
+                    const std::string_view text = getSymbolTable().decodeView(right);
 
                     const Node* patternNode = shadow.getLhs();
                     if (const RegexConstant* regexNode = dynamic_cast<const RegexConstant*>(patternNode);
                             regexNode) {
                         const auto& regex = regexNode->getRegex();
                         if (regex) {
-                            result = !std::regex_match(text, *regex);
+                            result = !std::regex_match(text.begin(), text.end(), *regex);
                         }
                     } else {
                         RamDomain left = execute(patternNode, ctxt);
                         const std::string& pattern = getSymbolTable().decode(left);
                         try {
                             const std::regex& regex = regexCache.getOrCreate(pattern);
-                            result = !std::regex_match(text, regex);
+                            result = !std::regex_match(text.begin(), text.end(), regex);
                         } catch (...) {
                             std::cerr << "warning: wrong pattern provided for !match(\"" << pattern << "\",\""
                                       << text << "\").\n";
@@ -1099,16 +1259,16 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
                 case BinaryConstraintOp::CONTAINS: {
                     RamDomain left = execute(shadow.getLhs(), ctxt);
                     RamDomain right = execute(shadow.getRhs(), ctxt);
-                    const std::string& pattern = getSymbolTable().decode(left);
-                    const std::string& text = getSymbolTable().decode(right);
-                    return text.find(pattern) != std::string::npos;
+                    const std::string_view pattern = getSymbolTable().decodeView(left);
+                    const std::string_view text = getSymbolTable().decodeView(right);
+                    return text.find(pattern) != std::string_view::npos;
                 }
                 case BinaryConstraintOp::NOT_CONTAINS: {
                     RamDomain left = execute(shadow.getLhs(), ctxt);
                     RamDomain right = execute(shadow.getRhs(), ctxt);
-                    const std::string& pattern = getSymbolTable().decode(left);
-                    const std::string& text = getSymbolTable().decode(right);
-                    return text.find(pattern) == std::string::npos;
+                    const std::string_view pattern = getSymbolTable().decodeView(left);
+                    const std::string_view text = getSymbolTable().decodeView(right);
+                    return text.find(pattern) == std::string_view::npos;
                 }
             }
 
@@ -1120,6 +1280,37 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 #undef COMPARE_EQ_NE
         ESAC(Constraint)
 
+        case I_ConstantConstraint: DISPATCH_LABEL(I_ConstantConstraint) {
+            const auto& shadow = *static_cast<const ConstantConstraint*>(node);
+            const RamDomain value = ctxt[shadow.getTupleId()][shadow.getElement()];
+            const RamDomain constant = shadow.getConstant();
+            // clang-format off
+#define COMPARE_CONSTANT(opCode, ty, op) \
+    case BinaryConstraintOp::opCode: return ramBitCast<ty>(value) op ramBitCast<ty>(constant);
+            // clang-format on
+            switch (shadow.getOperator()) {
+                COMPARE_CONSTANT(EQ, RamDomain, ==)
+                COMPARE_CONSTANT(FEQ, RamFloat, ==)
+                COMPARE_CONSTANT(NE, RamDomain, !=)
+                COMPARE_CONSTANT(FNE, RamFloat, !=)
+                COMPARE_CONSTANT(LT, RamSigned, <)
+                COMPARE_CONSTANT(ULT, RamUnsigned, <)
+                COMPARE_CONSTANT(FLT, RamFloat, <)
+                COMPARE_CONSTANT(LE, RamSigned, <=)
+                COMPARE_CONSTANT(ULE, RamUnsigned, <=)
+                COMPARE_CONSTANT(FLE, RamFloat, <=)
+                COMPARE_CONSTANT(GT, RamSigned, >)
+                COMPARE_CONSTANT(UGT, RamUnsigned, >)
+                COMPARE_CONSTANT(FGT, RamFloat, >)
+                COMPARE_CONSTANT(GE, RamSigned, >=)
+                COMPARE_CONSTANT(UGE, RamUnsigned, >=)
+                COMPARE_CONSTANT(FGE, RamFloat, >=)
+                default: break;
+            }
+#undef COMPARE_CONSTANT
+            UNREACHABLE_BAD_CASE_ANALYSIS
+        }
+
         CASE(TupleOperation)
             bool result = execute(shadow.getChild(), ctxt);
 
@@ -1142,6 +1333,12 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
     ESAC(Scan)
 
         FOR_EACH(SCAN)
+
+        // batch scans share the RAM node of scans
+        case I_BatchScan: DISPATCH_LABEL(I_BatchScan) {
+            const auto& shadow = *static_cast<const BatchScan*>(node);
+            return evalBatchScan(*static_cast<const ram::Scan*>(node->getShadow()), shadow, ctxt);
+        }
 #undef SCAN
 
 #define PARALLEL_SCAN(Structure, Arity, AuxiliaryArity, ...)            \
@@ -1204,6 +1401,16 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         FOR_EACH(PARALLEL_INDEX_IFEXISTS)
 #undef PARALLEL_INDEX_IFEXISTS
 
+        CASE(Intersection)
+            return evalIntersection(cur, shadow, ctxt);
+        ESAC(Intersection)
+
+#define INTERSECTION_SOURCE(Structure, Arity, AuxiliaryArity, ...) \
+    case (I_IntersectionSource_##Structure##_##Arity##_##AuxiliaryArity):
+        FOR_EACH(INTERSECTION_SOURCE)
+#undef INTERSECTION_SOURCE
+            fatal("intersection sources are evaluated by their intersection");
+
         CASE(UnpackRecord)
             RamDomain ref = execute(shadow.getExpr(), ctxt);
 
@@ -1214,7 +1421,9 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 
             // update environment variable
             std::size_t arity = cur.getArity();
-            const RamDomain* tuple = getRecordTable().unpack(ref, arity);
+            RamDomain unboxed[MAX_UNBOXED_ARITY];
+            const RamDomain* tuple =
+                    unpackRecord(getRecordTable(), ref, arity, cur.getUnboxedWidths(), unboxed);
 
             // save reference to temporary value
             ctxt[cur.getTupleId()] = tuple;
@@ -1332,14 +1541,28 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(Sequence)
 
         CASE(Parallel)
-            for (const auto& child : shadow.getChildren()) {
-                if (!execute(child.get(), ctxt)) {
-                    return false;
-                }
-            }
-            return true;
+            // the statements are independent tasks, sharing the threads of the enclosing scope
+            const auto& children = shadow.getChildren();
+            std::atomic<bool> result{true};
+            evaluator::runTaskGraph(
+                    std::vector<std::vector<std::size_t>>(children.size()), 0, [&](std::size_t task) {
+                        Context taskCtxt(ctxt);
+                        if (!execute(children[task].get(), taskCtxt)) {
+                            result = false;
+                        }
+                    });
+            return result;
         ESAC(Parallel)
 
+        CASE(TaskGraph)
+            evaluator::runTaskGraph(cur.getPredecessors(), numOfThreads, [&](std::size_t task) {
+                // concurrent tasks must not share views
+                Context taskCtxt(ctxt);
+                execute(shadow.getChild(task), taskCtxt);
+            });
+            return true;
+        ESAC(TaskGraph)
+
         CASE(Loop)
             resetIterationNumber();
             while (execute(shadow.getChild(), ctxt)) {
@@ -1389,10 +1612,80 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
 #undef ESTIMATEJOINSIZE
 
         CASE(Call)
-            execute(subroutine[shadow.getSubroutineName()].get(), ctxt);
+            // The subroutine of a stratum is called as "stratum_<subroutine>"
+            if (compiledStrata == nullptr ||
+                    !executeCompiledStratum(cur.getName().substr(std::strlen("stratum_")))) {
+                execute(subroutine.at(shadow.getSubroutineName()).get(), ctxt);
+            }
             return true;
         ESAC(Call)
 
+        CASE(CompactRecords)
+            recordTable.compact([&](const RecordTable& source, RecordTable& target) {
+                RecordRelocator relocator(source, target, cur.getTypes());
+                for (const auto& [handle, ramRelation] : shadow.getRelations()) {
+                    auto& rel = **handle;
+                    const auto& types = ramRelation->getAttributeTypes();
+                    const std::size_t arity = rel.getArity();
+                    if (rel.size() == 0) {
+                        continue;
+                    }
+
+                    // the tuples are reinserted, as their order depends on the references
+                    std::vector<RamDomain> tuples;
+                    tuples.reserve(rel.size() * arity);
+                    for (const RamDomain* tuple : rel) {
+                        tuples.insert(tuples.end(), tuple, tuple + arity);
+                    }
+                    rel.purge();
+                    for (std::size_t i = 0; i < types.size(); ++i) {
+                        const auto type = relocator.getType(types[i]);
+                        if (!relocator.isReference(type)) {
+                            continue;
+                        }
+                        for (std::size_t pos = i; pos < tuples.size(); pos += arity) {
+                            tuples[pos] = relocator.relocate(tuples[pos], type);
+                        }
+                    }
+                    rel.insertBatch(tuples.data(), tuples.size() / arity);
+                }
+            });
+            return true;
+        ESAC(CompactRecords)
+
+        CASE(Spill)
+            // the memory of a relation is estimated as that of its tuples in each of its indexes
+            auto getFootprint = [](const RelationWrapper& rel) {
+                return rel.size() * rel.getArity() * sizeof(RamDomain) * rel.getNumberOfIndexes();
+            };
+            std::size_t footprint = 0;
+            for (const auto& handle : relations) {
+                if (handle != nullptr && *handle != nullptr) {
+                    footprint += getFootprint(**handle);
+                }
+            }
+            for (RelationHandle* handle : shadow.getRelations()) {
+                if (footprint <= cur.getBudget()) {
+                    break;
+                }
+                auto& rel = **handle;
+                const std::size_t relFootprint = getFootprint(rel);
+                spillStore.spill(rel.getName(), rel, rel.getArity());
+                if (rel.size() == 0) {
+                    footprint -= relFootprint;
+                }
+            }
+            return true;
+        ESAC(Spill)
+
+        CASE(Restore)
+            for (RelationHandle* handle : shadow.getRelations()) {
+                auto& rel = **handle;
+                spillStore.restore(rel.getName(), rel, rel.getArity());
+            }
+            return true;
+        ESAC(Restore)
+
         CASE(LogSize)
             const auto& rel = *shadow.getRelation();
             ProfileEventSingleton::instance().makeQuantityEvent(
@@ -1432,6 +1725,13 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(IO)
 
         CASE(Query)
+            // recursive queries run with their joins in the order selected for the current iteration
+            if (JoinPlanner* planner = shadow.getJoinPlanner()) {
+                if (const Node* plan = planJoins(*planner)) {
+                    return execute(plan, ctxt);
+                }
+            }
+            ctxt.reserveFrame(shadow.getFrameSize());
             ViewContext* viewContext = shadow.getViewContext();
 
             // Execute view-free operations in outer filter if any.
@@ -1469,6 +1769,17 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
             return true;
         ESAC(Query)
 
+#define MERGE(Structure, Arity, AuxiliaryArity, ...)                                           \
+    CASE(Merge, Structure, Arity, AuxiliaryArity)                                               \
+        const auto& src = *static_cast<RelType*>(getRelationHandle(shadow.getSourceId()).get()); \
+        auto& trg = *static_cast<RelType*>(getRelationHandle(shadow.getTargetId()).get());       \
+        trg.insert(src, numOfThreads > 1 ? numOfThreads * 20 : 1);                              \
+        return true;                                                                            \
+    ESAC(Merge)
+
+        FOR_EACH(MERGE)
+#undef MERGE
+
         CASE(MergeExtend)
             auto& src = *static_cast<EqrelRelation*>(getRelationHandle(shadow.getSourceId()).get());
             auto& trg = *static_cast<EqrelRelation*>(getRelationHandle(shadow.getTargetId()).get());
@@ -1489,6 +1800,13 @@ RamDomain Engine::execute(const Node* node, Context& ctxt) {
         ESAC(Assign)
     }
 
+#ifdef SOUFFLE_THREADED_DISPATCH
+    // the sources of intersections are evaluated by their intersection
+#define INTERSECTION_SOURCE(Structure, Arity, AuxiliaryArity, ...) \
+    DISPATCH_LABEL(I_IntersectionSource_##Structure##_##Arity##_##AuxiliaryArity)
+    FOR_EACH(INTERSECTION_SOURCE)
+#undef INTERSECTION_SOURCE
+#endif
     UNREACHABLE_BAD_CASE_ANALYSIS
 
 #undef EVAL_CHILD
@@ -1585,46 +1903,280 @@ RamDomain Engine::evalProvenanceExistenceCheck(const ProvenanceExistenceCheck& s
     return (*equalRange.begin())[Arity - 1] <= execute(shadow.getChild(), ctxt);
 }
 
+inline bool Engine::executeNested(const Scan& shadow, Context& ctxt) {
+    for (const Node* condition : shadow.getFusedFilters()) {
+        if (!execute(condition, ctxt)) {
+            return true;
+        }
+    }
+    return execute(shadow.getFusedOperation(), ctxt);
+}
+
 template <typename Rel>
 RamDomain Engine::evalScan(const Rel& rel, const ram::Scan& cur, const Scan& shadow, Context& ctxt) {
     for (const auto& tuple : rel.scan()) {
         ctxt[cur.getTupleId()] = tuple.data();
-        if (!execute(shadow.getNestedOperation(), ctxt)) {
+        if (!executeNested(shadow, ctxt)) {
             break;
         }
     }
     return true;
 }
 
-template <typename Rel>
-RamDomain Engine::evalParallelScan(
-        const Rel& rel, const ram::ParallelScan& cur, const ParallelScan& shadow, Context& ctxt) {
-    auto viewContext = shadow.getViewContext();
+RamDomain Engine::evalBatchScan(const ram::Scan& cur, const BatchScan& shadow, Context& ctxt) {
+    Batch batch(cur.getTupleId(), shadow.getRelation()->getArity());
+    shadow.getRelation()->scanBlocks(Batch::SIZE, [&](const RamDomain* block, std::size_t count) {
+        batch.reset(block, count);
+        for (const Node* condition : shadow.getFilters()) {
+            filterBatch(condition, batch, ctxt);
+            if (batch.empty()) {
+                return true;
+            }
+        }
+        if (shadow.getInsert() != nullptr) {
+            insertBatch(*shadow.getInsert(), batch, ctxt);
+            return true;
+        }
+        for (std::size_t i = 0; i < batch.size(); ++i) {
+            ctxt[cur.getTupleId()] = batch.getTuple(i);
+            if (!execute(shadow.getBody(), ctxt)) {
+                return false;
+            }
+        }
+        return true;
+    });
+    return true;
+}
+
+void Engine::filterBatch(const Node* condition, Batch& batch, Context& ctxt) {
+    switch (condition->getType()) {
+        case I_True: return;
+        case I_False: return batch.retain([](std::size_t) { return false; });
+        case I_Conjunction: {
+            const auto& conjunction = *static_cast<const Conjunction*>(condition);
+            filterBatch(conjunction.getLhs(), batch, ctxt);
+            filterBatch(conjunction.getRhs(), batch, ctxt);
+            return;
+        }
+        case I_Constraint:
+        case I_ConstantConstraint: {
+            const auto& shadow = *static_cast<const Constraint*>(condition);
+            // clang-format off
+#define BATCH_COMPARE(opCode, ty, cmp) \
+    case BinaryConstraintOp::opCode: return filterBatchComparison<ty>(shadow, batch, ctxt, cmp<ty>());
+            // clang-format on
+            switch (static_cast<const ram::Constraint*>(condition->getShadow())->getOperator()) {
+                BATCH_COMPARE(EQ, RamDomain, std::equal_to)
+                BATCH_COMPARE(FEQ, RamFloat, std::equal_to)
+                BATCH_COMPARE(NE, RamDomain, std::not_equal_to)
+                BATCH_COMPARE(FNE, RamFloat, std::not_equal_to)
+                BATCH_COMPARE(LT, RamSigned, std::less)
+                BATCH_COMPARE(ULT, RamUnsigned, std::less)
+                BATCH_COMPARE(FLT, RamFloat, std::less)
+                BATCH_COMPARE(LE, RamSigned, std::less_equal)
+                BATCH_COMPARE(ULE, RamUnsigned, std::less_equal)
+                BATCH_COMPARE(FLE, RamFloat, std::less_equal)
+                BATCH_COMPARE(GT, RamSigned, std::greater)
+                BATCH_COMPARE(UGT, RamUnsigned, std::greater)
+                BATCH_COMPARE(FGT, RamFloat, std::greater)
+                BATCH_COMPARE(GE, RamSigned, std::greater_equal)
+                BATCH_COMPARE(UGE, RamUnsigned, std::greater_equal)
+                BATCH_COMPARE(FGE, RamFloat, std::greater_equal)
+                default: break;
+            }
+#undef BATCH_COMPARE
+            break;
+        }
+        default: break;
+    }
 
-    auto pStream = rel.partitionScan(numOfThreads * 20);
+    // other conditions are evaluated tuple by tuple
+    batch.retain([&](std::size_t i) {
+        ctxt[batch.getTupleId()] = batch.getTuple(i);
+        return execute(condition, ctxt) != 0;
+    });
+}
 
-    PARALLEL_START
-        Context newCtxt(ctxt);
-        auto viewInfo = viewContext->getViewInfoForNested();
+template <typename T, typename Compare>
+void Engine::filterBatchComparison(const Constraint& shadow, Batch& batch, Context& ctxt, Compare compare) {
+    RamDomain lhs[Batch::SIZE];
+    RamDomain rhs[Batch::SIZE];
+    evalBatchExpression(shadow.getLhs(), batch, ctxt, lhs);
+    evalBatchExpression(shadow.getRhs(), batch, ctxt, rhs);
+    batch.retain([&](std::size_t i) { return compare(ramBitCast<T>(lhs[i]), ramBitCast<T>(rhs[i])); });
+}
+
+void Engine::evalBatchExpression(const Node* expr, const Batch& batch, Context& ctxt, RamDomain* values) {
+    const std::size_t size = batch.size();
+    switch (expr->getType()) {
+        case I_TupleElement: {
+            const auto& shadow = *static_cast<const TupleElement*>(expr);
+            if (shadow.getTupleId() != batch.getTupleId()) {
+                std::fill_n(values, size, execute(expr, ctxt));
+                return;
+            }
+            for (std::size_t i = 0; i < size; ++i) {
+                values[i] = batch.getTuple(i)[shadow.getElement()];
+            }
+            return;
+        }
+        case I_NumericConstant:
+        case I_StringConstant:
+        case I_Variable:
+        case I_SubroutineArgument: std::fill_n(values, size, execute(expr, ctxt)); return;
+        case I_IntrinsicOperator: {
+            const auto& shadow = *static_cast<const IntrinsicOperator*>(expr);
+            if (shadow.getChildren().size() != 2) {
+                break;
+            }
+            // clang-format off
+#define BATCH_ARITHMETIC(opCode, ty, op) \
+    case FunctorOp::opCode: return evalBatchArithmetic<ty>(shadow, batch, ctxt, values, op<ty>());
+            // clang-format on
+            switch (static_cast<const ram::IntrinsicOperator*>(expr->getShadow())->getOperator()) {
+                BATCH_ARITHMETIC(ADD, RamSigned, std::plus)
+                BATCH_ARITHMETIC(UADD, RamUnsigned, std::plus)
+                BATCH_ARITHMETIC(FADD, RamFloat, std::plus)
+                BATCH_ARITHMETIC(SUB, RamSigned, std::minus)
+                BATCH_ARITHMETIC(USUB, RamUnsigned, std::minus)
+                BATCH_ARITHMETIC(FSUB, RamFloat, std::minus)
+                BATCH_ARITHMETIC(MUL, RamSigned, std::multiplies)
+                BATCH_ARITHMETIC(UMUL, RamUnsigned, std::multiplies)
+                BATCH_ARITHMETIC(FMUL, RamFloat, std::multiplies)
+                BATCH_ARITHMETIC(BAND, RamSigned, std::bit_and)
+                BATCH_ARITHMETIC(UBAND, RamUnsigned, std::bit_and)
+                BATCH_ARITHMETIC(BOR, RamSigned, std::bit_or)
+                BATCH_ARITHMETIC(UBOR, RamUnsigned, std::bit_or)
+                BATCH_ARITHMETIC(BXOR, RamSigned, std::bit_xor)
+                BATCH_ARITHMETIC(UBXOR, RamUnsigned, std::bit_xor)
+                default: break;
+            }
+#undef BATCH_ARITHMETIC
+            break;
+        }
+        default: break;
+    }
+
+    // other expressions are evaluated tuple by tuple
+    for (std::size_t i = 0; i < size; ++i) {
+        ctxt[batch.getTupleId()] = batch.getTuple(i);
+        values[i] = execute(expr, ctxt);
+    }
+}
+
+template <typename T, typename Operation>
+void Engine::evalBatchArithmetic(const IntrinsicOperator& shadow, const Batch& batch, Context& ctxt,
+        RamDomain* values, Operation operation) {
+    RamDomain rhs[Batch::SIZE];
+    evalBatchExpression(shadow.getChild(0), batch, ctxt, values);
+    evalBatchExpression(shadow.getChild(1), batch, ctxt, rhs);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        values[i] = ramBitCast(static_cast<T>(operation(ramBitCast<T>(values[i]), ramBitCast<T>(rhs[i]))));
+    }
+}
+
+void Engine::insertBatch(const Insert& shadow, const Batch& batch, Context& ctxt) {
+    RelationWrapper& rel = *shadow.getRelation();
+    const auto& superInfo = shadow.getSuperInst();
+    const std::size_t arity = rel.getArity();
+    const std::size_t size = batch.size();
+
+    // the tuples are assembled column by column
+    std::vector<RamDomain> tuples(size * arity);
+    for (std::size_t i = 0; i < size; ++i) {
+        std::copy_n(superInfo.first.begin(), arity, tuples.begin() + i * arity);
+    }
+    for (const auto& tupleElement : superInfo.tupleFirst) {
+        for (std::size_t i = 0; i < size; ++i) {
+            const RamDomain* tuple =
+                    tupleElement[1] == batch.getTupleId() ? batch.getTuple(i) : ctxt[tupleElement[1]];
+            tuples[i * arity + tupleElement[0]] = tuple[tupleElement[2]];
+        }
+    }
+    RamDomain values[Batch::SIZE];
+    for (const auto& expr : superInfo.exprFirst) {
+        evalBatchExpression(expr.second.get(), batch, ctxt, values);
+        for (std::size_t i = 0; i < size; ++i) {
+            tuples[i * arity + expr.first] = values[i];
+        }
+    }
+
+    // defer the insertion in parallel operations if the relation is buffered
+    if (shadow.isBuffered() && ctxt.getInsertBuffers() != nullptr) {
+        for (std::size_t i = 0; i < size; ++i) {
+            ctxt.getInsertBuffers()->append(rel, &tuples[i * arity]);
+        }
+        return;
+    }
+    // batch scans may be nested in parallel operations or run in concurrent rules,
+    // hence the batch is inserted as a buffer, which is safe to insert concurrently
+    rel.insertBuffer(tuples.data(), size);
+}
+
+std::size_t Engine::getPartitionCount() const {
+    // stolen iterations are cheap enough to split relations into finer partitions
+    return numOfThreads * (workStealing ? 100 : 20);
+}
+
+template <typename Partitions, typename Body>
+void Engine::evalPartitions(
+        const Partitions& partitions, ViewContext& viewContext, Context& ctxt, const Body& body) {
+    const auto& viewInfo = viewContext.getViewInfoForNested();
+
+    // each thread evaluates the partitions in a context of its own, buffering its insertions
+    auto createViews = [&](Context& newCtxt) {
         for (const auto& info : viewInfo) {
             newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
         }
+    };
+
+    if (workStealing) {
+        PARALLEL_STEAL_START(partitions.size())
+            Context newCtxt(ctxt);
+            InsertBuffers insertBuffers;
+            newCtxt.setInsertBuffers(&insertBuffers);
+            createViews(newCtxt);
+            psteal(i) {
+                body(partitions[i], newCtxt);
+            }
+            insertBuffers.flush();
+        PARALLEL_STEAL_END
+        return;
+    }
+
+    PARALLEL_START
+        Context newCtxt(ctxt);
+        InsertBuffers insertBuffers;
+        newCtxt.setInsertBuffers(&insertBuffers);
+        createViews(newCtxt);
 #if defined _OPENMP && _OPENMP < 200805
-        auto count = std::distance(pStream.begin(), pStream.end());
-        auto b = pStream.begin();
+        auto count = std::distance(partitions.begin(), partitions.end());
+        auto b = partitions.begin();
         pfor(int i = 0; i < count; i++) {
             auto it = b + i;
 #else
-        pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
+        pfor(auto it = partitions.begin(); it < partitions.end(); it++) {
 #endif
-            for (const auto& tuple : *it) {
-                newCtxt[cur.getTupleId()] = tuple.data();
-                if (!execute(shadow.getNestedOperation(), newCtxt)) {
-                    break;
-                }
-            }
+            body(*it, newCtxt);
         }
+        insertBuffers.flush();
     PARALLEL_END
+}
+
+template <typename Rel>
+RamDomain Engine::evalParallelScan(
+        const Rel& rel, const ram::ParallelScan& cur, const ParallelScan& shadow, Context& ctxt) {
+    auto viewContext = shadow.getViewContext();
+
+    auto pStream = rel.partitionScan(getPartitionCount());
+    evalPartitions(pStream, *viewContext, ctxt, [&](const auto& partition, Context& newCtxt) {
+        for (const auto& tuple : partition) {
+            newCtxt[cur.getTupleId()] = tuple.data();
+            if (!executeNested(shadow, newCtxt)) {
+                break;
+            }
+        }
+    });
     return true;
 }
 
@@ -1756,13 +2308,73 @@ RamDomain Engine::evalIndexScan(const ram::IndexScan& cur, const IndexScan& shad
     // conduct range query
     for (const auto& tuple : view->range(low, high)) {
         ctxt[cur.getTupleId()] = tuple.data();
-        if (!execute(shadow.getNestedOperation(), ctxt)) {
+        if (!executeNested(shadow, ctxt)) {
             break;
         }
     }
     return true;
 }
 
+RamDomain Engine::evalIntersection(const ram::Intersection& cur, const Intersection& shadow, Context& ctxt) {
+    const auto& sources = shadow.getSources();
+    evaluator::runIntersection<RamSigned>(
+            sources.size(),
+            [&](std::size_t i, RamDomain key, RamDomain& value) {
+                return seekIntersectionSource(*sources[i], key, value, ctxt);
+            },
+            [&](const auto& tuple) {
+                ctxt[cur.getTupleId()] = tuple.data();
+                return static_cast<bool>(execute(shadow.getNestedOperation(), ctxt));
+            });
+    return true;
+}
+
+bool Engine::seekIntersectionSource(
+        const IntersectionSource& shadow, RamDomain key, RamDomain& value, Context& ctxt) {
+    switch (shadow.getType()) {
+#define INTERSECTION_SOURCE(Structure, Arity, AuxiliaryArity, ...)              \
+    case (I_IntersectionSource_##Structure##_##Arity##_##AuxiliaryArity):      \
+        return evalIntersectionSource<Relation<Arity, AuxiliaryArity, interpreter::Structure>>( \
+                shadow, key, value, ctxt);
+        FOR_EACH(INTERSECTION_SOURCE)
+#undef INTERSECTION_SOURCE
+        default: fatal("unsupported intersection source");
+    }
+}
+
+template <typename Rel>
+bool Engine::evalIntersectionSource(
+        const IntersectionSource& shadow, RamDomain key, RamDomain& value, Context& ctxt) {
+    constexpr std::size_t Arity = Rel::Arity;
+    const auto& superInfo = shadow.getSuperInst();
+    souffle::Tuple<RamDomain, Arity> low;
+    souffle::Tuple<RamDomain, Arity> high;
+    TUPLE_COPY_FROM(low, superInfo.first);
+    TUPLE_COPY_FROM(high, superInfo.second);
+
+    /* TupleElement */
+    for (const auto& tupleElement : superInfo.tupleFirst) {
+        low[tupleElement[0]] = ctxt[tupleElement[1]][tupleElement[2]];
+        high[tupleElement[0]] = low[tupleElement[0]];
+    }
+    /* Generic */
+    for (const auto& expr : superInfo.exprFirst) {
+        low[expr.first] = execute(expr.second.get(), ctxt);
+        high[expr.first] = low[expr.first];
+    }
+
+    // the bound columns precede the join column in the index, hence the
+    // first tuple not less than the key carries the least matching value
+    const std::size_t pos = shadow.getColumn();
+    low[pos] = key;
+    auto range = Rel::castView(ctxt.getView(shadow.getViewId()))->range(low, high);
+    if (range.begin() == range.end()) {
+        return false;
+    }
+    value = (*range.begin())[pos];
+    return true;
+}
+
 template <typename Rel>
 RamDomain Engine::evalParallelIndexScan(
         const Rel& rel, const ram::ParallelIndexScan& cur, const ParallelIndexScan& shadow, Context& ctxt) {
@@ -1776,29 +2388,15 @@ RamDomain Engine::evalParallelIndexScan(
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t indexPos = shadow.getViewId();
-    auto pStream = rel.partitionRange(indexPos, low, high, numOfThreads * 20);
-    PARALLEL_START
-        Context newCtxt(ctxt);
-        auto viewInfo = viewContext->getViewInfoForNested();
-        for (const auto& info : viewInfo) {
-            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
-        }
-#if defined _OPENMP && _OPENMP < 200805
-        auto count = std::distance(pStream.begin(), pStream.end());
-        auto b = pStream.begin();
-        pfor(int i = 0; i < count; i++) {
-            auto it = b + i;
-#else
-        pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-#endif
-            for (const auto& tuple : *it) {
-                newCtxt[cur.getTupleId()] = tuple.data();
-                if (!execute(shadow.getNestedOperation(), newCtxt)) {
-                    break;
-                }
+    auto pStream = rel.partitionRange(indexPos, low, high, getPartitionCount());
+    evalPartitions(pStream, *viewContext, ctxt, [&](const auto& partition, Context& newCtxt) {
+        for (const auto& tuple : partition) {
+            newCtxt[cur.getTupleId()] = tuple.data();
+            if (!executeNested(shadow, newCtxt)) {
+                break;
             }
         }
-    PARALLEL_END
+    });
     return true;
 }
 
@@ -1821,30 +2419,16 @@ RamDomain Engine::evalParallelIfExists(
         const Rel& rel, const ram::ParallelIfExists& cur, const ParallelIfExists& shadow, Context& ctxt) {
     auto viewContext = shadow.getViewContext();
 
-    auto pStream = rel.partitionScan(numOfThreads * 20);
-    auto viewInfo = viewContext->getViewInfoForNested();
-    PARALLEL_START
-        Context newCtxt(ctxt);
-        for (const auto& info : viewInfo) {
-            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
-        }
-#if defined _OPENMP && _OPENMP < 200805
-        auto count = std::distance(pStream.begin(), pStream.end());
-        auto b = pStream.begin();
-        pfor(int i = 0; i < count; i++) {
-            auto it = b + i;
-#else
-        pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-#endif
-            for (const auto& tuple : *it) {
-                newCtxt[cur.getTupleId()] = tuple.data();
-                if (execute(shadow.getCondition(), newCtxt)) {
-                    execute(shadow.getNestedOperation(), newCtxt);
-                    break;
-                }
+    auto pStream = rel.partitionScan(getPartitionCount());
+    evalPartitions(pStream, *viewContext, ctxt, [&](const auto& partition, Context& newCtxt) {
+        for (const auto& tuple : partition) {
+            newCtxt[cur.getTupleId()] = tuple.data();
+            if (execute(shadow.getCondition(), newCtxt)) {
+                execute(shadow.getNestedOperation(), newCtxt);
+                break;
             }
         }
-    PARALLEL_END
+    });
     return true;
 }
 
@@ -1875,8 +2459,6 @@ RamDomain Engine::evalParallelIndexIfExists(const Rel& rel, const ram::ParallelI
         const ParallelIndexIfExists& shadow, Context& ctxt) {
     auto viewContext = shadow.getViewContext();
 
-    auto viewInfo = viewContext->getViewInfoForNested();
-
     // create pattern tuple for range query
     constexpr std::size_t Arity = Rel::Arity;
     const auto& superInfo = shadow.getSuperInst();
@@ -1885,31 +2467,16 @@ RamDomain Engine::evalParallelIndexIfExists(const Rel& rel, const ram::ParallelI
     CAL_SEARCH_BOUND(superInfo, low, high);
 
     std::size_t indexPos = shadow.getViewId();
-    auto pStream = rel.partitionRange(indexPos, low, high, numOfThreads * 20);
-
-    PARALLEL_START
-        Context newCtxt(ctxt);
-        for (const auto& info : viewInfo) {
-            newCtxt.createView(*getRelationHandle(info[0]), info[1], info[2]);
-        }
-#if defined _OPENMP && _OPENMP < 200805
-        auto count = std::distance(pStream.begin(), pStream.end());
-        auto b = pStream.begin();
-        pfor(int i = 0; i < count; i++) {
-            auto it = b + i;
-#else
-        pfor(auto it = pStream.begin(); it < pStream.end(); it++) {
-#endif
-            for (const auto& tuple : *it) {
-                newCtxt[cur.getTupleId()] = tuple.data();
-                if (execute(shadow.getCondition(), newCtxt)) {
-                    execute(shadow.getNestedOperation(), newCtxt);
-                    break;
-                }
+    auto pStream = rel.partitionRange(indexPos, low, high, getPartitionCount());
+    evalPartitions(pStream, *viewContext, ctxt, [&](const auto& partition, Context& newCtxt) {
+        for (const auto& tuple : partition) {
+            newCtxt[cur.getTupleId()] = tuple.data();
+            if (execute(shadow.getCondition(), newCtxt)) {
+                execute(shadow.getNestedOperation(), newCtxt);
+                break;
             }
         }
-    PARALLEL_END
-
+    });
     return true;
 }
 
@@ -2131,6 +2698,12 @@ RamDomain Engine::evalInsert(Rel& rel, const Insert& shadow, Context& ctxt) {
         tuple[expr.first] = execute(expr.second.get(), ctxt);
     }
 
+    // defer the insertion in parallel operations if the relation is buffered
+    if (shadow.isBuffered() && ctxt.getInsertBuffers() != nullptr) {
+        ctxt.getInsertBuffers()->append(rel, tuple.data());
+        return true;
+    }
+
     // insert in target relation
     rel.insert(tuple);
     return true;
@@ -17,9 +17,11 @@
 #pragma once
 
 #include "Global.h"
+#include "interpreter/CompiledStrata.h"
 #include "interpreter/Context.h"
 #include "interpreter/Generator.h"
 #include "interpreter/Index.h"
+#include "interpreter/JoinPlanner.h"
 #include "interpreter/Node.h"
 #include "interpreter/Relation.h"
 #include "ram/TranslationUnit.h"
@@ -29,6 +31,7 @@
 #include "souffle/SymbolTable.h"
 #include "souffle/datastructure/ConcurrentCache.h"
 #include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SpillStore.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
 #include "souffle/utility/ContainerUtil.h"
 #include <atomic>
@@ -36,6 +39,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <regex>
 #include <string>
 #include <vector>
@@ -75,9 +79,16 @@ public:
     /** @brief Return the record table */
     RecordTable& getRecordTable();
 
+    /** @brief Run the given strata compiled once they are built */
+    void setCompiledStrata(Own<CompiledStrata> strata);
+
 private:
     /** @brief Generate intermediate representation from RAM */
     void generateIR();
+    /** @brief Base the symbol and record tables on the snapshot of a previous run, if any */
+    void loadTableSnapshot(const std::string& fileName);
+    /** @brief Save a snapshot of the symbol and record tables */
+    void saveTableSnapshot(const std::string& fileName);
     /** @brief Remove a relation from the environment */
     void dropRelation(const std::size_t relId);
     /** @brief Swap the content of two relations */
@@ -88,6 +99,12 @@ private:
     ram::TranslationUnit& getTranslationUnit();
     /** @brief Execute a specific node program */
     RamDomain execute(const Node*, Context&);
+    /** @brief Execute the operation nested in a scan, evaluating the fused filters in place */
+    bool executeNested(const Scan& shadow, Context& ctxt);
+    /** @brief Return the query reordered for the current sizes of its relations, or null if unchanged */
+    const Node* planJoins(JoinPlanner& planner);
+    /** @brief Execute the subroutine of a stratum through the compiled program, if available */
+    bool executeCompiledStratum(const std::string& name);
     /** @brief Return method handler */
     void* getMethodHandle(const std::string& method);
     /** @brief Load DLL */
@@ -115,6 +132,32 @@ private:
     template <typename Rel>
     RamDomain evalScan(const Rel& rel, const ram::Scan& cur, const Scan& shadow, Context& ctxt);
 
+    RamDomain evalBatchScan(const ram::Scan& cur, const BatchScan& shadow, Context& ctxt);
+
+    /** @brief Deselect the tuples of a batch not satisfying the condition */
+    void filterBatch(const Node* condition, Batch& batch, Context& ctxt);
+
+    template <typename T, typename Compare>
+    void filterBatchComparison(const Constraint& shadow, Batch& batch, Context& ctxt, Compare compare);
+
+    /** @brief Evaluate an expression for the selected tuples of a batch */
+    void evalBatchExpression(const Node* expr, const Batch& batch, Context& ctxt, RamDomain* values);
+
+    template <typename T, typename Operation>
+    void evalBatchArithmetic(const IntrinsicOperator& shadow, const Batch& batch, Context& ctxt,
+            RamDomain* values, Operation operation);
+
+    /** @brief Insert the selected tuples of a batch */
+    void insertBatch(const Insert& shadow, const Batch& batch, Context& ctxt);
+
+    /** @brief Return the number of partitions of the relations scanned in parallel */
+    std::size_t getPartitionCount() const;
+
+    /** @brief Evaluate the body on each partition in parallel, each thread in a context of its own */
+    template <typename Partitions, typename Body>
+    void evalPartitions(
+            const Partitions& partitions, ViewContext& viewContext, Context& ctxt, const Body& body);
+
     template <typename Rel>
     RamDomain evalParallelScan(
             const Rel& rel, const ram::ParallelScan& cur, const ParallelScan& shadow, Context& ctxt);
@@ -144,6 +187,16 @@ private:
     RamDomain evalParallelIndexIfExists(const Rel& rel, const ram::ParallelIndexIfExists& cur,
             const ParallelIndexIfExists& shadow, Context& ctxt);
 
+    RamDomain evalIntersection(const ram::Intersection& cur, const Intersection& shadow, Context& ctxt);
+
+    /** @brief Obtain the least value of the join column of a source not less than the key */
+    bool seekIntersectionSource(
+            const IntersectionSource& shadow, RamDomain key, RamDomain& value, Context& ctxt);
+
+    template <typename Rel>
+    bool evalIntersectionSource(
+            const IntersectionSource& shadow, RamDomain key, RamDomain& value, Context& ctxt);
+
     template <typename Shadow>
     RamDomain initValue(const ram::Aggregator& aggregator, const Shadow& shadow, Context& ctxt);
 
@@ -187,7 +240,7 @@ private:
     /** Profile counter */
     std::atomic<RamDomain> counter{0};
     /** Loop iteration counter */
-    std::size_t iteration = 0;
+    std::atomic<std::size_t> iteration{0};
     /** Profile for rule frequencies */
     std::map<std::string, std::deque<std::atomic<std::size_t>>> frequencies;
     /** Profile for relation reads */
@@ -200,10 +253,22 @@ private:
     SpecializedRecordTable<0, 1, 2, 3, 4, 5, 6, 7, 8, 9> recordTable;
     /** Symbol table for relations */
     VecOwn<RelationHandle> relations;
-    /** Symbol table */
-    SymbolTableImpl symbolTable;
+    /** Symbol table, sharded for programs encoding symbols from many threads */
+    Own<SymbolTable> symbolTable;
     /** A cache for regexes */
     ConcurrentCache<std::string, std::regex> regexCache;
+    /** Strata compiled in the background, if any */
+    Own<CompiledStrata> compiledStrata;
+    /** Whether the threads of parallel operations steal partitions from each other */
+    const bool workStealing;
+    /** Generator of the nodes, kept to generate the queries reordered at runtime */
+    Own<NodeGenerator> generator;
+    /** Lock of the generator once the program runs */
+    std::mutex generatorLock;
+    /** Planners reordering the joins of recursive queries */
+    VecOwn<JoinPlanner> joinPlanners;
+    /** Relations moved to disk by Spill statements */
+    SpillStore spillStore;
 };
 
 }  // namespace souffle::interpreter
@@ -15,7 +15,10 @@
 
 #include "interpreter/Generator.h"
 #include "interpreter/Engine.h"
+#include "interpreter/JoinPlanner.h"
 #include "ram/UserDefinedAggregator.h"
+#include "ram/analysis/Relation.h"
+#include <optional>
 
 namespace souffle::interpreter {
 
@@ -23,6 +26,37 @@ using NodePtr = Own<Node>;
 using NodePtrVec = std::vector<NodePtr>;
 using RelationHandle = Own<RelationWrapper>;
 
+namespace {
+
+/**
+ * Return the operator of a numeric comparison, mirrored if its operands are
+ * swapped, or none for other constraints.
+ */
+std::optional<BinaryConstraintOp> numericComparison(BinaryConstraintOp op, bool swapped) {
+    using BCO = BinaryConstraintOp;
+    switch (op) {
+        case BCO::EQ:
+        case BCO::FEQ:
+        case BCO::NE:
+        case BCO::FNE: return op;
+        case BCO::LT: return swapped ? BCO::GT : op;
+        case BCO::ULT: return swapped ? BCO::UGT : op;
+        case BCO::FLT: return swapped ? BCO::FGT : op;
+        case BCO::LE: return swapped ? BCO::GE : op;
+        case BCO::ULE: return swapped ? BCO::UGE : op;
+        case BCO::FLE: return swapped ? BCO::FGE : op;
+        case BCO::GT: return swapped ? BCO::LT : op;
+        case BCO::UGT: return swapped ? BCO::ULT : op;
+        case BCO::FGT: return swapped ? BCO::FLT : op;
+        case BCO::GE: return swapped ? BCO::LE : op;
+        case BCO::UGE: return swapped ? BCO::ULE : op;
+        case BCO::FGE: return swapped ? BCO::FLE : op;
+        default: return std::nullopt;
+    }
+}
+
+}  // namespace
+
 NodeGenerator::NodeGenerator(Engine& engine) : engine(engine), global(engine.getGlobal()) {
     visit(engine.tUnit.getProgram(), [&](const ram::Relation& relation) {
         assert(relationMap.find(relation.getName()) == relationMap.end() && "double-naming of relations");
@@ -48,6 +82,9 @@ NodePtr NodeGenerator::generateTree(const ram::Node& root) {
         } else if (const auto* provExists = as<ram::ProvenanceExistenceCheck>(node)) {
             encodeIndexPos(*provExists);
             encodeView(provExists);
+        } else if (const auto* source = as<ram::IntersectionSource>(node)) {
+            encodeIndexPos(*source);
+            encodeView(source);
         }
     });
     // Parse program
@@ -267,6 +304,26 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Constraint>, const ram::Constra
         default: break;
     }
 
+    // numeric comparisons of a tuple element with a constant are evaluated without their operands
+    const bool swapped = left->getType() != I_TupleElement;
+    const Node* element = swapped ? right.get() : left.get();
+    const Node* constant = swapped ? left.get() : right.get();
+    const auto op = numericComparison(relOp.getOperator(), swapped);
+    if (op && element->getType() == I_TupleElement) {
+        std::optional<RamDomain> value;
+        if (constant->getType() == I_NumericConstant) {
+            value = asAssert<ram::NumericConstant>(constant->getShadow()).getConstant();
+        } else if (constant->getType() == I_StringConstant &&
+                   (*op == BinaryConstraintOp::EQ || *op == BinaryConstraintOp::NE)) {
+            value = static_cast<const StringConstant*>(constant)->getConstant();
+        }
+        if (value) {
+            const auto& tupleElement = *static_cast<const TupleElement*>(element);
+            return mk<ConstantConstraint>(&relOp, std::move(left), std::move(right), *op,
+                    tupleElement.getTupleId(), tupleElement.getElement(), *value);
+        }
+    }
+
     return mk<Constraint>(I_Constraint, &relOp, std::move(left), std::move(right));
 }
 
@@ -285,8 +342,32 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Scan>, const ram::Scan& scan) {
     orderingContext.addTupleWithDefaultOrder(scan.getTupleId(), scan);
     std::size_t relId = encodeRelation(scan.getRelation());
     auto rel = getRelationHandle(relId);
+    auto nested = visit_(type_identity<ram::TupleOperation>(), scan);
+    const bool countFrequencies = engine.profileEnabled && engine.frequencyCounterEnabled;
+    if (global.config().has("batch-execution") && !countFrequencies && getArity(scan.getRelation()) > 0) {
+        // the leading filters and a subsequent insertion are evaluated on blocks of tuples
+        std::vector<const Node*> filters;
+        const Node* body = nested.get();
+        while (const auto* filter = dynamic_cast<const Filter*>(body)) {
+            if (!isBatchCondition(asAssert<ram::Filter>(filter->getShadow()).getCondition())) {
+                break;
+            }
+            filters.push_back(filter->getCondition());
+            body = filter->getNestedOperation();
+        }
+        const auto* insert = dynamic_cast<const Insert*>(body);
+        if (dynamic_cast<const GuardedInsert*>(body) != nullptr) {
+            insert = nullptr;
+        }
+        if (!filters.empty() || insert != nullptr) {
+            return mk<BatchScan>(
+                    I_BatchScan, &scan, rel, std::move(nested), std::move(filters), body, insert);
+        }
+    }
     NodeType type = constructNodeType(global, "Scan", lookup(scan.getRelation()));
-    return mk<Scan>(type, &scan, rel, visit_(type_identity<ram::TupleOperation>(), scan));
+    auto res = mk<Scan>(type, &scan, rel, std::move(nested));
+    fuseFilters(*res);
+    return res;
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::ParallelScan>, const ram::ParallelScan& pScan) {
@@ -296,6 +377,7 @@ NodePtr NodeGenerator::visit_(type_identity<ram::ParallelScan>, const ram::Paral
     NodeType type = constructNodeType(global, "ParallelScan", lookup(pScan.getRelation()));
     auto res = mk<ParallelScan>(type, &pScan, rel, visit_(type_identity<ram::TupleOperation>(), pScan));
     res->setViewContext(parentQueryViewContext);
+    fuseFilters(*res);
     return res;
 }
 
@@ -303,8 +385,10 @@ NodePtr NodeGenerator::visit_(type_identity<ram::IndexScan>, const ram::IndexSca
     orderingContext.addTupleWithIndexOrder(iScan.getTupleId(), iScan);
     SuperInstruction indexOperation = getIndexSuperInstInfo(iScan);
     NodeType type = constructNodeType(global, "IndexScan", lookup(iScan.getRelation()));
-    return mk<IndexScan>(type, &iScan, nullptr, visit_(type_identity<ram::TupleOperation>(), iScan),
+    auto res = mk<IndexScan>(type, &iScan, nullptr, visit_(type_identity<ram::TupleOperation>(), iScan),
             encodeView(&iScan), std::move(indexOperation));
+    fuseFilters(*res);
+    return res;
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::ParallelIndexScan>, const ram::ParallelIndexScan& piscan) {
@@ -316,6 +400,7 @@ NodePtr NodeGenerator::visit_(type_identity<ram::ParallelIndexScan>, const ram::
     auto res = mk<ParallelIndexScan>(type, &piscan, rel, visit_(type_identity<ram::TupleOperation>(), piscan),
             encodeIndexPos(piscan), std::move(indexOperation));
     res->setViewContext(parentQueryViewContext);
+    fuseFilters(*res);
     return res;
 }
 
@@ -391,6 +476,26 @@ void* NodeGenerator::resolveFunctionPointers(const ram::AbstractAggregate& aggre
     }
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::Intersection>, const ram::Intersection& intersection) {
+    VecOwn<IntersectionSource> sources;
+    for (const auto* source : intersection.getSources()) {
+        SuperInstruction superOp = getIntersectionSuperInstInfo(*source);
+        // locate the join column in the order of the index
+        auto order = (*getRelationHandle(encodeRelation(source->getRelation())))
+                             ->getIndexOrder(encodeIndexPos(*source));
+        std::size_t pos = 0;
+        while (order[pos] != source->getColumn()) {
+            assert(!isUndefValue(source->getValues()[order[pos]]) && "join column must follow bound columns");
+            ++pos;
+        }
+        NodeType type = constructNodeType(global, "IntersectionSource", lookup(source->getRelation()));
+        sources.push_back(mk<IntersectionSource>(type, source, encodeView(source), std::move(superOp), pos));
+    }
+    orderingContext.addNewTuple(intersection.getTupleId(), 1);
+    return mk<Intersection>(I_Intersection, &intersection, std::move(sources),
+            visit_(type_identity<ram::TupleOperation>(), intersection));
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::Aggregate>, const ram::Aggregate& aggregate) {
     // Notice: Aggregate is sensitive to the visiting order of the subexprs in order to make
     // orderCtxt consistent. The order of visiting should be the same as the order of execution during
@@ -492,7 +597,9 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Insert>, const ram::Insert& ins
     std::size_t relId = encodeRelation(insert.getRelation());
     auto rel = getRelationHandle(relId);
     NodeType type = constructNodeType(global, "Insert", lookup(insert.getRelation()));
-    return mk<Insert>(type, &insert, rel, std::move(superOp));
+    bool buffered = engine.tUnit.getAnalysis<ram::analysis::RelationAnalysis>().hasInsertBuffer(
+            insert.getRelation());
+    return mk<Insert>(type, &insert, rel, std::move(superOp), buffered);
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Erase>, const ram::Erase& erase) {
@@ -520,7 +627,6 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Sequence>, const ram::Sequence&
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Parallel>, const ram::Parallel& parallel) {
-    // Parallel statements are executed in sequence for now.
     NodePtrVec children;
     for (const auto& value : parallel.getStatements()) {
         children.push_back(dispatch(*value));
@@ -528,8 +634,19 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Parallel>, const ram::Parallel&
     return mk<Parallel>(I_Parallel, &parallel, std::move(children));
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::TaskGraph>, const ram::TaskGraph& graph) {
+    NodePtrVec children;
+    for (const auto& task : graph.getTasks()) {
+        children.push_back(dispatch(*task));
+    }
+    return mk<TaskGraph>(I_TaskGraph, &graph, std::move(children));
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::Loop>, const ram::Loop& loop) {
-    return mk<Loop>(I_Loop, &loop, dispatch(loop.getBody()));
+    ++loopDepth;
+    auto body = dispatch(loop.getBody());
+    --loopDepth;
+    return mk<Loop>(I_Loop, &loop, std::move(body));
 }
 
 NodePtr NodeGenerator::visit_(type_identity<ram::Exit>, const ram::Exit& exit) {
@@ -545,6 +662,30 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Call>, const ram::Call& call) {
     return mk<Call>(I_Call, &call, call.getName());
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::CompactRecords>, const ram::CompactRecords& compact) {
+    CompactRecords::RelationTypes relations;
+    for (const auto& relation : compact.getRelations()) {
+        relations.emplace_back(getRelationHandle(encodeRelation(relation)), &lookup(relation));
+    }
+    return mk<CompactRecords>(I_CompactRecords, &compact, std::move(relations));
+}
+
+NodePtr NodeGenerator::visit_(type_identity<ram::Spill>, const ram::Spill& spill) {
+    Spill::Relations relations;
+    for (const auto& relation : spill.getRelations()) {
+        relations.push_back(getRelationHandle(encodeRelation(relation)));
+    }
+    return mk<Spill>(I_Spill, &spill, std::move(relations));
+}
+
+NodePtr NodeGenerator::visit_(type_identity<ram::Restore>, const ram::Restore& restore) {
+    Restore::Relations relations;
+    for (const auto& relation : restore.getRelations()) {
+        relations.push_back(getRelationHandle(encodeRelation(relation)));
+    }
+    return mk<Restore>(I_Restore, &restore, std::move(relations));
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::LogRelationTimer>, const ram::LogRelationTimer& timer) {
     std::size_t relId = encodeRelation(timer.getRelation());
     auto rel = getRelationHandle(relId);
@@ -628,11 +769,37 @@ NodePtr NodeGenerator::visit_(type_identity<ram::Query>, const ram::Query& query
     viewContext->isParallel =
             visitExists(*next, [&](const Node& n) { return as<ram::AbstractParallel, AllowCrossCast>(n); });
 
-    auto res = mk<Query>(I_Query, &query, dispatch(*next));
+    // the tuples of a query are bound to the slots of a frame, one per tuple identifier
+    std::size_t frameSize = 0;
+    visit(query, [&](const ram::TupleOperation& op) {
+        frameSize = std::max(frameSize, op.getTupleId() + 1);
+    });
+
+    auto res = mk<Query>(I_Query, &query, dispatch(*next), frameSize);
     res->setViewContext(parentQueryViewContext);
+
+    // the joins of recursive queries may be reordered between the iterations of their loop
+    if (loopDepth > 0 && global.config().has("adaptive-joins") && !engine.profileEnabled) {
+        if (auto planner = JoinPlanner::create(query, engine.tUnit)) {
+            std::vector<std::size_t> ids;
+            for (const std::string& relation : planner->getRelations()) {
+                ids.push_back(encodeRelation(relation));
+            }
+            planner->setRelationIds(std::move(ids));
+            res->setJoinPlanner(planner.get());
+            engine.joinPlanners.push_back(std::move(planner));
+        }
+    }
     return res;
 }
 
+NodePtr NodeGenerator::visit_(type_identity<ram::Merge>, const ram::Merge& merge) {
+    std::size_t src = encodeRelation(merge.getSourceRelation());
+    std::size_t target = encodeRelation(merge.getTargetRelation());
+    NodeType type = constructNodeType(global, "Merge", lookup(merge.getTargetRelation()));
+    return mk<Merge>(type, &merge, src, target);
+}
+
 NodePtr NodeGenerator::visit_(type_identity<ram::MergeExtend>, const ram::MergeExtend& extend) {
     std::size_t src = encodeRelation(extend.getFirstRelation());
     std::size_t target = encodeRelation(extend.getSecondRelation());
@@ -678,9 +845,11 @@ std::size_t NodeGenerator::encodeIndexPos(RamNode& node) {
     if (signature.empty()) {
         signature = ram::analysis::SearchSignature::getFullSearchSignature(signature.arity());
     }
-    auto i = engine.isa.getIndexSelection(name).getLexOrderNum(signature);
-    indexTable[&node] = i;
-    return i;
+    // Searches of queries reordered at runtime may be served by orders selected for other searches
+    auto i = engine.isa.getIndexSelection(name).getCoveringLexOrderNum(signature);
+    assert(i.has_value() && "no index serves the search");
+    indexTable[&node] = *i;
+    return *i;
 };
 
 std::size_t NodeGenerator::encodeView(const ram::Node* node) {
@@ -724,15 +893,46 @@ bool NodeGenerator::requireView(const ram::Node* node) {
         return true;
     } else if (isA<ram::IndexOperation>(node)) {
         return true;
+    } else if (isA<ram::IntersectionSource>(node)) {
+        return true;
     }
     return false;
 }
 
+bool NodeGenerator::isBatchCondition(const ram::Condition& condition) {
+    bool batchable = true;
+    visit(condition, [&](const ram::Node& node) {
+        batchable = batchable && (isA<ram::Constraint>(node) || isA<ram::Conjunction>(node) ||
+                                         isA<ram::Negation>(node) || isA<ram::True>(node) ||
+                                         isA<ram::False>(node) || isA<ram::NumericConstant>(node) ||
+                                         isA<ram::StringConstant>(node) || isA<ram::TupleElement>(node) ||
+                                         isA<ram::IntrinsicOperator>(node) ||
+                                         isA<ram::SubroutineArgument>(node) || isA<ram::Variable>(node));
+    });
+    return batchable;
+}
+
+void NodeGenerator::fuseFilters(Scan& scan) {
+    // filters counting their frequencies are executed as nodes of their own
+    if (engine.profileEnabled && engine.frequencyCounterEnabled) {
+        return;
+    }
+    std::vector<const Node*> conditions;
+    const Node* operation = scan.getNestedOperation();
+    while (const auto* filter = dynamic_cast<const Filter*>(operation)) {
+        conditions.push_back(filter->getCondition());
+        operation = filter->getNestedOperation();
+    }
+    scan.fuseFilters(std::move(conditions), operation);
+}
+
 const std::string& NodeGenerator::getViewRelation(const ram::Node* node) {
     if (const auto* exist = as<ram::AbstractExistenceCheck>(node)) {
         return exist->getRelation();
     } else if (const auto* index = as<ram::IndexOperation>(node)) {
         return index->getRelation();
+    } else if (const auto* source = as<ram::IntersectionSource>(node)) {
+        return source->getRelation();
     }
 
     fatal("The ram::Node does not require a view.");
@@ -854,6 +1054,45 @@ SuperInstruction NodeGenerator::getExistenceSuperInstInfo(const ram::AbstractExi
     return superOp;
 }
 
+SuperInstruction NodeGenerator::getIntersectionSuperInstInfo(const ram::IntersectionSource& source) {
+    auto interpreterRel = encodeRelation(source.getRelation());
+    auto order = (*getRelationHandle(interpreterRel))->getIndexOrder(encodeIndexPos(source));
+    std::size_t arity = getArity(source.getRelation());
+    SuperInstruction superOp(arity);
+    const auto& children = source.getValues();
+    for (std::size_t i = 0; i < arity; ++i) {
+        auto& child = children[order[i]];
+
+        // Unbounded, including the join column which is set during the evaluation
+        if (isUndefValue(child)) {
+            superOp.first[i] = MIN_RAM_SIGNED;
+            superOp.second[i] = MAX_RAM_SIGNED;
+            continue;
+        }
+
+        // Constant
+        if (isA<ram::NumericConstant>(child)) {
+            superOp.first[i] = as<ram::NumericConstant>(child)->getConstant();
+            superOp.second[i] = superOp.first[i];
+            continue;
+        }
+
+        // TupleElement
+        if (isA<ram::TupleElement>(child)) {
+            auto tuple = as<ram::TupleElement>(child);
+            std::size_t tupleId = tuple->getTupleId();
+            std::size_t elementId = tuple->getElement();
+            std::size_t newElementId = orderingContext.mapOrder(tupleId, elementId);
+            superOp.tupleFirst.push_back({i, tupleId, newElementId});
+            continue;
+        }
+
+        // Generic expression
+        superOp.exprFirst.push_back(std::pair<std::size_t, Own<Node>>(i, dispatch(*child)));
+    }
+    return superOp;
+}
+
 SuperInstruction NodeGenerator::getInsertSuperInstInfo(const ram::Insert& exist) {
     std::size_t arity = getArity(exist.getRelation());
     SuperInstruction superOp(arity);
@@ -29,6 +29,7 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/CompactRecords.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -47,11 +48,14 @@
 #include "ram/IndexOperation.h"
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
+#include "ram/Intersection.h"
+#include "ram/IntersectionSource.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -72,19 +76,23 @@
 #include "ram/Query.h"
 #include "ram/Relation.h"
 #include "ram/RelationSize.h"
+#include "ram/Restore.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
+#include "ram/Spill.h"
 #include "ram/Statement.h"
 #include "ram/StringConstant.h"
 #include "ram/SubroutineArgument.h"
 #include "ram/SubroutineReturn.h"
 #include "ram/Swap.h"
+#include "ram/TaskGraph.h"
 #include "ram/True.h"
 #include "ram/TupleElement.h"
 #include "ram/TupleOperation.h"
 #include "ram/UndefValue.h"
 #include "ram/UnpackRecord.h"
 #include "ram/UserDefinedOperator.h"
+#include "ram/Variable.h"
 #include "ram/analysis/Index.h"
 #include "ram/utility/Utils.h"
 #include "ram/utility/Visitor.h"
@@ -189,6 +197,8 @@ public:
 
     NodePtr visit_(type_identity<ram::UnpackRecord>, const ram::UnpackRecord& unpack) override;
 
+    NodePtr visit_(type_identity<ram::Intersection>, const ram::Intersection& intersection) override;
+
     NodePtr visit_(type_identity<ram::Aggregate>, const ram::Aggregate& aggregate) override;
 
     NodePtr visit_(type_identity<ram::ParallelAggregate>, const ram::ParallelAggregate& pAggregate) override;
@@ -214,11 +224,16 @@ public:
 
     NodePtr visit_(type_identity<ram::Parallel>, const ram::Parallel& parallel) override;
 
+    NodePtr visit_(type_identity<ram::TaskGraph>, const ram::TaskGraph& graph) override;
+
     NodePtr visit_(type_identity<ram::Loop>, const ram::Loop& loop) override;
 
     NodePtr visit_(type_identity<ram::Exit>, const ram::Exit& exit) override;
 
     NodePtr visit_(type_identity<ram::Call>, const ram::Call& call) override;
+    NodePtr visit_(type_identity<ram::CompactRecords>, const ram::CompactRecords& compact) override;
+    NodePtr visit_(type_identity<ram::Spill>, const ram::Spill& spill) override;
+    NodePtr visit_(type_identity<ram::Restore>, const ram::Restore& restore) override;
 
     NodePtr visit_(type_identity<ram::LogRelationTimer>, const ram::LogRelationTimer& timer) override;
 
@@ -237,6 +252,7 @@ public:
 
     NodePtr visit_(type_identity<ram::Query>, const ram::Query& query) override;
 
+    NodePtr visit_(type_identity<ram::Merge>, const ram::Merge& merge) override;
     NodePtr visit_(type_identity<ram::MergeExtend>, const ram::MergeExtend& extend) override;
 
     NodePtr visit_(type_identity<ram::Swap>, const ram::Swap& swap) override;
@@ -322,6 +338,18 @@ private:
      */
     bool requireView(const ram::Node* node);
 
+    /**
+     * Return true if the given condition may be evaluated on blocks of tuples,
+     * i.e., it neither accesses relations nor has side effects.
+     */
+    bool isBatchCondition(const ram::Condition& condition);
+
+    /**
+     * Fuse the leading filters of the operation nested in a scan into the
+     * scan, which evaluates their conditions without dispatching the filters.
+     */
+    void fuseFilters(Scan& scan);
+
     /**
      * @brief Return the associated relation of a operation which requires a view.
      * This function assume the operation does requires a view.
@@ -338,6 +366,11 @@ private:
      */
     SuperInstruction getExistenceSuperInstInfo(const ram::AbstractExistenceCheck& abstractExist);
 
+    /**
+     * @brief Encode and return the super-instruction information about an intersection source
+     */
+    SuperInstruction getIntersectionSuperInstInfo(const ram::IntersectionSource& source);
+
     /**
      * @brief Encode and return the super-instruction information about a insert operation
      *
@@ -358,6 +391,8 @@ private:
     std::shared_ptr<ViewContext> parentQueryViewContext = nullptr;
     /** Next available location to encode View */
     std::size_t viewId = 0;
+    /** Number of loops enclosing the current node */
+    std::size_t loopDepth = 0;
     /** Next available location to encode a relation */
     std::size_t relId = 0;
     /** Environment encoding, store a mapping from ram::Node to its View id. */
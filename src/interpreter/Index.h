@@ -21,6 +21,7 @@
 #include "souffle/datastructure/UnionFind.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include <array>
 #include <atomic>
@@ -30,6 +31,7 @@
 #include <iosfwd>
 #include <iterator>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -139,6 +141,18 @@ struct ViewWrapper {
     virtual ~ViewWrapper() = default;
 };
 
+/**
+ * Determines whether the given data structure supports the insertion of
+ * batches of elements, e.g. the bottom-up construction of b-trees.
+ */
+template <typename Structure, typename = void>
+struct supports_batch_insert : std::false_type {};
+
+template <typename Structure>
+struct supports_batch_insert<Structure,
+        std::void_t<decltype(std::declval<Structure&>().insertBatch(
+                std::declval<std::vector<typename Structure::element_type>&>()))>> : std::true_type {};
+
 /**
  * An index is an abstraction of a data structure
  */
@@ -242,8 +256,77 @@ public:
      * Inserts all elements of the given index.
      */
     void insert(const Index<Arity, AuxiliaryArity, Structure>& src) {
+        // the content of an index with the same order is a sorted range of encoded tuples
+        if constexpr (supports_batch_insert<Data>::value) {
+            if (src.order == order) {
+                data.insertSorted(src.begin(), src.end());
+                return;
+            }
+        }
         for (const auto& tuple : src) {
-            this->insert(tuple);
+            this->insert(src.order.decode(tuple));
+        }
+    }
+
+    /**
+     * Inserts all elements of the given index, merging the given number of
+     * disjoint partitions of the source concurrently.
+     */
+    void insert(const Index<Arity, AuxiliaryArity, Structure>& src, std::size_t partitionCount) {
+        if constexpr (supports_batch_insert<Data>::value) {
+            if (partitionCount > 1) {
+                const bool sameOrder = (src.order == order);
+                const auto chunks = src.data.getChunks(partitionCount);
+                const int count = static_cast<int>(chunks.size());
+                PARALLEL_START
+                    Hints hints;
+                    pfor(int i = 0; i < count; i++) {
+                        for (const auto& tuple : chunks[i]) {
+                            data.insert(sameOrder ? tuple : order.encode(src.order.decode(tuple)), hints);
+                        }
+                    }
+                PARALLEL_END
+                return;
+            }
+        }
+        insert(src);
+    }
+
+    /**
+     * Inserts a batch of tuples into this index.
+     */
+    void insert(const std::vector<Tuple>& tuples) {
+        if constexpr (supports_batch_insert<Data>::value) {
+            std::vector<Tuple> batch;
+            batch.reserve(tuples.size());
+            for (const auto& tuple : tuples) {
+                batch.push_back(order.encode(tuple));
+            }
+            data.insertBatch(batch);
+        } else {
+            for (const auto& tuple : tuples) {
+                this->insert(tuple);
+            }
+        }
+    }
+
+    /**
+     * Inserts a buffer of tuples derived by a single thread. Unlike batches,
+     * buffers of several threads may be inserted concurrently.
+     */
+    void insertBuffer(const std::vector<Tuple>& tuples) {
+        if constexpr (supports_batch_insert<Data>::value) {
+            std::vector<Tuple> buffer;
+            buffer.reserve(tuples.size());
+            for (const auto& tuple : tuples) {
+                buffer.push_back(order.encode(tuple));
+            }
+            Hints hints;
+            data.insertBuffer(buffer, hints);
+        } else {
+            for (const auto& tuple : tuples) {
+                this->insert(tuple);
+            }
         }
     }
 
@@ -416,7 +499,23 @@ public:
     }
 
     void insert(const Index& src) {
-        data = src.data;
+        if (src.data) {
+            data = true;
+        }
+    }
+
+    void insert(const Index& src, std::size_t /* partitionCount */) {
+        insert(src);
+    }
+
+    void insert(const std::vector<Tuple>& tuples) {
+        if (!tuples.empty()) {
+            data = true;
+        }
+    }
+
+    void insertBuffer(const std::vector<Tuple>& tuples) {
+        insert(tuples);
     }
 
     bool contains(const Tuple& /* t */) const {
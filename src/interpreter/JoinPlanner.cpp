@@ -0,0 +1,351 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file JoinPlanner.cpp
+ *
+ * Define the planner reordering the joins of recursive queries at runtime.
+ ***********************************************************************/
+
+#include "interpreter/JoinPlanner.h"
+#include "RelationTag.h"
+#include "ram/Constraint.h"
+#include "ram/Filter.h"
+#include "ram/IndexScan.h"
+#include "ram/ParallelIndexScan.h"
+#include "ram/ParallelScan.h"
+#include "ram/Relation.h"
+#include "ram/Scan.h"
+#include "ram/TupleElement.h"
+#include "ram/UndefValue.h"
+#include "ram/analysis/Index.h"
+#include "ram/analysis/Relation.h"
+#include "ram/utility/Utils.h"
+#include "ram/utility/Visitor.h"
+#include "souffle/BinaryConstraintOps.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace souffle::interpreter {
+
+namespace {
+
+/** Return the atoms whose tuples a node refers to, if all of them are atoms */
+std::optional<std::size_t> findRefs(const ram::Node& node, const std::map<std::size_t, std::size_t>& atoms) {
+    std::size_t refs = 0;
+    bool known = true;
+    visit(node, [&](const ram::TupleElement& element) {
+        auto it = atoms.find(element.getTupleId());
+        if (it == atoms.end()) {
+            known = false;
+        } else {
+            refs |= std::size_t(1) << it->second;
+        }
+    });
+    if (!known) {
+        return std::nullopt;
+    }
+    return refs;
+}
+
+}  // namespace
+
+Own<JoinPlanner> JoinPlanner::create(const ram::Query& query, const ram::TranslationUnit& tUnit) {
+    const auto& relAnalysis = tUnit.getAnalysis<ram::analysis::RelationAnalysis>();
+    const auto& isa = tUnit.getAnalysis<ram::analysis::IndexAnalysis>();
+    Own<JoinPlanner> planner(new JoinPlanner());
+
+    // conditions of the outermost filter not referring to any tuple precede the loop nest
+    const ram::Operation* op = &query.getOperation();
+    if (const auto* filter = as<ram::Filter>(op)) {
+        if (!visitExists(filter->getCondition(), [](const ram::TupleElement&) { return true; })) {
+            for (const auto* term : ram::findConjunctiveTerms(&filter->getCondition())) {
+                planner->outer.push_back(clone(term));
+            }
+            op = &filter->getOperation();
+        }
+    }
+
+    // collect the atoms and filters of the loop nest, up to the first other operation
+    std::map<std::size_t, std::size_t> atomOfTuple;
+    planner->parallel = isA<ram::ParallelScan>(op) || isA<ram::ParallelIndexScan>(op);
+    while (true) {
+        const auto* scan = as<ram::Scan>(op);
+        const auto* indexScan = as<ram::IndexScan>(op);
+        if (scan == nullptr && indexScan == nullptr) {
+            if (const auto* filter = as<ram::Filter>(op)) {
+                for (const auto* term : ram::findConjunctiveTerms(&filter->getCondition())) {
+                    auto refs = findRefs(*term, atomOfTuple);
+                    if (!refs.has_value()) {
+                        return nullptr;
+                    }
+                    planner->terms.push_back({clone(term), *refs});
+                }
+                op = &filter->getOperation();
+                continue;
+            }
+            break;
+        }
+
+        const auto& relOp = scan != nullptr ? static_cast<const ram::RelationOperation&>(*scan)
+                                            : static_cast<const ram::RelationOperation&>(*indexScan);
+        const ram::Relation& rel = relAnalysis.lookup(relOp.getRelation());
+        const auto repr = rel.getRepresentation();
+        if (rel.getArity() == 0 || rel.getAuxiliaryArity() > 0 ||
+                (repr != RelationRepresentation::DEFAULT && repr != RelationRepresentation::BTREE) ||
+                planner->atoms.size() == maxAtoms) {
+            return nullptr;
+        }
+        const std::size_t atom = planner->atoms.size();
+        planner->atoms.push_back({rel.getName(), relOp.getTupleId(), rel.getArity(), relOp.getProfileText()});
+
+        // only index scans of equalities are reordered
+        if (indexScan != nullptr) {
+            const auto& [lower, upper] = indexScan->getRangePattern();
+            for (std::size_t column = 0; column < rel.getArity(); ++column) {
+                if (ram::isUndefValue(lower[column]) && ram::isUndefValue(upper[column])) {
+                    continue;
+                }
+                if (ram::isUndefValue(lower[column]) || ram::isUndefValue(upper[column]) ||
+                        !(*lower[column] == *upper[column])) {
+                    return nullptr;
+                }
+                auto refs = findRefs(*lower[column], atomOfTuple);
+                if (!refs.has_value()) {
+                    return nullptr;
+                }
+                Equality equality{atom, column, clone(lower[column]), *refs, std::nullopt};
+                if (const auto* element = as<ram::TupleElement>(lower[column])) {
+                    const std::size_t other = atomOfTuple.at(element->getTupleId());
+                    equality.mirror = std::make_pair(other, element->getElement());
+                }
+                planner->equalities.push_back(std::move(equality));
+            }
+        }
+        atomOfTuple[relOp.getTupleId()] = atom;
+        op = scan != nullptr ? &scan->getOperation() : &indexScan->getOperation();
+    }
+    if (planner->atoms.size() < 2) {
+        return nullptr;
+    }
+    planner->nested = clone(op);
+
+    // the attributes bound for each atom, and whether an index serves them, given the atoms placed before
+    const std::size_t count = planner->atoms.size();
+    planner->boundCount.assign(count, std::vector<std::size_t>(std::size_t(1) << count, 0));
+    planner->served.assign(count, std::vector<bool>(std::size_t(1) << count, false));
+    for (std::size_t atom = 0; atom < count; ++atom) {
+        const auto cluster = isa.getIndexSelection(planner->atoms[atom].relation);
+        for (std::size_t placed = 0; placed < (std::size_t(1) << count); ++placed) {
+            if ((placed & (std::size_t(1) << atom)) != 0) {
+                continue;
+            }
+            const auto bound = planner->getBound(atom, placed);
+            ram::analysis::SearchSignature signature(bound.size());
+            std::size_t k = 0;
+            for (std::size_t column = 0; column < bound.size(); ++column) {
+                if (bound[column]) {
+                    signature[column] = ram::analysis::AttributeConstraint::Equal;
+                    ++k;
+                }
+            }
+            planner->boundCount[atom][placed] = k;
+            planner->served[atom][placed] = k == 0 || cluster.getCoveringLexOrderNum(signature).has_value();
+        }
+    }
+
+    planner->order.resize(count);
+    std::iota(planner->order.begin(), planner->order.end(), 0);
+    return planner;
+}
+
+std::vector<std::string> JoinPlanner::getRelations() const {
+    std::vector<std::string> relations;
+    for (const auto& atom : atoms) {
+        relations.push_back(atom.relation);
+    }
+    return relations;
+}
+
+std::vector<bool> JoinPlanner::getBound(std::size_t atom, std::size_t placed) const {
+    std::vector<bool> bound(atoms[atom].arity, false);
+    for (const auto& equality : equalities) {
+        if (equality.atom == atom && (equality.refs & ~placed) == 0) {
+            bound[equality.column] = true;
+        } else if (equality.mirror.has_value() && equality.mirror->first == atom &&
+                   (placed & (std::size_t(1) << equality.atom)) != 0) {
+            bound[equality.mirror->second] = true;
+        }
+    }
+    return bound;
+}
+
+bool JoinPlanner::isOriginalOrder() const {
+    return std::is_sorted(order.begin(), order.end());
+}
+
+double JoinPlanner::estimateCost(const Order& candidate, const std::vector<std::size_t>& sizes) const {
+    double cost = 0;
+    double tuples = 1;
+    std::size_t placed = 0;
+    for (std::size_t atom : candidate) {
+        const double size = static_cast<double>(sizes[atom]);
+        const double arity = static_cast<double>(atoms[atom].arity);
+        const double free = arity - static_cast<double>(boundCount[atom][placed]);
+        tuples *= size == 0 ? 0 : std::pow(size, free / arity);
+        cost += tuples;
+        placed |= std::size_t(1) << atom;
+    }
+    return cost;
+}
+
+bool JoinPlanner::replan(const std::vector<std::size_t>& sizes) {
+    const double current = estimateCost(order, sizes);
+    if (current < minReplanCost) {
+        return false;
+    }
+
+    Order candidate(atoms.size());
+    std::iota(candidate.begin(), candidate.end(), 0);
+    Order best = order;
+    double bestCost = current;
+    do {
+        std::size_t placed = 0;
+        bool valid = true;
+        for (std::size_t atom : candidate) {
+            valid = valid && served[atom][placed];
+            placed |= std::size_t(1) << atom;
+        }
+        if (!valid) {
+            continue;
+        }
+        const double cost = estimateCost(candidate, sizes);
+        if (cost < bestCost) {
+            best = candidate;
+            bestCost = cost;
+        }
+    } while (std::next_permutation(candidate.begin(), candidate.end()));
+
+    if (bestCost * replanRatio > current) {
+        return false;
+    }
+    order = std::move(best);
+    return true;
+}
+
+Own<ram::Query> JoinPlanner::reorder() const {
+    std::vector<std::size_t> position(atoms.size());
+    for (std::size_t pos = 0; pos < order.size(); ++pos) {
+        position[order[pos]] = pos;
+    }
+
+    // bind the attributes of each atom to the equalities available once the atoms before it are placed
+    std::vector<ram::RamPattern> patterns;
+    std::vector<bool> used(equalities.size(), false);
+    std::size_t placed = 0;
+    for (std::size_t atom : order) {
+        ram::RamPattern pattern;
+        for (std::size_t column = 0; column < atoms[atom].arity; ++column) {
+            pattern.first.push_back(mk<ram::UndefValue>());
+            pattern.second.push_back(mk<ram::UndefValue>());
+        }
+        for (std::size_t i = 0; i < equalities.size(); ++i) {
+            const auto& equality = equalities[i];
+            Own<ram::Expression> value;
+            std::size_t column = 0;
+            if (equality.atom == atom && (equality.refs & ~placed) == 0) {
+                value = clone(equality.value);
+                column = equality.column;
+            } else if (equality.mirror.has_value() && equality.mirror->first == atom &&
+                       (placed & (std::size_t(1) << equality.atom)) != 0) {
+                value = mk<ram::TupleElement>(atoms[equality.atom].tupleId, equality.column);
+                column = equality.mirror->second;
+            }
+            if (value == nullptr || !ram::isUndefValue(pattern.first[column].get())) {
+                continue;
+            }
+            pattern.first[column] = clone(value);
+            pattern.second[column] = std::move(value);
+            used[i] = true;
+        }
+        patterns.push_back(std::move(pattern));
+        placed |= std::size_t(1) << atom;
+    }
+
+    // the other equalities and the conditions are checked once the atoms they refer to are placed
+    std::vector<VecOwn<ram::Condition>> conditions(atoms.size());
+    VecOwn<ram::Condition> preceding;
+    for (const auto& condition : outer) {
+        preceding.push_back(clone(condition));
+    }
+    auto addCondition = [&](Own<ram::Condition> condition, std::size_t refs) {
+        if (refs == 0) {
+            preceding.push_back(std::move(condition));
+            return;
+        }
+        std::size_t level = 0;
+        for (std::size_t atom = 0; atom < atoms.size(); ++atom) {
+            if ((refs & (std::size_t(1) << atom)) != 0) {
+                level = std::max(level, position[atom]);
+            }
+        }
+        conditions[level].push_back(std::move(condition));
+    };
+    for (std::size_t i = 0; i < equalities.size(); ++i) {
+        if (!used[i]) {
+            const auto& equality = equalities[i];
+            addCondition(mk<ram::Constraint>(BinaryConstraintOp::EQ,
+                                 mk<ram::TupleElement>(atoms[equality.atom].tupleId, equality.column),
+                                 clone(equality.value)),
+                    equality.refs | (std::size_t(1) << equality.atom));
+        }
+    }
+    for (const auto& term : terms) {
+        addCondition(clone(term.condition), term.refs);
+    }
+
+    Own<ram::Operation> op = clone(nested);
+    for (std::size_t pos = order.size(); pos-- > 0;) {
+        const Atom& atom = atoms[order[pos]];
+        if (!conditions[pos].empty()) {
+            op = mk<ram::Filter>(ram::toCondition(conditions[pos]), std::move(op));
+        }
+        auto& pattern = patterns[pos];
+        const bool indexed = std::any_of(pattern.first.begin(), pattern.first.end(),
+                [](const auto& value) { return !ram::isUndefValue(value.get()); });
+        const bool isParallel = parallel && pos == 0;
+        if (!indexed && isParallel) {
+            op = mk<ram::ParallelScan>(atom.relation, atom.tupleId, std::move(op), atom.profileText);
+        } else if (!indexed) {
+            op = mk<ram::Scan>(atom.relation, atom.tupleId, std::move(op), atom.profileText);
+        } else if (isParallel) {
+            op = mk<ram::ParallelIndexScan>(
+                    atom.relation, atom.tupleId, std::move(pattern), std::move(op), atom.profileText);
+        } else {
+            op = mk<ram::IndexScan>(
+                    atom.relation, atom.tupleId, std::move(pattern), std::move(op), atom.profileText);
+        }
+    }
+    if (!preceding.empty()) {
+        op = mk<ram::Filter>(ram::toCondition(preceding), std::move(op));
+    }
+    return mk<ram::Query>(std::move(op));
+}
+
+const Node* JoinPlanner::getPlan() const {
+    auto it = plans.find(order);
+    return it == plans.end() ? nullptr : it->second.second.get();
+}
+
+void JoinPlanner::setPlan(Own<ram::Query> query, Own<Node> node) {
+    plans[order] = std::make_pair(std::move(query), std::move(node));
+}
+
+}  // namespace souffle::interpreter
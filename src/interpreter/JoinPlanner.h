@@ -0,0 +1,170 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved.
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file JoinPlanner.h
+ *
+ * Declares the planner reordering the joins of recursive queries at runtime.
+ ***********************************************************************/
+
+#pragma once
+
+#include "interpreter/Node.h"
+#include "ram/Condition.h"
+#include "ram/Expression.h"
+#include "ram/Operation.h"
+#include "ram/Query.h"
+#include "ram/TranslationUnit.h"
+#include "souffle/utility/ContainerUtil.h"
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::interpreter {
+
+/**
+ * @class JoinPlanner
+ * @brief Planner reordering the joins of a recursive query between the iterations of its loop
+ *
+ * The atoms of a query are the scans and the index scans of equalities of its outermost loop nest.
+ * An atom binding k of the n attributes of a relation of N tuples is estimated to produce
+ * N^((n-k)/n) tuples per tuple of the atoms it is nested in, and the cost of an order is the
+ * number of tuples produced by all its atoms. Given the live sizes of the relations, the atoms are
+ * reordered only if the current order is estimated to cost several times the best order whose
+ * searches are served by the indexes of the relations, since the reordered query is generated anew.
+ */
+class JoinPlanner {
+public:
+    /** Order of the atoms of the query, outermost first */
+    using Order = std::vector<std::size_t>;
+
+    /** @brief Return a planner of the query, or null if its joins may not be reordered */
+    static Own<JoinPlanner> create(const ram::Query& query, const ram::TranslationUnit& tUnit);
+
+    /** @brief Return the relations joined by the atoms */
+    std::vector<std::string> getRelations() const;
+
+    /**
+     * @brief Select the order of the atoms given the sizes of their relations
+     * @return whether the order changed
+     */
+    bool replan(const std::vector<std::size_t>& sizes);
+
+    /** @brief Return the current order of the atoms */
+    const Order& getOrder() const {
+        return order;
+    }
+
+    /** @brief Whether the atoms are in the order of the query */
+    bool isOriginalOrder() const;
+
+    /** @brief Return the estimated cost of an order given the sizes of the relations */
+    double estimateCost(const Order& candidate, const std::vector<std::size_t>& sizes) const;
+
+    /** @brief Return the query joining the atoms in the current order */
+    Own<ram::Query> reorder() const;
+
+    /** @brief Return the node of the query in the current order, if generated */
+    const Node* getPlan() const;
+
+    /** @brief Set the node of the query in the current order, generated from the reordered query */
+    void setPlan(Own<ram::Query> query, Own<Node> node);
+
+    /** @brief Set the identifiers of the relations of the atoms in the engine */
+    void setRelationIds(std::vector<std::size_t> ids) {
+        relationIds = std::move(ids);
+    }
+
+    /** @brief Return the identifiers of the relations of the atoms in the engine */
+    const std::vector<std::size_t>& getRelationIds() const {
+        return relationIds;
+    }
+
+    /** Maximal number of atoms of a query, all of whose orders are ranked */
+    static constexpr std::size_t maxAtoms = 6;
+
+    /** Ratio of the cost of the current order to the cost of the best order triggering a reordering */
+    static constexpr double replanRatio = 4.0;
+
+    /** Cost below which the current order is kept */
+    static constexpr double minReplanCost = 1e4;
+
+private:
+    /** A scan of a relation, possibly binding some of its attributes */
+    struct Atom {
+        std::string relation;
+        std::size_t tupleId;
+        std::size_t arity;
+        std::string profileText;
+    };
+
+    /** An equality binding an attribute of an atom to a value */
+    struct Equality {
+        std::size_t atom;
+        std::size_t column;
+        Own<ram::Expression> value;
+
+        /** Atoms referred to by the value */
+        std::size_t refs;
+
+        /** The attribute of an atom the value is, if any, whose binding the equality may provide */
+        std::optional<std::pair<std::size_t, std::size_t>> mirror;
+    };
+
+    /** A condition of a filter of the loop nest */
+    struct Term {
+        Own<ram::Condition> condition;
+
+        /** Atoms referred to by the condition */
+        std::size_t refs;
+    };
+
+    JoinPlanner() = default;
+
+    /** @brief Return the attributes of an atom bound once the given atoms are */
+    std::vector<bool> getBound(std::size_t atom, std::size_t placed) const;
+
+    /** Atoms, in the order of the query */
+    std::vector<Atom> atoms;
+
+    /** Equalities of the index scans */
+    std::vector<Equality> equalities;
+
+    /** Conditions of the filters of the loop nest */
+    std::vector<Term> terms;
+
+    /** Conditions of the filter preceding the loop nest */
+    VecOwn<ram::Condition> outer;
+
+    /** Operation nested in the innermost atom */
+    Own<ram::Operation> nested;
+
+    /** Whether the outermost atom is scanned in parallel */
+    bool parallel = false;
+
+    /** Number of attributes bound for each atom and set of atoms placed before it */
+    std::vector<std::vector<std::size_t>> boundCount;
+
+    /** Whether the search of each atom is served by an index, for each set of atoms placed before it */
+    std::vector<std::vector<bool>> served;
+
+    /** Identifiers of the relations of the atoms in the engine */
+    std::vector<std::size_t> relationIds;
+
+    /** Current order */
+    Order order;
+
+    /** Reordered queries and their nodes, by order */
+    std::map<Order, std::pair<Own<ram::Query>, Own<Node>>> plans;
+};
+
+}  // namespace souffle::interpreter
@@ -25,6 +25,7 @@
 
 #include "interpreter/Util.h"
 #include "ram/Relation.h"
+#include "souffle/BinaryConstraintOps.h"
 #include "souffle/RamTypes.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
@@ -49,6 +50,7 @@ class Node;
 }
 
 namespace interpreter {
+class JoinPlanner;
 class ViewContext;
 struct RelationWrapper;
 
@@ -78,8 +80,10 @@ struct RelationWrapper;
     FOR_EACH(Expand, ExistenceCheck)\
     FOR_EACH_PROVENANCE(Expand, ProvenanceExistenceCheck)\
     Forward(Constraint)\
+    Forward(ConstantConstraint)\
     Forward(TupleOperation)\
     FOR_EACH(Expand, Scan)\
+    Forward(BatchScan)\
     FOR_EACH(Expand, ParallelScan)\
     FOR_EACH(Expand, IndexScan)\
     FOR_EACH(Expand, ParallelIndexScan)\
@@ -88,6 +92,8 @@ struct RelationWrapper;
     FOR_EACH(Expand, IndexIfExists)\
     FOR_EACH(Expand, ParallelIndexIfExists)\
     Forward(UnpackRecord)\
+    Forward(Intersection)\
+    FOR_EACH(Expand, IntersectionSource)\
     FOR_EACH(Expand, Aggregate)\
     FOR_EACH(Expand, ParallelAggregate)\
     FOR_EACH(Expand, IndexAggregate)\
@@ -100,6 +106,7 @@ struct RelationWrapper;
     Forward(SubroutineReturn)\
     Forward(Sequence)\
     Forward(Parallel)\
+    Forward(TaskGraph)\
     Forward(Loop)\
     Forward(Assign)\
     Forward(Exit)\
@@ -111,9 +118,13 @@ struct RelationWrapper;
     Forward(LogSize)\
     Forward(IO)\
     Forward(Query)\
+    FOR_EACH(Expand, Merge)\
     Forward(MergeExtend)\
     Forward(Swap)\
-    Forward(Call)
+    Forward(Call)\
+    Forward(CompactRecords)\
+    Forward(Spill)\
+    Forward(Restore)
 
 #define SINGLE_TOKEN(tok) I_##tok,
 
@@ -157,6 +168,8 @@ inline NodeType constructNodeType(Global&, std::string tokBase, const ram::Relat
         return map.at("I_" + tokBase + "_Eqrel_" + arity + "_" + auxiliaryArity);
     } else if(rel.getRepresentation() == RelationRepresentation::BTREE_DELETE) {
         return map.at("I_" + tokBase + "_BtreeDelete_" + arity + "_" + auxiliaryArity);
+    } else if(rel.getRepresentation() == RelationRepresentation::HASHSET) {
+        return map.at("I_" + tokBase + "_Hashset_" + arity + "_" + auxiliaryArity);
     } else  {
         return map.at("I_" + tokBase + "_Btree_" + arity + "_" + auxiliaryArity);
     }
@@ -351,7 +364,7 @@ protected:
 /**
  * @class BinRelOperation
  * @brief  operation that involves with two relations should inherit from this class.
- *        E.g. Swap, MergeExtend
+ *        E.g. Swap, Merge, MergeExtend
  */
 class BinRelOperation {
 public:
@@ -654,6 +667,43 @@ class Constraint : public BinaryNode {
     using BinaryNode::BinaryNode;
 };
 
+/**
+ * @class ConstantConstraint
+ * @brief Super-node of a numeric constraint between a tuple element and a constant
+ *
+ * The operands are kept for the evaluation on blocks of tuples; the element
+ * is on the left of the operator.
+ */
+class ConstantConstraint : public Constraint {
+public:
+    ConstantConstraint(const ram::Node* sdw, Own<Node> lhs, Own<Node> rhs, BinaryConstraintOp op,
+            std::size_t tupleId, std::size_t element, RamDomain constant)
+            : Constraint(I_ConstantConstraint, sdw, std::move(lhs), std::move(rhs)), op(op), tupleId(tupleId),
+              element(element), constant(constant) {}
+
+    BinaryConstraintOp getOperator() const {
+        return op;
+    }
+
+    std::size_t getTupleId() const {
+        return tupleId;
+    }
+
+    std::size_t getElement() const {
+        return element;
+    }
+
+    RamDomain getConstant() const {
+        return constant;
+    }
+
+private:
+    const BinaryConstraintOp op;
+    const std::size_t tupleId;
+    const std::size_t element;
+    const RamDomain constant;
+};
+
 /**
  * @class TupleOperation
  */
@@ -667,7 +717,28 @@ class TupleOperation : public UnaryNode {
 class Scan : public Node, public NestedOperation, public RelationalOperation {
 public:
     Scan(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, Own<Node> nested)
-            : Node(ty, sdw), NestedOperation(std::move(nested)), RelationalOperation(relHandle) {}
+            : Node(ty, sdw), NestedOperation(std::move(nested)), RelationalOperation(relHandle),
+              fusedOperation(NestedOperation::nested.get()) {}
+
+    /** @brief Fuse the leading filters of the nested operation into the scan */
+    void fuseFilters(std::vector<const Node*> conditions, const Node* operation) {
+        fusedFilters = std::move(conditions);
+        fusedOperation = operation;
+    }
+
+    /** @brief get the conditions of the fused filters */
+    const std::vector<const Node*>& getFusedFilters() const {
+        return fusedFilters;
+    }
+
+    /** @brief get the operation following the fused filters */
+    const Node* getFusedOperation() const {
+        return fusedOperation;
+    }
+
+private:
+    std::vector<const Node*> fusedFilters;
+    const Node* fusedOperation;
 };
 
 /**
@@ -751,6 +822,40 @@ protected:
     Own<Node> expr;
 };
 
+/**
+ * @class IntersectionSource
+ */
+class IntersectionSource : public Node, public SuperOperation, public ViewOperation {
+public:
+    IntersectionSource(enum NodeType ty, const ram::Node* sdw, std::size_t viewId, SuperInstruction superInst,
+            std::size_t column)
+            : Node(ty, sdw), SuperOperation(std::move(superInst)), ViewOperation(viewId), column(column) {}
+
+    /** @brief get position of the join column in the order of the index */
+    inline std::size_t getColumn() const {
+        return column;
+    }
+
+private:
+    const std::size_t column;
+};
+
+/**
+ * @class Intersection
+ */
+class Intersection : public Node, public NestedOperation {
+public:
+    Intersection(enum NodeType ty, const ram::Node* sdw, VecOwn<IntersectionSource> sources, Own<Node> nested)
+            : Node(ty, sdw), NestedOperation(std::move(nested)), sources(std::move(sources)) {}
+
+    inline const VecOwn<IntersectionSource>& getSources() const {
+        return sources;
+    }
+
+protected:
+    VecOwn<IntersectionSource> sources;
+};
+
 /**
  * @class Aggregate
  */
@@ -829,8 +934,54 @@ public:
  */
 class Insert : public Node, public SuperOperation, public RelationalOperation {
 public:
-    Insert(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, SuperInstruction superInst)
-            : Node(ty, sdw), SuperOperation(std::move(superInst)), RelationalOperation(relHandle) {}
+    Insert(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, SuperInstruction superInst,
+            bool buffered = false)
+            : Node(ty, sdw), SuperOperation(std::move(superInst)), RelationalOperation(relHandle),
+              buffered(buffered) {}
+
+    /** @brief Whether insertions within parallel operations are buffered per thread */
+    bool isBuffered() const {
+        return buffered;
+    }
+
+protected:
+    const bool buffered;
+};
+
+/**
+ * @class BatchScan
+ * @brief Scan evaluating its leading filters and its insertion on blocks of tuples
+ *
+ * The filters and the insertion are part of the nested operation; the
+ * operation following the filters is executed tuple by tuple unless it is
+ * the insertion.
+ */
+class BatchScan : public Scan {
+public:
+    BatchScan(enum NodeType ty, const ram::Node* sdw, RelationHandle* relHandle, Own<Node> nested,
+            std::vector<const Node*> filters, const Node* body, const Insert* insert)
+            : Scan(ty, sdw, relHandle, std::move(nested)), filters(std::move(filters)), body(body),
+              insert(insert) {}
+
+    /** @brief get the conditions of the filters evaluated on blocks */
+    const std::vector<const Node*>& getFilters() const {
+        return filters;
+    }
+
+    /** @brief get the operation following the filters */
+    const Node* getBody() const {
+        return body;
+    }
+
+    /** @brief get the insertion following the filters, if any */
+    const Insert* getInsert() const {
+        return insert;
+    }
+
+private:
+    const std::vector<const Node*> filters;
+    const Node* const body;
+    const Insert* const insert;
 };
 
 /**
@@ -880,6 +1031,13 @@ class Parallel : public CompoundNode {
     using CompoundNode::CompoundNode;
 };
 
+/**
+ * @class TaskGraph
+ */
+class TaskGraph : public CompoundNode {
+    using CompoundNode::CompoundNode;
+};
+
 /**
  * @class Loop
  */
@@ -951,6 +1109,63 @@ private:
     const std::string subroutineName;
 };
 
+/**
+ * @class CompactRecords
+ */
+class CompactRecords : public Node {
+public:
+    using RelationTypes = std::vector<std::pair<RelationalOperation::RelationHandle*, const ram::Relation*>>;
+
+    CompactRecords(enum NodeType ty, const ram::Node* sdw, RelationTypes relations)
+            : Node(ty, sdw), relations(std::move(relations)) {}
+
+    /** The relations whose records are kept, along with their attribute types */
+    const RelationTypes& getRelations() const {
+        return relations;
+    }
+
+private:
+    const RelationTypes relations;
+};
+
+/**
+ * @class Spill
+ */
+class Spill : public Node {
+public:
+    using Relations = std::vector<RelationalOperation::RelationHandle*>;
+
+    Spill(enum NodeType ty, const ram::Node* sdw, Relations relations)
+            : Node(ty, sdw), relations(std::move(relations)) {}
+
+    /** The relations which may be spilled, in the order they are spilled */
+    const Relations& getRelations() const {
+        return relations;
+    }
+
+private:
+    const Relations relations;
+};
+
+/**
+ * @class Restore
+ */
+class Restore : public Node {
+public:
+    using Relations = std::vector<RelationalOperation::RelationHandle*>;
+
+    Restore(enum NodeType ty, const ram::Node* sdw, Relations relations)
+            : Node(ty, sdw), relations(std::move(relations)) {}
+
+    /** The relations which are restored */
+    const Relations& getRelations() const {
+        return relations;
+    }
+
+private:
+    const Relations relations;
+};
+
 /**
  * @class LogSize
  */
@@ -973,7 +1188,36 @@ public:
  * @class Query
  */
 class Query : public UnaryNode, public AbstractParallel {
-    using UnaryNode::UnaryNode;
+public:
+    Query(enum NodeType ty, const ram::Node* sdw, Own<Node> child, std::size_t frameSize)
+            : UnaryNode(ty, sdw, std::move(child)), frameSize(frameSize) {}
+
+    /** @brief get the number of tuple slots of the query, allocated once before it runs */
+    std::size_t getFrameSize() const {
+        return frameSize;
+    }
+
+    /** @brief get the planner reordering the joins of the query at runtime, if any */
+    JoinPlanner* getJoinPlanner() const {
+        return joinPlanner;
+    }
+
+    void setJoinPlanner(JoinPlanner* planner) {
+        joinPlanner = planner;
+    }
+
+private:
+    const std::size_t frameSize;
+    JoinPlanner* joinPlanner = nullptr;
+};
+
+/**
+ * @class Merge
+ */
+class Merge : public Node, public BinRelOperation {
+public:
+    Merge(enum NodeType ty, const ram::Node* sdw, std::size_t src, std::size_t target)
+            : Node(ty, sdw), BinRelOperation(src, target) {}
 };
 
 /**
@@ -233,7 +233,7 @@ public:
             bool input = false;
             bool output = false;
             visit(prog, [&](const ram::IO& io) {
-                if (map[io.getRelation()] == &rel) {
+                if (map[io.getRelation()] == &rel && !io.isCheckpoint()) {
                     const std::string& op = io.get("operation");
                     if (op == "input") {
                         input = true;
@@ -21,9 +21,12 @@
 #include "souffle/RamTypes.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <set>
@@ -107,6 +110,34 @@ public:
 
     virtual void insert(const RamDomain*) = 0;
 
+    /**
+     * Inserts a batch of tuples stored consecutively in the given buffer.
+     */
+    virtual void insertBatch(const RamDomain* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(data + i * arity);
+        }
+    }
+
+    /**
+     * Inserts the tuples stored consecutively in the given buffer, which a
+     * thread collected during a parallel operation. Unlike insertBatch(),
+     * this operation may be invoked concurrently.
+     */
+    virtual void insertBuffer(const RamDomain* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(data + i * arity);
+        }
+    }
+
+    /**
+     * Passes the tuples in the order of the main index to the consumer, in
+     * blocks of at most the given number of tuples stored consecutively, until
+     * the consumer returns false.
+     */
+    virtual void scanBlocks(std::size_t blockSize,
+            const std::function<bool(const RamDomain*, std::size_t)>& consumer) const = 0;
+
     virtual bool contains(const RamDomain*) const = 0;
 
     virtual std::size_t size() const = 0;
@@ -134,6 +165,11 @@ public:
      */
     virtual Order getIndexOrder(std::size_t) const = 0;
 
+    /**
+     * Return the number of indexes.
+     */
+    virtual std::size_t getNumberOfIndexes() const = 0;
+
     /**
      * Obtains a view on an index of this relation, facilitating hint-supported accesses.
      *
@@ -218,6 +254,44 @@ public:
         insert(constructTuple(data));
     }
 
+    void insertBatch(const RamDomain* data, std::size_t count) override {
+        std::vector<Tuple> tuples;
+        tuples.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            tuples.push_back(constructTuple(data + i * Arity));
+        }
+        insert(tuples);
+    }
+
+    void insertBuffer(const RamDomain* data, std::size_t count) override {
+        std::vector<Tuple> tuples;
+        tuples.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            tuples.push_back(constructTuple(data + i * Arity));
+        }
+        insertBuffer(tuples);
+    }
+
+    void scanBlocks(std::size_t blockSize,
+            const std::function<bool(const RamDomain*, std::size_t)>& consumer) const override {
+        std::vector<RamDomain> block;
+        block.reserve(blockSize * Arity);
+        std::size_t count = 0;
+        for (const auto& tuple : scan()) {
+            block.insert(block.end(), tuple.begin(), tuple.end());
+            if (++count == blockSize) {
+                if (!consumer(block.data(), count)) {
+                    return;
+                }
+                block.clear();
+                count = 0;
+            }
+        }
+        if (count > 0) {
+            consumer(block.data(), count);
+        }
+    }
+
     bool contains(const RamDomain* data) const override {
         return contains(constructTuple(data));
     }
@@ -234,6 +308,10 @@ public:
         return indexes[idx]->getOrder();
     }
 
+    std::size_t getNumberOfIndexes() const override {
+        return indexes.size();
+    }
+
     class iterator_base : public RelationWrapper::iterator_base {
         iterator iter;
         Order order;
@@ -301,8 +379,61 @@ public:
      * Add all entries of the given relation to this relation.
      */
     void insert(const Relation<Arity, AuxiliaryArity, Structure>& other) {
-        for (const auto& tuple : other.scan()) {
-            this->insert(tuple);
+        // all indexes are total orders, hence they can be filled independently
+        std::vector<Tuple> tuples;
+        for (auto& index : indexes) {
+            // an index of the other relation with the same order provides a sorted range
+            auto pos = std::find_if(other.indexes.begin(), other.indexes.end(),
+                    [&](const auto& cur) { return cur->getOrder() == index->getOrder(); });
+            if (pos != other.indexes.end()) {
+                index->insert(**pos);
+                continue;
+            }
+
+            // otherwise decode the tuples of the other relation once
+            if (tuples.empty()) {
+                const Order order = other.main->getOrder();
+                for (const auto& tuple : other.scan()) {
+                    tuples.push_back(order.decode(tuple));
+                }
+            }
+            index->insert(tuples);
+        }
+    }
+
+    /**
+     * Add all entries of the given relation to this relation. Sufficiently large
+     * relations are split into the given number of partitions merged concurrently.
+     */
+    void insert(const Relation<Arity, AuxiliaryArity, Structure>& other, std::size_t partitionCount) {
+        if (partitionCount <= 1 || other.size() < parallelMergeThreshold) {
+            insert(other);
+            return;
+        }
+        for (auto& index : indexes) {
+            auto pos = std::find_if(other.indexes.begin(), other.indexes.end(),
+                    [&](const auto& cur) { return cur->getOrder() == index->getOrder(); });
+            index->insert(pos != other.indexes.end() ? **pos : *other.main, partitionCount);
+        }
+    }
+
+    /**
+     * Add a batch of tuples to this relation.
+     */
+    void insert(const std::vector<Tuple>& tuples) {
+        for (auto& index : indexes) {
+            index->insert(tuples);
+        }
+    }
+
+    /**
+     * Add a buffer of tuples collected by a single thread to this relation;
+     * the indexes of a set are total orders, hence they are filled
+     * independently.
+     */
+    void insertBuffer(const std::vector<Tuple>& tuples) {
+        for (auto& index : indexes) {
+            index->insertBuffer(tuples);
         }
     }
 
@@ -449,6 +580,10 @@ Own<RelationWrapper> createBTreeRelation(
 Own<RelationWrapper> createBTreeDeleteRelation(
         const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
 
+// A factory for hash set based relation.
+Own<RelationWrapper> createHashsetRelation(
+        const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
+
 // A factory for BTree provenance index.
 Own<RelationWrapper> createProvenanceRelation(
         const ram::Relation& id, const ram::analysis::IndexCluster& indexSelection);
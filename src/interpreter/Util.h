@@ -20,6 +20,7 @@
 #include "souffle/datastructure/BTree.h"
 #include "souffle/datastructure/BTreeDelete.h"
 #include "souffle/datastructure/Brie.h"
+#include "souffle/datastructure/ConcurrentHashSet.h"
 #include "souffle/datastructure/EquivalenceRelation.h"
 #include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
@@ -113,6 +114,28 @@ namespace souffle::interpreter {
     func(BtreeDelete, 19, 0, __VA_ARGS__) \
     func(BtreeDelete, 20, 0, __VA_ARGS__)
 
+#define FOR_EACH_HASHSET(func, ...)\
+    func(Hashset, 1, 0, __VA_ARGS__) \
+    func(Hashset, 2, 0, __VA_ARGS__) \
+    func(Hashset, 3, 0, __VA_ARGS__) \
+    func(Hashset, 4, 0, __VA_ARGS__) \
+    func(Hashset, 5, 0, __VA_ARGS__) \
+    func(Hashset, 6, 0, __VA_ARGS__) \
+    func(Hashset, 7, 0, __VA_ARGS__) \
+    func(Hashset, 8, 0, __VA_ARGS__) \
+    func(Hashset, 9, 0, __VA_ARGS__) \
+    func(Hashset, 10, 0, __VA_ARGS__) \
+    func(Hashset, 11, 0, __VA_ARGS__) \
+    func(Hashset, 12, 0, __VA_ARGS__) \
+    func(Hashset, 13, 0, __VA_ARGS__) \
+    func(Hashset, 14, 0, __VA_ARGS__) \
+    func(Hashset, 15, 0, __VA_ARGS__) \
+    func(Hashset, 16, 0, __VA_ARGS__) \
+    func(Hashset, 17, 0, __VA_ARGS__) \
+    func(Hashset, 18, 0, __VA_ARGS__) \
+    func(Hashset, 19, 0, __VA_ARGS__) \
+    func(Hashset, 20, 0, __VA_ARGS__)
+
 // Brie is disabled for now.
 #define FOR_EACH_BRIE(func, ...)
     /* func(Brie, 0, __VA_ARGS__) \ */
@@ -143,6 +166,7 @@ namespace souffle::interpreter {
 #define FOR_EACH(func, ...)                 \
     FOR_EACH_BTREE(func, __VA_ARGS__)       \
     FOR_EACH_BTREE_DELETE(func, __VA_ARGS__)\
+    FOR_EACH_HASHSET(func, __VA_ARGS__)     \
     FOR_EACH_BRIE(func, __VA_ARGS__)        \
     FOR_EACH_PROVENANCE(func, __VA_ARGS__)  \
     FOR_EACH_EQREL(func, __VA_ARGS__)
@@ -161,6 +185,10 @@ struct comparator;
 
 template <unsigned First, unsigned... Rest>
 struct comparator<First, Rest...> {
+    // the attribute compared first, enabling detail::simd_search in b-tree nodes
+    static constexpr std::size_t leading_column = First;
+    using leading_type = RamDomain;
+
     template <typename T>
     int operator()(const T& a, const T& b) const {
         return (a[First] < b[First]) ? -1 : ((a[First] > b[First]) ? 1 : comparator<Rest...>()(a, b));
@@ -279,7 +307,7 @@ struct ProvenanceUpdater {
 
 // Alias for btree_set
 template <std::size_t Arity, std::size_t AuxiliaryArity>
-using Btree = btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>, 256,
+using Btree = btree_set<t_tuple<Arity>, comparator<Arity>, arena_allocator<t_tuple<Arity>>, 256,
         typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - AuxiliaryArity>,
         Updater<Arity, AuxiliaryArity>>;
 
@@ -289,12 +317,16 @@ using BtreeDelete = btree_delete_set<t_tuple<Arity>, comparator<Arity>, std::all
         typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - AuxiliaryArity>,
         Updater<Arity, AuxiliaryArity>>;
 
+// Alias for ConcurrentHashSet
+template <std::size_t Arity, std::size_t AuxiliaryArity>
+using Hashset = ConcurrentHashSet<t_tuple<Arity>>;
+
 // Alias for Trie
 template <std::size_t Arity, std::size_t AuxiliaryArity>
 using Brie = Trie<Arity>;
 
 template <std::size_t Arity, std::size_t AuxiliaryArity>
-using Provenance = btree_set<t_tuple<Arity>, comparator<Arity>, std::allocator<t_tuple<Arity>>, 256,
+using Provenance = btree_set<t_tuple<Arity>, comparator<Arity>, arena_allocator<t_tuple<Arity>>, 256,
         typename detail::default_strategy<t_tuple<Arity>>::type, comparator<Arity - AuxiliaryArity>,
         ProvenanceUpdater<Arity, AuxiliaryArity>>;
 
@@ -16,14 +16,17 @@
 
 #include "tests/test.h"
 
+#include "interpreter/Context.h"
 #include "interpreter/ProgInterface.h"
 #include "interpreter/Relation.h"
 #include "ram/analysis/Index.h"
 #include "souffle/SouffleInterface.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/utility/ParallelUtil.h"
 #include <iosfwd>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace souffle::interpreter::test {
 
@@ -287,4 +290,233 @@ TEST(Reordering, Iteration) {
     }
 }
 
+TEST(Merge, Reordering) {
+    // create relations of arity 3 with different index orders
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(3);
+    SearchSet searches = {existenceCheck};
+
+    LexOrder order021 = {0, 2, 1};
+    LexOrder order102 = {1, 0, 2};
+    LexOrder order210 = {2, 1, 0};
+    SignatureOrderMap targetMapping;
+    targetMapping.insert({existenceCheck, order021});
+    IndexCluster targetSelection(targetMapping, searches, {order021, order102});
+    SignatureOrderMap sourceMapping;
+    sourceMapping.insert({existenceCheck, order210});
+    IndexCluster sourceSelection(sourceMapping, searches, {order210, order021});
+
+    Relation<3, 0, interpreter::Btree> target("target", targetSelection);
+    Relation<3, 0, interpreter::Btree> source("source", sourceSelection);
+
+    // fill the source in a batch, including a duplicate
+    std::vector<RamDomain> data;
+    for (RamDomain i = 0; i < 1000; i++) {
+        data.insert(data.end(), {i % 10, i % 7, i});
+    }
+    data.insert(data.end(), {0, 0, 0});
+    RelationWrapper* wrapper = &source;
+    wrapper->insertBatch(data.data(), data.size() / 3);
+    EXPECT_EQ(1000, source.size());
+
+    // the target already contains some of the tuples
+    for (RamDomain i = 0; i < 1000; i += 3) {
+        target.insert(souffle::Tuple<RamDomain, 3>{i % 10, i % 7, i});
+    }
+    target.insert(souffle::Tuple<RamDomain, 3>{42, 42, 4242});
+
+    target.insert(source);
+    EXPECT_EQ(1001, target.size());
+
+    // all indexes of the target hold the decoded tuples
+    for (std::size_t idx = 0; idx < 2; idx++) {
+        std::size_t count = 0;
+        Order order = target.getIndexOrder(idx);
+        for (const auto& cur : target.getIndex(idx)->scan()) {
+            auto t = order.decode(cur);
+            EXPECT_TRUE(t[2] == 4242 || (t[0] == t[2] % 10 && t[1] == t[2] % 7));
+            count++;
+        }
+        EXPECT_EQ(1001, count);
+    }
+}
+
+TEST(Merge, Parallel) {
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(2);
+    SearchSet searches = {existenceCheck};
+
+    LexOrder order01 = {0, 1};
+    LexOrder order10 = {1, 0};
+    SignatureOrderMap mapping;
+    mapping.insert({existenceCheck, order01});
+    IndexCluster targetSelection(mapping, searches, {order01, order10});
+    IndexCluster sourceSelection(mapping, searches, {order01});
+
+    Relation<2, 0, interpreter::Btree> target("target", targetSelection);
+    Relation<2, 0, interpreter::Btree> source("source", sourceSelection);
+
+    // the source is large enough to be merged partition by partition
+    const RamDomain N = 50000;
+    for (RamDomain i = 0; i < N; i++) {
+        source.insert(souffle::Tuple<RamDomain, 2>{i % 100, i});
+    }
+    for (RamDomain i = 0; i < N; i += 2) {
+        target.insert(souffle::Tuple<RamDomain, 2>{i % 100, i});
+    }
+
+    target.insert(source, 40);
+    EXPECT_EQ(N, target.size());
+
+    for (std::size_t idx = 0; idx < 2; idx++) {
+        std::size_t count = 0;
+        Order order = target.getIndexOrder(idx);
+        for (const auto& cur : target.getIndex(idx)->scan()) {
+            auto t = order.decode(cur);
+            EXPECT_EQ(t[1] % 100, t[0]);
+            count++;
+        }
+        EXPECT_EQ(N, count);
+    }
+}
+
+TEST(InsertBuffers, Parallel) {
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(2);
+    SearchSet searches = {existenceCheck};
+
+    LexOrder order01 = {0, 1};
+    LexOrder order10 = {1, 0};
+    SignatureOrderMap mapping;
+    mapping.insert({existenceCheck, order01});
+    IndexCluster indexSelection(mapping, searches, {order01, order10});
+
+    Relation<2, 0, interpreter::Btree> rel("test", indexSelection);
+    rel.insert(souffle::Tuple<RamDomain, 2>{0, 0});
+
+    // each thread buffers its tuples, deriving every tuple several times
+    const int N = 10000;
+#pragma omp parallel
+    {
+        InsertBuffers buffers;
+#pragma omp for
+        for (int i = 0; i < 3 * N; i++) {
+            RamDomain tuple[2] = {(i % N) % 100, i % N};
+            buffers.append(rel, tuple);
+        }
+        buffers.flush();
+    }
+    EXPECT_EQ(N, rel.size());
+
+    for (std::size_t idx = 0; idx < 2; idx++) {
+        std::size_t count = 0;
+        Order order = rel.getIndexOrder(idx);
+        for (const auto& cur : rel.getIndex(idx)->scan()) {
+            auto t = order.decode(cur);
+            EXPECT_EQ(t[1] % 100, t[0]);
+            count++;
+        }
+        EXPECT_EQ(N, count);
+    }
+}
+
+TEST(InsertBuffers, Limit) {
+    LexOrder order01 = {0, 1};
+    IndexCluster indexSelection({}, {}, {order01});
+    Relation<2, 0, interpreter::Btree> rel("test", indexSelection);
+
+    // a full buffer is inserted right away, the remaining tuples once the buffers are flushed
+    const RamDomain N = static_cast<RamDomain>(insertBufferLimit);
+    InsertBuffers buffers;
+    for (RamDomain i = 0; i <= N; i++) {
+        RamDomain tuple[2] = {i, i};
+        buffers.append(rel, tuple);
+    }
+    EXPECT_EQ(N, rel.size());
+    buffers.flush();
+    EXPECT_EQ(N + 1, rel.size());
+}
+
+TEST(Batch, ScanBlocks) {
+    LexOrder order01 = {0, 1};
+    IndexCluster indexSelection({}, {}, {order01});
+
+    Relation<2, 0, interpreter::Btree> rel("test", indexSelection);
+    const RamDomain N = 2500;
+    for (RamDomain i = 0; i < N; i++) {
+        rel.insert(souffle::Tuple<RamDomain, 2>{i, i % 10});
+    }
+
+    // blocks are full except for the last one, and keep the order of the main index
+    std::vector<std::size_t> sizes;
+    RamDomain previous = -1;
+    rel.scanBlocks(Batch::SIZE, [&](const RamDomain* block, std::size_t count) {
+        sizes.push_back(count);
+        for (std::size_t i = 0; i < count; i++) {
+            EXPECT_LT(previous, block[2 * i] * N + block[2 * i + 1]);
+            previous = block[2 * i] * N + block[2 * i + 1];
+        }
+        return true;
+    });
+    EXPECT_EQ((std::vector<std::size_t>{Batch::SIZE, Batch::SIZE, N - 2 * Batch::SIZE}), sizes);
+
+    // the consumer stops the scan
+    std::size_t blocks = 0;
+    rel.scanBlocks(Batch::SIZE, [&](const RamDomain*, std::size_t) { return ++blocks < 2; });
+    EXPECT_EQ(2, blocks);
+
+    // selections keep the order of the block
+    Batch batch(0, 2);
+    rel.scanBlocks(Batch::SIZE, [&](const RamDomain* block, std::size_t count) {
+        batch.reset(block, count);
+        return false;
+    });
+    batch.retain([&](std::size_t i) { return batch.getTuple(i)[1] % 2 == 0; });
+    EXPECT_EQ(Batch::SIZE / 2, batch.size());
+    batch.retain([&](std::size_t i) { return i < 3; });
+    EXPECT_EQ(3, batch.size());
+    for (std::size_t i = 0; i < batch.size(); i++) {
+        EXPECT_EQ(2 * RamDomain(i), batch.getTuple(i)[0]);
+        EXPECT_EQ(2 * RamDomain(i), batch.getTuple(i)[1]);
+    }
+    batch.retain([](std::size_t) { return false; });
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(Hashset, Existence) {
+    SearchSignature existenceCheck = SearchSignature::getFullSearchSignature(2);
+    SearchSet searches = {existenceCheck};
+    LexOrder order10 = {1, 0};
+    SignatureOrderMap mapping;
+    mapping.insert({existenceCheck, order10});
+    IndexCluster indexSelection(mapping, searches, {order10});
+
+    Relation<2, 0, interpreter::Hashset> rel("test", indexSelection);
+    Relation<2, 0, interpreter::Hashset> other("other", indexSelection);
+
+    for (RamDomain i = 0; i < 1000; i++) {
+        EXPECT_TRUE(rel.insert(souffle::Tuple<RamDomain, 2>{i, i + 1}));
+        EXPECT_FALSE(rel.insert(souffle::Tuple<RamDomain, 2>{i, i + 1}));
+    }
+    for (RamDomain i = 0; i < 2000; i++) {
+        other.insert(souffle::Tuple<RamDomain, 2>{i, i + 1});
+    }
+    EXPECT_EQ(1000, rel.size());
+
+    rel.insert(other);
+    EXPECT_EQ(2000, rel.size());
+
+    Order order = rel.getIndexOrder(0);
+    auto view = rel.getIndex(0)->createView();
+    for (RamDomain i = 0; i < 2000; i++) {
+        EXPECT_TRUE(view.contains(order.encode(souffle::Tuple<RamDomain, 2>{i, i + 1})));
+        EXPECT_FALSE(view.contains(order.encode(souffle::Tuple<RamDomain, 2>{i + 1, i})));
+    }
+
+    std::size_t count = 0;
+    for (const auto& cur : rel.getIndex(0)->scan()) {
+        auto t = order.decode(cur);
+        EXPECT_EQ(t[0] + 1, t[1]);
+        count++;
+    }
+    EXPECT_EQ(2000, count);
+}
+
 }  // namespace souffle::interpreter::test
@@ -19,22 +19,40 @@
 #include "Global.h"
 #include "RelationTag.h"
 #include "interpreter/Engine.h"
+#include "interpreter/JoinPlanner.h"
+#include "ram/Clear.h"
+#include "ram/Constraint.h"
+#include "ram/Exit.h"
 #include "ram/Expression.h"
+#include "ram/Filter.h"
+#include "ram/FloatConstant.h"
 #include "ram/IO.h"
+#include "ram/IndexScan.h"
 #include "ram/Insert.h"
+#include "ram/Loop.h"
+#include "ram/Parallel.h"
+#include "ram/ParallelScan.h"
 #include "ram/Program.h"
 #include "ram/Query.h"
 #include "ram/Relation.h"
+#include "ram/Scan.h"
 #include "ram/Sequence.h"
 #include "ram/SignedConstant.h"
 #include "ram/Statement.h"
 #include "ram/StringConstant.h"
+#include "ram/TaskGraph.h"
+#include "ram/True.h"
 #include "ram/TranslationUnit.h"
+#include "ram/TupleElement.h"
+#include "ram/UndefValue.h"
+#include "ram/UnsignedConstant.h"
 #include "reports/DebugReport.h"
 #include "reports/ErrorReport.h"
+#include "souffle/BinaryConstraintOps.h"
 #include "souffle/RamTypes.h"
 #include "souffle/SymbolTable.h"
 #include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/StringUtil.h"
 #include "souffle/utility/json11.h"
 #include <algorithm>
 #include <cstddef>
@@ -625,4 +643,399 @@ meow	-3	3	0.5
     std::cin.rdbuf(backupCin);
 }
 
+/** Prints the size of the given relation of signed numbers */
+Own<ram::Statement> printSize(const std::string& name, std::size_t arity) {
+    std::vector<std::string> attributes;
+    for (std::size_t i = 0; i < arity; i++) {
+        attributes.push_back("x" + std::to_string(i));
+    }
+    Json types = Json::object{{"relation", Json::object{{"arity", static_cast<long long>(arity)},
+                                                   {"types", Json::array(arity, Json("i"))}}}};
+    std::map<std::string, std::string> dirs = {{"operation", "printsize"}, {"IO", "stdoutprintsize"},
+            {"attributeNames", toString(join(attributes, "\t"))}, {"name", name}, {"auxArity", "0"},
+            {"types", types.dump()}};
+    return mk<ram::IO>(name, dirs);
+}
+
+/** Runs the given program with the given number of threads, and returns what it prints */
+const std::string runProgram(Global& glb, Own<ram::Program> prog, std::size_t numThreads) {
+    glb.config().set("jobs", std::to_string(numThreads));
+
+    ErrorReport errReport;
+    DebugReport debugReport(glb);
+
+    TranslationUnit translationUnit(glb, std::move(prog), errReport, debugReport);
+
+    // configure and execute interpreter
+    Own<Engine> interpreter = mk<Engine>(translationUnit, numThreads);
+
+    std::streambuf* oldCoutStreambuf = std::cout.rdbuf();
+    std::ostringstream sout;
+    std::cout.rdbuf(sout.rdbuf());
+
+    interpreter->executeMain();
+
+    std::cout.rdbuf(oldCoutStreambuf);
+
+    return sout.str();
+}
+
+/** Joins relation A with itself, i.e. inserts (x, z) into the given relation for all A(x, y), A(y, z) */
+Own<ram::Statement> selfJoin(const std::string& target) {
+    VecOwn<Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    values.push_back(mk<ram::TupleElement>(1, 1));
+    return mk<ram::Query>(mk<ram::Scan>("A", 0,
+            mk<ram::Scan>("A", 1,
+                    mk<ram::Filter>(mk<ram::Constraint>(BinaryConstraintOp::EQ, mk<ram::TupleElement>(0, 1),
+                                            mk<ram::TupleElement>(1, 0)),
+                            mk<ram::Insert>(target, std::move(values))))));
+}
+
+const std::string testInterpreterTaskGraph(std::size_t numThreads) {
+    VecOwn<ram::Relation> rels;
+    VecOwn<ram::Statement> printSizes;
+    for (std::string name : {"A", "B", "C", "D", "E"}) {
+        rels.push_back(mk<ram::Relation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+        printSizes.push_back(printSize(name, 2));
+    }
+
+    VecOwn<ram::Statement> facts;
+    for (RamDomain i = 0; i < 300; i++) {
+        for (RamDomain j = 1; j <= 5; j++) {
+            VecOwn<Expression> values;
+            values.push_back(mk<SignedConstant>(i));
+            values.push_back(mk<SignedConstant>(i + j));
+            facts.push_back(mk<ram::Query>(mk<ram::Insert>("A", std::move(values))));
+        }
+    }
+
+    /*
+     * TASK GRAPH
+     *  TASK 0
+     *   A = facts
+     *  TASK 1 AFTER 0
+     *   PARALLEL B, C, D = A o A
+     *  TASK 2 AFTER 0
+     *   E = A o A
+     *  TASK 3 AFTER 1 2
+     *   PRINTSIZE A, B, C, D, E
+     *  TASK 4 AFTER 3
+     *   CLEAR A
+     * END TASK GRAPH
+     */
+    VecOwn<ram::Statement> tasks;
+    tasks.push_back(mk<ram::Sequence>(std::move(facts)));
+    tasks.push_back(mk<ram::Parallel>(selfJoin("B"), selfJoin("C"), selfJoin("D")));
+    tasks.push_back(selfJoin("E"));
+    tasks.push_back(mk<ram::Sequence>(std::move(printSizes)));
+    tasks.push_back(mk<ram::Clear>("A"));
+    Own<ram::Statement> main = mk<ram::TaskGraph>(
+            std::move(tasks), std::vector<std::vector<std::size_t>>{{}, {0}, {0}, {1, 2}, {3}});
+
+    std::map<std::string, Own<Statement>> subs;
+    Global glb;
+    return runProgram(glb, mk<Program>(std::move(rels), std::move(main), std::move(subs)), numThreads);
+}
+
+TEST(TaskGraph, ParallelRules) {
+    // values reach the values two to ten above them in two steps, except near the end
+    std::string expected = "A\t1500\nB\t2681\nC\t2681\nD\t2681\nE\t2681\n";
+    EXPECT_EQ(expected, testInterpreterTaskGraph(1));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(expected, testInterpreterTaskGraph(4));
+    }
+}
+
+/** Filters the tuples of A through the given conditions into the given relation */
+Own<ram::Statement> filterA(const std::string& target, VecOwn<ram::Condition> conditions) {
+    VecOwn<Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    Own<ram::Operation> operation = mk<ram::Insert>(target, std::move(values));
+    for (auto it = conditions.rbegin(); it != conditions.rend(); ++it) {
+        operation = mk<ram::Filter>(std::move(*it), std::move(operation));
+    }
+    return mk<ram::Query>(mk<ram::Scan>("A", 0, std::move(operation)));
+}
+
+const std::string testInterpreterConstantFilters() {
+    // A(x, y, z, s) holds (i, i, i + 0.5, "even" or "odd") for i in [0, 100)
+    VecOwn<ram::Relation> rels;
+    rels.push_back(mk<ram::Relation>("A", 4, 0, std::vector<std::string>{"x", "y", "z", "s"},
+            std::vector<std::string>{"i", "u", "f", "s"}, RelationRepresentation::BTREE));
+    VecOwn<ram::Statement> stmts;
+    for (RamDomain i = 0; i < 100; i++) {
+        VecOwn<Expression> values;
+        values.push_back(mk<SignedConstant>(i));
+        values.push_back(mk<UnsignedConstant>(i));
+        values.push_back(mk<FloatConstant>(i + 0.5));
+        values.push_back(mk<ram::StringConstant>(i % 2 == 0 ? "even" : "odd"));
+        stmts.push_back(mk<ram::Query>(mk<ram::Insert>("A", std::move(values))));
+    }
+
+    using BCO = BinaryConstraintOp;
+    auto compare = [](BCO op, Own<Expression> lhs, Own<Expression> rhs) {
+        VecOwn<ram::Condition> conditions;
+        conditions.push_back(mk<ram::Constraint>(op, std::move(lhs), std::move(rhs)));
+        return conditions;
+    };
+    auto x = []() { return mk<ram::TupleElement>(0, 0); };
+    std::vector<VecOwn<ram::Condition>> filters;
+    filters.push_back(compare(BCO::LT, x(), mk<SignedConstant>(30)));
+    filters.push_back(compare(BCO::GT, mk<SignedConstant>(30), x()));
+    filters.push_back(compare(BCO::GE, x(), mk<SignedConstant>(90)));
+    filters.push_back(compare(BCO::LE, mk<SignedConstant>(90), x()));
+    filters.push_back(compare(BCO::EQ, mk<SignedConstant>(42), x()));
+    filters.push_back(compare(BCO::NE, x(), mk<SignedConstant>(42)));
+    filters.push_back(compare(BCO::ULT, mk<ram::TupleElement>(0, 1), mk<UnsignedConstant>(5)));
+    filters.push_back(compare(BCO::UGE, mk<UnsignedConstant>(5), mk<ram::TupleElement>(0, 1)));
+    filters.push_back(compare(BCO::FLT, mk<ram::TupleElement>(0, 2), mk<FloatConstant>(9.5)));
+    filters.push_back(compare(BCO::FGT, mk<FloatConstant>(9.5), mk<ram::TupleElement>(0, 2)));
+    filters.push_back(compare(BCO::EQ, mk<ram::TupleElement>(0, 3), mk<ram::StringConstant>("odd")));
+    filters.push_back(compare(BCO::NE, mk<ram::StringConstant>("odd"), mk<ram::TupleElement>(0, 3)));
+    filters.push_back(compare(BCO::EQ, x(), mk<ram::TupleElement>(0, 1)));
+    // several filters in a row are fused into the scan
+    filters.push_back(compare(BCO::GT, x(), mk<SignedConstant>(10)));
+    filters.back().push_back(mk<ram::Constraint>(BCO::LE, x(), mk<SignedConstant>(20)));
+    filters.back().push_back(mk<ram::Constraint>(BCO::NE, x(), mk<SignedConstant>(15)));
+
+    VecOwn<ram::Statement> printSizes;
+    for (std::size_t i = 0; i < filters.size(); i++) {
+        const std::string name = "R" + std::to_string(i);
+        rels.push_back(mk<ram::Relation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+        stmts.push_back(filterA(name, std::move(filters[i])));
+        printSizes.push_back(printSize(name, 1));
+    }
+    stmts.push_back(mk<ram::Sequence>(std::move(printSizes)));
+
+    std::map<std::string, Own<Statement>> subs;
+    Own<ram::Program> prog =
+            mk<Program>(std::move(rels), mk<ram::Sequence>(std::move(stmts)), std::move(subs));
+
+    Global glb;
+    return runProgram(glb, std::move(prog), 1);
+}
+
+TEST(SuperNodes, ConstantFilters) {
+    std::string expected =
+            "R0\t30\nR1\t30\nR2\t10\nR3\t10\nR4\t1\nR5\t99\nR6\t5\nR7\t6\nR8\t9\nR9\t9\n"
+            "R10\t50\nR11\t50\nR12\t100\nR13\t9\n";
+    EXPECT_EQ(expected, testInterpreterConstantFilters());
+}
+
+const std::string testInterpreterDeepJoin(std::size_t numThreads, bool workStealing = false) {
+    // E(x, x + 1) and E(x, x + 2) for x in [0, 100)
+    VecOwn<ram::Relation> rels;
+    for (std::string name : {"E", "P"}) {
+        rels.push_back(mk<ram::Relation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    }
+    VecOwn<ram::Statement> stmts;
+    for (RamDomain i = 0; i < 100; i++) {
+        for (RamDomain d = 1; d <= 2; d++) {
+            VecOwn<Expression> values;
+            values.push_back(mk<SignedConstant>(i));
+            values.push_back(mk<SignedConstant>(i + d));
+            stmts.push_back(mk<ram::Query>(mk<ram::Insert>("E", std::move(values))));
+        }
+    }
+
+    // P(a, g) :- E(a, b), E(b, c), E(c, d), E(d, e), E(e, f), E(f, g).
+    VecOwn<Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    values.push_back(mk<ram::TupleElement>(5, 1));
+    Own<ram::Operation> operation = mk<ram::Insert>("P", std::move(values));
+    for (std::size_t i = 5; i > 0; i--) {
+        VecOwn<Expression> low;
+        low.push_back(mk<ram::TupleElement>(i - 1, 1));
+        low.push_back(mk<UndefValue>());
+        VecOwn<Expression> high;
+        high.push_back(mk<ram::TupleElement>(i - 1, 1));
+        high.push_back(mk<UndefValue>());
+        operation = mk<ram::IndexScan>(
+                "E", i, std::make_pair(std::move(low), std::move(high)), std::move(operation));
+    }
+    if (numThreads > 1) {
+        operation = mk<ram::ParallelScan>("E", 0, std::move(operation));
+    } else {
+        operation = mk<ram::Scan>("E", 0, std::move(operation));
+    }
+    stmts.push_back(mk<ram::Query>(std::move(operation)));
+    stmts.push_back(printSize("P", 2));
+
+    std::map<std::string, Own<Statement>> subs;
+    Own<ram::Program> prog =
+            mk<Program>(std::move(rels), mk<ram::Sequence>(std::move(stmts)), std::move(subs));
+
+    Global glb;
+    if (workStealing) {
+        glb.config().set("work-stealing");
+    }
+    return runProgram(glb, std::move(prog), numThreads);
+}
+
+TEST(Frame, DeepJoin) {
+    // the tuples of the six atoms are bound to the slots of a single frame per thread
+    EXPECT_EQ("P\t650\n", testInterpreterDeepJoin(1));
+    EXPECT_EQ("P\t650\n", testInterpreterDeepJoin(4));
+}
+
+TEST(WorkStealing, DeepJoin) {
+    // the threads steal the partitions of the outer scan from each other
+    EXPECT_EQ("P\t650\n", testInterpreterDeepJoin(4, true));
+    EXPECT_EQ("P\t650\n", testInterpreterDeepJoin(1, true));
+}
+
+const std::string testInterpreterParallelBatchScan(std::size_t numThreads) {
+    // A(x) and B(x) for x in [0, 300)
+    VecOwn<ram::Relation> rels;
+    for (std::string name : {"A", "B"}) {
+        rels.push_back(mk<ram::Relation>(name, 1, 0, std::vector<std::string>{"x"},
+                std::vector<std::string>{"i"}, RelationRepresentation::BTREE));
+    }
+    rels.push_back(mk<ram::Relation>("R", 2, 0, std::vector<std::string>{"x", "y"},
+            std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    VecOwn<ram::Statement> stmts;
+    for (std::string name : {"A", "B"}) {
+        for (RamDomain i = 0; i < 300; i++) {
+            VecOwn<Expression> values;
+            values.push_back(mk<SignedConstant>(i));
+            stmts.push_back(mk<ram::Query>(mk<ram::Insert>(name, std::move(values))));
+        }
+    }
+
+    // R(x, y) :- A(x), B(y), where the inner scan inserts its batches from all threads
+    VecOwn<Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    values.push_back(mk<ram::TupleElement>(1, 0));
+    stmts.push_back(mk<ram::Query>(
+            mk<ram::ParallelScan>("A", 0, mk<ram::Scan>("B", 1, mk<ram::Insert>("R", std::move(values))))));
+    stmts.push_back(printSize("R", 2));
+
+    std::map<std::string, Own<Statement>> subs;
+    Own<ram::Program> prog =
+            mk<Program>(std::move(rels), mk<ram::Sequence>(std::move(stmts)), std::move(subs));
+
+    Global glb;
+    glb.config().set("batch-execution");
+    return runProgram(glb, std::move(prog), numThreads);
+}
+
+TEST(BatchScan, NestedInParallelScan) {
+    // R is not buffered, so the batches of all threads are inserted into it concurrently
+    EXPECT_EQ("R\t90000\n", testInterpreterParallelBatchScan(1));
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ("R\t90000\n", testInterpreterParallelBatchScan(4));
+    }
+}
+
+/** P(x, z) :- D(x, y), E(y, z), in a loop, with D much larger than E */
+Own<ram::Program> makeAdaptiveJoinsProgram(const ram::Query*& recursive) {
+    VecOwn<ram::Relation> rels;
+    for (std::string name : {"D", "E", "P"}) {
+        rels.push_back(mk<ram::Relation>(name, 2, 0, std::vector<std::string>{"x", "y"},
+                std::vector<std::string>{"i", "i"}, RelationRepresentation::BTREE));
+    }
+
+    // D(x, x % 10) for x in [0, 4000) and E(y, y + 100) for y in [0, 10)
+    VecOwn<ram::Statement> stmts;
+    auto insert = [&](const std::string& rel, RamDomain x, RamDomain y) {
+        VecOwn<Expression> values;
+        values.push_back(mk<SignedConstant>(x));
+        values.push_back(mk<SignedConstant>(y));
+        stmts.push_back(mk<ram::Query>(mk<ram::Insert>(rel, std::move(values))));
+    };
+    for (RamDomain x = 0; x < 4000; x++) {
+        insert("D", x, x % 10);
+    }
+    for (RamDomain y = 0; y < 10; y++) {
+        insert("E", y, y + 100);
+    }
+
+    // P(x, y) :- D(x, y), y = 100, searching D by its second attribute
+    {
+        VecOwn<Expression> low;
+        low.push_back(mk<UndefValue>());
+        low.push_back(mk<SignedConstant>(100));
+        VecOwn<Expression> high;
+        high.push_back(mk<UndefValue>());
+        high.push_back(mk<SignedConstant>(100));
+        VecOwn<Expression> values;
+        values.push_back(mk<ram::TupleElement>(0, 0));
+        values.push_back(mk<ram::TupleElement>(0, 1));
+        stmts.push_back(mk<ram::Query>(mk<ram::IndexScan>("D", 0,
+                std::make_pair(std::move(low), std::move(high)), mk<ram::Insert>("P", std::move(values)))));
+    }
+
+    VecOwn<Expression> values;
+    values.push_back(mk<ram::TupleElement>(0, 0));
+    values.push_back(mk<ram::TupleElement>(1, 1));
+    VecOwn<Expression> low;
+    low.push_back(mk<ram::TupleElement>(0, 1));
+    low.push_back(mk<UndefValue>());
+    VecOwn<Expression> high;
+    high.push_back(mk<ram::TupleElement>(0, 1));
+    high.push_back(mk<UndefValue>());
+    auto query = mk<ram::Query>(mk<ram::Scan>("D", 0,
+            mk<ram::IndexScan>("E", 1, std::make_pair(std::move(low), std::move(high)),
+                    mk<ram::Insert>("P", std::move(values)))));
+    recursive = query.get();
+    stmts.push_back(mk<ram::Loop>(mk<ram::Sequence>(std::move(query), mk<ram::Exit>(mk<ram::True>()))));
+    stmts.push_back(printSize("P", 2));
+
+    std::map<std::string, Own<Statement>> subs;
+    return mk<Program>(std::move(rels), mk<ram::Sequence>(std::move(stmts)), std::move(subs));
+}
+
+const std::string testInterpreterAdaptiveJoins(bool adaptive) {
+    Global glb;
+    if (adaptive) {
+        glb.config().set("adaptive-joins");
+    }
+    const ram::Query* recursive = nullptr;
+    return runProgram(glb, makeAdaptiveJoinsProgram(recursive), 1);
+}
+
+TEST(AdaptiveJoins, Reorder) {
+    Global glb;
+    const ram::Query* recursive = nullptr;
+    ErrorReport errReport;
+    DebugReport debugReport(glb);
+    TranslationUnit translationUnit(glb, makeAdaptiveJoinsProgram(recursive), errReport, debugReport);
+
+    auto planner = JoinPlanner::create(*recursive, translationUnit);
+    ASSERT_TRUE(planner != nullptr);
+    EXPECT_EQ((std::vector<std::string>{"D", "E"}), planner->getRelations());
+
+    // small relations, or a small delta, keep the order of the query
+    EXPECT_FALSE(planner->replan({100, 10}));
+    EXPECT_FALSE(planner->replan({10, 4000}));
+    EXPECT_TRUE(planner->isOriginalOrder());
+
+    // a large delta scanned first is reordered to be searched by its second attribute
+    EXPECT_TRUE(planner->replan({4000, 10}));
+    EXPECT_EQ((JoinPlanner::Order{1, 0}), planner->getOrder());
+    auto reordered = planner->reorder();
+    const auto* scan = as<ram::Scan>(reordered->getOperation());
+    ASSERT_TRUE(scan != nullptr);
+    EXPECT_EQ("E", scan->getRelation());
+    const auto* indexScan = as<ram::IndexScan>(scan->getOperation());
+    ASSERT_TRUE(indexScan != nullptr);
+    EXPECT_EQ("D", indexScan->getRelation());
+    EXPECT_TRUE(isUndefValue(indexScan->getRangePattern().first[0]));
+    EXPECT_EQ(ram::TupleElement(1, 0), *indexScan->getRangePattern().first[1]);
+
+    // the reordered query is kept until the other order is much cheaper
+    EXPECT_FALSE(planner->replan({1000, 10}));
+    EXPECT_TRUE(planner->replan({10, 4000}));
+    EXPECT_TRUE(planner->isOriginalOrder());
+}
+
+TEST(AdaptiveJoins, Evaluate) {
+    EXPECT_EQ("P\t4000\n", testInterpreterAdaptiveJoins(false));
+    EXPECT_EQ("P\t4000\n", testInterpreterAdaptiveJoins(true));
+}
+
 }  // namespace souffle::interpreter::test
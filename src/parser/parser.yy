@@ -138,6 +138,7 @@
 %token BTREE_QUALIFIER           "BTREE datastructure qualifier"
 %token BTREE_DELETE_QUALIFIER    "BTREE_DELETE datastructure qualifier"
 %token EQREL_QUALIFIER           "equivalence relation qualifier"
+%token HASHSET_QUALIFIER         "HASHSET datastructure qualifier"
 %token OVERRIDABLE_QUALIFIER     "relation qualifier overidable"
 %token INLINE_QUALIFIER          "relation qualifier inline"
 %token NO_INLINE_QUALIFIER       "relation qualifier no_inline"
@@ -644,6 +645,10 @@ relation_tags
     {
       $$ = driver.addReprTag(RelationTag::EQREL, @2, $1);
     }
+  | relation_tags HASHSET_QUALIFIER
+    {
+      $$ = driver.addReprTag(RelationTag::HASHSET, @2, $1);
+    }
   /* Deprecated Qualifiers */
   | relation_tags OUTPUT_QUALIFIER
     {
@@ -1242,6 +1247,15 @@ query_plan
   : PLAN query_plan_list
     {
       $$ = $query_plan_list;
+    }
+  | PLAN IDENT
+    {
+      auto name = $IDENT;
+      if (name != "leapfrog") {
+        driver.error(@IDENT, "unknown execution plan `" + name + "`");
+      }
+      $$ = mk<ast::ExecutionPlan>(@$);
+      $$->setLeapfrog(true);
     };
 
 query_plan_list
@@ -197,6 +197,7 @@ WS [ \t\r\v\f]
 "brie"                                { return yy::parser::make_BRIE_QUALIFIER(yylloc); }
 "btree_delete"                        { return yy::parser::make_BTREE_DELETE_QUALIFIER(yylloc); }
 "btree"                               { return yy::parser::make_BTREE_QUALIFIER(yylloc); }
+"hashset"                             { return yy::parser::make_HASHSET_QUALIFIER(yylloc); }
 "min"                                 { return yy::parser::make_MIN(yylloc); }
 "max"                                 { return yy::parser::make_MAX(yylloc); }
 "as"                                  { return yy::parser::make_AS(yylloc); }
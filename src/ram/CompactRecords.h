@@ -0,0 +1,81 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file CompactRecords.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Statement.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class CompactRecords
+ * @brief Release the records not referenced by the given relations
+ *
+ * The records referenced by the tuples of the relations are copied into a
+ * new record table, which replaces the record table; the tuples are updated
+ * to refer to the copies. The types are the "records" and "ADTs" type
+ * information of IO directives, describing the layout of the records.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * COMPACT RECORDS OF A, B
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class CompactRecords : public Statement {
+public:
+    CompactRecords(std::vector<std::string> relations, std::string types)
+            : Statement(NK_CompactRecords), relations(std::move(relations)), types(std::move(types)) {}
+
+    /** @brief Get the relations whose records are kept */
+    const std::vector<std::string>& getRelations() const {
+        return relations;
+    }
+
+    /** @brief Get the type information of records */
+    const std::string& getTypes() const {
+        return types;
+    }
+
+    CompactRecords* cloning() const override {
+        return new CompactRecords(relations, types);
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_CompactRecords;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "COMPACT RECORDS OF " << join(relations, ", ") << std::endl;
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<CompactRecords>(node);
+        return relations == other.relations && types == other.types;
+    }
+
+    /** Relations whose records are kept */
+    const std::vector<std::string> relations;
+
+    /** Type information of records */
+    const std::string types;
+};
+
+}  // namespace souffle::ram
@@ -50,6 +50,11 @@ public:
         return directives.at(key);
     }
 
+    /** @brief check whether the I/O saves or restores a checkpoint of the program */
+    bool isCheckpoint() const {
+        return directives.count("checkpoint-dir") > 0;
+    }
+
     IO* cloning() const override {
         return new IO(relation, directives);
     }
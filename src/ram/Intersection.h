@@ -0,0 +1,103 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Intersection.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/IntersectionSource.h"
+#include "ram/NestedOperation.h"
+#include "ram/Node.h"
+#include "ram/Operation.h"
+#include "ram/TupleOperation.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <cassert>
+#include <iosfwd>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class Intersection
+ * @brief Multi-way join on a single variable
+ *
+ * Binds the unary tuple t<id> to each value which occurs in the join column
+ * of all its sources, in ascending order. Intersections over several
+ * relations implement worst-case optimal joins (leapfrog triejoin) when
+ * nested for each variable of a rule.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * FOR t1 IN INTERSECT(edge(t0.0,*), edge(*,_))
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class Intersection : public TupleOperation {
+public:
+    Intersection(VecOwn<IntersectionSource> sources, Own<Operation> nested, std::size_t ident,
+            std::string profileText = "")
+            : TupleOperation(NK_Intersection, ident, std::move(nested), std::move(profileText)),
+              sources(std::move(sources)) {
+        assert(!this->sources.empty() && "intersection without sources");
+        assert(allValidPtrs(this->sources));
+    }
+
+    /** @brief Get sources of the intersection */
+    std::vector<IntersectionSource*> getSources() const {
+        return toPtrVector(sources);
+    }
+
+    Intersection* cloning() const override {
+        return new Intersection(clone(sources), clone(getOperation()), getTupleId(), getProfileText());
+    }
+
+    void apply(const NodeMapper& map) override {
+        TupleOperation::apply(map);
+        for (auto& source : sources) {
+            source = map(std::move(source));
+        }
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_Intersection;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "FOR t" << getTupleId() << " IN INTERSECT("
+           << join(sources, ", ", print_deref<Own<IntersectionSource>>()) << ")\n";
+        NestedOperation::print(os, tabpos + 1);
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<Intersection>(node);
+        return TupleOperation::equal(node) && equal_targets(sources, other.sources);
+    }
+
+    NodeVec getChildren() const override {
+        auto res = TupleOperation::getChildren();
+        for (auto& source : sources) {
+            res.push_back(source.get());
+        }
+        return res;
+    }
+
+    /** Relations to intersect */
+    VecOwn<IntersectionSource> sources;
+};
+
+}  // namespace souffle::ram
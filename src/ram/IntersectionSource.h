@@ -0,0 +1,121 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file IntersectionSource.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Expression.h"
+#include "ram/Node.h"
+#include "ram/utility/Utils.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include <cassert>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class IntersectionSource
+ * @brief A relation taking part in an intersection
+ *
+ * The source provides the values of the join column of all tuples of the
+ * relation matching a pattern. Defined values of the pattern are bound,
+ * undefined ones are unconstrained. The value of the join column itself
+ * is undefined and printed as a star.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * edge(t0.0,*)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class IntersectionSource : public Node {
+public:
+    IntersectionSource(std::string rel, std::size_t column, VecOwn<Expression> vals)
+            : Node(NK_IntersectionSource), relation(std::move(rel)), column(column),
+              values(std::move(vals)) {
+        assert(allValidPtrs(values));
+        assert(column < values.size() && "join column out of range");
+        assert(isUndefValue(values[column].get()) && "join column must be undefined");
+    }
+
+    /** @brief Get relation */
+    const std::string& getRelation() const {
+        return relation;
+    }
+
+    /** @brief Get join column */
+    std::size_t getColumn() const {
+        return column;
+    }
+
+    /** @brief Get pattern of the tuples */
+    std::vector<Expression*> getValues() const {
+        return toPtrVector(values);
+    }
+
+    IntersectionSource* cloning() const override {
+        return new IntersectionSource(relation, column, clone(values));
+    }
+
+    void apply(const NodeMapper& map) override {
+        for (auto& val : values) {
+            val = map(std::move(val));
+        }
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_IntersectionSource;
+    }
+
+protected:
+    void print(std::ostream& os) const override {
+        os << relation << "(";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) {
+                os << ",";
+            }
+            if (i == column) {
+                os << "*";
+            } else if (isUndefValue(values[i].get())) {
+                os << "_";
+            } else {
+                os << *values[i];
+            }
+        }
+        os << ")";
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<IntersectionSource>(node);
+        return relation == other.relation && column == other.column && equal_targets(values, other.values);
+    }
+
+    NodeVec getChildren() const override {
+        return toPtrVector<Node const>(values);
+    }
+
+    /** Relation */
+    const std::string relation;
+
+    /** Join column */
+    const std::size_t column;
+
+    /** Pattern of the tuples */
+    VecOwn<Expression> values;
+};
+
+}  // namespace souffle::ram
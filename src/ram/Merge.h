@@ -0,0 +1,71 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Merge.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/BinRelationStatement.h"
+#include "ram/Relation.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace souffle::ram {
+
+/**
+ * @class Merge
+ * @brief Inserts all tuples of a relation into another relation of the same signature
+ *
+ * The merge enables the bulk-insertion of the sorted content of the source
+ * relation, e.g. when merging delta relations into full relations.
+ *
+ * The following example merges A into B:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * MERGE B WITH A
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class Merge : public BinRelationStatement {
+public:
+    Merge(std::string tRef, const std::string& sRef) : BinRelationStatement(NK_Merge, sRef, tRef) {}
+
+    /** @brief Get source relation */
+    const std::string& getSourceRelation() const {
+        return getFirstRelation();
+    }
+
+    /** @brief Get target relation */
+    const std::string& getTargetRelation() const {
+        return getSecondRelation();
+    }
+
+    Merge* cloning() const override {
+        auto* res = new Merge(second, first);
+        return res;
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_Merge;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos);
+        os << "MERGE " << getTargetRelation() << " WITH " << getSourceRelation();
+        os << std::endl;
+    }
+};
+
+}  // namespace souffle::ram
@@ -116,6 +116,8 @@ public:
             NK_Variable,
         NK_LastExpression,
 
+        NK_IntersectionSource,
+
         NK_Operation,
             NK_Erase,
             NK_Insert,
@@ -160,6 +162,7 @@ public:
 
                     NK_UnpackRecord,
                     NK_NestedIntrinsicOperator,
+                    NK_Intersection,
                 NK_LastTupleOperation,
 
             NK_LastNestedOperation,
@@ -174,11 +177,13 @@ public:
             NK_Assign,
 
             NK_BinRelationStatement,
+                NK_Merge,
                 NK_MergeExtend,
                 NK_Swap,
             NK_LastBinRelationStatement,
 
             NK_Call,
+            NK_CompactRecords,
             NK_DebugInfo,
             NK_Exit,
             NK_ListStatement,
@@ -189,6 +194,7 @@ public:
             NK_LogTimer,
             NK_Loop,
             NK_Query,
+            NK_Restore,
             NK_RelationStatement,
                 NK_Clear,
                 NK_EstimateJoinSize,
@@ -197,6 +203,9 @@ public:
                 NK_LogSize,
             NK_LastRelationStatement,
 
+            NK_Spill,
+            NK_TaskGraph,
+
         NK_LastStatement,
     };
     // clang-format on
@@ -32,11 +32,23 @@ namespace souffle::ram {
 /**
  * @class PackRecord
  * @brief Packs a record's arguments into a reference
+ *
+ * Records whose arguments fit into the given unboxed widths are encoded in
+ * the value itself (see souffle/RecordTable.h).
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * PACK(t0.0,t0.1)
+ * PACK<32,31>(t0.0,t0.1)
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
  */
 class PackRecord : public Expression {
 public:
-    PackRecord(VecOwn<Expression> args) : Expression(NK_PackRecord), arguments(std::move(args)) {
+    PackRecord(VecOwn<Expression> args, std::vector<unsigned> unboxedWidths = {})
+            : Expression(NK_PackRecord), arguments(std::move(args)), unboxedWidths(std::move(unboxedWidths)) {
         assert(allValidPtrs(arguments));
+        assert((this->unboxedWidths.empty() || this->unboxedWidths.size() == arguments.size()) &&
+                "Unboxed widths do not match the arguments");
     }
 
     /** @brief Get record arguments */
@@ -44,12 +56,17 @@ public:
         return toPtrVector(arguments);
     }
 
+    /** @brief Get the bit widths of unboxed records, or none if records are always boxed */
+    const std::vector<unsigned>& getUnboxedWidths() const {
+        return unboxedWidths;
+    }
+
     PackRecord* cloning() const override {
-        auto* res = new PackRecord({});
+        VecOwn<Expression> args;
         for (auto& cur : arguments) {
-            res->arguments.emplace_back(cur->cloning());
+            args.emplace_back(cur->cloning());
         }
-        return res;
+        return new PackRecord(std::move(args), unboxedWidths);
     }
 
     void apply(const NodeMapper& map) override {
@@ -64,13 +81,17 @@ public:
 
 protected:
     void print(std::ostream& os) const override {
-        os << "PACK("
+        os << "PACK";
+        if (!unboxedWidths.empty()) {
+            os << "<" << join(unboxedWidths, ",") << ">";
+        }
+        os << "("
            << join(arguments, ",", [](std::ostream& out, const Own<Expression>& arg) { out << *arg; }) << ")";
     }
 
     bool equal(const Node& node) const override {
         const auto& other = asAssert<PackRecord>(node);
-        return equal_targets(arguments, other.arguments);
+        return equal_targets(arguments, other.arguments) && unboxedWidths == other.unboxedWidths;
     }
 
     NodeVec getChildren() const override {
@@ -79,6 +100,9 @@ protected:
 
     /** Arguments */
     VecOwn<Expression> arguments;
+
+    /** Bit widths of unboxed records */
+    const std::vector<unsigned> unboxedWidths;
 };
 
 }  // namespace souffle::ram
@@ -0,0 +1,67 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Restore.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Statement.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class Restore
+ * @brief Load the given relations back into memory, if a Spill statement moved them to disk
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * RESTORE A, B
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class Restore : public Statement {
+public:
+    Restore(std::vector<std::string> relations) : Statement(NK_Restore), relations(std::move(relations)) {}
+
+    /** @brief Get the relations which are restored */
+    const std::vector<std::string>& getRelations() const {
+        return relations;
+    }
+
+    Restore* cloning() const override {
+        return new Restore(relations);
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_Restore;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "RESTORE " << join(relations, ", ") << std::endl;
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<Restore>(node);
+        return relations == other.relations;
+    }
+
+    /** Relations which are restored */
+    const std::vector<std::string> relations;
+};
+
+}  // namespace souffle::ram
@@ -0,0 +1,84 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file Spill.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Statement.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class Spill
+ * @brief Move relations to disk while the relations in memory exceed a budget
+ *
+ * The memory of the relations of the program is estimated from their sizes
+ * and the number of their indexes. While it exceeds the budget, the next of
+ * the given relations is written to a spill file and purged, until it is
+ * restored by a Restore statement. The relations are given in the order they
+ * are spilled, i.e. the relations used last come first.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * SPILL A, B WITHIN 1048576 BYTES
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class Spill : public Statement {
+public:
+    Spill(std::vector<std::string> relations, std::size_t budget)
+            : Statement(NK_Spill), relations(std::move(relations)), budget(budget) {}
+
+    /** @brief Get the relations which may be spilled, in the order they are spilled */
+    const std::vector<std::string>& getRelations() const {
+        return relations;
+    }
+
+    /** @brief Get the number of bytes the relations in memory may take */
+    std::size_t getBudget() const {
+        return budget;
+    }
+
+    Spill* cloning() const override {
+        return new Spill(relations, budget);
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_Spill;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "SPILL " << join(relations, ", ") << " WITHIN " << budget << " BYTES"
+           << std::endl;
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<Spill>(node);
+        return relations == other.relations && budget == other.budget;
+    }
+
+    /** Relations which may be spilled */
+    const std::vector<std::string> relations;
+
+    /** Number of bytes the relations in memory may take */
+    const std::size_t budget;
+};
+
+}  // namespace souffle::ram
@@ -0,0 +1,119 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file TaskGraph.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Node.h"
+#include "ram/Statement.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StreamUtil.h"
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace souffle::ram {
+
+/**
+ * @class TaskGraph
+ * @brief Execute statements according to their dependencies
+ *
+ * Each statement (task) is executed once all the tasks it depends on have
+ * completed; independent tasks may be executed concurrently. Tasks may only
+ * depend on tasks preceding them, hence executing the tasks in sequence is
+ * a valid schedule.
+ *
+ * For example:
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * TASK GRAPH
+ *  TASK 0
+ *   CALL stratum_A
+ *  TASK 1
+ *   CALL stratum_B
+ *  TASK 2 AFTER 0 1
+ *   CALL stratum_C
+ * END TASK GRAPH
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ */
+class TaskGraph : public Statement {
+public:
+    TaskGraph(VecOwn<Statement> tasks, std::vector<std::vector<std::size_t>> predecessors)
+            : Statement(NK_TaskGraph), tasks(std::move(tasks)), predecessors(std::move(predecessors)) {
+        assert(allValidPtrs(this->tasks));
+        assert(this->tasks.size() == this->predecessors.size() && "each task requires a predecessor list");
+        for (std::size_t i = 0; i < this->predecessors.size(); i++) {
+            for (std::size_t pred : this->predecessors[i]) {
+                assert(pred < i && "tasks must only depend on preceding tasks");
+            }
+        }
+    }
+
+    /** @brief Get tasks */
+    std::vector<Statement*> getTasks() const {
+        return toPtrVector(tasks);
+    }
+
+    /** @brief Get the tasks each task depends on */
+    const std::vector<std::vector<std::size_t>>& getPredecessors() const {
+        return predecessors;
+    }
+
+    TaskGraph* cloning() const override {
+        return new TaskGraph(clone(tasks), predecessors);
+    }
+
+    void apply(const NodeMapper& map) override {
+        for (auto& task : tasks) {
+            task = map(std::move(task));
+        }
+    }
+
+    static bool classof(const Node* n) {
+        return n->getKind() == NK_TaskGraph;
+    }
+
+protected:
+    void print(std::ostream& os, int tabpos) const override {
+        os << times(" ", tabpos) << "TASK GRAPH" << std::endl;
+        for (std::size_t i = 0; i < tasks.size(); i++) {
+            os << times(" ", tabpos + 1) << "TASK " << i;
+            if (!predecessors[i].empty()) {
+                os << " AFTER " << join(predecessors[i], " ");
+            }
+            os << std::endl;
+            Statement::print(tasks[i].get(), os, tabpos + 2);
+        }
+        os << times(" ", tabpos) << "END TASK GRAPH" << std::endl;
+    }
+
+    bool equal(const Node& node) const override {
+        const auto& other = asAssert<TaskGraph>(node);
+        return equal_targets(tasks, other.tasks) && predecessors == other.predecessors;
+    }
+
+    NodeVec getChildren() const override {
+        return toPtrVector<Node const>(tasks);
+    }
+
+    /** Tasks */
+    VecOwn<Statement> tasks;
+
+    /** Indices of the tasks each task depends on */
+    const std::vector<std::vector<std::size_t>> predecessors;
+};
+
+}  // namespace souffle::ram
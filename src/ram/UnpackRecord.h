@@ -36,19 +36,25 @@ namespace souffle::ram {
  * @class UnpackRecord
  * @brief Record lookup
  *
- * Looks up a record with respect to an expression
+ * Looks up a record with respect to an expression. Records of the given
+ * unboxed widths may be encoded in the value itself (see
+ * souffle/RecordTable.h).
  *
  * For example:
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
- * UNPACK t0.0 INTO t1
+ * UNPACK t1 ARITY 2 FROM t0.0
+ * UNPACK t1 ARITY 2 UNBOXED 32,31 FROM t0.0
  * ~~~~~~~~~~~~~~~~~~~~~~~~~~~
  */
 class UnpackRecord : public TupleOperation {
 public:
-    UnpackRecord(Own<Operation> nested, std::size_t ident, Own<Expression> expr, std::size_t arity)
+    UnpackRecord(Own<Operation> nested, std::size_t ident, Own<Expression> expr, std::size_t arity,
+            std::vector<unsigned> unboxedWidths = {})
             : TupleOperation(NK_UnpackRecord, ident, std::move(nested)), expression(std::move(expr)),
-              arity(arity) {
+              arity(arity), unboxedWidths(std::move(unboxedWidths)) {
         assert(expression != nullptr && "Expression is a null-pointer");
+        assert((this->unboxedWidths.empty() || this->unboxedWidths.size() == arity) &&
+                "Unboxed widths do not match the arity");
     }
 
     /** @brief Get record expression */
@@ -62,8 +68,14 @@ public:
         return arity;
     }
 
+    /** @brief Get the bit widths of unboxed records, or none if records are always boxed */
+    const std::vector<unsigned>& getUnboxedWidths() const {
+        return unboxedWidths;
+    }
+
     UnpackRecord* cloning() const override {
-        return new UnpackRecord(clone(getOperation()), getTupleId(), clone(getExpression()), arity);
+        return new UnpackRecord(
+                clone(getOperation()), getTupleId(), clone(getExpression()), arity, unboxedWidths);
     }
 
     void apply(const NodeMapper& map) override {
@@ -78,14 +90,18 @@ public:
 protected:
     void print(std::ostream& os, int tabpos) const override {
         os << times(" ", tabpos);
-        os << "UNPACK t" << getTupleId() << " ARITY " << arity << " FROM " << *expression << "\n";
+        os << "UNPACK t" << getTupleId() << " ARITY " << arity;
+        if (!unboxedWidths.empty()) {
+            os << " UNBOXED " << join(unboxedWidths, ",");
+        }
+        os << " FROM " << *expression << "\n";
         NestedOperation::print(os, tabpos + 1);
     }
 
     bool equal(const Node& node) const override {
         const auto& other = asAssert<UnpackRecord>(node);
         return TupleOperation::equal(other) && equal_ptr(expression, other.expression) &&
-               arity == other.arity;
+               arity == other.arity && unboxedWidths == other.unboxedWidths;
     }
 
     NodeVec getChildren() const override {
@@ -99,6 +115,9 @@ protected:
 
     /** Arity of the unpacked tuple */
     const std::size_t arity;
+
+    /** Bit widths of unboxed records */
+    const std::vector<unsigned> unboxedWidths;
 };
 
 }  // namespace souffle::ram
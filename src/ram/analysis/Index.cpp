@@ -18,7 +18,9 @@
 #include "Global.h"
 #include "RelationTag.h"
 #include "ram/EstimateJoinSize.h"
+#include "ram/BinRelationStatement.h"
 #include "ram/Expression.h"
+#include "ram/IO.h"
 #include "ram/Node.h"
 #include "ram/Program.h"
 #include "ram/Relation.h"
@@ -27,10 +29,13 @@
 #include "ram/analysis/Relation.h"
 #include "ram/utility/Utils.h"
 #include "ram/utility/Visitor.h"
+#include "souffle/utility/ContainerUtil.h"
+#include "souffle/utility/FunctionalUtil.h"
 #include "souffle/utility/StreamUtil.h"
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <queue>
@@ -402,6 +407,8 @@ void IndexAnalysis::run(const TranslationUnit& translationUnit) {
             relationToSearches[exists->getRelation()].insert(getSearchSignature(exists));
         } else if (const auto* provExists = as<ProvenanceExistenceCheck>(node)) {
             relationToSearches[provExists->getRelation()].insert(getSearchSignature(provExists));
+        } else if (const auto* source = as<IntersectionSource>(node)) {
+            relationToSearches[source->getRelation()].insert(getSearchSignature(source));
         } else if (const auto* ramRel = as<Relation>(node)) {
             relationToSearches[ramRel->getName()].insert(getSearchSignature(ramRel));
         }
@@ -443,6 +450,74 @@ void IndexAnalysis::run(const TranslationUnit& translationUnit) {
         auto& searches = relToSearch.second;
         indexCover.insert({relation, solver->solve(searches)});
     }
+
+    computeHashableRelations(translationUnit);
+}
+
+void IndexAnalysis::computeHashableRelations(const TranslationUnit& translationUnit) {
+    const Program& program = translationUnit.getProgram();
+
+    // relations exchanging tuples via swaps or merges must share their representation,
+    // hence they are grouped by a union-find over the relation names
+    std::map<std::string, std::string> parent;
+    std::function<std::string(const std::string&)> find = [&](const std::string& rel) -> std::string {
+        auto it = parent.find(rel);
+        if (it == parent.end() || it->second == rel) {
+            return rel;
+        }
+        return it->second = find(it->second);
+    };
+    visit(program, [&](const BinRelationStatement& stmt) {
+        parent[find(stmt.getFirstRelation())] = find(stmt.getSecondRelation());
+    });
+
+    // relations whose order of tuples is observed by an iteration or a store
+    std::set<std::string> ordered;
+    visit(program, [&](const Node& node) {
+        if (const auto* search = as<IndexOperation>(node)) {
+            const SearchSignature signature = getSearchSignature(search);
+            if (signature != SearchSignature::getFullSearchSignature(signature.arity())) {
+                ordered.insert(search->getRelation());
+            }
+        } else if (const auto* op = as<RelationOperation>(node)) {
+            ordered.insert(op->getRelation());
+        } else if (const auto* estimateJoinSize = as<EstimateJoinSize>(node)) {
+            ordered.insert(estimateJoinSize->getRelation());
+        } else if (const auto* source = as<IntersectionSource>(node)) {
+            ordered.insert(source->getRelation());
+        } else if (const auto* io = as<IO>(node)) {
+            // checkpoints are restored regardless of the order of the tuples
+            if (io->get("operation") != "input" && !io->isCheckpoint()) {
+                ordered.insert(io->getRelation());
+            }
+        }
+    });
+
+    // a group is hashable if each of its relations is exclusively searched with fully bound keys
+    std::map<std::string, bool> groupHashable;
+    std::map<std::string, bool> groupCandidate;
+    for (const Relation* rel : program.getRelations()) {
+        const std::string& name = rel->getName();
+        const auto repr = rel->getRepresentation();
+        bool ok = rel->getArity() > 0 && rel->getAuxiliaryArity() == 0 &&
+                  (repr == RelationRepresentation::DEFAULT || repr == RelationRepresentation::HASHSET);
+        for (const auto& search : relationToSearches[name]) {
+            ok = ok && all_of(search, [](AttributeConstraint c) { return c == AttributeConstraint::Equal; });
+        }
+        const std::string group = find(name);
+        groupHashable.emplace(group, true).first->second &= ok;
+        groupCandidate.emplace(group, true).first->second &= !contains(ordered, name);
+    }
+
+    for (const Relation* rel : program.getRelations()) {
+        const std::string group = find(rel->getName());
+        if (groupHashable[group]) {
+            hashable.insert(rel->getName());
+            if (groupCandidate[group]) {
+                hashSetCandidates.insert(rel->getName());
+            }
+        }
+    }
 }
 
 void IndexAnalysis::print(std::ostream& os) const {
@@ -467,6 +542,10 @@ void IndexAnalysis::print(std::ostream& os) const {
             os << join(order, "<") << "\n";
             os << "\n";
         }
+
+        if (isHashable(relName)) {
+            os << "\tHashable" << (isHashSetCandidate(relName) ? " (hash set candidate)" : "") << "\n";
+        }
     }
 }
 
@@ -552,6 +631,14 @@ SearchSignature IndexAnalysis::getSearchSignature(const ExistenceCheck* existChe
     return searchSignature(rel->getArity(), existCheck->getValues());
 }
 
+SearchSignature IndexAnalysis::getSearchSignature(const IntersectionSource* source) const {
+    const Relation* rel = &relAnalysis->lookup(source->getRelation());
+    SearchSignature keys = searchSignature(rel->getArity(), source->getValues());
+    // the join column is enumerated in ascending order, hence it follows the bound columns
+    keys[source->getColumn()] = AttributeConstraint::Inequal;
+    return keys;
+}
+
 SearchSignature IndexAnalysis::getSearchSignature(const Relation* ramRel) const {
     return SearchSignature::getFullSearchSignature(ramRel->getArity());
 }
@@ -20,10 +20,12 @@
 #include "ram/EstimateJoinSize.h"
 #include "ram/ExistenceCheck.h"
 #include "ram/IndexOperation.h"
+#include "ram/IntersectionSource.h"
 #include "ram/ProvenanceExistenceCheck.h"
 #include "ram/Relation.h"
 #include "ram/TranslationUnit.h"
 #include "ram/analysis/Relation.h"
+#include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
 #include <algorithm>
 #include <cassert>
@@ -32,6 +34,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -477,6 +480,40 @@ public:
         return static_cast<std::size_t>(std::distance(orders.begin(), it));
     }
 
+    /**
+     * Get the position of an order serving a search of equalities, whether the order was selected
+     * for the search or the search is served by an order completed to a total order whose prefix
+     * holds exactly the bound attributes, if any
+     */
+    std::optional<std::size_t> getCoveringLexOrderNum(const SearchSignature& cols) const {
+        if (indexSelection.count(cols) > 0) {
+            return getLexOrderNum(cols);
+        }
+        AttributeSet bound;
+        for (std::size_t i = 0; i < cols.arity(); ++i) {
+            if (cols[i] == AttributeConstraint::Inequal) {
+                return std::nullopt;
+            }
+            if (cols[i] == AttributeConstraint::Equal) {
+                bound.insert(i);
+            }
+        }
+        for (std::size_t pos = 0; pos < orders.size(); ++pos) {
+            // orders are completed with the missing attributes in ascending order
+            LexOrder order = orders[pos];
+            for (std::size_t i = 0; i < cols.arity(); ++i) {
+                if (std::find(order.begin(), order.end(), i) == order.end()) {
+                    order.push_back(i);
+                }
+            }
+            const auto prefix = order.begin() + static_cast<std::ptrdiff_t>(bound.size());
+            if (AttributeSet(order.begin(), prefix) == bound) {
+                return pos;
+            }
+        }
+        return std::nullopt;
+    }
+
 private:
     SignatureOrderMap indexSelection;
     SearchCollection searches;
@@ -529,6 +566,13 @@ public:
      */
     SearchSignature getSearchSignature(const ProvenanceExistenceCheck* existCheck) const;
 
+    /**
+     * @Brief Get the index signature for a source of an intersection
+     * @param Intersection source
+     * @result index signature with the bound values as equalities and the join column as inequality
+     */
+    SearchSignature getSearchSignature(const IntersectionSource* source) const;
+
     /**
      * @Brief Get the default index signature for a relation (the total-order index)
      * @param ramRel RAM-relation
@@ -545,7 +589,34 @@ public:
      */
     bool isTotalSignature(const AbstractExistenceCheck* existCheck) const;
 
+    /**
+     * @Brief whether a relation may be represented by a hash set
+     * @param relName name of the relation
+     *
+     * isHashable returns true if the relation and all relations it is swapped or
+     * merged with are exclusively searched with fully bound keys.
+     */
+    bool isHashable(const std::string& relName) const {
+        return contains(hashable, relName);
+    }
+
+    /**
+     * @Brief whether a relation should be represented by a hash set
+     * @param relName name of the relation
+     *
+     * isHashSetCandidate returns true if the relation is hashable and the order
+     * of its tuples is never observed, i.e., it is neither iterated nor written.
+     */
+    bool isHashSetCandidate(const std::string& relName) const {
+        return contains(hashSetCandidates, relName);
+    }
+
 private:
+    /**
+     * Computes the relations that may and should be represented by hash sets.
+     */
+    void computeHashableRelations(const TranslationUnit& translationUnit);
+
     /** relation analysis for looking up relations by name */
     RelationAnalysis* relAnalysis;
 
@@ -555,6 +626,12 @@ private:
     Own<IndexSelectionStrategy> solver;
     std::map<std::string, IndexCluster> indexCover;
     std::map<std::string, SearchSet> relationToSearches;
+
+    /** relations supporting a hash set representation */
+    std::set<std::string> hashable;
+
+    /** hashable relations whose order of tuples is never observed */
+    std::set<std::string> hashSetCandidates;
 };
 
 }  // namespace souffle::ram::analysis
@@ -31,6 +31,8 @@
 #include "ram/IndexIfExists.h"
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
+#include "ram/Intersection.h"
+#include "ram/IntersectionSource.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/Negation.h"
 #include "ram/Node.h"
@@ -122,6 +124,24 @@ std::optional<std::size_t> LevelAnalysis::getLevel(const Node* node) const {
             return level;
         }
 
+        // intersection
+        maybe_level visit_(type_identity<Intersection>, const Intersection& intersection) override {
+            maybe_level level = std::nullopt;
+            for (auto* source : intersection.getSources()) {
+                level = max(level, dispatch(*source));
+            }
+            return level;
+        }
+
+        // intersection source
+        maybe_level visit_(type_identity<IntersectionSource>, const IntersectionSource& source) override {
+            maybe_level level = std::nullopt;
+            for (auto* value : source.getValues()) {
+                level = max(level, dispatch(*value));
+            }
+            return level;
+        }
+
         // choice
         maybe_level visit_(type_identity<IfExists>, const IfExists& choice) override {
             return max(-1, dispatch(choice.getCondition()));
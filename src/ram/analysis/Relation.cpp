@@ -17,7 +17,9 @@
 #include "ram/Relation.h"
 #include "ram/analysis/Relation.h"
 #include "ram/utility/Visitor.h"
+#include "souffle/utility/ContainerUtil.h"
 #include "souffle/utility/MiscUtil.h"
+#include "souffle/utility/StringUtil.h"
 #include <algorithm>
 #include <cassert>
 #include <utility>
@@ -31,9 +33,36 @@ const ram::Relation& RelationAnalysis::lookup(const std::string& name) const {
     return *(it->second);
 }
 
+bool RelationAnalysis::hasInsertBuffer(const std::string& name) const {
+    return contains(bufferedRelations, name);
+}
+
 void RelationAnalysis::run(const TranslationUnit& translationUnit) {
     visit(translationUnit.getProgram(),
             [&](const Relation& relation) { relationMap[relation.getName()] = &relation; });
+
+    // select the b-tree sets whose (new) tuples are buffered, either all or by name
+    const auto& config = translationUnit.global().config();
+    if (!config.has("insert-buffers")) {
+        return;
+    }
+    const auto selected = splitString(config.get("insert-buffers"), ',');
+    for (const auto& [name, relation] : relationMap) {
+        const auto rep = relation->getRepresentation();
+        if (relation->isNullary() || relation->getAuxiliaryArity() > 0 ||
+                (rep != RelationRepresentation::DEFAULT && rep != RelationRepresentation::BTREE)) {
+            continue;
+        }
+        std::string baseName = name;
+        for (const std::string prefix : {"@new_", "@delta_"}) {
+            if (isPrefix(prefix, baseName)) {
+                baseName = baseName.substr(prefix.size());
+            }
+        }
+        if (contains(selected, "*") || contains(selected, baseName)) {
+            bufferedRelations.insert(name);
+        }
+    }
 }
 
 }  // namespace souffle::ram::analysis
@@ -18,6 +18,9 @@
 
 #include "ram/Node.h"
 #include "ram/TranslationUnit.h"
+#include <map>
+#include <set>
+#include <string>
 
 namespace souffle::ram {
 
@@ -40,8 +43,17 @@ public:
 
     const ram::Relation& lookup(const std::string& name) const;
 
+    /**
+     * Determines whether the tuples inserted into the given relation by
+     * parallel operations are collected in thread-local buffers, as selected
+     * by the insert-buffers option.
+     */
+    bool hasInsertBuffer(const std::string& name) const;
+
 protected:
     std::map<std::string, const ram::Relation*> relationMap;
+
+    std::set<std::string> bufferedRelations;
 };
 
 }  // namespace analysis
@@ -195,6 +195,22 @@ TEST(PackRecord, CloneAndEquals) {
     EXPECT_EQ(d, *dClone);
     EXPECT_NE(&d, dClone);
     delete dClone;
+
+    // PACK<32,31>(argument(1), number(5)) differs from the boxed record
+    VecOwn<Expression> f_args;
+    f_args.emplace_back(new SubroutineArgument(1));
+    f_args.emplace_back(new SignedConstant(5));
+    PackRecord f(std::move(f_args), {32, 31});
+    VecOwn<Expression> g_args;
+    g_args.emplace_back(new SubroutineArgument(1));
+    g_args.emplace_back(new SignedConstant(5));
+    PackRecord g(std::move(g_args));
+    EXPECT_NE(f, g);
+
+    PackRecord* fClone = f.cloning();
+    EXPECT_EQ(f, *fClone);
+    EXPECT_NE(&f, fClone);
+    delete fClone;
 }
 
 TEST(RamSubrountineArgument, CloneAndEquals) {
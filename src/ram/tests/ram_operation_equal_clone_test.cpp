@@ -423,6 +423,18 @@ TEST(RamUnpackedRecord, CloneAndEquals) {
     EXPECT_EQ(a, *c);
     EXPECT_NE(&a, c);
     delete c;
+
+    // UNPACK t1 ARITY 2 UNBOXED 32,31 FROM t0.0
+    // RETURN number(0)
+    VecOwn<Expression> d_return_args;
+    d_return_args.emplace_back(new SignedConstant(0));
+    auto d_return = mk<SubroutineReturn>(std::move(d_return_args));
+    UnpackRecord d(std::move(d_return), 1, mk<TupleElement>(0, 0), 2, {32, 31});
+    UnpackRecord* e = d.cloning();
+    EXPECT_EQ(d, *e);
+    EXPECT_NE(&d, e);
+    EXPECT_EQ(d.getUnboxedWidths(), e->getUnboxedWidths());
+    delete e;
 }
 
 TEST(RamFilter, CloneAndEquals) {
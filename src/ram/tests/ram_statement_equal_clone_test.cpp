@@ -19,7 +19,9 @@
 #include "FunctorOps.h"
 #include "RelationTag.h"
 #include "ram/Break.h"
+#include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/CompactRecords.h"
 #include "ram/Condition.h"
 #include "ram/Constraint.h"
 #include "ram/DebugInfo.h"
@@ -35,6 +37,7 @@
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/Operation.h"
@@ -42,12 +45,15 @@
 #include "ram/ParallelIfExists.h"
 #include "ram/Query.h"
 #include "ram/Relation.h"
+#include "ram/Restore.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
 #include "ram/SignedConstant.h"
+#include "ram/Spill.h"
 #include "ram/Statement.h"
 #include "ram/SubroutineReturn.h"
 #include "ram/Swap.h"
+#include "ram/TaskGraph.h"
 #include "ram/TupleElement.h"
 #include "ram/UndefValue.h"
 #include "souffle/BinaryConstraintOps.h"
@@ -92,6 +98,70 @@ TEST(Clear, CloneAndEquals) {
     delete c;
 }
 
+TEST(CompactRecords, CloneAndEquals) {
+    // COMPACT RECORDS OF A, B
+    const std::string types = R"({"records": {"r:R": {"types": ["i:number"], "arity": 1}}, "ADTs": {}})";
+    CompactRecords a({"A", "B"}, types);
+    CompactRecords b({"A", "B"}, types);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    CompactRecords d({"A"}, types);
+    EXPECT_NE(a, d);
+
+    CompactRecords* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(Spill, CloneAndEquals) {
+    // SPILL A, B WITHIN 1024 BYTES
+    Spill a({"A", "B"}, 1024);
+    Spill b({"A", "B"}, 1024);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    Spill d({"A", "B"}, 2048);
+    EXPECT_NE(a, d);
+
+    Spill* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(Restore, CloneAndEquals) {
+    // RESTORE A, B
+    Restore a({"A", "B"});
+    Restore b({"A", "B"});
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    Restore d({"B"});
+    EXPECT_NE(a, d);
+
+    Restore* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
+TEST(Merge, CloneAndEquals) {
+    // MERGE B WITH A
+    Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    Relation B("B", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
+    Merge a("B", "A");
+    Merge b("B", "A");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    Merge* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(MergeExtend, CloneAndEquals) {
     // MERGE B WITH A
     Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
@@ -316,6 +386,39 @@ TEST(Exit, CloneAndEquals) {
     delete c;
 }
 
+TEST(TaskGraph, CloneAndEquals) {
+    /*
+     * TASK GRAPH
+     *  TASK 0
+     *   CALL A
+     *  TASK 1
+     *   CALL B
+     *  TASK 2 AFTER 0 1
+     *   CALL C
+     * END TASK GRAPH
+     * */
+    auto makeTasks = []() {
+        VecOwn<Statement> tasks;
+        tasks.push_back(mk<Call>("A"));
+        tasks.push_back(mk<Call>("B"));
+        tasks.push_back(mk<Call>("C"));
+        return tasks;
+    };
+    TaskGraph a(makeTasks(), {{}, {}, {0, 1}});
+    TaskGraph b(makeTasks(), {{}, {}, {0, 1}});
+    EXPECT_EQ(a, b);
+    EXPECT_NE(&a, &b);
+
+    // the same tasks with different dependencies differ
+    TaskGraph d(makeTasks(), {{}, {0}, {1}});
+    EXPECT_NE(a, d);
+
+    TaskGraph* c = a.cloning();
+    EXPECT_EQ(a, *c);
+    EXPECT_NE(&a, c);
+    delete c;
+}
+
 TEST(LogRelationTimer, CloneAndEquals) {
     Relation A("A", 1, 1, {"x"}, {"i"}, RelationRepresentation::DEFAULT);
     /*
@@ -0,0 +1,72 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashSetSelection.cpp
+ *
+ ***********************************************************************/
+
+#include "ram/transform/HashSetSelection.h"
+#include "RelationTag.h"
+#include "ram/Node.h"
+#include "ram/Program.h"
+#include "ram/Relation.h"
+#include "ram/utility/NodeMapper.h"
+#include "reports/ErrorReport.h"
+#include <memory>
+#include <set>
+#include <string>
+
+namespace souffle::ram::transform {
+
+bool HashSetSelectionTransformer::selectHashSets(TranslationUnit& translationUnit) {
+    const auto& indexAnalysis = translationUnit.getAnalysis<analysis::IndexAnalysis>();
+    Program& program = translationUnit.getProgram();
+
+    std::set<std::string> selected;
+    for (const Relation* rel : program.getRelations()) {
+        const std::string& name = rel->getName();
+        switch (rel->getRepresentation()) {
+            case RelationRepresentation::HASHSET:
+                // only report user-facing relations; auxiliary relations share their verdict
+                if (!indexAnalysis.isHashable(name) && !rel->isTemp()) {
+                    translationUnit.getErrorReport().addDiagnostic(Diagnostic(Diagnostic::Type::ERROR,
+                            DiagnosticMessage("Relation " + name +
+                                              " cannot be represented by a hash set since it requires range "
+                                              "or prefix searches")));
+                }
+                break;
+            case RelationRepresentation::DEFAULT:
+                if (indexAnalysis.isHashSetCandidate(name)) {
+                    selected.insert(name);
+                }
+                break;
+            default: break;
+        }
+    }
+
+    if (selected.empty()) {
+        return false;
+    }
+
+    program.apply(nodeMapper<Node>([&](auto&& go, Own<Node> node) -> Own<Node> {
+        if (const auto* rel = as<Relation>(node)) {
+            if (contains(selected, rel->getName())) {
+                return mk<Relation>(rel->getName(), rel->getArity(), rel->getAuxiliaryArity(),
+                        rel->getAttributeNames(), rel->getAttributeTypes(), RelationRepresentation::HASHSET);
+            }
+        }
+        node->apply(go);
+        return node;
+    }));
+
+    return true;
+}
+
+}  // namespace souffle::ram::transform
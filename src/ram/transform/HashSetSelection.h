@@ -0,0 +1,55 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file HashSetSelection.h
+ *
+ ***********************************************************************/
+
+#pragma once
+
+#include "ram/Program.h"
+#include "ram/TranslationUnit.h"
+#include "ram/analysis/Index.h"
+#include "ram/transform/Transformer.h"
+#include <string>
+
+namespace souffle::ram::transform {
+
+/**
+ * @class HashSetSelectionTransformer
+ * @brief Selects the hash set representation for relations which are
+ *        exclusively searched with fully bound keys.
+ *
+ * Relations with the default representation are represented by hash sets
+ * if neither they nor the relations they are swapped or merged with are
+ * searched by ranges or prefixes, iterated, or written. Relations explicitly
+ * qualified as hash sets which require range or prefix searches are reported
+ * as errors.
+ */
+class HashSetSelectionTransformer : public Transformer {
+public:
+    std::string getName() const override {
+        return "HashSetSelectionTransformer";
+    }
+
+    /**
+     * @brief Select the hash set representation for relations
+     * @param translationUnit Translation unit whose program is transformed
+     * @return Flag showing whether the program has been changed by the transformation
+     */
+    bool selectHashSets(TranslationUnit& translationUnit);
+
+protected:
+    bool transform(TranslationUnit& translationUnit) override {
+        return selectHashSets(translationUnit);
+    }
+};
+
+}  // namespace souffle::ram::transform
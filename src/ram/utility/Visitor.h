@@ -28,6 +28,7 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/CompactRecords.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -49,12 +50,15 @@
 #include "ram/IndexOperation.h"
 #include "ram/IndexScan.h"
 #include "ram/Insert.h"
+#include "ram/Intersection.h"
+#include "ram/IntersectionSource.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/ListStatement.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -77,14 +81,17 @@
 #include "ram/RelationOperation.h"
 #include "ram/RelationSize.h"
 #include "ram/RelationStatement.h"
+#include "ram/Restore.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
 #include "ram/SignedConstant.h"
+#include "ram/Spill.h"
 #include "ram/Statement.h"
 #include "ram/StringConstant.h"
 #include "ram/SubroutineArgument.h"
 #include "ram/SubroutineReturn.h"
 #include "ram/Swap.h"
+#include "ram/TaskGraph.h"
 #include "ram/True.h"
 #include "ram/TupleElement.h"
 #include "ram/TupleOperation.h"
@@ -154,6 +161,7 @@ struct Visitor : souffle::detail::VisitorBase<R, NodeType, Params...> {
         SOUFFLE_VISITOR_FORWARD(SubroutineReturn);
         SOUFFLE_VISITOR_FORWARD(UnpackRecord);
         SOUFFLE_VISITOR_FORWARD(NestedIntrinsicOperator);
+        SOUFFLE_VISITOR_FORWARD(Intersection);
         SOUFFLE_VISITOR_FORWARD(ParallelScan);
         SOUFFLE_VISITOR_FORWARD(Scan);
         SOUFFLE_VISITOR_FORWARD(ParallelIndexScan);
@@ -176,6 +184,7 @@ struct Visitor : souffle::detail::VisitorBase<R, NodeType, Params...> {
         SOUFFLE_VISITOR_FORWARD(EstimateJoinSize);
 
         SOUFFLE_VISITOR_FORWARD(Swap);
+        SOUFFLE_VISITOR_FORWARD(Merge);
         SOUFFLE_VISITOR_FORWARD(MergeExtend);
 
         // Control-flow
@@ -183,11 +192,18 @@ struct Visitor : souffle::detail::VisitorBase<R, NodeType, Params...> {
         SOUFFLE_VISITOR_FORWARD(Sequence);
         SOUFFLE_VISITOR_FORWARD(Loop);
         SOUFFLE_VISITOR_FORWARD(Parallel);
+        SOUFFLE_VISITOR_FORWARD(TaskGraph);
         SOUFFLE_VISITOR_FORWARD(Exit);
         SOUFFLE_VISITOR_FORWARD(LogTimer);
         SOUFFLE_VISITOR_FORWARD(LogRelationTimer);
         SOUFFLE_VISITOR_FORWARD(DebugInfo);
         SOUFFLE_VISITOR_FORWARD(Call);
+        SOUFFLE_VISITOR_FORWARD(CompactRecords);
+        SOUFFLE_VISITOR_FORWARD(Spill);
+        SOUFFLE_VISITOR_FORWARD(Restore);
+
+        // Others
+        SOUFFLE_VISITOR_FORWARD(IntersectionSource);
 
         // did not work ...
         fatal("unsupported type: %s", typeid(node).name());
@@ -205,18 +221,23 @@ protected:
     SOUFFLE_VISITOR_LINK(Assign, Statement);
 
     SOUFFLE_VISITOR_LINK(Swap, BinRelationStatement);
+    SOUFFLE_VISITOR_LINK(Merge, BinRelationStatement);
     SOUFFLE_VISITOR_LINK(MergeExtend, BinRelationStatement);
     SOUFFLE_VISITOR_LINK(BinRelationStatement, Statement);
 
     SOUFFLE_VISITOR_LINK(Sequence, ListStatement);
     SOUFFLE_VISITOR_LINK(Loop, Statement);
     SOUFFLE_VISITOR_LINK(Parallel, ListStatement);
+    SOUFFLE_VISITOR_LINK(TaskGraph, Statement);
     SOUFFLE_VISITOR_LINK(ListStatement, Statement);
     SOUFFLE_VISITOR_LINK(Exit, Statement);
     SOUFFLE_VISITOR_LINK(LogTimer, Statement);
     SOUFFLE_VISITOR_LINK(LogRelationTimer, Statement);
     SOUFFLE_VISITOR_LINK(DebugInfo, Statement);
     SOUFFLE_VISITOR_LINK(Call, Statement);
+    SOUFFLE_VISITOR_LINK(CompactRecords, Statement);
+    SOUFFLE_VISITOR_LINK(Spill, Statement);
+    SOUFFLE_VISITOR_LINK(Restore, Statement);
 
     SOUFFLE_VISITOR_LINK(Statement, Node);
 
@@ -227,6 +248,7 @@ protected:
     SOUFFLE_VISITOR_LINK(SubroutineReturn, Operation);
     SOUFFLE_VISITOR_LINK(UnpackRecord, TupleOperation);
     SOUFFLE_VISITOR_LINK(NestedIntrinsicOperator, TupleOperation)
+    SOUFFLE_VISITOR_LINK(Intersection, TupleOperation);
     SOUFFLE_VISITOR_LINK(Scan, RelationOperation);
     SOUFFLE_VISITOR_LINK(ParallelScan, Scan);
     SOUFFLE_VISITOR_LINK(IndexScan, IndexOperation);
@@ -286,6 +308,9 @@ protected:
 
     // -- relation
     SOUFFLE_VISITOR_LINK(Relation, Node);
+
+    // -- intersection source --
+    SOUFFLE_VISITOR_LINK(IntersectionSource, Node);
 };
 }  // namespace souffle::ram
 
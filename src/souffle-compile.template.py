@@ -19,19 +19,26 @@ if not JSON_DATA_TEXT:
       "link_options": "-pthread -ldl -lstdc++fs /usr/lib/x86_64-linux-gnu/libsqlite3.so /usr/lib/x86_64-linux-gnu/libz.so /usr/lib/x86_64-linux-gnu/libncurses.so",
       "rpaths": "/usr/lib/x86_64-linux-gnu:/usr/lib/x86_64-linux-gnu",
       "outname_fmt": "-o {}",
+      "objname_fmt": "-o {}",
       "libdir_fmt": "-L{}",
       "libname_fmt": "-l{}",
       "rpath_fmt": "-Wl,-rpath,{}",
       "path_delimiter": ":",
       "exe_extension": "",
+      "obj_extension": ".o",
+      "pic_flag": "-fPIC",
+      "shared_flag": "-shared",
       "source_include_dir": "",
       "jni_includes": ""
     }"""
 
 import argparse
+import concurrent.futures
+import hashlib
 import json
 import os
 import pathlib
+import re
 import shutil
 import subprocess
 import sys
@@ -54,14 +61,80 @@ def capture_command_output(cmd, descr, verbose=False):
     return status.stdout
 
 
+# line markers of the preprocessed source, either '# 12 "file"' or '#line 12 "file"'
+LINE_MARKER = re.compile(rb'^[ \t]*#(line)?[ \t]+[0-9]+.*$', re.MULTILINE)
+
+
+# remove from the preprocessed source the paths of the source file and of its directory, which
+# differ from one run to the next when the program is generated in a temporary file
+def normalise_preprocessed(text, source):
+    text = LINE_MARKER.sub(b'', text)
+    source = pathlib.Path(source)
+    paths = [str(source), str(source.absolute())]
+    if source.absolute().parent != pathlib.Path(source.absolute().anchor):
+        paths.append(str(source.absolute().parent))
+    for path in sorted(paths, key=len, reverse=True):
+        # __FILE__ expands to a string literal, in which backslashes are escaped
+        for form in (path, path.replace('\\', '\\\\')):
+            text = text.replace(os.fsencode(form), b'<source>')
+    return text
+
+
+# compile a source file to an object file in the object cache, unless the cache already holds the
+# object of the same preprocessed source compiled with the same compiler and flags, and return the
+# path of the object file
+#
+# The key covers the preprocessed source rather than the source itself, since the generated files
+# of a program include the headers generated next to them. The paths of the source are left out of
+# the key, such that the object is reused for the same program generated in another file.
+def compile_cached_object(source, flags):
+    compiler = '"{}"'.format(conf['compiler'])
+    flags = " ".join(flags)
+    preprocessed = subprocess.run("{} -E {} \"{}\"".format(compiler, flags, source),
+                                  capture_output=True, shell=True)
+    if preprocessed.returncode != 0:
+        sys.stderr.write(preprocessed.stderr.decode(errors='replace'))
+        raise RuntimeError("Error: Preprocessing of {}".format(source))
+
+    key = hashlib.sha256()
+    for part in (conf['compiler'], conf['compiler_version'], flags):
+        key.update(part.encode())
+        key.update(b"\0")
+    key.update(normalise_preprocessed(preprocessed.stdout, source))
+    obj = args.object_cache / (key.hexdigest() + objext)
+    if obj.exists():
+        if args.verbose:
+            sys.stderr.write("Reusing {} for {}\n".format(obj, source))
+        # refresh the modification time, such that the cache may be trimmed by age of last use
+        obj.touch()
+        return obj
+
+    # the object is renamed once complete, such that concurrent builds never see a partial one
+    fd, tmp = tempfile.mkstemp(suffix=objext, dir=args.object_cache)
+    os.close(fd)
+    tmp = pathlib.Path(tmp)
+    cmd = "{} -c {} {} \"{}\"".format(compiler, flags, OBJNAME_FMT.format('"{}"'.format(tmp)), source)
+    try:
+        launch_command(cmd, "Compilation of {}".format(source), verbose=args.verbose)
+        os.replace(tmp, obj)
+    finally:
+        if tmp.exists():
+            tmp.unlink()
+    return obj
+
+
 conf = json.loads(JSON_DATA_TEXT)
 OUTNAME_FMT = conf['outname_fmt']
+OBJNAME_FMT = conf['objname_fmt']
 LIBDIR_FMT = conf['libdir_fmt']
 LIBNAME_FMT = conf['libname_fmt']
 RPATH_FMT = conf['rpath_fmt']
 PATH_DELIMITER = conf['path_delimiter']
 RPATHS = conf['rpaths'].split(PATH_DELIMITER)
 exeext = conf['exe_extension']
+objext = conf['obj_extension']
+PIC_FLAG = conf['pic_flag']
+SHARED_FLAG = conf['shared_flag']
 SOURCE_INCLUDE_DIR = conf['source_include_dir']
 JNI_INCLUDES = conf['jni_includes'].split(PATH_DELIMITER)
 
@@ -73,7 +146,9 @@ parser.add_argument('-l', action='append', default=[], metavar='LIBNAME', dest='
 parser.add_argument('-L', action='append', default=[], metavar='LIBDIR', dest='lib_dirs', type=lambda p: pathlib.Path(p).absolute(), help="Search directory for functors libraries")
 parser.add_argument('-g', action='store_true', dest='debug', help="Debug build type")
 parser.add_argument('-s', metavar='LANG', dest='swiglang', choices=["java", "python"], help="use SWIG interface to generate into LANG language")
+parser.add_argument('--shared', action='store_true', dest='shared', help="Build a shared library embedding the program")
 parser.add_argument('-v', action='store_true', dest='verbose', help="Verbose output")
+parser.add_argument('--object-cache', metavar='DIR', dest='object_cache', type=lambda p: pathlib.Path(p).absolute(), help="Compile each source file on its own, and reuse its object file from DIR if its preprocessed content and flags are unchanged")
 parser.add_argument('source', nargs='+', metavar='SOURCE', type=lambda p: pathlib.Path(p).absolute(), help="C++ source files")
 parser.add_argument('-o', metavar='BINARY', dest='output', type=lambda p: pathlib.Path(p).absolute(), help="Binary file name")
 
@@ -181,24 +256,43 @@ if args.swiglang:
         # move generated files to same directory as cpp file
         os.sys.exit(0)
 else:
-    exepath = pathlib.Path("{}{}".format(args.output, exeext))
+    if args.shared:
+        exepath = args.output
+    else:
+        exepath = pathlib.Path("{}{}".format(args.output, exeext))
 
-    cmd = []
-    cmd.append('"{}"'.format(conf['compiler']))
-    cmd.append(conf['definitions'])
-    cmd.append(conf['compile_options'])
-    cmd.append(conf['includes'])
-    cmd.append(conf['std_flag'])
-    cmd.append(conf['cxx_flags'])
+    flags = []
+    flags.append(conf['definitions'])
+    flags.append(conf['compile_options'])
+    flags.append(conf['includes'])
+    flags.append(conf['std_flag'])
+    flags.append(conf['cxx_flags'])
+
+    if args.shared:
+        flags.append("{} -D__EMBEDDED_SOUFFLE__".format(PIC_FLAG))
 
     if args.debug:
-        cmd.append(conf['debug_cxx_flags'])
+        flags.append(conf['debug_cxx_flags'])
     else:
-        cmd.append(conf['release_cxx_flags'])
+        flags.append(conf['release_cxx_flags'])
+
+    cmd = []
+    cmd.append('"{}"'.format(conf['compiler']))
+    cmd.extend(flags)
+
+    if args.shared:
+        cmd.append(SHARED_FLAG)
 
     cmd.append(OUTNAME_FMT.format(exepath))
-    for f in args.source:
-        cmd.append(str(f))
+    if args.object_cache:
+        args.object_cache.mkdir(parents=True, exist_ok=True)
+        with concurrent.futures.ThreadPoolExecutor(max_workers=os.cpu_count()) as executor:
+            objects = list(executor.map(lambda f: compile_cached_object(f, flags), args.source))
+        for f in objects:
+            cmd.append('"{}"'.format(f))
+    else:
+        for f in args.source:
+            cmd.append(str(f))
 
     cmd.append(conf['link_options'])
     cmd.extend(list(map(lambda rpath: RPATH_FMT.format(rpath), RPATHS)))
@@ -62,6 +62,8 @@ Own<Relation> Relation::getSynthesiserRelation(
         rel = new BrieRelation(ramRel, indexSelection);
     } else if (ramRel.getRepresentation() == RelationRepresentation::EQREL) {
         rel = new EqrelRelation(ramRel, indexSelection);
+    } else if (ramRel.getRepresentation() == RelationRepresentation::HASHSET) {
+        rel = new HashSetRelation(ramRel, indexSelection);
     } else if (ramRel.getRepresentation() == RelationRepresentation::INFO) {
         rel = new InfoRelation(ramRel, indexSelection);
     } else {
@@ -281,6 +283,12 @@ void DirectRelation::generateTypeStruct(GenDb& db) {
 
         auto genstruct = [&](std::string name, std::size_t bound) {
             decl << "struct " << name << "{\n";
+            // expose an integral leading attribute to the simd_search strategy of the b-tree
+            if (bound > 0 && types[ind[0]][0] != 'f') {
+                decl << "static constexpr std::size_t leading_column = " << ind[0] << ";\n";
+                decl << "using leading_type = " << (types[ind[0]][0] == 'u' ? "RamUnsigned" : "RamSigned")
+                     << ";\n";
+            }
             decl << " int operator()(const t_tuple& a, const t_tuple& b) const {\n";
             decl << "  return ";
             std::function<void(std::size_t)> gencmp = [&](std::size_t i) {
@@ -350,7 +358,7 @@ void DirectRelation::generateTypeStruct(GenDb& db) {
                 comparator_aux = comparator;
             }
             decl << "using t_ind_" << i << " = btree_set<t_tuple," << comparator
-                 << ",std::allocator<t_tuple>,256,typename "
+                 << ",arena_allocator<t_tuple>,256,typename "
                     "souffle::detail::default_strategy<t_tuple>::type,"
                  << comparator_aux << ",updater>;\n";
         } else {
@@ -358,12 +366,15 @@ void DirectRelation::generateTypeStruct(GenDb& db) {
             if (hasErase) {
                 btree_name = "btree_delete";
             }
+            // nodes of b-trees are allocated in arenas, which b-trees supporting deletion do not use
+            std::string allocator = hasErase ? "" : ",arena_allocator<t_tuple>";
             if (ind.size() == arity) {
-                decl << "using t_ind_" << i << " = " << btree_name << "_set<t_tuple," << comparator << ">;\n";
+                decl << "using t_ind_" << i << " = " << btree_name << "_set<t_tuple," << comparator
+                     << allocator << ">;\n";
             } else {
                 // without provenance, some indices may be not full, so we use btree_multiset for those
                 decl << "using t_ind_" << i << " = " << btree_name << "_multiset<t_tuple," << comparator
-                     << ">;\n";
+                     << allocator << ">;\n";
             }
         }
         decl << "t_ind_" << i << " ind_" << i << ";\n";
@@ -447,6 +458,77 @@ void DirectRelation::generateTypeStruct(GenDb& db) {
     def << "return insert(data);\n";
     def << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
 
+    // bulk-insertion methods
+    if (hasBatchInsert()) {
+        decl << "void insertBatch(std::vector<t_tuple>& batch);\n";
+        def << "void Type::insertBatch(std::vector<t_tuple>& batch) {\n";
+        def << "t_comparator_" << masterIndex << " comparator;\n";
+        def << "auto less = [&](const t_tuple& a, const t_tuple& b) { return comparator.less(a, b); };\n";
+        def << "auto equal = [&](const t_tuple& a, const t_tuple& b) { return comparator.equal(a, b); };\n";
+        def << "if (!std::is_sorted(batch.begin(), batch.end(), less)) {\n";
+        def << "std::sort(batch.begin(), batch.end(), less);\n";
+        def << "}\n";
+        // only new tuples are inserted, such that multiset indexes receive each tuple once
+        def << "batch.erase(std::unique(batch.begin(), batch.end(), equal), batch.end());\n";
+        def << "t_ind_" << masterIndex << "::operation_hints hints;\n";
+        def << "batch.erase(std::remove_if(batch.begin(), batch.end(), [&](const t_tuple& t) { return ind_"
+            << masterIndex << ".contains(t, hints); }), batch.end());\n";
+        def << "ind_" << masterIndex << ".insertSorted(batch.begin(), batch.end());\n";
+        for (std::size_t i = 0; i < numIndexes; i++) {
+            if (i != masterIndex) {
+                def << "ind_" << i << ".insertBatch(batch);\n";
+            }
+        }
+        def << "}\n";  // end of insertBatch(std::vector<t_tuple>&)
+
+        decl << "void insertBatch(const RamDomain* data, std::size_t count);\n";
+        def << "void Type::insertBatch(const RamDomain* data, std::size_t count) {\n";
+        def << "std::vector<t_tuple> batch(count);\n";
+        def << "for (std::size_t i = 0; i < count; ++i) {\n";
+        def << "std::copy(data + i * " << arity << ", data + (i + 1) * " << arity << ", batch[i].begin());\n";
+        def << "}\n";
+        def << "insertBatch(batch);\n";
+        def << "}\n";  // end of insertBatch(const RamDomain*, std::size_t)
+
+        // thread-local buffers are inserted in order, such that the hints of each index stay effective
+        decl << "void insertBuffer(std::vector<t_tuple>& buffer, context& h);\n";
+        def << "void Type::insertBuffer(std::vector<t_tuple>& buffer, context& h) {\n";
+        def << "t_comparator_" << masterIndex << " comparator;\n";
+        def << "std::sort(buffer.begin(), buffer.end(), [&](const t_tuple& a, const t_tuple& b) { return "
+               "comparator.less(a, b); });\n";
+        def << "buffer.erase(std::unique(buffer.begin(), buffer.end(), [&](const t_tuple& a, const t_tuple& "
+               "b) { return comparator.equal(a, b); }), buffer.end());\n";
+        def << "for (const auto& t : buffer) {\n";
+        def << "insert(t, h);\n";
+        def << "}\n";
+        def << "buffer.clear();\n";
+        def << "}\n";  // end of insertBuffer(std::vector<t_tuple>&, context&)
+
+        // large relations are merged concurrently, partition by partition
+        decl << "template <typename T>\n";
+        decl << "void insertAll(const T& other) {\n";
+        decl << "if (MAX_THREADS > 1 && other.size() >= souffle::parallelMergeThreshold) {\n";
+        decl << "auto part = other.partition();\n";
+        decl << "const int count = static_cast<int>(part.size());\n";
+        decl << "PARALLEL_START\n";
+        decl << "context h;\n";
+        decl << "pfor(int index = 0; index < count; index++) {\n";
+        decl << "for (const auto& t : part[index]) {\n";
+        decl << "insert(t, h);\n";
+        decl << "}\n";
+        decl << "}\n";
+        decl << "PARALLEL_END\n";
+        decl << "return;\n";
+        decl << "}\n";
+        // otherwise, partitions are bulk-inserted one at a time, bounding the tuples copied at once
+        decl << "std::vector<t_tuple> batch;\n";
+        decl << "for (const auto& cur : other.partition()) {\n";
+        decl << "batch.assign(cur.begin(), cur.end());\n";
+        decl << "insertBatch(batch);\n";
+        decl << "}\n";
+        decl << "}\n";  // end of insertAll(const T&)
+    }
+
     // contains methods
     decl << "bool contains(const t_tuple& t, context& h) const;\n";
     def << "bool Type::contains(const t_tuple& t, context& h) const {\n";
@@ -1312,6 +1394,200 @@ void BrieRelation::generateTypeStruct(GenDb& db) {
     decl << "};\n";
 }
 
+// -------- Hash Set Relation --------
+
+/** Generate index set for a hash set relation, which consists of the single full order */
+void HashSetRelation::computeIndices() {
+    computedIndices = indexSelection.getAllOrders();
+    assert(computedIndices.size() == 1 && "hash set relations only support a single index");
+    masterIndex = 0;
+}
+
+/** Generate type name of a hash set relation */
+std::string HashSetRelation::getTypeNamespace() {
+    std::stringstream res;
+    res << "t_hashset_" << getArity();
+
+    for (auto& search : indexSelection.getSearches()) {
+        res << "__" << search;
+    }
+
+    return res.str();
+}
+
+std::string HashSetRelation::getTypeName() {
+    return getTypeNamespace() + "::Type";
+}
+
+/** Generate type struct of a hash set relation */
+void HashSetRelation::generateTypeStruct(GenDb& db) {
+    std::size_t arity = getArity();
+
+    fs::path basename(uniqueCppIdent(getTypeNamespace(), 20));
+    GenDatastructure& cl = db.getDatastructure("Type", basename, std::make_optional(getTypeNamespace()));
+    std::ostream& decl = cl.decl();
+    std::ostream& def = cl.def();
+
+    cl.addInclude("\"souffle/SouffleInterface.h\"");
+    cl.addInclude("\"souffle/datastructure/ConcurrentHashSet.h\"");
+
+    // struct definition
+    decl << "struct Type {\n";
+    decl << "static constexpr Relation::arity_type Arity = " << arity << ";\n";
+
+    // stored tuple type and the hash set, tuples are stored in their natural order
+    decl << "using t_tuple = Tuple<RamDomain, " << arity << ">;\n";
+    decl << "using t_ind_0 = ConcurrentHashSet<t_tuple>;\n";
+    decl << "t_ind_0 ind_0;\n";
+    def << "using t_ind_0 = Type::t_ind_0;\n";
+
+    decl << "using iterator = t_ind_0::iterator;\n";
+    def << "using iterator = Type::iterator;\n";
+
+    // hints are empty but retained for interface compatibility
+    decl << "struct context {\n";
+    decl << "t_ind_0::operation_hints hints_0;\n";
+    decl << "};\n";
+    def << "using context = Type::context;\n";
+    decl << "context createContext() { return context(); }\n";
+
+    // insert methods
+    decl << "bool insert(const t_tuple& t);\n";
+    def << "bool Type::insert(const t_tuple& t) {\n";
+    def << "return ind_0.insert(t);\n";
+    def << "}\n";  // end of insert(t_tuple&)
+
+    decl << "bool insert(const t_tuple& t, context& h);\n";
+    def << "bool Type::insert(const t_tuple& t, context& h) {\n";
+    def << "return ind_0.insert(t, h.hints_0);\n";
+    def << "}\n";  // end of insert(t_tuple&, context&)
+
+    decl << "bool insert(const RamDomain* ramDomain);\n";
+    def << "bool Type::insert(const RamDomain* ramDomain) {\n";
+    def << "RamDomain data[" << arity << "];\n";
+    def << "std::copy(ramDomain, ramDomain + " << arity << ", data);\n";
+    def << "const t_tuple& tuple = reinterpret_cast<const t_tuple&>(data);\n";
+    def << "return insert(tuple);\n";
+    def << "}\n";  // end of insert(RamDomain*)
+
+    std::vector<std::string> decls;
+    std::vector<std::string> params;
+    for (std::size_t i = 0; i < arity; i++) {
+        decls.push_back("RamDomain a" + std::to_string(i));
+        params.push_back("a" + std::to_string(i));
+    }
+    decl << "bool insert(" << join(decls, ",") << ");\n";
+
+    def << "bool Type::insert(" << join(decls, ",") << ") {\n";
+    def << "RamDomain data[" << arity << "] = {" << join(params, ",") << "};\n";
+    def << "return insert(data);\n";
+    def << "}\n";  // end of insert(RamDomain x1, RamDomain x2, ...)
+
+    // contains methods
+    decl << "bool contains(const t_tuple& t, context& h) const;\n";
+    def << "bool Type::contains(const t_tuple& t, context& h) const {\n";
+    def << "return ind_0.contains(t, h.hints_0);\n";
+    def << "}\n";
+
+    decl << "bool contains(const t_tuple& t) const;\n";
+    def << "bool Type::contains(const t_tuple& t) const {\n";
+    def << "return ind_0.contains(t);\n";
+    def << "}\n";
+
+    // size method
+    decl << "std::size_t size() const;\n";
+    def << "std::size_t Type::size() const {\n";
+    def << "return ind_0.size();\n";
+    def << "}\n";
+
+    // find methods
+    decl << "iterator find(const t_tuple& t, context& h) const;\n";
+    def << "iterator Type::find(const t_tuple& t, context& h) const {\n";
+    def << "return ind_0.find(t, h.hints_0);\n";
+    def << "}\n";
+
+    decl << "iterator find(const t_tuple& t) const;\n";
+    def << "iterator Type::find(const t_tuple& t) const {\n";
+    def << "return ind_0.find(t);\n";
+    def << "}\n";
+
+    // empty lowerUpperRange method
+    decl << "range<iterator> lowerUpperRange_" << SearchSignature(arity)
+         << "(const t_tuple& /* lower */, const t_tuple& /* upper */, context& /* h */) const;\n";
+    def << "range<iterator> Type::lowerUpperRange_" << SearchSignature(arity)
+        << "(const t_tuple& /* lower */, const t_tuple& /* upper */, context& /* h */) const {\n";
+    def << "return range<iterator>(ind_0.begin(),ind_0.end());\n";
+    def << "}\n";
+
+    decl << "range<iterator> lowerUpperRange_" << SearchSignature(arity)
+         << "(const t_tuple& /* lower */, const t_tuple& /* upper */) const;\n";
+    def << "range<iterator> Type::lowerUpperRange_" << SearchSignature(arity)
+        << "(const t_tuple& /* lower */, const t_tuple& /* upper */) const {\n";
+    def << "return range<iterator>(ind_0.begin(),ind_0.end());\n";
+    def << "}\n";
+
+    // lowerUpperRange methods for the searches, which all bind every attribute
+    for (auto search : indexSelection.getSearches()) {
+        decl << "range<iterator> lowerUpperRange_" << search;
+        decl << "(const t_tuple& lower, const t_tuple& upper, context& h) const;\n";
+        def << "range<iterator> Type::lowerUpperRange_" << search;
+        def << "(const t_tuple& lower, const t_tuple& upper, context& h) const {\n";
+        def << "if (lower != upper) {\n";
+        def << "    return make_range(ind_0.end(), ind_0.end());\n";
+        def << "}\n";
+        def << "return make_range(ind_0.lower_bound(lower, h.hints_0), "
+               "ind_0.upper_bound(lower, h.hints_0));\n";
+        def << "}\n";
+
+        decl << "range<iterator> lowerUpperRange_" << search;
+        decl << "(const t_tuple& lower, const t_tuple& upper) const;\n";
+        def << "range<iterator> Type::lowerUpperRange_" << search;
+        def << "(const t_tuple& lower, const t_tuple& upper) const {\n";
+        def << "context h;\n";
+        def << "return lowerUpperRange_" << search << "(lower,upper,h);\n";
+        def << "}\n";
+    }
+
+    // empty method
+    decl << "bool empty() const;\n";
+    def << "bool Type::empty() const {\n";
+    def << "return ind_0.empty();\n";
+    def << "}\n";
+
+    // partition method for parallelism
+    decl << "std::vector<range<iterator>> partition() const;\n";
+    def << "std::vector<range<iterator>> Type::partition() const {\n";
+    def << "return ind_0.getChunks(400);\n";
+    def << "}\n";
+
+    // purge method
+    decl << "void purge();\n";
+    def << "void Type::purge() {\n";
+    def << "ind_0.clear();\n";
+    def << "}\n";
+
+    // begin and end iterators
+    decl << "iterator begin() const;\n";
+    def << "iterator Type::begin() const {\n";
+    def << "return ind_0.begin();\n";
+    def << "}\n";
+
+    decl << "iterator end() const;\n";
+    def << "iterator Type::end() const {\n";
+    def << "return ind_0.end();\n";
+    def << "}\n";
+
+    // printStatistics method
+    decl << "void printStatistics(std::ostream& o) const;\n";
+    def << "void Type::printStatistics(std::ostream& o) const {\n";
+    def << "o << \" arity " << arity << " hash set\\n\";\n";
+    def << "ind_0.printStats(o);\n";
+    def << "}\n";
+
+    // end struct
+    decl << "};\n";
+}
+
 // -------- Eqrel Relation --------
 
 /** Generate index set for a eqrel relation, which should be empty */
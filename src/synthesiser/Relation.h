@@ -68,6 +68,11 @@ public:
     /** Generate relation type struct */
     virtual void generateTypeStruct(GenDb& db) = 0;
 
+    /** Whether the type struct supports the bulk-insertion of tuples via insertBatch/insertAll */
+    virtual bool hasBatchInsert() const {
+        return false;
+    }
+
     /** Factory method to generate a SynthesiserRelation */
     static Own<Relation> getSynthesiserRelation(
             const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection);
@@ -124,6 +129,10 @@ public:
     std::string getTypeName() override;
     void generateTypeStruct(GenDb& db) override;
 
+    bool hasBatchInsert() const override {
+        return !hasAuxiliary && !hasErase;
+    }
+
 private:
     const bool hasAuxiliary;
     const bool hasProvenance;
@@ -152,6 +161,17 @@ public:
     void generateTypeStruct(GenDb& db) override;
 };
 
+class HashSetRelation : public Relation {
+public:
+    HashSetRelation(const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection)
+            : Relation(ramRel, indexSelection) {}
+
+    void computeIndices() override;
+    std::string getTypeNamespace();
+    std::string getTypeName() override;
+    void generateTypeStruct(GenDb& db) override;
+};
+
 class EqrelRelation : public Relation {
 public:
     EqrelRelation(const ram::Relation& ramRel, const ram::analysis::IndexCluster& indexSelection)
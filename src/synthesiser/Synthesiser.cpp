@@ -28,6 +28,7 @@
 #include "ram/Break.h"
 #include "ram/Call.h"
 #include "ram/Clear.h"
+#include "ram/CompactRecords.h"
 #include "ram/Condition.h"
 #include "ram/Conjunction.h"
 #include "ram/Constraint.h"
@@ -45,13 +46,17 @@
 #include "ram/IndexAggregate.h"
 #include "ram/IndexIfExists.h"
 #include "ram/IndexScan.h"
+#include "ram/GuardedInsert.h"
 #include "ram/Insert.h"
+#include "ram/Intersection.h"
+#include "ram/IntersectionSource.h"
 #include "ram/IntrinsicAggregator.h"
 #include "ram/IntrinsicOperator.h"
 #include "ram/LogRelationTimer.h"
 #include "ram/LogSize.h"
 #include "ram/LogTimer.h"
 #include "ram/Loop.h"
+#include "ram/Merge.h"
 #include "ram/MergeExtend.h"
 #include "ram/Negation.h"
 #include "ram/NestedIntrinsicOperator.h"
@@ -72,13 +77,16 @@
 #include "ram/Relation.h"
 #include "ram/RelationOperation.h"
 #include "ram/RelationSize.h"
+#include "ram/Restore.h"
 #include "ram/Scan.h"
 #include "ram/Sequence.h"
+#include "ram/Spill.h"
 #include "ram/SignedConstant.h"
 #include "ram/Statement.h"
 #include "ram/SubroutineArgument.h"
 #include "ram/SubroutineReturn.h"
 #include "ram/Swap.h"
+#include "ram/TaskGraph.h"
 #include "ram/TranslationUnit.h"
 #include "ram/True.h"
 #include "ram/TupleElement.h"
@@ -89,6 +97,7 @@
 #include "ram/UserDefinedAggregator.h"
 #include "ram/UserDefinedOperator.h"
 #include "ram/analysis/Index.h"
+#include "ram/analysis/Relation.h"
 #include "ram/utility/Utils.h"
 #include "ram/utility/Visitor.h"
 #include "souffle/BinaryConstraintOps.h"
@@ -123,6 +132,7 @@ namespace souffle::synthesiser {
 
 using json11::Json;
 using ram::analysis::IndexAnalysis;
+using ram::analysis::RelationAnalysis;
 using namespace ram;
 using namespace stream_write_qualified_char_as_number;
 
@@ -179,6 +189,10 @@ const std::string Synthesiser::getOpContextName(const ram::Relation& rel) {
     return getRelationName(rel) + "_op_ctxt";
 }
 
+const std::string Synthesiser::getInsertBufferName(const ram::Relation& rel) {
+    return getRelationName(rel) + "_buffer";
+}
+
 /** Get relation type struct */
 void Synthesiser::generateRelationTypeStruct(GenDb& db, Own<Relation> relationType) {
     std::string name = relationType->getTypeName();
@@ -206,6 +220,8 @@ ram::RelationSet Synthesiser::getReferencedRelations(const Operation& op) {
             res.insert(lookup(provExists->getRelation()));
         } else if (auto insert = as<Insert>(node)) {
             res.insert(lookup(insert->getRelation()));
+        } else if (auto source = as<IntersectionSource>(node)) {
+            res.insert(lookup(source->getRelation()));
         }
     });
     return res;
@@ -234,6 +250,8 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
         Synthesiser& synthesiser;
         Global& glb;
         IndexAnalysis* const isa = &synthesiser.getTranslationUnit().getAnalysis<IndexAnalysis>();
+        RelationAnalysis* const relAnalysis =
+                &synthesiser.getTranslationUnit().getAnalysis<RelationAnalysis>();
 
 // macros to add comments to generated code for debugging
 #ifndef PRINT_BEGIN_COMMENT
@@ -255,6 +273,12 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
         std::ostringstream preamble;
         bool preambleIssued = false;
 
+        // whether the parallel loop of the current query steals iterations, see WorkStealingLoop
+        bool stealingIssued = false;
+
+        // relations whose insertions are collected in thread-local buffers by the current query
+        std::set<std::string> bufferedRelations;
+
     public:
         CodeEmitter(Synthesiser& syn) : synthesiser(syn), glb(synthesiser.glb) {
             rec = [&](auto& out, const auto* value) {
@@ -271,6 +295,30 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             };
         }
 
+        /** Emit the start of the parallel loop over the partitions `part`, each bound to `it` */
+        void emitParallelLoop(std::ostream& out) {
+            if (glb.config().has("work-stealing")) {
+                stealingIssued = true;
+                out << "PARALLEL_STEAL_START(part.size())\n";
+                out << preamble.str();
+                out << "psteal(index) {\n";
+                out << "auto it = part.begin() + index;\n";
+                return;
+            }
+            out << "PARALLEL_START\n";
+            out << preamble.str();
+            out << R"cpp(
+                   #if defined _OPENMP && _OPENMP < 200805
+                           auto count = std::distance(part.begin(), part.end());
+                           auto base = part.begin();
+                           pfor(int index  = 0; index < count; index++) {
+                               auto it = base + index;
+                   #else
+                           pfor(auto it = part.begin(); it < part.end(); it++) {
+                   #endif
+                   )cpp";
+        }
+
         std::pair<std::stringstream, std::stringstream> getPaddedRangeBounds(const ram::Relation& rel,
                 const std::vector<Expression*>& rangePatternLower,
                 const std::vector<Expression*>& rangePatternUpper) {
@@ -361,9 +409,13 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 out << "std::map<std::string, std::string> directiveMap(";
                 printDirectives(directives);
                 out << ");\n";
-                out << R"_(if (!inputDirectory.empty()) {)_";
-                out << R"_(directiveMap["fact-dir"] = inputDirectory;)_";
-                out << "}\n";
+                // the relations of checkpoints are read from the checkpoint directory, whereas
+                // the input files hashed by the progress of checkpoints are in the fact directory
+                if (!io.isCheckpoint() || io.get("IO") == "checkpoint") {
+                    out << R"_(if (!inputDirectory.empty()) {)_";
+                    out << R"_(directiveMap["fact-dir"] = inputDirectory;)_";
+                    out << "}\n";
+                }
                 out << "IOSystem::getInstance().getReader(";
                 out << "directiveMap, symTable, recordTable";
                 out << ")->readAll(*" << synthesiser.getRelationName(synthesiser.lookup(io.getRelation()));
@@ -377,12 +429,14 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 out << "std::map<std::string, std::string> directiveMap(";
                 printDirectives(directives);
                 out << ");\n";
-                out << R"_(if (outputDirectory == "-"){)_";
-                out << R"_(directiveMap["IO"] = "stdout"; directiveMap["headers"] = "true";)_";
-                out << "}\n";
-                out << R"_(else if (!outputDirectory.empty()) {)_";
-                out << R"_(directiveMap["output-dir"] = outputDirectory;)_";
-                out << "}\n";
+                if (!io.isCheckpoint()) {
+                    out << R"_(if (outputDirectory == "-"){)_";
+                    out << R"_(directiveMap["IO"] = "stdout"; directiveMap["headers"] = "true";)_";
+                    out << "}\n";
+                    out << R"_(else if (!outputDirectory.empty()) {)_";
+                    out << R"_(directiveMap["output-dir"] = outputDirectory;)_";
+                    out << "}\n";
+                }
                 out << "IOSystem::getInstance().getWriter(";
                 out << "directiveMap, symTable, recordTable";
                 out << ")->writeAll(*" << synthesiser.getRelationName(synthesiser.lookup(io.getRelation()))
@@ -440,6 +494,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             preamble.str("");
             preamble.clear();
             preambleIssued = false;
+            stealingIssued = false;
 
             // create operation contexts for this operation
             for (const ram::Relation* rel : synthesiser.getReferencedRelations(query.getOperation())) {
@@ -448,6 +503,21 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 preamble << "->createContext());\n";
             }
 
+            // in parallel loops, each thread collects the tuples of buffered relations
+            bufferedRelations.clear();
+            if (isParallel) {
+                visit(*next, [&](const Insert& insert) {
+                    if (!isA<GuardedInsert>(insert) && relAnalysis->hasInsertBuffer(insert.getRelation())) {
+                        bufferedRelations.insert(insert.getRelation());
+                    }
+                });
+                for (const auto& name : bufferedRelations) {
+                    const auto* rel = synthesiser.lookup(name);
+                    preamble << "std::vector<Tuple<RamDomain," << rel->getArity() << ">> "
+                             << synthesiser.getInsertBufferName(*rel) << ";\n";
+                }
+            }
+
             // discharge conditions that require a context
             if (isParallel) {
                 if (requireCtx.size() > 0) {
@@ -473,7 +543,14 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             }
 
             if (isParallel) {
-                out << "PARALLEL_END\n";  // end parallel
+                // insert the buffered tuples of each thread
+                for (const auto& name : bufferedRelations) {
+                    const auto* rel = synthesiser.lookup(name);
+                    out << synthesiser.getRelationName(rel) << "->insertBuffer("
+                        << synthesiser.getInsertBufferName(*rel) << ",READ_OP_CONTEXT("
+                        << synthesiser.getOpContextName(*rel) << "));\n";
+                }
+                out << (stealingIssued ? "PARALLEL_STEAL_END\n" : "PARALLEL_END\n");  // end parallel
             }
 
             out << "}\n";
@@ -521,6 +598,28 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        /** Emits the execution of a graph of tasks, see evaluator::runTaskGraph */
+        void emitTaskGraph(const std::vector<Statement*>& tasks,
+                const std::vector<std::vector<std::size_t>>& predecessors, const std::string& numThreads,
+                std::ostream& out) {
+            // dependencies of the tasks
+            out << "souffle::evaluator::runTaskGraph(std::vector<std::vector<std::size_t>>{";
+            for (std::size_t i = 0; i < tasks.size(); i++) {
+                out << (i > 0 ? ", " : "") << "{" << join(predecessors[i], ", ") << "}";
+            }
+            out << "}, " << numThreads << ", [&](std::size_t task) {\n";
+
+            // the tasks, selected by index
+            out << "switch (task) {\n";
+            for (std::size_t i = 0; i < tasks.size(); i++) {
+                out << "case " << i << ": {\n";
+                dispatch(*tasks[i], out);
+                out << "} break;\n";
+            }
+            out << "}\n";
+            out << "});\n";
+        }
+
         void visit_(type_identity<Parallel>, const Parallel& parallel, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             auto stmts = parallel.getStatements();
@@ -538,20 +637,14 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 return;
             }
 
-            // more than one => parallel sections
-
-            // start parallel section
-            out << "SECTIONS_START;\n";
-
-            // put each thread in another section
-            for (const auto& cur : stmts) {
-                out << "SECTION_START;\n";
-                dispatch(*cur, out);
-                out << "SECTION_END\n";
-            }
+            // more than one => independent tasks, sharing the threads of the enclosing scope
+            emitTaskGraph(stmts, std::vector<std::vector<std::size_t>>(stmts.size()), "0", out);
+            PRINT_END_COMMENT(out);
+        }
 
-            // done
-            out << "SECTIONS_END;\n";
+        void visit_(type_identity<TaskGraph>, const TaskGraph& graph, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            emitTaskGraph(graph.getTasks(), graph.getPredecessors(), "getNumThreads()", out);
             PRINT_END_COMMENT(out);
         }
 
@@ -588,6 +681,25 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(type_identity<Merge>, const Merge& merge, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            const auto* target = synthesiser.lookup(merge.getTargetRelation());
+            const std::string& targetName = synthesiser.getRelationName(target);
+            const std::string& sourceName =
+                    synthesiser.getRelationName(synthesiser.lookup(merge.getSourceRelation()));
+
+            auto relationType =
+                    Relation::getSynthesiserRelation(*target, isa->getIndexSelection(target->getName()));
+            if (relationType->hasBatchInsert()) {
+                out << targetName << "->insertAll(*" << sourceName << ");\n";
+            } else {
+                out << "for (const auto& env0 : *" << sourceName << ") {\n";
+                out << targetName << "->insert(env0);\n";
+                out << "}\n";
+            }
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(type_identity<MergeExtend>, const MergeExtend& extend, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
             out << synthesiser.getRelationName(synthesiser.lookup(extend.getSourceRelation())) << "->"
@@ -614,6 +726,58 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(
+                type_identity<CompactRecords>, const CompactRecords& compact, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            synthesiser.currentClass->addInclude("\"souffle/datastructure/RecordRelocator.h\"", true);
+            out << "recordTable.compact([&](const RecordTable& source, RecordTable& target) {\n";
+            out << "RecordRelocator relocator(source, target, R\"_(" << compact.getTypes() << ")_\");\n";
+            for (const auto& name : compact.getRelations()) {
+                const auto* rel = synthesiser.lookup(name);
+                out << "relocateRecords(relocator, *" << synthesiser.getRelationName(rel) << ", {";
+                out << join(rel->getAttributeTypes(), ",", [](std::ostream& os, const std::string& type) {
+                    os << "\"" << type << "\"";
+                });
+                out << "});\n";
+            }
+            out << "});\n";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visit_(type_identity<Spill>, const Spill& spill, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            // relations are spilled in order until the relations in memory are within the budget
+            out << "{\n";
+            out << "std::size_t footprint = getRelationFootprint();\n";
+            out << "auto spill = [&](const std::string& name, auto& rel, std::size_t arity, std::size_t "
+                   "tupleFootprint) {\n";
+            out << "if (footprint <= " << spill.getBudget() << "ULL) return;\n";
+            out << "const std::size_t relFootprint = rel.size() * tupleFootprint;\n";
+            out << "spillStore.spill(name, rel, arity);\n";
+            out << "if (rel.size() == 0) footprint -= relFootprint;\n";
+            out << "};\n";
+            for (const auto& name : spill.getRelations()) {
+                const auto* rel = synthesiser.lookup(name);
+                const auto relationType =
+                        Relation::getSynthesiserRelation(*rel, isa->getIndexSelection(name));
+                const std::size_t indexes = std::max<std::size_t>(1, relationType->getIndices().size());
+                out << "spill(R\"_(" << name << ")_\", *" << synthesiser.getRelationName(rel) << ", "
+                    << rel->getArity() << ", " << rel->getArity() * indexes << " * sizeof(RamDomain));\n";
+            }
+            out << "}\n";
+            PRINT_END_COMMENT(out);
+        }
+
+        void visit_(type_identity<Restore>, const Restore& restore, std::ostream& out) override {
+            PRINT_BEGIN_COMMENT(out);
+            for (const auto& name : restore.getRelations()) {
+                const auto* rel = synthesiser.lookup(name);
+                out << "spillStore.restore(R\"_(" << name << ")_\", *" << synthesiser.getRelationName(rel)
+                    << ", " << rel->getArity() << ");\n";
+            }
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(
                 type_identity<LogRelationTimer>, const LogRelationTimer& timer, std::ostream& out) override {
             PRINT_BEGIN_COMMENT(out);
@@ -694,18 +858,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
-            out << "PARALLEL_START\n";
-            out << preamble.str();
-            out << R"cpp(
-                   #if defined _OPENMP && _OPENMP < 200805
-                           auto count = std::distance(part.begin(), part.end());
-                           auto base = part.begin();
-                           pfor(int index  = 0; index < count; index++) {
-                               auto it = base + index;
-                   #else
-                           pfor(auto it = part.begin(); it < part.end(); it++) {
-                   #endif
-                   )cpp";
+            emitParallelLoop(out);
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -778,18 +931,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_BEGIN_COMMENT(out);
 
             out << "auto part = " << relName << "->partition();\n";
-            out << "PARALLEL_START\n";
-            out << preamble.str();
-            out << R"cpp(
-                   #if defined _OPENMP && _OPENMP < 200805
-                           auto count = std::distance(part.begin(), part.end());
-                           auto base = part.begin();
-                           pfor(int index  = 0; index < count; index++) {
-                               auto it = base + index;
-                   #else
-                           pfor(auto it = part.begin(); it < part.end(); it++) {
-                   #endif
-                   )cpp";
+            emitParallelLoop(out);
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -835,6 +977,54 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             PRINT_END_COMMENT(out);
         }
 
+        void visit_(type_identity<Intersection>, const Intersection& intersection,
+                std::ostream& out) override {
+            const auto sources = intersection.getSources();
+            auto identifier = intersection.getTupleId();
+
+            PRINT_BEGIN_COMMENT(out);
+            synthesiser.currentClass->addInclude("\"souffle/utility/EvaluatorUtil.h\"", true);
+
+            // join values are enumerated in the order of the comparators of the indexes
+            const auto* firstRel = synthesiser.lookup(sources.front()->getRelation());
+            bool isUnsigned = firstRel->getAttributeTypes()[sources.front()->getColumn()][0] == 'u';
+
+            out << "souffle::evaluator::runIntersection<" << (isUnsigned ? "RamUnsigned" : "RamSigned")
+                << ">(" << sources.size() << ",\n";
+            out << "[&](std::size_t source, RamDomain key, RamDomain& value) -> bool {\n";
+            out << "switch (source) {\n";
+            for (std::size_t i = 0; i < sources.size(); ++i) {
+                const auto* source = sources[i];
+                const auto* rel = synthesiser.lookup(source->getRelation());
+                auto relName = synthesiser.getRelationName(rel);
+                auto keys = isa->getSearchSignature(source);
+                auto ctxName = "READ_OP_CONTEXT(" + synthesiser.getOpContextName(*rel) + ")";
+                const auto values = source->getValues();
+                auto rangeBounds = getPaddedRangeBounds(*rel, values, values);
+
+                // seek the least tuple whose join column is not less than the key
+                out << "case " << i << ": {\n";
+                out << "auto lower = " << rangeBounds.first.str() << ";\n";
+                out << "lower[" << source->getColumn() << "] = key;\n";
+                out << "auto range = " << relName << "->lowerUpperRange_" << keys << "(lower,"
+                    << rangeBounds.second.str() << "," << ctxName << ");\n";
+                out << "if (range.begin() == range.end()) return false;\n";
+                out << "value = (*range.begin())[" << source->getColumn() << "];\n";
+                out << "return true;\n";
+                out << "}\n";
+            }
+            out << "}\n";
+            out << "return false;\n";
+            out << "},\n";
+            out << "[&](const auto& env" << identifier << ") -> bool {\n";
+
+            visit_(type_identity<TupleOperation>(), intersection, out);
+
+            out << "return true;\n";
+            out << "});\n";
+            PRINT_END_COMMENT(out);
+        }
+
         void visit_(type_identity<EstimateJoinSize>, const EstimateJoinSize& estimateJoinSize,
                 std::ostream& out) override {
             const auto* rel = synthesiser.lookup(estimateJoinSize.getRelation());
@@ -978,18 +1168,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 << "lowerUpperRange_" << keys << "(" << rangeBounds.first.str() << ","
                 << rangeBounds.second.str() << ");\n";
             out << "auto part = range.partition();\n";
-            out << "PARALLEL_START\n";
-            out << preamble.str();
-            out << R"cpp(
-                   #if defined _OPENMP && _OPENMP < 200805
-                           auto count = std::distance(part.begin(), part.end());
-                           auto base = part.begin();
-                           pfor(int index  = 0; index < count; index++) {
-                               auto it = base + index;
-                   #else
-                           pfor(auto it = part.begin(); it < part.end(); it++) {
-                   #endif
-                   )cpp";
+            emitParallelLoop(out);
             out << "try{\n";
             out << "for(const auto& env0 : *it) {\n";
 
@@ -1058,18 +1237,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                 << "lowerUpperRange_" << keys << "(" << rangeBounds.first.str() << ","
                 << rangeBounds.second.str() << ");\n";
             out << "auto part = range.partition();\n";
-            out << "PARALLEL_START\n";
-            out << preamble.str();
-            out << R"cpp(
-                   #if defined _OPENMP && _OPENMP < 200805
-                           auto count = std::distance(part.begin(), part.end());
-                           auto base = part.begin();
-                           pfor(int index  = 0; index < count; index++) {
-                               auto it = base + index;
-                   #else
-                           pfor(auto it = part.begin(); it < part.end(); it++) {
-                   #endif
-                   )cpp";
+            emitParallelLoop(out);
             out << "try{";
             out << "for(const auto& env0 : *it) {\n";
             out << "if( ";
@@ -1104,10 +1272,20 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             out << "if (ref == 0) continue;\n";
 
             // Unpack tuple
-            out << "const RamDomain *"
-                << "env" << unpack.getTupleId() << " = "
-                << "recordTable.unpack(ref," << arity << ");"
-                << "\n";
+            const auto& widths = unpack.getUnboxedWidths();
+            if (widths.empty()) {
+                out << "const RamDomain *"
+                    << "env" << unpack.getTupleId() << " = "
+                    << "recordTable.unpack(ref," << arity << ");"
+                    << "\n";
+            } else {
+                out << "RamDomain env" << unpack.getTupleId() << "_unboxed[" << arity << "];\n";
+                out << "const RamDomain *"
+                    << "env" << unpack.getTupleId() << " = "
+                    << "unpackRecord(recordTable,ref," << arity << ",std::array<unsigned," << arity << ">{{"
+                    << join(widths, ",") << "}},env" << unpack.getTupleId() << "_unboxed);"
+                    << "\n";
+            }
 
             out << "{\n";
 
@@ -1772,9 +1950,17 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             out << "Tuple<RamDomain," << arity << "> tuple{{" << join(insert.getValues(), ",", rec)
                 << "}};\n";
 
-            // insert tuple
-            out << relName << "->"
-                << "insert(tuple," << ctxName << ");\n";
+            // insert tuple, or defer it until the buffer is full or the parallel loop ends
+            if (contains(bufferedRelations, insert.getRelation())) {
+                const std::string bufferName = synthesiser.getInsertBufferName(*rel);
+                out << bufferName << ".push_back(tuple);\n";
+                out << "if (" << bufferName << ".size() >= souffle::insertBufferLimit) {\n";
+                out << relName << "->insertBuffer(" << bufferName << "," << ctxName << ");\n";
+                out << "}\n";
+            } else {
+                out << relName << "->"
+                    << "insert(tuple," << ctxName << ");\n";
+            }
 
             PRINT_END_COMMENT(out);
         }
@@ -1835,12 +2021,12 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
     EVAL_CHILD(ty, getRHS);     \
     out << ")";                 \
     break
-#define COMPARE_STRING(op)                \
-    out << "(symTable.decode(";           \
-    EVAL_CHILD(RamDomain, getLHS);        \
-    out << ") " #op " symTable.decode(";  \
-    EVAL_CHILD(RamDomain, getRHS);        \
-    out << "))";                          \
+#define COMPARE_STRING(op)                    \
+    out << "(symTable.decodeView(";           \
+    EVAL_CHILD(RamDomain, getLHS);            \
+    out << ") " #op " symTable.decodeView(";  \
+    EVAL_CHILD(RamDomain, getRHS);            \
+    out << "))";                              \
     break
 #define COMPARE_EQ_NE(opCode, op)                                         \
     case BinaryConstraintOp::   opCode: COMPARE_NUMERIC(RamDomain  , op); \
@@ -1868,7 +2054,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                     if (const StringConstant* str = as<StringConstant>(&rel.getLHS()); str) {
                         const auto& regex = synthesiser.compileRegex(str->getConstant());
                         if (regex) {
-                            out << "std::regex_match(symTable.decode(";
+                            out << "regex_match_view(symTable.decodeView(";
                             dispatch(rel.getRHS(), out);
                             out << "), regexes.at(" << *regex << "))";
                         } else {
@@ -1876,9 +2062,9 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                         }
                     } else {
                         synthesiser.SubroutineUsingStdRegex = true;
-                        out << "regex_wrapper(symTable.decode(";
+                        out << "regex_wrapper(symTable.decodeView(";
                         dispatch(rel.getLHS(), out);
-                        out << "),symTable.decode(";
+                        out << "),symTable.decodeView(";
                         dispatch(rel.getRHS(), out);
                         out << "))";
                     }
@@ -1888,7 +2074,7 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                     if (const StringConstant* str = as<StringConstant>(&rel.getLHS()); str) {
                         const auto& regex = synthesiser.compileRegex(str->getConstant());
                         if (regex) {
-                            out << "!std::regex_match(symTable.decode(";
+                            out << "!regex_match_view(symTable.decodeView(";
                             dispatch(rel.getRHS(), out);
                             out << "), regexes.at(" << *regex << "))";
                         } else {
@@ -1896,28 +2082,28 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
                         }
                     } else {
                         synthesiser.SubroutineUsingStdRegex = true;
-                        out << "!regex_wrapper(symTable.decode(";
+                        out << "!regex_wrapper(symTable.decodeView(";
                         dispatch(rel.getLHS(), out);
-                        out << "),symTable.decode(";
+                        out << "),symTable.decodeView(";
                         dispatch(rel.getRHS(), out);
                         out << "))";
                     }
                     break;
                 }
                 case BinaryConstraintOp::CONTAINS: {
-                    out << "(symTable.decode(";
+                    out << "(symTable.decodeView(";
                     dispatch(rel.getRHS(), out);
-                    out << ").find(symTable.decode(";
+                    out << ").find(symTable.decodeView(";
                     dispatch(rel.getLHS(), out);
-                    out << ")) != std::string::npos)";
+                    out << ")) != std::string_view::npos)";
                     break;
                 }
                 case BinaryConstraintOp::NOT_CONTAINS: {
-                    out << "(symTable.decode(";
+                    out << "(symTable.decodeView(";
                     dispatch(rel.getRHS(), out);
-                    out << ").find(symTable.decode(";
+                    out << ").find(symTable.decodeView(";
                     dispatch(rel.getLHS(), out);
-                    out << ")) == std::string::npos)";
+                    out << ")) == std::string_view::npos)";
                     break;
                 }
             }
@@ -2449,6 +2635,10 @@ void Synthesiser::emitCode(std::ostream& out, const Statement& stmt) {
             } else {
                 out << "{{ramBitCast(" << join(pack.getArguments(), "),ramBitCast(", rec) << ")}}\n";
             }
+            const auto& widths = pack.getUnboxedWidths();
+            if (!widths.empty()) {
+                out << ",std::array<unsigned," << arity << ">{{" << join(widths, ",") << "}}";
+            }
             out << ")";
 
             PRINT_END_COMMENT(out);
@@ -2673,8 +2863,11 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
     std::set<const IO*> loadIOs;
     std::set<const IO*> storeIOs;
 
-    // collect load/store operations/relations
+    // collect load/store operations/relations; checkpoints are internal to the program
     visit(prog, [&](const IO& io) {
+        if (io.isCheckpoint()) {
+            return;
+        }
         auto op = io.get("operation");
         if (op == "input") {
             loadRelations.insert(io.getRelation());
@@ -2769,11 +2962,12 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
             // regex wrapper
             GenFunction& wrapper = gen.addFunction("regex_wrapper", Visibility::Private);
             wrapper.setRetType("inline bool");
-            wrapper.setNextArg("const std::string&", "pattern");
-            wrapper.setNextArg("const std::string&", "text");
+            wrapper.setNextArg("std::string_view", "pattern");
+            wrapper.setNextArg("std::string_view", "text");
             wrapper.body()
                     << "   bool result = false; \n"
-                    << "   try { result = std::regex_match(text, regexCache.getOrCreate(pattern)); } "
+                    << "   try { result = std::regex_match(text.begin(), text.end(), "
+                       "regexCache.getOrCreate(std::string(pattern))); } "
                        "catch(...) { "
                        "\n"
                     << "     std::cerr << \"warning: wrong pattern provided for match(\\\"\" << pattern << "
@@ -2801,6 +2995,13 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
 
             constructor.setNextInitializer("regexes", rst.str());
             regexes.clear();
+
+            // symbols are matched against the regular expressions in place
+            GenFunction& match = gen.addFunction("regex_match_view", Visibility::Private);
+            match.setRetType("inline bool");
+            match.setNextArg("std::string_view", "text");
+            match.setNextArg("const std::regex&", "regex");
+            match.body() << "return std::regex_match(text.begin(), text.end(), regex);\n";
         }
 
         // substring wrapper
@@ -2838,7 +3039,13 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         }
         st << "}";
     }
-    mainClass.addField("SymbolTableImpl", "symTable", Visibility::Private);
+    std::string symbolTableType = "SymbolTableImpl";
+    if (glb.config().has("arena-symbols")) {
+        symbolTableType = "ArenaSymbolTable";
+    } else if (glb.config().has("sharded-symbols")) {
+        symbolTableType = "ShardedSymbolTable";
+    }
+    mainClass.addField(symbolTableType, "symTable", Visibility::Private);
     constructor.setNextInitializer("symTable", st.str());
 
     // declare record table
@@ -2876,6 +3083,13 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         mainClass.addField(function_ty(name), name, Visibility::Private);
     }
 
+    // the memory of the relations is estimated for spill statements
+    std::stringstream footprint;
+    auto getTupleFootprint = [](Relation& relation) {
+        const std::size_t indexes = std::max<std::size_t>(1, relation.getIndices().size());
+        return std::to_string(relation.getArity() * indexes) + " * sizeof(RamDomain)";
+    };
+
     int relCtr = 0;
     for (auto rel : prog.getRelations()) {
         // get some table details
@@ -2889,6 +3103,8 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         // defining table
         mainClass.addField("Own<" + type + ">", cppName, Visibility::Private);
         constructor.setNextInitializer(cppName, "mk<" + type + ">()");
+        footprint << "footprint += " << cppName << "->size() * " << getTupleFootprint(*relationType)
+                  << ";\n";
         if (!rel->isTemp()) {
             std::stringstream ty, init, wrapper_name;
             ty << "souffle::RelationWrapper<" << type << ">";
@@ -2914,6 +3130,18 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         }
     }
 
+    if (visitExists(prog.getMain(), [](const Spill&) { return true; })) {
+        mainClass.addInclude("\"souffle/datastructure/SpillStore.h\"");
+        mainClass.addField("SpillStore", "spillStore", Visibility::Private);
+        constructor.setNextInitializer("spillStore", "R\"_(" + glb.config().get("spill-dir") + ")_\"");
+
+        GenFunction& getFootprint = mainClass.addFunction("getRelationFootprint", Visibility::Private);
+        getFootprint.setRetType("std::size_t");
+        getFootprint.body() << "std::size_t footprint = 0;\n";
+        getFootprint.body() << footprint.str();
+        getFootprint.body() << "return footprint;\n";
+    }
+
     for (auto [name, value] : subroutineInits) {
         std::string clName = convertStratumIdent("Stratum_" + name);
         std::string fName = convertStratumIdent("stratum_" + name);
@@ -3217,6 +3445,9 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
     factory_hook << "extern \"C\" {\n";
     factory_hook << db.getNS(false) << "::factory_" << classname << " __factory_" << classname
                  << "_instance;\n";
+    factory_hook << "souffle::SouffleProgram* __factory_" << classname << "_newInstance() {\n";
+    factory_hook << "return __factory_" << classname << "_instance.newInstance();\n";
+    factory_hook << "}\n";
     factory_hook << "}\n";
     factory_hook << "#endif\n";
     factory_hook << "} // namespace souffle\n";
@@ -3240,6 +3471,9 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         hook << "R\"()\",\n";
     }
     hook << std::stoi(glb.config().get("jobs"));
+    if (glb.config().has("table-snapshot")) {
+        hook << ",\nR\"(" << glb.config().get("table-snapshot") << ")\"";
+    }
     hook << ");\n";
 
     hook << "if (!opt.parse(argc,argv)) return 1;\n";
@@ -3269,7 +3503,16 @@ void Synthesiser::generateCode(GenDb& db, const std::string& id, bool& withShare
         hook << R"_(souffle::ProfileEventSingleton::instance().makeConfigRecord("version", ")_"
              << glb.config().get("version") << R"_(");)_" << '\n';
     }
+    hook << "if (!opt.getTableSnapshot().empty()) {\n";
+    hook << "try { obj.loadTableSnapshot(opt.getTableSnapshot()); }\n";
+    hook << "catch (std::runtime_error& e) { std::cerr << \"Warning: ignoring table snapshot: \" << e.what() "
+            "<< std::endl; }\n";
+    hook << "}\n";
     hook << "obj.runAll(opt.getInputFileDir(), opt.getOutputFileDir());\n";
+    hook << "if (!opt.getTableSnapshot().empty()) {\n";
+    hook << "try { obj.saveTableSnapshot(opt.getTableSnapshot()); }\n";
+    hook << "catch (std::runtime_error& e) { std::cerr << \"Warning: \" << e.what() << std::endl; }\n";
+    hook << "}\n";
 
     if (glb.config().get("provenance") == "explain") {
         hook << "explain(obj, false);\n";
@@ -108,6 +108,9 @@ protected:
     /** Get context name */
     const std::string getOpContextName(const ram::Relation& rel);
 
+    /** Get the name of the thread-local insert buffer */
+    const std::string getInsertBufferName(const ram::Relation& rel);
+
     /** Get relation struct definition */
     void generateRelationTypeStruct(GenDb& db, Own<Relation> relationType);
 
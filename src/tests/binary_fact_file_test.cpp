@@ -0,0 +1,150 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file binary_fact_file_test.cpp
+ *
+ * Tests the round trip of relations through binary fact files.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/io/IOSystem.h"
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+using Entry = Tuple<RamDomain, 3>;
+
+/** A relation accepting batches of tuples */
+struct Collector {
+    std::vector<Entry> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.push_back(Entry{{tuple[0], tuple[1], tuple[2]}});
+    }
+
+    void insertBatch(const RamDomain* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(data + i * 3);
+        }
+    }
+};
+
+std::map<std::string, std::string> getOperation(const std::string& fileName, const std::string& types) {
+    std::map<std::string, std::string> rwOperation;
+    rwOperation["IO"] = "binary";
+    rwOperation["name"] = "R";
+    rwOperation["filename"] = fileName;
+    rwOperation["types"] = R"({"relation": {"arity": 3, "types": )" + types + "}}";
+    return rwOperation;
+}
+
+template <typename F>
+bool throwsInvalidArgument(F&& f) {
+    try {
+        f();
+    } catch (std::invalid_argument&) {
+        return true;
+    }
+    return false;
+}
+
+const std::string fileName = (std::filesystem::temp_directory_path() / "binary_fact_file_test.bin").string();
+
+const std::string types = R"(["s:symbol", "i:number", "f:float"])";
+
+}  // namespace
+
+TEST(BinaryFactFile, RoundTrip) {
+    const auto operation = getOperation(fileName, types);
+
+    // write a relation using one symbol table ...
+    std::vector<Entry> written;
+    {
+        SymbolTableImpl symbolTable;
+        SpecializedRecordTable<0> recordTable;
+        for (RamDomain i = 0; i < 100000; ++i) {
+            const RamDomain symbol = symbolTable.encode("symbol_" + std::to_string(i % 1000));
+            written.push_back(Entry{{symbol, -i, ramBitCast(static_cast<RamFloat>(i) / 2)}});
+        }
+        IOSystem::getInstance().getWriter(operation, symbolTable, recordTable)->writeAll(written);
+    }
+
+    // ... and read it using another one, which already contains other symbols
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    symbolTable.encode("other");
+    Collector relation;
+    IOSystem::getInstance().getReader(operation, symbolTable, recordTable)->readAll(relation);
+
+    ASSERT_TRUE(written.size() == relation.tuples.size());
+    for (std::size_t i = 0; i < written.size(); ++i) {
+        const Entry& tuple = relation.tuples[i];
+        EXPECT_EQ("symbol_" + std::to_string(i % 1000), symbolTable.decode(tuple[0]));
+        EXPECT_EQ(written[i][1], tuple[1]);
+        EXPECT_EQ(written[i][2], tuple[2]);
+    }
+
+    std::filesystem::remove(fileName);
+    std::filesystem::remove(getBinarySymbolFileName(fileName));
+}
+
+TEST(BinaryFactFile, Invalid) {
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+
+    // attributes referring to the record table are not supported
+    const auto records = getOperation(fileName, R"(["r:R", "i:number", "i:number"])");
+    EXPECT_TRUE(throwsInvalidArgument(
+            [&]() { IOSystem::getInstance().getWriter(records, symbolTable, recordTable); }));
+
+    // files of other formats are rejected
+    {
+        std::ofstream file(fileName);
+        file << "symbol\t1\t1.0\n";
+    }
+    const auto operation = getOperation(fileName, types);
+    EXPECT_TRUE(throwsInvalidArgument(
+            [&]() { IOSystem::getInstance().getReader(operation, symbolTable, recordTable); }));
+
+    std::filesystem::remove(fileName);
+}
+
+TEST(BinaryFactFile, WriteFailure) {
+    // writes to /dev/full fail as the device is out of space
+    if (!std::filesystem::exists("/dev/full")) {
+        return;
+    }
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    const std::vector<Entry> written(1000, Entry{{1, 2, 3}});
+    const auto operation = getOperation("/dev/full", R"(["i:number", "i:number", "i:number"])");
+    bool failed = false;
+    try {
+        IOSystem::getInstance().getWriter(operation, symbolTable, recordTable)->writeAll(written);
+    } catch (std::runtime_error&) {
+        failed = true;
+    }
+    EXPECT_TRUE(failed);
+}
+
+}  // namespace souffle::test
@@ -365,6 +365,39 @@ TEST(BTreeMultiSet, Load) {
     }
 }
 
+TEST(BTreeMultiSet, InsertSorted) {
+    using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 200; N++) {
+        // bottom-up construction of an empty tree, keeping duplicates
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(i / 3);
+        }
+
+        test_set t;
+        t.insertSorted(data.begin(), data.end());
+        EXPECT_EQ(data.size(), t.size());
+        EXPECT_TRUE(t.check());
+
+        // a range overlapping the maximum
+        std::vector<int> more;
+        for (int i = 0; i < N; i++) {
+            more.push_back(N / 6 + i);
+        }
+        t.insertSorted(more.begin(), more.end());
+        EXPECT_TRUE(t.check());
+
+        std::multiset<int> ref(data.begin(), data.end());
+        ref.insert(more.begin(), more.end());
+        EXPECT_EQ(ref.size(), t.size());
+        EXPECT_TRUE(std::equal(ref.begin(), ref.end(), t.begin()));
+        for (int i : ref) {
+            EXPECT_EQ(ref.count(i), (std::size_t)std::distance(t.lower_bound(i), t.upper_bound(i)));
+        }
+    }
+}
+
 TEST(BTreeMultiSet, Clear) {
     using test_set = btree_multiset<int, detail::comparator<int>, std::allocator<int>, 16>;
 
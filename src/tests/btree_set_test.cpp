@@ -28,6 +28,7 @@
 #include <memory>
 #include <random>
 #include <set>
+#include <sstream>
 #include <string>
 #include <system_error>
 #include <tuple>
@@ -484,6 +485,61 @@ TEST(BTreeSet, Load) {
     }
 }
 
+TEST(BTreeSet, InsertSorted) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    for (int N = 0; N < 200; N++) {
+        // bottom-up construction of an empty tree, including duplicates
+        std::vector<int> data;
+        for (int i = 0; i < N; i++) {
+            data.push_back(i / 2 * 2);
+        }
+
+        test_set t;
+        t.insertSorted(data.begin(), data.end());
+        EXPECT_EQ((std::size_t)(N + 1) / 2, t.size());
+        EXPECT_TRUE(t.check());
+
+        // a range overlapping the maximum: filling the gaps and appending the rest
+        std::vector<int> more;
+        for (int i = 0; i < N; i++) {
+            more.push_back(N / 2 + i);
+        }
+        t.insertSorted(more.begin(), more.end());
+        EXPECT_TRUE(t.check());
+
+        std::set<int> ref(data.begin(), data.end());
+        ref.insert(more.begin(), more.end());
+        EXPECT_EQ(ref.size(), t.size());
+        EXPECT_TRUE(std::equal(ref.begin(), ref.end(), t.begin()));
+    }
+}
+
+TEST(BTreeSet, InsertBatch) {
+    using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
+
+    std::mt19937 randomGenerator(3);
+    std::uniform_int_distribution<int> distribution(0, 5000);
+
+    test_set t;
+    std::set<int> ref;
+    for (int round = 0; round < 20; round++) {
+        std::vector<int> batch;
+        for (int i = 0; i < 500; i++) {
+            batch.push_back(distribution(randomGenerator) + round * 100);
+        }
+        ref.insert(batch.begin(), batch.end());
+        t.insertBatch(batch);
+
+        EXPECT_TRUE(t.check());
+        EXPECT_EQ(ref.size(), t.size());
+        EXPECT_TRUE(std::equal(ref.begin(), ref.end(), t.begin()));
+        for (int i : ref) {
+            EXPECT_TRUE(t.contains(i));
+        }
+    }
+}
+
 TEST(BTreeSet, Clear) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -501,6 +557,69 @@ TEST(BTreeSet, Clear) {
     EXPECT_TRUE(t.empty());
 }
 
+TEST(BTreeSet, ArenaReuse) {
+    using test_set = btree_set<int, detail::comparator<int>, arena_allocator<int>, 16>;
+
+    test_set t;
+    std::size_t reserved = 0;
+
+    // refilling a cleared tree reuses the memory of its arena
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 10000; i++) {
+            t.insert((i * 7919) % 10000);
+        }
+        EXPECT_EQ(10000, t.size());
+        EXPECT_TRUE(t.check());
+
+        std::ostringstream stats;
+        t.printStats(stats);
+        EXPECT_TRUE(stats.str().find("Arena reserved") != std::string::npos);
+
+        std::size_t cur = 0;
+        std::istringstream in(stats.str().substr(stats.str().find("Arena reserved:") + 15));
+        in >> cur;
+        if (round == 0) {
+            reserved = cur;
+        }
+        EXPECT_EQ(reserved, cur);
+
+        t.clear();
+        EXPECT_TRUE(t.empty());
+        EXPECT_FALSE(t.contains(5));
+    }
+}
+
+TEST(BTreeSet, ArenaOwnership) {
+    using test_set = btree_set<int, detail::comparator<int>, arena_allocator<int>, 16>;
+
+    std::vector<int> data;
+    for (int i = 0; i < 1000; i++) {
+        data.push_back(i);
+    }
+
+    // nodes remain valid when moving or swapping trees
+    test_set a = test_set::load(data.begin(), data.end());
+    test_set b(std::move(a));
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(1000, b.size());
+
+    a.insert(-1);
+    a.swap(b);
+    EXPECT_EQ(1000, a.size());
+    EXPECT_EQ(1, b.size());
+    b.clear();
+    EXPECT_TRUE(a.check());
+
+    // copies own their nodes
+    test_set c(a);
+    a.clear();
+    EXPECT_EQ(1000, c.size());
+    EXPECT_TRUE(c.check());
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(c.contains(i));
+    }
+}
+
 TEST(BTreeSet, ChunkSplit) {
     using test_set = btree_set<int, detail::comparator<int>, std::allocator<int>, 16>;
 
@@ -576,6 +695,104 @@ TEST(BTreeSet, ChunkSplitStress) {
     }
 }
 
+/**
+ * A tuple comparator ordering by the given leading column first and the
+ * remaining columns in natural order afterwards. It exposes its leading column
+ * for the simd_search strategy.
+ */
+template <std::size_t First, typename T>
+struct LeadingComparator {
+    static constexpr std::size_t leading_column = First;
+    using leading_type = T;
+
+    template <typename Key>
+    int operator()(const Key& a, const Key& b) const {
+        if (T(a[First]) != T(b[First])) {
+            return T(a[First]) < T(b[First]) ? -1 : 1;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (i != First && a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+    template <typename Key>
+    bool less(const Key& a, const Key& b) const {
+        return (*this)(a, b) < 0;
+    }
+    template <typename Key>
+    bool equal(const Key& a, const Key& b) const {
+        return (*this)(a, b) == 0;
+    }
+};
+
+/**
+ * Checks that a b-tree using the simd_search strategy agrees with one using
+ * the linear_search strategy on random insertions and lookups. The leading
+ * attribute takes the given number of values; few values result in long runs
+ * of keys sharing it.
+ */
+template <typename Key, typename Comp>
+bool checkSimdSearch(int leadingValues = 41) {
+    using simd_set = btree_set<Key, Comp, std::allocator<Key>, 256, detail::simd_search>;
+    using model_set = btree_set<Key, Comp, std::allocator<Key>, 256, detail::linear_search>;
+
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> dist(-20, 20);
+    std::uniform_int_distribution<int> leading(0, leadingValues - 1);
+    auto randomKey = [&]() {
+        Key k{};
+        for (auto& cur : k) {
+            cur = dist(generator);
+        }
+        k[Comp::leading_column] = leading(generator) - 20;
+        return k;
+    };
+
+    simd_set t;
+    model_set m;
+    bool ok = true;
+    for (int i = 0; i < 5000; i++) {
+        auto k = randomKey();
+        ok = (m.insert(k) == t.insert(k)) && ok;
+    }
+    ok = ok && m.size() == t.size() && t.check();
+    ok = ok && std::equal(m.begin(), m.end(), t.begin(), t.end());
+
+    auto same = [&](typename model_set::iterator a, typename simd_set::iterator b) {
+        if (a == m.end() || b == t.end()) {
+            return (a == m.end()) == (b == t.end());
+        }
+        return *a == *b;
+    };
+    for (int i = 0; i < 5000; i++) {
+        auto k = randomKey();
+        ok = ok && m.contains(k) == t.contains(k);
+        ok = ok && same(m.lower_bound(k), t.lower_bound(k));
+        ok = ok && same(m.upper_bound(k), t.upper_bound(k));
+    }
+    return ok;
+}
+
+TEST(BTreeSet, SimdSearch) {
+    // the default strategy for integer tuples
+    using int_strategy = detail::default_strategy<std::array<int32_t, 3>>::type;
+    using float_strategy = detail::default_strategy<std::array<float, 3>>::type;
+    EXPECT_TRUE((std::is_same_v<int_strategy, detail::simd_search>));
+    EXPECT_TRUE((std::is_same_v<float_strategy, detail::binary_search>));
+
+    EXPECT_TRUE((checkSimdSearch<std::array<int32_t, 3>, LeadingComparator<0, int32_t>>()));
+    EXPECT_TRUE((checkSimdSearch<std::array<int32_t, 3>, LeadingComparator<2, int32_t>>()));
+    EXPECT_TRUE((checkSimdSearch<std::array<int32_t, 5>, LeadingComparator<1, uint32_t>>()));
+    EXPECT_TRUE((checkSimdSearch<std::array<int64_t, 3>, LeadingComparator<0, int64_t>>()));
+    EXPECT_TRUE((checkSimdSearch<std::array<int64_t, 4>, LeadingComparator<3, uint64_t>>()));
+
+    // runs of keys sharing their leading attribute span entire nodes
+    EXPECT_TRUE((checkSimdSearch<std::array<int32_t, 3>, LeadingComparator<0, int32_t>>(2)));
+    EXPECT_TRUE((checkSimdSearch<std::array<int64_t, 4>, LeadingComparator<3, uint64_t>>(2)));
+}
+
 using Entry = std::tuple<int, int64_t>;
 
 std::vector<Entry> getData(unsigned numEntries) {
@@ -726,6 +943,41 @@ TEST(Performance, Load) {
 
     // take time for structured load
     time("bulk-load", [&]() { auto t = btree_set<int>::load(data.begin(), data.end()); });
+
+    // take time for bottom-up insertion of a sorted range
+    time("sorted insert", [&]() {
+        btree_set<int> t;
+        t.insertSorted(data.begin(), data.end());
+    });
+}
+
+TEST(Performance, Search) {
+    //        int N = 1<<22;
+    int N = 1 << 18;
+
+    // get list of 3-column tuples to be inserted
+    using Key = std::array<int32_t, 3>;
+    std::vector<Key> in;
+    std::vector<Key> out;
+    time("generating data", [&]() {
+        auto data = getData(2 * N);
+        for (std::size_t i = 0; i < data.size(); i++) {
+            Key k{std::get<0>(data[i]), static_cast<int32_t>(std::get<1>(data[i])),
+                    static_cast<int32_t>(i % 7)};
+            (i % 2 == 0 ? in : out).push_back(k);
+        }
+    });
+
+    using Comp = LeadingComparator<0, int32_t>;
+
+    using t1 = btree_set<Key, Comp, std::allocator<Key>, 256, detail::linear_search>;
+    checkPerformance(t1, "souffle btree_set - 256 - linear", in, out);
+
+    using t2 = btree_set<Key, Comp, std::allocator<Key>, 256, detail::binary_search>;
+    checkPerformance(t2, "souffle btree_set - 256 - binary", in, out);
+
+    using t3 = btree_set<Key, Comp, std::allocator<Key>, 256, detail::simd_search>;
+    checkPerformance(t3, "souffle btree_set - 256 - simd", in, out);
 }
 
 TEST(BTreeSet, Parallel) {
@@ -867,5 +1119,53 @@ TEST(BTreeSet, ParallelScaling) {
     }
 }
 
+TEST(BTreeSet, ParallelInsertBuffer) {
+    using Key = std::array<int32_t, 2>;
+    using test_set = btree_set<Key>;
+    using op_context_type = test_set::operation_hints;
+
+    const int N = 1 << 16;
+    const int dup = 4;  // the number of times each element is derived
+
+    std::vector<Key> data;
+    for (int i = 0; i < N * dup; i++) {
+        data.push_back(Key{(i % N) / 64, (i % N) % 64});
+    }
+    std::mt19937 generator(13);
+    std::shuffle(data.begin(), data.end(), generator);
+
+    // direct concurrent insertions and thread-local buffers produce the same set
+    for (int threads : {8, 32, 64}) {
+        omp_set_num_threads(threads);
+
+        test_set direct;
+#pragma omp parallel
+        {
+            op_context_type ctxt;
+#pragma omp for
+            for (int i = 0; i < N * dup; i++) {
+                direct.insert(data[i], ctxt);
+            }
+        }
+
+        test_set buffered;
+#pragma omp parallel
+        {
+            std::vector<Key> buffer;
+#pragma omp for
+            for (int i = 0; i < N * dup; i++) {
+                buffer.push_back(data[i]);
+            }
+            op_context_type ctxt;
+            buffered.insertBuffer(buffer, ctxt);
+        }
+
+        EXPECT_TRUE(buffered.check());
+        EXPECT_EQ(N, direct.size());
+        EXPECT_EQ(N, buffered.size());
+        EXPECT_TRUE(std::equal(direct.begin(), direct.end(), buffered.begin(), buffered.end()));
+    }
+}
+
 #endif
 }  // namespace souffle::test
@@ -0,0 +1,186 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file checkpoint_test.cpp
+ *
+ * Tests saving and restoring the progress of checkpointed runs.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/io/IOSystem.h"
+#include "souffle/utility/FileUtil.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+using RecordTable = SpecializedRecordTable<0, 2>;
+
+/** A relation collecting the completed strata */
+struct Collector {
+    std::vector<RamDomain> strata;
+
+    void insert(const RamDomain* tuple) {
+        strata.push_back(tuple[0]);
+    }
+};
+
+const std::string dir = (std::filesystem::temp_directory_path() / "checkpoint_test").string();
+
+/** The fingerprint and the input files of the program of the runs */
+std::map<std::string, std::string> program;
+
+std::map<std::string, std::string> getOperation(const std::string& stratum = "") {
+    std::map<std::string, std::string> rwOperation = program;
+    rwOperation["IO"] = "checkpoint";
+    rwOperation["name"] = "@checkpoint";
+    rwOperation["checkpoint-dir"] = dir;
+    rwOperation["types"] = R"({"relation": {"arity": 1, "types": ["i:number"]}})";
+    if (!stratum.empty()) {
+        rwOperation["stratum"] = stratum;
+    }
+    return rwOperation;
+}
+
+std::vector<RamDomain> restore(SymbolTableImpl& symbolTable, RecordTable& recordTable) {
+    Collector relation;
+    IOSystem::getInstance().getReader(getOperation(), symbolTable, recordTable)->readAll(relation);
+    return relation.strata;
+}
+
+void save(const SymbolTableImpl& symbolTable, const RecordTable& recordTable, const std::string& stratum) {
+    const std::vector<Tuple<RamDomain, 1>> relation;
+    IOSystem::getInstance().getWriter(getOperation(stratum), symbolTable, recordTable)->writeAll(relation);
+}
+
+}  // namespace
+
+TEST(Checkpoint, Resume) {
+    std::filesystem::remove_all(dir);
+    const RamDomain record[] = {1, 2};
+    RamDomain symbol;
+    RamDomain ref;
+    {
+        // a new run starts from the first stratum
+        SymbolTableImpl symbolTable{"program"};
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+
+        symbol = symbolTable.encode("computed");
+        ref = recordTable.pack(record, 2);
+        save(symbolTable, recordTable, "2");
+    }
+
+    // a resumed run skips the completed strata and decodes the values of the saved relations
+    SymbolTableImpl symbolTable{"program"};
+    RecordTable recordTable;
+    const std::vector<RamDomain> completed = {0, 1, 2};
+    EXPECT_TRUE(restore(symbolTable, recordTable) == completed);
+    EXPECT_EQ("computed", symbolTable.decode(symbol));
+    EXPECT_EQ(2, recordTable.unpack(ref, 2)[1]);
+
+    // the progress is discarded once the run has completed
+    save(symbolTable, recordTable, "");
+    SymbolTableImpl otherSymbolTable{"program"};
+    RecordTable otherRecordTable;
+    EXPECT_TRUE(restore(otherSymbolTable, otherRecordTable).empty());
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Checkpoint, Inconsistent) {
+    std::filesystem::remove_all(dir);
+    {
+        SymbolTableImpl symbolTable{"a"};
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+        save(symbolTable, recordTable, "0");
+    }
+
+    // a checkpoint of another program is ignored
+    SymbolTableImpl symbolTable{"b"};
+    RecordTable recordTable;
+    EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+    EXPECT_EQ(0, symbolTable.encode("b"));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Checkpoint, ChangedProgram) {
+    std::filesystem::remove_all(dir);
+    const std::vector<RamDomain> completed = {0, 1};
+    program = {{"fingerprint", "1"}};
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+        save(symbolTable, recordTable, "1");
+    }
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable) == completed);
+    }
+
+    // a run of a changed program starts from the first stratum, and discards the checkpoint
+    program = {{"fingerprint", "2"}};
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+    }
+    program = {{"fingerprint", "1"}};
+    SymbolTableImpl symbolTable;
+    RecordTable recordTable;
+    EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+
+    program.clear();
+    std::filesystem::remove_all(dir);
+}
+
+TEST(Checkpoint, ChangedInputs) {
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string facts = dir + pathSeparator + "edge.facts";
+    std::ofstream(facts) << "1\t2\n";
+    program = {{"fingerprint", "1"}, {"inputs", R"(["edge.facts"])"}, {"fact-dir", dir}};
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+        save(symbolTable, recordTable, "0");
+    }
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        EXPECT_TRUE(restore(symbolTable, recordTable) == std::vector<RamDomain>{0});
+    }
+
+    // a run on changed inputs starts from the first stratum
+    std::ofstream(facts) << "1\t3\n";
+    SymbolTableImpl symbolTable;
+    RecordTable recordTable;
+    EXPECT_TRUE(restore(symbolTable, recordTable).empty());
+
+    program.clear();
+    std::filesystem::remove_all(dir);
+}
+
+}  // namespace souffle::test
@@ -0,0 +1,143 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file hash_set_test.cpp
+ *
+ * A test case testing the concurrent hash set.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/ConcurrentHashSet.h"
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace souffle::test {
+
+using Entry = Tuple<RamDomain, 2>;
+using HashSet = ConcurrentHashSet<Entry>;
+
+TEST(HashSet, Basic) {
+    HashSet set;
+    EXPECT_TRUE(set.empty());
+    EXPECT_EQ(0, set.size());
+    EXPECT_TRUE(set.begin() == set.end());
+
+    EXPECT_TRUE(set.insert(Entry{1, 2}));
+    EXPECT_FALSE(set.insert(Entry{1, 2}));
+    EXPECT_TRUE(set.insert(Entry{2, 1}));
+    EXPECT_EQ(2, set.size());
+
+    EXPECT_TRUE(set.contains(Entry{1, 2}));
+    EXPECT_TRUE(set.contains(Entry{2, 1}));
+    EXPECT_FALSE(set.contains(Entry{1, 1}));
+
+    EXPECT_TRUE(set.find(Entry{1, 1}) == set.end());
+    EXPECT_EQ((Entry{2, 1}), *set.find(Entry{2, 1}));
+
+    set.clear();
+    EXPECT_TRUE(set.empty());
+    EXPECT_FALSE(set.contains(Entry{1, 2}));
+}
+
+TEST(HashSet, PointRange) {
+    HashSet set;
+    for (RamDomain i = 0; i < 100; i++) {
+        set.insert(Entry{i, -i});
+    }
+
+    // a point range covers exactly the element, if present
+    std::size_t count = 0;
+    for (auto it = set.lower_bound(Entry{5, -5}); it != set.upper_bound(Entry{5, -5}); ++it) {
+        EXPECT_EQ((Entry{5, -5}), *it);
+        count++;
+    }
+    EXPECT_EQ(1, count);
+    EXPECT_TRUE(set.lower_bound(Entry{5, 5}) == set.upper_bound(Entry{5, 5}));
+}
+
+TEST(HashSet, Growth) {
+    HashSet set;
+    std::set<Entry> ref;
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<RamDomain> dist(-5000, 5000);
+
+    for (int i = 0; i < 20000; i++) {
+        Entry e{dist(generator), dist(generator) % 10};
+        EXPECT_EQ(ref.insert(e).second, set.insert(e));
+    }
+    EXPECT_EQ(ref.size(), set.size());
+
+    // iteration enumerates each element exactly once
+    std::vector<Entry> content(set.begin(), set.end());
+    std::sort(content.begin(), content.end());
+    EXPECT_TRUE(std::equal(content.begin(), content.end(), ref.begin(), ref.end()));
+
+    for (const auto& e : ref) {
+        EXPECT_TRUE(set.contains(e));
+    }
+}
+
+TEST(HashSet, Chunks) {
+    HashSet set;
+    for (RamDomain i = 0; i < 1000; i++) {
+        set.insert(Entry{i, i});
+    }
+
+    for (std::size_t num : {1, 7, 100, 5000}) {
+        auto chunks = set.getChunks(num);
+        EXPECT_TRUE(chunks.size() <= num);
+        std::size_t count = 0;
+        for (const auto& chunk : chunks) {
+            EXPECT_FALSE(chunk.empty());
+            for (const auto& e : chunk) {
+                EXPECT_EQ(e[0], e[1]);
+                count++;
+            }
+        }
+        EXPECT_EQ(1000, count);
+    }
+}
+
+TEST(HashSet, Parallel) {
+    const int N = 10000;
+
+    // insert every element several times from all threads
+    std::vector<Entry> full;
+    for (int dup = 0; dup < 3; dup++) {
+        for (RamDomain i = 0; i < N; i++) {
+            full.push_back(Entry{i, i % 17});
+        }
+    }
+    std::mt19937 generator(7);
+    std::shuffle(full.begin(), full.end(), generator);
+
+    HashSet set;
+    int inserted = 0;
+#pragma omp parallel for reduction(+ : inserted)
+    for (int idx = 0; idx < static_cast<int>(full.size()); ++idx) {
+        if (set.insert(full[idx])) {
+            inserted++;
+        }
+    }
+
+    EXPECT_EQ(N, inserted);
+    EXPECT_EQ(N, set.size());
+    for (RamDomain i = 0; i < N; i++) {
+        EXPECT_TRUE(set.contains(Entry{i, i % 17}));
+    }
+}
+
+}  // namespace souffle::test
@@ -16,8 +16,14 @@
 
 #include "tests/test.h"
 
+#include "souffle/utility/EvaluatorUtil.h"
 #include "souffle/utility/ParallelUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace souffle {
 
@@ -99,5 +105,75 @@ TEST(ParallelUtils, OptimisticReadWriteLock) {
 
     EXPECT_EQ(2 * (N / K), c);
 }
+
+TEST(ParallelUtils, WorkStealingLoop) {
+    const std::size_t N = 1000;
+    const std::size_t T = 4;
+
+    // the share of the first thread is slow to process
+    const std::size_t heavy = N / T;
+
+    WorkStealingLoop loop(N, T);
+    std::vector<std::atomic<int>> runs(N);
+    std::atomic<std::size_t> stolen{0};
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(T)
+#endif
+    {
+        std::size_t i = 0;
+        while (loop.next(i)) {
+            runs[i]++;
+            if (i < heavy) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+#ifdef _OPENMP
+                if (omp_get_thread_num() != 0) {
+                    stolen++;
+                }
+#endif
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < N; i++) {
+        EXPECT_EQ(1, runs[i].load());
+    }
+#ifdef _OPENMP
+    EXPECT_LT(0, stolen.load());
+#endif
+}
+
+TEST(ParallelUtils, TaskGraphThreadBudget) {
+    const std::size_t numThreads = 4;
+
+    // task 0 runs alongside task 1, and then alongside the tasks readied by task 1
+    const std::vector<std::vector<std::size_t>> predecessors = {{}, {}, {1}, {1}, {1}};
+    const std::vector<int> durations = {100, 1, 20, 20, 20};
+
+    std::atomic<std::size_t> busy = 0;
+    std::atomic<std::size_t> peak = 0;
+    std::vector<std::atomic<int>> runs(predecessors.size());
+    evaluator::runTaskGraph(predecessors, numThreads, [&](std::size_t task) {
+        runs[task]++;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            const std::size_t current = ++busy;
+            std::size_t seen = peak.load();
+            while (seen < current && !peak.compare_exchange_weak(seen, current)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(durations[task]));
+            busy--;
+        }
+    });
+
+    for (auto& run : runs) {
+        EXPECT_EQ(1, run.load());
+    }
+    EXPECT_LT(peak.load(), numThreads + 1);
+    EXPECT_LT(0, peak.load());
+}
+
 }  // namespace test
 }  // end namespace souffle
@@ -0,0 +1,130 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file read_stream_csv_test.cpp
+ *
+ * Tests the parallel, chunked reading of CSV input.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/io/ReadStreamCSV.h"
+#include <cstddef>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace souffle::test {
+
+namespace {
+
+/** A relation recording the decoded tuples in the order of insertion */
+struct Collector {
+    explicit Collector(SymbolTable& symbolTable) : symbolTable(symbolTable) {}
+
+    SymbolTable& symbolTable;
+    std::vector<std::string> tuples;
+
+    void insert(const RamDomain* tuple) {
+        tuples.push_back(symbolTable.decode(tuple[0]) + "|" + std::to_string(tuple[1]));
+    }
+};
+
+/** A relation accepting batches of tuples */
+struct BatchCollector : public Collector {
+    using Collector::Collector;
+
+    void insertBatch(const RamDomain* data, std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(data + i * 2);
+        }
+    }
+};
+
+std::map<std::string, std::string> getOperation(bool rfc4180) {
+    std::map<std::string, std::string> rwOperation;
+    rwOperation["types"] = R"({"relation": {"arity": 2, "types": ["s:symbol", "i:number"]}})";
+    rwOperation["rfc4180"] = rfc4180 ? "true" : "false";
+    return rwOperation;
+}
+
+/** Creates input of the given number of lines exceeding the minimal chunk size */
+std::string getInput(std::size_t numLines, bool rfc4180) {
+    std::stringstream input;
+    for (std::size_t i = 0; i < numLines; ++i) {
+        if (!rfc4180) {
+            input << "symbol_" << i << "\t" << i << (i % 3 == 0 ? "\r\n" : "\n");
+        } else if (i % 7 == 0) {
+            input << "\"quoted, \"\"multi\"\"\r\nline\n" << i << "\"," << i << "\n";
+        } else {
+            input << "symbol_" << i << "," << i << "\n";
+        }
+    }
+    return input.str();
+}
+
+template <typename Relation>
+std::vector<std::string> read(
+        const std::string& input, bool rfc4180, [[maybe_unused]] std::size_t numThreads) {
+#ifdef _OPENMP
+    omp_set_num_threads(static_cast<int>(numThreads));
+#endif
+    SymbolTableImpl symbolTable;
+    SpecializedRecordTable<0> recordTable;
+    std::istringstream stream(input);
+    ReadStreamCSV reader(stream, getOperation(rfc4180), symbolTable, recordTable);
+    Relation relation(symbolTable);
+    reader.readAll(relation);
+    return relation.tuples;
+}
+
+}  // namespace
+
+TEST(ReadStreamCSV, Chunked) {
+    for (bool rfc4180 : {false, true}) {
+        const std::string input = getInput(100000, rfc4180);
+        const auto expected = read<Collector>(input, rfc4180, 1);
+        EXPECT_EQ(100000, expected.size());
+        EXPECT_EQ(expected, read<Collector>(input, rfc4180, 4));
+        EXPECT_EQ(expected, read<BatchCollector>(input, rfc4180, 4));
+
+        // input lacking a trailing new line
+        const std::string truncated = input.substr(0, input.size() - 1);
+        EXPECT_EQ(expected, read<BatchCollector>(truncated, rfc4180, 4));
+    }
+}
+
+TEST(ReadStreamCSV, ChunkedErrorLine) {
+    for (std::size_t numThreads : {1, 4}) {
+        std::string input = getInput(100000, false);
+        const std::size_t pos = input.find("symbol_87655\t");
+        input.replace(pos, 19, "symbol_87655\tfoo\n");
+        bool rejected = false;
+        try {
+            read<BatchCollector>(input, false, numThreads);
+        } catch (std::invalid_argument& e) {
+            rejected = true;
+            EXPECT_EQ(std::string("Error converting <foo> in column 2 in line 87656; "), e.what());
+        }
+        EXPECT_TRUE(rejected);
+    }
+}
+
+}  // namespace souffle::test
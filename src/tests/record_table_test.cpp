@@ -18,6 +18,7 @@
 
 #include "souffle/RamTypes.h"
 #include "souffle/RecordTable.h"
+#include "souffle/datastructure/RecordRelocator.h"
 #include "souffle/datastructure/RecordTableImpl.h"
 #include <algorithm>
 #include <functional>
@@ -188,4 +189,164 @@ INSTANTIATE_TEMPLATE_TEST(PackUnpack, Vector, 11);
 INSTANTIATE_TEMPLATE_TEST(PackUnpack, Vector, 23);
 INSTANTIATE_TEMPLATE_TEST(PackUnpack, Vector, 59);
 
+TEST(Unboxed, PackUnpack) {
+    SpecializedRecordTable<2> recordTable;
+    const std::vector<unsigned> widths = {16, 15};
+    RamDomain buffer[MAX_UNBOXED_ARITY];
+
+    const RamDomain small[] = {-32768, 16383};
+    const RamDomain value = packRecord(recordTable, small, 2, widths);
+    EXPECT_TRUE(isUnboxedRecord(value));
+    EXPECT_EQ(value, packRecord(recordTable, small, 2, widths));
+    const RamDomain* data = unpackRecord(recordTable, value, 2, widths, buffer);
+    EXPECT_EQ(-32768, data[0]);
+    EXPECT_EQ(16383, data[1]);
+
+    // records of fields exceeding their widths are boxed
+    const RamDomain large[] = {0, 16384};
+    const RamDomain ref = packRecord(recordTable, large, 2, widths);
+    EXPECT_FALSE(isUnboxedRecord(ref));
+    EXPECT_EQ(ref, recordTable.pack(large, 2));
+    data = unpackRecord(recordTable, ref, 2, widths, buffer);
+    EXPECT_EQ(0, data[0]);
+    EXPECT_EQ(16384, data[1]);
+
+    // records without widths are always boxed, and zero is still nil
+    const RamDomain zeros[] = {0, 0};
+    EXPECT_FALSE(isUnboxedRecord(packRecord(recordTable, zeros, 2, {})));
+    EXPECT_NE(0, packRecord(recordTable, zeros, 2, widths));
+}
+
+namespace {
+
+/** The types of a list of pairs of a number and a symbol, and of an ADT with a list branch */
+const std::string relocationTypes = R"({
+    "records": {
+        "r:Pair": {"types": ["i:number", "s:symbol"], "arity": 2},
+        "r:List": {"types": ["r:Pair", "r:List"], "arity": 2},
+        "r:Small": {"types": ["i:number", "i:number"], "arity": 2, "widths": [16, 15]},
+        "r:Smalls": {"types": ["r:Small", "r:Smalls"], "arity": 2}
+    },
+    "ADTs": {
+        "+:Expr": {"arity": 3, "enum": false, "branches": [
+            {"name": "Leaf", "types": ["i:number"]},
+            {"name": "Nil", "types": []},
+            {"name": "Node", "types": ["+:Expr", "r:Pair", "+:Expr"]}
+        ]},
+        "+:Color": {"arity": 2, "enum": true, "branches": [
+            {"name": "Red", "types": []},
+            {"name": "Blue", "types": []}
+        ]}
+    }
+})";
+
+using CompactedTable = SpecializedRecordTable<0, 1, 2, 3>;
+
+/** Relocate the given values of the given type, and return the new values */
+std::vector<RamDomain> compact(
+        CompactedTable& recordTable, const std::string& type, const std::vector<RamDomain>& values) {
+    std::vector<RamDomain> relocated;
+    recordTable.compact([&](const RecordTable& source, RecordTable& target) {
+        RecordRelocator relocator(source, target, relocationTypes);
+        const auto typeId = relocator.getType(type);
+        for (RamDomain value : values) {
+            relocated.push_back(relocator.relocate(value, typeId));
+        }
+    });
+    return relocated;
+}
+
+}  // namespace
+
+TEST(Compact, Records) {
+    CompactedTable recordTable;
+    RamDomain list = 0;
+    std::vector<RamDomain> garbage;
+    for (RamDomain i = 0; i < 100; ++i) {
+        garbage.push_back(recordTable.pack({-i, -i}));
+        list = recordTable.pack({recordTable.pack({i, i + 1}), list});
+    }
+
+    const auto relocated = compact(recordTable, "r:List", {list, 0});
+    EXPECT_EQ(0, relocated[1]);
+
+    // the list is intact, and the unreachable pairs are released
+    RamDomain cell = relocated[0];
+    for (RamDomain i = 99; i >= 0; --i) {
+        const RamDomain* data = recordTable.unpack(cell, 2);
+        const RamDomain* pair = recordTable.unpack(data[0], 2);
+        EXPECT_EQ(i, pair[0]);
+        EXPECT_EQ(i + 1, pair[1]);
+        cell = data[1];
+    }
+    EXPECT_EQ(0, cell);
+    EXPECT_LT(recordTable.pack({-1, -1}), 202);
+
+    // shared records remain shared
+    const RamDomain pair = recordTable.pack({7, 7});
+    const RamDomain first = recordTable.pack({pair, 0});
+    const RamDomain second = recordTable.pack({pair, first});
+    const auto lists = compact(recordTable, "r:List", {first, second});
+    EXPECT_EQ(lists[0], recordTable.unpack(lists[1], 2)[1]);
+    EXPECT_EQ(recordTable.unpack(lists[0], 2)[0], recordTable.unpack(lists[1], 2)[0]);
+}
+
+TEST(Compact, ADTs) {
+    CompactedTable recordTable;
+    const RamDomain pair = recordTable.pack({1, 2});
+    const RamDomain leaf = recordTable.pack({0, 42});
+    const RamDomain nil = recordTable.pack({1, recordTable.pack(nullptr, 0)});
+    const RamDomain node = recordTable.pack({2, recordTable.pack({leaf, pair, nil})});
+    recordTable.pack({3, 3, 3});
+    recordTable.pack({4, 4});
+
+    const auto relocated = compact(recordTable, "+:Expr", {node, leaf});
+    const RamDomain* branch = recordTable.unpack(relocated[0], 2);
+    EXPECT_EQ(2, branch[0]);
+    const RamDomain* args = recordTable.unpack(branch[1], 3);
+    EXPECT_EQ(args[0], relocated[1]);
+    EXPECT_EQ(42, recordTable.unpack(args[0], 2)[1]);
+    EXPECT_EQ(2, recordTable.unpack(args[1], 2)[1]);
+    EXPECT_EQ(1, recordTable.unpack(args[2], 2)[0]);
+
+    // enumerations are plain numbers
+    EXPECT_EQ(1, compact(recordTable, "+:Color", {1})[0]);
+}
+
+TEST(Compact, Unboxed) {
+    CompactedTable recordTable;
+    const std::vector<unsigned> widths = {16, 15};
+    const RamDomain small[] = {3, -4};
+    const RamDomain large[] = {3, 1 << 20};
+    const RamDomain unboxed = packRecord(recordTable, small, 2, widths);
+    const RamDomain boxed = packRecord(recordTable, large, 2, widths);
+    recordTable.pack({5, 5});
+    const RamDomain list = recordTable.pack({unboxed, recordTable.pack({boxed, 0})});
+
+    // unboxed records are kept, boxed ones are copied
+    const RamDomain cell = compact(recordTable, "r:Smalls", {list})[0];
+    const RamDomain* data = recordTable.unpack(cell, 2);
+    EXPECT_EQ(unboxed, data[0]);
+    data = recordTable.unpack(data[1], 2);
+    EXPECT_FALSE(isUnboxedRecord(data[0]));
+    EXPECT_EQ(1 << 20, recordTable.unpack(data[0], 2)[1]);
+}
+
+TEST(Compact, DeepList) {
+    CompactedTable recordTable;
+    RamDomain list = 0;
+    const RamDomain pair = recordTable.pack({1, 1});
+    for (RamDomain i = 0; i < 1000000; ++i) {
+        list = recordTable.pack({pair, list});
+    }
+
+    RamDomain cell = compact(recordTable, "r:List", {list})[0];
+    std::size_t length = 0;
+    while (cell != 0) {
+        cell = recordTable.unpack(cell, 2)[1];
+        ++length;
+    }
+    EXPECT_EQ(1000000, length);
+}
+
 }  // namespace souffle::test
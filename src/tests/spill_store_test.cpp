@@ -0,0 +1,141 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file spill_store_test.cpp
+ *
+ * Tests the spilling of relations to disk.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/SpillStore.h"
+#include <cstddef>
+#include <filesystem>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+using Pair = Tuple<RamDomain, 2>;
+
+/** A relation of pairs, as enumerated by synthesised programs */
+struct PairRelation {
+    std::set<Pair> tuples;
+
+    std::size_t size() const {
+        return tuples.size();
+    }
+
+    auto begin() const {
+        return tuples.begin();
+    }
+
+    auto end() const {
+        return tuples.end();
+    }
+
+    void insert(const RamDomain* tuple) {
+        tuples.insert(Pair{tuple[0], tuple[1]});
+    }
+
+    void purge() {
+        tuples.clear();
+    }
+};
+
+/** A relation of pairs inserting batches of tuples */
+struct BatchPairRelation : PairRelation {
+    std::size_t batches = 0;
+
+    void insertBatch(const RamDomain* data, std::size_t count) {
+        ++batches;
+        for (std::size_t i = 0; i < count; ++i) {
+            insert(data + i * 2);
+        }
+    }
+};
+
+const std::string directory = std::filesystem::temp_directory_path().string();
+
+}  // namespace
+
+TEST(SpillStore, RoundTrip) {
+    SpillStore store(directory);
+    PairRelation rel;
+    for (RamDomain i = 0; i < 1000; ++i) {
+        rel.tuples.insert(Pair{i, -i});
+    }
+    const auto expected = rel.tuples;
+
+    store.spill("R", rel, 2);
+    EXPECT_TRUE(store.isSpilled("R"));
+    EXPECT_EQ(0, rel.size());
+
+    store.restore("R", rel, 2);
+    EXPECT_FALSE(store.isSpilled("R"));
+    EXPECT_TRUE(expected == rel.tuples);
+
+    // restoring a relation held in memory has no effect
+    store.restore("R", rel, 2);
+    EXPECT_TRUE(expected == rel.tuples);
+}
+
+TEST(SpillStore, Empty) {
+    SpillStore store(directory);
+    PairRelation rel;
+    store.spill("R", rel, 2);
+    EXPECT_FALSE(store.isSpilled("R"));
+}
+
+TEST(SpillStore, Pages) {
+    SpillStore store(directory);
+    BatchPairRelation rel;
+    const std::size_t pageSize = SpillStore::pageBytes / (2 * sizeof(RamDomain));
+    const std::size_t size = 2 * pageSize + 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        rel.tuples.insert(Pair{static_cast<RamDomain>(i / 7), static_cast<RamDomain>(i % 7)});
+    }
+    const auto expected = rel.tuples;
+
+    store.spill("R", rel, 2);
+    store.restore("R", rel, 2);
+    EXPECT_EQ(3, rel.batches);
+    EXPECT_TRUE(expected == rel.tuples);
+}
+
+TEST(SpillStore, Relations) {
+    SpillStore store(directory);
+    PairRelation a;
+    PairRelation b;
+    a.tuples.insert(Pair{1, 2});
+    b.tuples.insert(Pair{3, 4});
+    b.tuples.insert(Pair{5, 6});
+
+    store.spill("A", a, 2);
+    store.spill("B", b, 2);
+    store.restore("B", b, 2);
+    EXPECT_TRUE(store.isSpilled("A"));
+    EXPECT_EQ(0, a.size());
+    EXPECT_EQ(2, b.size());
+
+    // a relation may be spilled again once restored
+    store.spill("B", b, 2);
+    store.restore("A", a, 2);
+    store.restore("B", b, 2);
+    EXPECT_TRUE((std::set<Pair>{{1, 2}}) == a.tuples);
+    EXPECT_TRUE((std::set<Pair>{{3, 4}, {5, 6}}) == b.tuples);
+}
+
+}  // namespace souffle::test
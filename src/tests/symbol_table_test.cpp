@@ -16,14 +16,20 @@
 
 #include "tests/test.h"
 
+#include "souffle/RamTypes.h"
 #include "souffle/SymbolTable.h"
+#include "souffle/datastructure/ShardedFlyweight.h"
+#include "souffle/datastructure/StringArena.h"
 #include "souffle/datastructure/SymbolTableImpl.h"
 #include "souffle/utility/MiscUtil.h"
 #include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
 #include <random>
+#include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #ifdef _OPENMP
@@ -111,4 +117,184 @@ TEST(SymbolTable, Inserts) {
     }
 }
 
+TEST(ShardedSymbolTable, Basics) {
+    ShardedSymbolTable table{"a", "b"};
+    EXPECT_STREQ("a", table.decode(table.encode("a")));
+    EXPECT_STREQ("b", table.decode(table.encode("b")));
+    EXPECT_NE(table.encode("a"), table.encode("b"));
+    EXPECT_TRUE(table.weakContains("a"));
+    EXPECT_FALSE(table.weakContains("c"));
+    EXPECT_TRUE(table.findOrInsert("c").second);
+    EXPECT_FALSE(table.findOrInsert("c").second);
+    EXPECT_TRUE(table.weakContains("c"));
+}
+
+TEST(ShardedSymbolTable, ParallelInserts) {
+    // enough symbols to grow each shard several times
+    const int N = 100000;
+    ShardedSymbolTable table;
+    std::vector<RamDomain> indices(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < 4 * N; ++i) {
+        // each symbol is encoded by several threads concurrently
+        const int j = i % N;
+        const RamDomain index = table.encode("symbol_" + std::to_string(j));
+        if (i < N) {
+            indices[j] = index;
+        }
+    }
+
+    std::vector<RamDomain> unique = indices;
+    std::sort(unique.begin(), unique.end());
+    EXPECT_TRUE(std::unique(unique.begin(), unique.end()) == unique.end());
+    for (int i = 0; i < N; ++i) {
+        EXPECT_STREQ("symbol_" + std::to_string(i), table.decode(indices[i]));
+        EXPECT_EQ(indices[i], table.encode("symbol_" + std::to_string(i)));
+    }
+
+    std::size_t count = 0;
+    for (const auto& It : table) {
+        EXPECT_EQ(static_cast<RamDomain>(It.second), table.encode(It.first));
+        ++count;
+    }
+    EXPECT_EQ(static_cast<std::size_t>(N), count);
+}
+
+TEST(ShardedFlyweight, ContendedGrowth) {
+    // all keys fall into the first shard, which grows while every thread inserts into it
+    struct FirstShard {
+        std::size_t operator()(std::size_t key) const {
+            return key << 6;
+        }
+    };
+    const std::size_t N = 200000;
+    ShardedFlyweight<std::size_t, FirstShard> flyweight;
+    std::vector<std::size_t> indices(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (std::size_t i = 0; i < N; ++i) {
+        indices[i] = flyweight.findOrInsert(i).first;
+    }
+
+    for (std::size_t i = 0; i < N; ++i) {
+        EXPECT_EQ(i, flyweight.fetch(indices[i]));
+        EXPECT_FALSE(flyweight.findOrInsert(i).second);
+    }
+    EXPECT_EQ(N, static_cast<std::size_t>(std::distance(flyweight.begin(), flyweight.end())));
+}
+
+TEST(ArenaSymbolTable, Basics) {
+    ArenaSymbolTable table{"a", "b"};
+    EXPECT_STREQ("a", table.decode(table.encode("a")));
+    EXPECT_STREQ("b", table.decode(table.encode("b")));
+    EXPECT_NE(table.encode("a"), table.encode("b"));
+    EXPECT_TRUE(table.weakContains("a"));
+    EXPECT_FALSE(table.weakContains("c"));
+    EXPECT_TRUE(table.findOrInsert("c").second);
+    EXPECT_FALSE(table.findOrInsert("c").second);
+    EXPECT_TRUE(table.weakContains("c"));
+
+    // views and materialized strings refer to the same characters
+    const std::string large(StringArena::chunkSize, 'x');
+    for (const std::string& symbol : {std::string(""), std::string("a"), large}) {
+        const RamDomain index = table.encode(symbol);
+        EXPECT_TRUE(table.decodeView(index) == symbol);
+        EXPECT_STREQ(symbol, table.decode(index));
+        EXPECT_EQ(&table.decode(index), &table.decode(index));
+    }
+
+    std::set<std::string> symbols;
+    for (const auto& It : table) {
+        EXPECT_EQ(static_cast<RamDomain>(It.second), table.encode(It.first));
+        symbols.insert(It.first);
+    }
+    EXPECT_EQ(5, symbols.size());
+}
+
+TEST(ArenaSymbolTable, ParallelInserts) {
+    const int N = 100000;
+    ArenaSymbolTable table;
+    std::vector<RamDomain> indices(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < 4 * N; ++i) {
+        const int j = i % N;
+        const RamDomain index = table.encode("symbol_" + std::to_string(j));
+        if (i < N) {
+            indices[j] = index;
+        } else {
+            // materialize concurrently with insertions
+            table.decode(index);
+        }
+    }
+
+    for (int i = 0; i < N; ++i) {
+        EXPECT_TRUE(table.decodeView(indices[i]) == "symbol_" + std::to_string(i));
+        EXPECT_STREQ("symbol_" + std::to_string(i), table.decode(indices[i]));
+        EXPECT_EQ(indices[i], table.encode("symbol_" + std::to_string(i)));
+    }
+}
+
+TEST(StringArena, Append) {
+    StringArena arena;
+    std::vector<std::string_view> views;
+    std::size_t bytes = 0;
+    for (int i = 0; i < 200000; ++i) {
+        views.push_back(arena.append("symbol_" + std::to_string(i)));
+        bytes += views.back().size();
+    }
+    for (int i = 0; i < 200000; ++i) {
+        EXPECT_TRUE(views[i] == "symbol_" + std::to_string(i));
+    }
+
+    // small strings are packed back to back
+    EXPECT_TRUE(views[1].data() == views[0].data() + views[0].size());
+    EXPECT_LT(arena.getReservedBytes(), bytes + StringArena::chunkSize);
+}
+
+#ifdef _OPENMP
+/**
+ * Measures the throughput of encoding and decoding symbols against the number
+ * of threads. Most symbols are encoded repeatedly, as in rules concatenating
+ * strings in hot loops. Returns whether all runs decoded the same symbols.
+ */
+template <typename Table>
+bool checkScaling(const std::string& name) {
+    //        const int N = 10000000;     // real benchmark
+    const int N = 100000;  // to not run to long for unit testing
+    const int distinct = N / 16;
+
+    std::set<std::size_t> checksums;
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        Table table(threads);
+        table.setNumLanes(threads);
+        omp_set_num_threads(threads);
+
+        double start = omp_get_wtime();
+        std::size_t checksum = 0;
+#pragma omp parallel for reduction(+ : checksum)
+        for (int i = 0; i < N; ++i) {
+            const RamDomain index = table.encode("symbol_" + std::to_string((i * 7919) % distinct));
+            checksum += table.decode(index).size();
+        }
+        double end = omp_get_wtime();
+
+        std::cout << name << " - number of threads: " << threads << " [" << (end - start) << "s, "
+                  << static_cast<std::size_t>(N / (end - start)) << " encodes/s]\n";
+        checksums.insert(checksum);
+    }
+    return checksums.size() == 1;
+}
+
+TEST(SymbolTable, ParallelScaling) {
+    EXPECT_TRUE(checkScaling<SymbolTableImpl>("SymbolTableImpl"));
+    EXPECT_TRUE(checkScaling<ShardedSymbolTable>("ShardedSymbolTable"));
+    EXPECT_TRUE(checkScaling<ArenaSymbolTable>("ArenaSymbolTable"));
+}
+#endif
+
 }  // namespace souffle::test
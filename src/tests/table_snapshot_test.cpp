@@ -0,0 +1,202 @@
+/*
+ * Souffle - A Datalog Compiler
+ * Copyright (c) 2021, The Souffle Developers. All rights reserved
+ * Licensed under the Universal Permissive License v 1.0 as shown at:
+ * - https://opensource.org/licenses/UPL
+ * - <souffle root>/licenses/SOUFFLE-UPL.txt
+ */
+
+/************************************************************************
+ *
+ * @file table_snapshot_test.cpp
+ *
+ * Tests snapshots of the symbol and record tables.
+ *
+ ***********************************************************************/
+
+#include "tests/test.h"
+
+#include "souffle/RamTypes.h"
+#include "souffle/datastructure/RecordRelocator.h"
+#include "souffle/datastructure/RecordTableImpl.h"
+#include "souffle/datastructure/SymbolTableImpl.h"
+#include "souffle/datastructure/TableSnapshot.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace souffle::test {
+
+namespace {
+
+using RecordTable = SpecializedRecordTable<0, 1, 2>;
+
+template <typename F>
+bool throwsRuntimeError(F&& f) {
+    try {
+        f();
+    } catch (std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void save(const std::string& fileName, const SymbolTableImpl& symbolTable, const RecordTable& recordTable) {
+    TableSnapshotWriter writer;
+    symbolTable.exportSnapshot(writer);
+    recordTable.exportSnapshot(writer);
+    writer.write(fileName);
+}
+
+const std::string fileName =
+        (std::filesystem::temp_directory_path() / "table_snapshot_test.snapshot").string();
+
+}  // namespace
+
+TEST(TableSnapshot, RoundTrip) {
+    std::map<std::string, RamDomain> symbols;
+    std::map<std::vector<RamDomain>, RamDomain> records;
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        for (RamDomain i = 0; i < 1000; ++i) {
+            const std::string symbol = "symbol_" + std::to_string(i);
+            symbols[symbol] = symbolTable.encode(symbol);
+            for (const std::vector<RamDomain>& record :
+                    {std::vector<RamDomain>{i}, {i, -i}, {i, i, i, i, i}}) {
+                records[record] = recordTable.pack(record.data(), record.size());
+            }
+        }
+        symbols[""] = symbolTable.encode("");
+        save(fileName, symbolTable, recordTable);
+    }
+
+    // the symbols of the program are encoded before the snapshot is loaded
+    SymbolTableImpl symbolTable{"symbol_0", "symbol_1"};
+    RecordTable recordTable;
+    auto snapshot = TableSnapshot::open(fileName);
+    symbolTable.importSnapshot(snapshot);
+    recordTable.importSnapshot(snapshot);
+
+    for (const auto& [symbol, index] : symbols) {
+        EXPECT_TRUE(symbolTable.weakContains(symbol));
+        EXPECT_EQ(index, symbolTable.encode(symbol));
+        EXPECT_EQ(symbol, symbolTable.decode(index));
+    }
+    for (const auto& [record, ref] : records) {
+        EXPECT_EQ(ref, recordTable.pack(record.data(), record.size()));
+        const RamDomain* data = recordTable.unpack(ref, record.size());
+        EXPECT_TRUE(std::vector<RamDomain>(data, data + record.size()) == record);
+    }
+
+    // new entries are indexed past the snapshot
+    EXPECT_FALSE(symbolTable.weakContains("new"));
+    const auto inserted = symbolTable.findOrInsert("new");
+    EXPECT_TRUE(inserted.second);
+    EXPECT_LT(snapshot->getSymbolSlots() - 1, static_cast<std::size_t>(inserted.first));
+    EXPECT_EQ("new", symbolTable.decode(inserted.first));
+    const RamDomain newRecord[] = {-1, -1};
+    const RamDomain newRef = recordTable.pack(newRecord, 2);
+    EXPECT_LT(snapshot->getRecords(2)->getSlots() - 1, static_cast<std::size_t>(newRef));
+    EXPECT_EQ(-1, recordTable.unpack(newRef, 2)[1]);
+
+    // iteration covers the snapshot and the new entries
+    std::size_t count = 0;
+    for (const auto& [symbol, index] : symbolTable) {
+        EXPECT_EQ(symbol, symbolTable.decode(static_cast<RamDomain>(index)));
+        ++count;
+    }
+    EXPECT_EQ(symbols.size() + 1, count);
+
+    // snapshots of tables based on a snapshot contain both
+    save(fileName, symbolTable, recordTable);
+    SymbolTableImpl reloadedSymbols;
+    RecordTable reloadedRecords;
+    auto reloaded = TableSnapshot::open(fileName);
+    reloadedSymbols.importSnapshot(reloaded);
+    reloadedRecords.importSnapshot(reloaded);
+    EXPECT_EQ(inserted.first, reloadedSymbols.encode("new"));
+    EXPECT_EQ(symbols["symbol_5"], reloadedSymbols.encode("symbol_5"));
+    EXPECT_EQ(newRef, reloadedRecords.pack(newRecord, 2));
+    const std::vector<RamDomain> oldRecord = {7, -7};
+    EXPECT_EQ(records[oldRecord], reloadedRecords.pack(oldRecord.data(), 2));
+
+    std::filesystem::remove(fileName);
+}
+
+TEST(TableSnapshot, Inconsistent) {
+    {
+        SymbolTableImpl symbolTable{"a", "b"};
+        RecordTable recordTable;
+        save(fileName, symbolTable, recordTable);
+    }
+
+    // the symbols of the program were encoded in another order
+    SymbolTableImpl symbolTable{"b", "a"};
+    EXPECT_TRUE(throwsRuntimeError([&]() { symbolTable.importSnapshot(TableSnapshot::open(fileName)); }));
+    EXPECT_EQ(0, symbolTable.encode("b"));
+
+    // symbols are not changed if the records are inconsistent with the snapshot
+    SymbolTableImpl consistent{"a"};
+    RecordTable recordTable;
+    recordTable.pack({1, 2});
+    EXPECT_TRUE(throwsRuntimeError(
+            [&]() { importTableSnapshot(consistent, recordTable, TableSnapshot::open(fileName)); }));
+    EXPECT_EQ(1, consistent.encode("c"));
+
+    // offsets of symbols must be in order
+    {
+        std::fstream file(fileName, std::ios::in | std::ios::out | std::ios::binary);
+        const std::uint64_t offset = 5;
+        file.seekp(sizeof(TableSnapshot::Header) + sizeof(offset));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    EXPECT_TRUE(throwsRuntimeError([&]() { TableSnapshot::open(fileName); }));
+
+    // files of other formats are rejected
+    std::filesystem::resize_file(fileName, 16);
+    EXPECT_TRUE(throwsRuntimeError([&]() { TableSnapshot::open(fileName); }));
+
+    std::filesystem::remove(fileName);
+    EXPECT_TRUE(throwsRuntimeError([&]() { TableSnapshot::open(fileName); }));
+}
+
+TEST(TableSnapshot, Compact) {
+    RamDomain kept;
+    {
+        SymbolTableImpl symbolTable;
+        RecordTable recordTable;
+        kept = recordTable.pack({recordTable.pack({1, 2}), 0});
+        recordTable.pack({3, 4});
+        save(fileName, symbolTable, recordTable);
+    }
+
+    RecordTable recordTable;
+    recordTable.importSnapshot(TableSnapshot::open(fileName));
+    const RamDomain added = recordTable.pack({recordTable.pack({5, 6}), kept});
+    recordTable.pack({7, 8});
+
+    const std::string types = R"({"records": {
+        "r:Pair": {"types": ["i:number", "i:number"], "arity": 2},
+        "r:List": {"types": ["r:Pair", "r:List"], "arity": 2}
+    }})";
+    RamDomain relocated = 0;
+    recordTable.compact([&](const souffle::RecordTable& source, souffle::RecordTable& target) {
+        RecordRelocator relocator(source, target, types);
+        relocated = relocator.relocate(added, relocator.getType("r:List"));
+    });
+
+    // the records of the snapshot keep their references
+    EXPECT_EQ(kept, recordTable.unpack(relocated, 2)[1]);
+    EXPECT_EQ(kept, recordTable.pack({recordTable.pack({1, 2}), 0}));
+    EXPECT_EQ(6, recordTable.unpack(recordTable.unpack(relocated, 2)[0], 2)[1]);
+
+    std::filesystem::remove(fileName);
+}
+
+}  // namespace souffle::test
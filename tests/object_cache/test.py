@@ -0,0 +1,49 @@
+import argparse
+import os
+import shutil
+import subprocess
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--souffle")
+    parser.add_argument("--output_dir")
+    parser.add_argument("dl")
+
+    args = parser.parse_args()
+    output_dir = args.output_dir
+    cache = os.path.join(output_dir, "cache")
+
+    if os.path.exists(output_dir):
+        shutil.rmtree(output_dir)
+    os.makedirs(output_dir)
+    os.chdir(output_dir)
+
+    def compile_and_run():
+        status = subprocess.run(
+            [args.souffle, "-c", "--object-cache", cache, args.dl], capture_output=True, text=True
+        )
+        sys.stderr.write(status.stderr)
+        if status.returncode != 0:
+            sys.exit("Error: souffle failed with status {}".format(status.returncode))
+        return status.stdout, sorted(os.listdir(cache))
+
+    first_output, first_objects = compile_and_run()
+    second_output, second_objects = compile_and_run()
+
+    if not first_objects:
+        sys.exit("Error: no object in the cache after the first run")
+    # an object of the second run missing from the cache would have been added to it
+    if second_objects != first_objects:
+        sys.exit(
+            "Error: the second run did not reuse the cached objects {}, the cache holds {}".format(
+                first_objects, second_objects
+            )
+        )
+    if second_output != first_output:
+        sys.exit("Error: the outputs of the two runs differ")
+
+
+if __name__ == "__main__":
+    main()